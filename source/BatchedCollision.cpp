@@ -0,0 +1,275 @@
+/* This is the source file which contains the batched collision step used in the space
+ * inhomogeneous problem when BatchedCollisions = True.  Without it, ComputeQ is called once for each
+ * space-step held by the process, so the whole table of convolution weights is read from memory
+ * chunk_Nx times in every stage of RK4.  Here the spectra of all of these space-steps are found
+ * first, and each row of the table (the weights for a given ki) is then read once and applied to
+ * every space-step before the next row is read.  Each weight is loaded once for chunk_Nx products,
+ * and the innermost loop runs over the space-steps, whose spectra are stored next to each other for
+ * each Fourier node.
+ *
+ * For each space-step the quadrature sums are accumulated in the same order as in ComputeQ_Direct
+ * and the stages of RK4 are those of RK4_Inhomo, so the results are the same as with
+ * BatchedCollisions = False.  With ProjectionGEMM = True the increments of all of the space-steps are
+ * projected onto the DG basis together, with one matrix product, and with BatchedFFTs = True the FFTs
+ * of all of the space-steps are taken together, with one call of fftw_execute for each transform.
+ *
+ * Functions included: InitBatchedCollision, FreeBatchedCollision, ComputeQ_Batched, StageSeries, RK4_Batched
+ *
+ */
+
+#include "BatchedCollision.h"																		// BatchedCollision.h is where the prototypes for the functions contained in this file are declared
+
+static int batch_cells;																				// declare batch_cells (the largest number of space-steps in a batch)
+static fftw_complex *fHat_cells;																	// declare a pointer to fHat_cells (the spectra of the space-steps in the batch, with the values of all the space-steps at a given Fourier node stored together)
+static double *sum_re, *sum_im;																		// declare pointers to sum_re & sum_im (the real & imaginary parts of the quadrature sums for every space-step in the batch, with one set for each thread)
+static double **Q_cells, **f1_cells;																// declare pointers to Q_cells & f1_cells (Q & f1 of RK4_Inhomo, for each space-step in the batch)
+static fftw_complex **qHat_cells, **Q1_cells, **Q2_cells, **Q3_cells;								// declare pointers to qHat_cells, Q1_cells, Q2_cells & Q3_cells (qHat, Q1_fft, Q2_fft & Q3_fft of RK4_Inhomo, for each space-step in the batch)
+
+void InitBatchedCollision(int cells)																// Function to allocate the spectra, sums & stages of RK4 for a batch of up to cells space-steps
+{
+	int c;
+
+	batch_cells = cells;
+	fHat_cells = (fftw_complex *)fftw_malloc(cells*size_ft*sizeof(fftw_complex));
+	sum_re = (double *)malloc(omp_get_max_threads()*cells*sizeof(double));
+	sum_im = (double *)malloc(omp_get_max_threads()*cells*sizeof(double));
+
+	Q_cells = (double **)malloc(cells*sizeof(double *));
+	f1_cells = (double **)malloc(cells*sizeof(double *));
+	qHat_cells = (fftw_complex **)malloc(cells*sizeof(fftw_complex *));
+	Q1_cells = (fftw_complex **)malloc(cells*sizeof(fftw_complex *));
+	Q2_cells = (fftw_complex **)malloc(cells*sizeof(fftw_complex *));
+	Q3_cells = (fftw_complex **)malloc(cells*sizeof(fftw_complex *));
+	for(c=0;c<cells;c++)
+	{
+		Q_cells[c] = (double *)malloc(size_ft*sizeof(double));
+		f1_cells[c] = (double *)malloc(size_ft*sizeof(double));
+		qHat_cells[c] = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		Q1_cells[c] = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		Q2_cells[c] = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		Q3_cells[c] = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+	}
+	if(BatchedFFTs)
+	{
+		if(myrank_mpi==0)
+		{
+			PlanBatchedFFTs(cells, fft_planner);													// plan the r2c & c2r FFTs of all of the space-steps of a batch at once
+		}
+		ShareFFTWisdom();																			// send the wisdom of these plans to the other processes, which then look them up
+		if(myrank_mpi!=0)
+		{
+			PlanBatchedFFTs(cells, fft_planner);
+		}
+	}
+
+	if(myrank_mpi==0)
+	{
+		printf("Collisions are batched over up to %d space-steps (%g MB of spectra & stages per process).\n\n",
+				cells, (double)cells*size_ft*(5*sizeof(fftw_complex) + 2*sizeof(double))/(1024.*1024.));
+	}
+}
+
+void FreeBatchedCollision()																			// Function to delete the spectra, sums & stages of RK4 of the batch
+{
+	int c;
+
+	for(c=0;c<batch_cells;c++)
+	{
+		free(Q_cells[c]); free(f1_cells[c]);
+		fftw_free(qHat_cells[c]); fftw_free(Q1_cells[c]); fftw_free(Q2_cells[c]); fftw_free(Q3_cells[c]);
+	}
+	free(Q_cells); free(f1_cells);
+	free(qHat_cells); free(Q1_cells); free(Q2_cells); free(Q3_cells);
+	fftw_free(fHat_cells);
+	free(sum_re); free(sum_im);
+	if(BatchedFFTs)
+	{
+		FreeBatchedFFTs();
+	}
+}
+
+void ComputeQ_Batched(double **f, fftw_complex **qHat, int cells, double **conv_weights)			// Function to calculate the Fourier transform of Q(f[c],f[c]) for c = 0,...,cells-1, as in ComputeQ_Direct, reading each row of conv_weights once for all of them
+{
+	int c, ki, i, j, k, l, m, n, x, y, z, kw, kz;
+	int t, ki_end, threads = ModeThreads();
+	int start_i, start_j, start_k, end_i, end_j, end_k;
+	double tempD, *acc_re, *acc_im;
+	double prefactor = h_eta*h_eta*h_eta;
+	const double *W;
+	const fftw_complex *fHat_w, *fHat_z;
+
+	if(BatchedFFTs)																					// find the spectra of all of the space-steps with one batched FFT, using qHat to hold them until they are stored with those of the others
+	{
+		fft3D_Batched(f, qHat, cells);
+		for(c=0;c<cells;c++)
+		{
+			for(i=0;i<size_ft;i++)
+			{
+				fHat_cells[c + cells*i][0] = qHat[c][i][0];
+				fHat_cells[c + cells*i][1] = qHat[c][i][1];
+			}
+		}
+	}
+	else
+	{
+		for(c=0;c<cells;c++)																		// find the spectrum of each space-step & store it with those of the others
+		{
+			fft3D(f[c], fftOut);
+			for(i=0;i<size_ft;i++)
+			{
+				fHat_cells[c + cells*i][0] = fftOut[i][0];
+				fHat_cells[c + cells*i][1] = fftOut[i][1];
+			}
+		}
+	}
+
+	#pragma omp parallel for schedule(static,1) num_threads(threads) private(t,ki_end,c,ki,i,j,k,l,m,n,x,y,z,kw,kz,start_i,start_j,start_k,end_i,end_j,end_k,tempD,acc_re,acc_im,W,fHat_w,fHat_z) shared(qHat, fHat_cells, conv_weights)
+	for(t=0;t<threads;t++)																			// give each thread one range of modes of about the same cost (see ModeSchedule.cpp)
+	{
+		for(ki=ModeStart(t, threads), ki_end=ModeStart(t+1, threads);ki<ki_end;ki++)
+		{
+			i = ki/(N*N); j = (ki/N)%N; k = ki%N;
+			W = conv_weights[ki];																	// the row of weights for ki, which is read once for the whole batch
+			acc_re = sum_re + batch_cells*omp_get_thread_num();
+			acc_im = sum_im + batch_cells*omp_get_thread_num();
+
+			ConvolutionWindow(i, &start_i, &end_i);
+			ConvolutionWindow(j, &start_j, &end_j);
+			ConvolutionWindow(k, &start_k, &end_k);
+
+			for(c=0;c<cells;c++)
+			{
+				acc_re[c] = 0.;
+				acc_im[c] = 0.;
+			}
+			for(l=start_i;l<end_i;l++)
+			{
+				x = i + N/2 - l;																	// eta[x] = ki[i] - eta[l]
+				for(m=start_j;m<end_j;m++)
+				{
+					y = j + N/2 - m;
+					for(n=start_k;n<end_k;n++)
+					{
+						z = k + N/2 - n;
+						kw = n + N*(m + N*l);
+						kz = z + N*(y + N*x);
+
+						tempD = prefactor*wtN[l]*wtN[m]*wtN[n]*W[kw];								// the same product as in ComputeQ_Direct, so each sum is unchanged
+						fHat_w = fHat_cells + cells*kw;
+						fHat_z = fHat_cells + cells*kz;
+						#pragma omp simd
+						for(c=0;c<cells;c++)
+						{
+							acc_re[c] += tempD*(fHat_w[c][0]*fHat_z[c][0] - fHat_w[c][1]*fHat_z[c][1]);
+							acc_im[c] += tempD*(fHat_w[c][0]*fHat_z[c][1] + fHat_w[c][1]*fHat_z[c][0]);
+						}
+					}
+				}
+			}
+			for(c=0;c<cells;c++)
+			{
+				qHat[c][ki][0] = acc_re[c];
+				qHat[c][ki][1] = acc_im[c];
+			}
+		}
+	}
+
+	for(c=0;c<cells;c++)
+	{
+		GatherModes(qHat[c]);																		// collect the modes computed by the other processes holding these space-steps (see ModeSchedule.cpp)
+	}
+	CheckComputeQ_Batched(f, qHat, cells);															// the first time through, compare every space-step with ComputeQ_Direct (if CheckEngine is true)
+}
+
+static void StageSeries(fftw_complex **Q_hat, double **Q, int cells)								// Function to conserve the moments of the stage Q_hat of RK4 of each space-step & set Q to its Fourier series, with one batched inverse FFT if BatchedFFTs is true
+{
+	int c;
+
+	for(c=0;c<cells;c++)
+	{
+		conserveMoments(Q_hat[c]);
+	}
+	if(BatchedFFTs)
+	{
+		FS_Batched(Q_hat, Q, cells);
+	}
+	else
+	{
+		for(c=0;c<cells;c++)
+		{
+			FS(Q_hat[c], Q[c]);
+		}
+	}
+}
+
+void RK4_Batched(double **f, double **conv_weights, double *U, double *dU)							// Function to advance every space-step held by this process one time-step of the collisional problem, as the calls of ComputeQ, conserveMoments & RK4_Inhomo for each space-step do, but with each stage batched over the space-steps
+{
+	int c, i, first, cells;
+	double *proj;
+
+	first = chunk_Nx*grid_rank_x;																	// the first space-step held by this process
+	cells = Nx - first;
+	if(cells > chunk_Nx)
+	{
+		cells = chunk_Nx;
+	}
+	if(cells <= 0)
+	{
+		return;
+	}
+
+	ComputeQ_Batched(f, qHat_cells, cells, conv_weights);											// the first stage, Kn^1 = Q(Fn, Fn)
+	StageSeries(qHat_cells, Q_cells, cells);
+	for(c=0;c<cells;c++)
+	{
+		#pragma omp parallel for private(i) shared(c, f)
+		for(i=0;i<size_ft;i++)
+		{
+			f1_cells[c][i] = f[c][i] + dt*Q_cells[c][i]*nu;
+		}
+	}
+
+	ComputeQ_Batched(f1_cells, Q1_cells, cells, conv_weights);										// the second stage
+	StageSeries(Q1_cells, f1_cells, cells);															// f1 of each space-step is no longer needed, so it holds the Fourier series of Q1 until it is overwritten below
+	for(c=0;c<cells;c++)
+	{
+		#pragma omp parallel for private(i) shared(c, f)
+		for(i=0;i<size_ft;i++)
+		{
+			f1_cells[c][i] = f[c][i] +  0.5*dt*Q_cells[c][i]*nu + 0.5*dt*f1_cells[c][i]*nu;
+		}
+	}
+
+	ComputeQ_Batched(f1_cells, Q2_cells, cells, conv_weights);										// the third stage
+	StageSeries(Q2_cells, f1_cells, cells);
+	for(c=0;c<cells;c++)
+	{
+		#pragma omp parallel for private(i) shared(c, f)
+		for(i=0;i<size_ft;i++)
+		{
+			f1_cells[c][i] = f[c][i] + 0.5*Q_cells[c][i]*nu + 0.5*f1_cells[c][i]*nu;					// as in RK4_Inhomo (where this stage has no factor of dt)
+		}
+	}
+
+	ComputeQ_Batched(f1_cells, Q3_cells, cells, conv_weights);										// the fourth stage
+	for(c=0;c<cells;c++)
+	{
+		conserveMoments(Q3_cells[c]);
+	}
+
+	if(ProjectionGEMM)																				// project the increments of all of the space-steps with one matrix product
+	{
+		proj = ProjectRK4StagesBatched(qHat_cells, Q1_cells, Q2_cells, Q3_cells, cells, nu);
+		for(c=0;c<cells;c++)
+		{
+			RK4_Inhomo_Apply(first + c, proj + 5*size_v*c, U, dU);									// update the DG coefficients at the space-step first + c
+		}
+	}
+	else
+	{
+		for(c=0;c<cells;c++)
+		{
+			RK4_Inhomo_Update(first + c, qHat_cells[c], Q1_cells[c], Q2_cells[c], Q3_cells[c], U, dU);	// combine the stages & project the increment onto the DG basis at the space-step first + c
+		}
+	}
+}
@@ -0,0 +1,34 @@
+/* This is the header file associated to BatchedCollision.cpp in which the prototypes for the
+ * functions contained in that file are declared.  Any other header files which must be linked to
+ * for the functions here are also included.
+ *
+ */
+
+//************************//
+//     INCLUDE GUARDS     //
+//************************//
+
+#ifndef BATCHEDCOLLISION_H_
+#define BATCHEDCOLLISION_H_
+
+//************************//
+//        INCLUDES        //
+//************************//
+
+#include "LP_ompi.h"																				// allows the libraries included, macros defined and external variables declared in LP_ompi.h to be used in the BatchedCollision functions
+#include "collisionRoutines_1.h"																	// allows fft3D, FS, fft3D_Batched, FS_Batched, RK4_Inhomo_Update & RK4_Inhomo_Apply to be used in the BatchedCollision functions
+#include "conservationRoutines.h"																	// allows conserveMoments to be used in the BatchedCollision functions
+
+//************************//
+//   FUNCTION PROTOTYPES  //
+//************************//
+
+void InitBatchedCollision(int cells);
+
+void FreeBatchedCollision();
+
+void ComputeQ_Batched(double **f, fftw_complex **qHat, int cells, double **conv_weights);
+
+void RK4_Batched(double **f, double **conv_weights, double *U, double *dU);
+
+#endif /* BATCHEDCOLLISION_H_ */
@@ -0,0 +1,315 @@
+/* This is the main source file for the CollisionBenchmark target, which times the quadrature sums of
+ * the Direct collision engine (ComputeQ with CollisionEngine = Direct) with each of the kernels
+ * which can be chosen with DirectKernel, so that the fastest one on a given machine can be found.
+ *
+ * It reads the same input file as the solver (LPsolver-input.txt), sets up the velocity & Fourier
+ * domains and the table of convolution weights for the values of N, Lv & gamma found there, and then
+ * calls ComputeQ for a fixed f with the Scalar kernel and each of the split-complex kernels
+ * supported by the processor, and then with the Scalar loop reading the weights stored as floats
+ * (FloatWeights = True), then the packed weights (PackedWeights = True), then one weight per orbit
+ * of the kernel (SymmetricWeights = True), and finally with the Scalar sums batched over Cells
+ * copies of f, as in the collision step of the space inhomogeneous problem with BatchedCollisions =
+ * True.  The FFTs of fft3D & FS for these copies are then timed one copy at a time and all at once
+ * (BatchedFFTs = True).  The number of calls timed for each kernel is set by Repeats, and the number
+ * of copies of f in the batch by Cells, in the Benchmark section of the input file (defaults 10 &
+ * 4).  For each kernel the time per call (per copy of f for the batch), the speedup over the Scalar
+ * kernel and the largest difference from the Scalar result are printed.  Last, the Scalar kernel is
+ * timed with 1, 2, 4, ... threads up to MaxThreads (default the number of OpenMP threads), printing
+ * the speedup & parallel efficiency for each.
+ *
+ * This file is only compiled with a main when COLLISION_BENCHMARK is defined.
+ *
+ */
+
+#include "LP_ompi.h"																				// LP_ompi.h is where the libraries required by the program included, all macros are defined and all variables to be used throughout the various files are defined as external
+
+#ifdef COLLISION_BENCHMARK
+
+static double TimeComputeQ(double *f, fftw_complex *qHat, double **conv_weights, int repeats)	// Function to return the time per call of ComputeQ with the current options, after one untimed call to warm up the caches & threads
+{
+	int rep;
+	double t1;
+
+	ComputeQ(f, qHat, conv_weights);
+	t1 = MPI_Wtime();
+	for(rep=0;rep<repeats;rep++)
+	{
+		ComputeQ(f, qHat, conv_weights);
+	}
+	return (MPI_Wtime() - t1)/repeats;
+}
+
+static void PrintKernelTime(const char *kernel, double t, double t_scalar, double rel_diff)		// Function to print the time per call of a kernel, its speedup over the Scalar kernel & the largest difference from the Scalar result (relative to its largest value)
+{
+	if(myrank_mpi==0)
+	{
+		printf("%8s %16.6e %10.2f %24.3e\n", kernel, t, t_scalar/t, rel_diff);
+	}
+}
+
+int main()
+{
+	int i, j, k, c, kernel, rep, repeats, cells, gamma;												// declare i, j, k & c (counters), kernel (the kernel being timed), rep (a counter for the calls), repeats (the number of calls timed), cells (the number of copies of f in the batched call) & gamma (the power of |u| in the collision kernel)
+	int provided;																					// declare provided (the actual provided level of MPI thread support)
+	std::string flag, IC_flag, IC_name, input_filename;												// declare the strings flag, IC_flag, IC_name & input_filename (which are read from the input file in the same way as in the solver)
+	double *f, t1, t2, t_scalar = 0., rel_diff;													// declare a pointer to f (the sampling of the solution), t1 & t2 (to time the calls), t_scalar (the time per call of the Scalar kernel) & rel_diff (the largest difference from the Scalar result, relative to its largest value)
+	fftw_complex *qHat, *qHat_scalar;																// declare pointers to qHat (the result of the kernel being timed) & qHat_scalar (the result of the Scalar kernel)
+	double **f_cells, **Q_cells, *Q_single, t_fft;													// declare pointers to f_cells (the copies of f in the batched call), Q_cells & Q_single (the Fourier series found by the batched & single FFTs) & t_fft (the time per copy of the single FFTs)
+	fftw_complex **qHat_cells;																		// declare a pointer to qHat_cells (the results of the batched call)
+	double **conv_weights;																			// declare a pointer to the rows of the table of convolution weights
+	int threads, max_threads, saved_threads;														// declare threads (the number of threads timed), max_threads (the most threads timed) & saved_threads (the number of threads to restore afterwards)
+	double t_one = 0.;																				// declare t_one (the time per call with one thread)
+
+	MPI_Init_thread(NULL, NULL, MPI_THREAD_FUNNELED, &provided);									// initialise the hybrid MPI & OpenMP environment (only the master thread makes MPI calls here)
+	MPI_Comm_rank(MPI_COMM_WORLD, &myrank_mpi);														// store the rank of the current process in the MPI_COMM_WORLD communicator in myrank_mpi
+	MPI_Comm_size(MPI_COMM_WORLD, &nprocs_mpi);														// store the total number of processes running in the MPI_COMM_WORLD communicator in nprocs_mpi
+
+	//************************
+	//GRVY input parsing
+	//************************
+
+	GRVY_Input_Class iparse;																		// define a GRVY input parsing object
+	input_filename.assign("./LPsolver-input.txt");													// set a name for the input file to be ready by GRVY
+
+	if(! iparse.Open(input_filename.c_str()))														// Initialise and read in the GRVY file with the input paramters
+	{
+		std::cout << "Program cannot run... The file " << input_filename << " cannot be found."
+			<< std::endl << "Please create an appropriate input file before running again."
+			<< std::endl;																			// Print an error message if the file does not exist
+		exit(1);																					// Exit if it does not exist
+	}
+
+	ReadICOptions(iparse);																			// Read the initial condition for this run from the input file (Lv is read from its section)
+	CheckICOptions(IC_flag);																		// Check just one initial condition was set for this run
+	ReadICName(iparse, IC_flag, IC_name);															// Read in a string of the name of the initial conditions chosen
+
+	ReadGamma(iparse, gamma);																		// Read in gamma to find the types of collisions being used
+	ReadInputParameters(iparse, flag, nT, Nx, Nv, N, nu, dt, A_amp, k_wave, Lv, Lx);				// Read in all input parameters
+	ReadWeightStoreOptions(iparse);																	// Read in if the weights are mapped from a weight store
+	ReadFFTWOptions(iparse);																		// Read in how the FFTs are planned, as in the solver
+	iparse.Read_Var("Benchmark/Repeats",&repeats,10);												// Read in the number of calls timed for each kernel
+	iparse.Read_Var("Benchmark/Cells",&cells,4);													// Read in the number of space-steps in the batch timed with BatchedCollisions
+	iparse.Read_Var("Benchmark/MaxThreads",&max_threads,omp_get_max_threads());					// Read in the most threads the scaling of ComputeQ is timed with
+
+	//INITIALISE VELOCITY AND FOURIER DOMAINS & THE FFTs (IN THE SAME WAY AS THE SOLVER):
+	size_ft = N*N*N;																				// set size_ft to N^3
+	scale = 1.0/sqrt(2.0*M_PI);																		// set scale to 1/sqrt(2*pi)
+	scale3 = pow(scale, 3.0);																		// set scale3 to scale^3
+	L_v = Lv;																						// set L_v to Lv
+	R_v = Lv;																						// set R_v to Lv
+	L_eta = 0.5*(double)(N-1)*PI/L_v;																// set L_eta to (N-1)*Pi/(2*L_v)
+	h_v = 2.0*L_v/(double)(N-1);																	// set h_v to 2*L_v/(N-1)
+	h_eta = 2.0*L_eta/(double)(N);																	// set h_eta to 2*L_eta/N
+	eta = (double *)malloc(N*sizeof(double));														// allocate enough space at the pointer eta to store N many double numbers
+	v = (double *)malloc(N*sizeof(double));															// allocate enough space at the pointer v to store N many double numbers
+	wtN = (double *)malloc(N*sizeof(double));														// allocate enough space at the pointer wtN to store N many double numbers
+	for(i=0;i<N;i++)
+	{
+		eta[i] = -L_eta + (double)i*h_eta;															// set the ith value of eta to -L_eta + i*h_eta
+		v[i] = -L_v + (double)i*h_v;																// set the ith value of v to -L_v + i*h_v
+	}
+	trapezoidalRule(N, wtN);																		// set wtN to the weights required for a trapezoidal rule with N points
+	InitFFTShifts();																				// tabulate the 1-D factors which shift the FFTs in fft3D & FS, as in the solver
+
+	temp = (fftw_complex *)fftw_malloc(N*N*(N/2+1)*sizeof(fftw_complex));							// allocate enough space at the pointer temp for the half spectrum of a real function, as in the solver
+	fftOut = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));								// allocate enough space at the pointers fftOut, qHat & qHat_scalar for size_ft many complex numbers
+	qHat = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+	qHat_scalar = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+	fftw_init_threads();																			// initialise the environment for using the fftw3 routines with multiple threads
+	fftw_plan_with_nthreads(FFTThreads(N));															// set the number of threads used by fftw3 routines as in the solver
+	LoadFFTWisdom();																				// import the wisdom of earlier runs (if UseWisdom is true)
+	PlanFFTs(fft_planner);																			// set p_forward & p_backward to the r2c & c2r plans of dimension NxNxN, as in the solver
+	InitCollisionWorkspaces(0);																		// point the shared collision workspace at temp & fftOut, as in the solver
+	InitModeSchedule();																				// tabulate the cost of the quadrature sum of each mode, as in the solver
+
+	// Sample a Maxwellian with a small random perturbation, so that no part of the spectrum is zero:
+	f = (double *)malloc(size_ft*sizeof(double));													// allocate enough space at the pointer f to store size_ft many double numbers
+	srand(1);
+	for(i=0;i<N;i++)
+	{
+		for(j=0;j<N;j++)
+		{
+			for(k=0;k<N;k++)
+			{
+				f[k + N*(j + N*i)] = scale3*exp(-0.5*(v[i]*v[i] + v[j]*v[j] + v[k]*v[k]))
+										*(1. + 0.1*(double)rand()/(double)RAND_MAX);
+			}
+		}
+	}
+
+	collision_engine = ENGINE_DIRECT;
+	conv_weights = GetWeightTable(WEIGHTS_LANDAU, gamma);											// build (or map) the table of gHat3 weights read by every kernel
+	direct_kernel = KERNEL_AUTO;
+	InitSIMDCollision();																			// allocate the split-complex streams & report the kernel DirectKernel = Auto would choose (direct_kernel is set again for each kernel below)
+
+	if(myrank_mpi==0)
+	{
+		printf("\nComputeQ with the Direct collision engine (N = %d, gamma = %d, %d threads, %d calls per kernel):\n",
+				N, gamma, omp_get_max_threads(), repeats);
+		printf("%8s %16s %10s %24s\n", "kernel", "seconds/call", "speedup", "max rel diff vs Scalar");
+	}
+	for(kernel=KERNEL_SCALAR;kernel<KERNEL_AUTO;kernel++)
+	{
+		if(! DirectKernelSupported(kernel))
+		{
+			if(myrank_mpi==0)
+			{
+				printf("%8s %16s\n", DirectKernelName(kernel), "not supported");
+			}
+			continue;
+		}
+		direct_kernel = kernel;
+		if(kernel == KERNEL_SCALAR)
+		{
+			t_scalar = TimeComputeQ(f, qHat_scalar, conv_weights, repeats);
+			PrintKernelTime(DirectKernelName(kernel), t_scalar, t_scalar, 0.);
+		}
+		else
+		{
+			t2 = TimeComputeQ(f, qHat, conv_weights, repeats);
+			PrintKernelTime(DirectKernelName(kernel), t2, t_scalar, RelativeMaxDiff(qHat, qHat_scalar, size_ft));
+		}
+	}
+
+	// Time the Scalar loop again with the weights stored as floats (FloatWeights = True):
+	FloatWeights = true;
+	CompareFloatWeights = false;
+	direct_kernel = KERNEL_SCALAR;
+	InitFloatWeights(gamma);
+	t2 = TimeComputeQ(f, qHat, conv_weights, repeats);
+	PrintKernelTime("Float", t2, t_scalar, RelativeMaxDiff(qHat, qHat_scalar, size_ft));
+	FreeFloatWeights();
+	FloatWeights = false;
+
+	// Time the Scalar loop again reading the packed weights (PackedWeights = True):
+	PackedWeights = true;
+	InitPackedWeights(gamma);
+	t2 = TimeComputeQ(f, qHat, conv_weights, repeats);
+	PrintKernelTime("Packed", t2, t_scalar, RelativeMaxDiff(qHat, qHat_scalar, size_ft));
+	PackedWeights = false;
+
+	// Time the Scalar loop again reading one weight per orbit of the kernel (SymmetricWeights = True):
+	SymmetricWeights = true;
+	InitSymmetricWeights(gamma);
+	t2 = TimeComputeQ(f, qHat, conv_weights, repeats);
+	PrintKernelTime("Symmetry", t2, t_scalar, RelativeMaxDiff(qHat, qHat_scalar, size_ft));
+	SymmetricWeights = false;
+
+	// Time the Scalar sums again batched over cells copies of f (BatchedCollisions = True), reporting the time per copy:
+	f_cells = (double **)malloc(cells*sizeof(double *));
+	qHat_cells = (fftw_complex **)malloc(cells*sizeof(fftw_complex *));
+	for(c=0;c<cells;c++)
+	{
+		f_cells[c] = f;
+		qHat_cells[c] = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+	}
+	InitBatchedCollision(cells);
+	ComputeQ_Batched(f_cells, qHat_cells, cells, conv_weights);
+	t1 = MPI_Wtime();
+	for(rep=0;rep<repeats;rep++)
+	{
+		ComputeQ_Batched(f_cells, qHat_cells, cells, conv_weights);
+	}
+	t2 = (MPI_Wtime() - t1)/(repeats*cells);
+	rel_diff = 0.;
+	for(c=0;c<cells;c++)
+	{
+		rel_diff = fmax(rel_diff, RelativeMaxDiff(qHat_cells[c], qHat_scalar, size_ft));
+	}
+	if(myrank_mpi==0)
+	{
+		printf("%8s %16.6e %10.2f %24.3e   (per cell, %d cells per batch)\n", "Batched", t2, t_scalar/t2, rel_diff, cells);
+	}
+	FreeBatchedCollision();
+
+	// Time the FFTs of fft3D & FS for the batch, one copy at a time (BatchedFFTs = False) & all at once
+	// (BatchedFFTs = True), reporting the time per copy & the difference of the batched Fourier series:
+	Q_cells = (double **)malloc(cells*sizeof(double *));
+	for(c=0;c<cells;c++)
+	{
+		Q_cells[c] = (double *)malloc(size_ft*sizeof(double));
+	}
+	Q_single = (double *)malloc(size_ft*sizeof(double));
+	PlanBatchedFFTs(cells, fft_planner);
+	SaveFFTWisdom();																				// keep the wisdom of the single & batched plans for later runs (if UseWisdom is true)
+	t1 = MPI_Wtime();
+	for(rep=0;rep<repeats;rep++)
+	{
+		for(c=0;c<cells;c++)
+		{
+			fft3D(f_cells[c], qHat_cells[c]);
+			FS(qHat_cells[c], Q_cells[c]);
+		}
+	}
+	t_fft = (MPI_Wtime() - t1)/(repeats*cells);
+	for(i=0;i<size_ft;i++)
+	{
+		Q_single[i] = Q_cells[0][i];
+	}
+	t1 = MPI_Wtime();
+	for(rep=0;rep<repeats;rep++)
+	{
+		fft3D_Batched(f_cells, qHat_cells, cells);
+		FS_Batched(qHat_cells, Q_cells, cells);
+	}
+	t2 = (MPI_Wtime() - t1)/(repeats*cells);
+	rel_diff = 0.;
+	for(c=0;c<cells;c++)
+	{
+		rel_diff = fmax(rel_diff, RelativeMaxDiff(Q_cells[c], Q_single, size_ft));
+	}
+	if(myrank_mpi==0)
+	{
+		printf("\nfft3D & FS for a batch of %d copies of f:\n", cells);
+		printf("%8s %16s %10s %24s\n", "FFTs", "seconds/cell", "speedup", "max rel diff vs Single");
+		printf("%8s %16.6e %10.2f %24s\n", "Single", t_fft, 1., "-");
+		printf("%8s %16.6e %10.2f %24.3e\n", "Batched", t2, t_fft/t2, rel_diff);
+	}
+	FreeBatchedFFTs();
+	for(c=0;c<cells;c++)
+	{
+		fftw_free(qHat_cells[c]);
+		free(Q_cells[c]);
+	}
+	free(f_cells); free(qHat_cells); free(Q_cells); free(Q_single);
+
+	// Time the Scalar kernel with 1, 2, 4, ... threads (up to MaxThreads), reporting the speedup over
+	// one thread, the parallel efficiency (the speedup divided by the number of threads) & the largest
+	// efficiency the schedule of the modes allows (see ModeSchedule.cpp):
+	direct_kernel = KERNEL_SCALAR;
+	saved_threads = omp_get_max_threads();
+	if(myrank_mpi==0)
+	{
+		printf("\nScaling of ComputeQ with the Scalar kernel (N = %d, %d calls per number of threads):\n", N, repeats);
+		printf("%8s %16s %10s %12s %12s\n", "threads", "seconds/call", "speedup", "efficiency", "balance");
+	}
+	for(threads=1;threads<=max_threads;threads*=2)
+	{
+		omp_set_num_threads(threads);
+		t2 = TimeComputeQ(f, qHat, conv_weights, repeats);
+		if(threads == 1)
+		{
+			t_one = t2;
+		}
+		if(myrank_mpi==0)
+		{
+			printf("%8d %16.6e %10.2f %12.3f %12.3f\n", threads, t2, t_one/t2, t_one/(t2*threads), ModeScheduleBalance(threads));
+		}
+	}
+	omp_set_num_threads(saved_threads);
+
+	FreeSIMDCollision();																			// delete the split-complex streams
+	FreeWeightTables();																				// delete the table of convolution weights (or unmap its weight store)
+	fftw_destroy_plan(p_forward); fftw_destroy_plan(p_backward);									// delete the fftw plans
+	FreeFFTShifts();																				// delete the tables of the factors which shift the FFTs
+	FreeCollisionWorkspaces();																		// delete the partial sums of the shared collision workspace
+	FreeModeSchedule();																				// delete the running total of the costs of the modes
+	fftw_free(temp); fftw_free(fftOut); fftw_free(qHat); fftw_free(qHat_scalar);					// delete the dynamic memory allocated for temp, fftOut, qHat & qHat_scalar
+	free(f); free(eta); free(v); free(wtN);															// delete the dynamic memory allocated for f, eta, v & wtN
+	iparse.Close();																					// close the input file
+
+	MPI_Finalize();																					// ensure that MPI exits cleanly
+	return 0;
+}
+
+#endif /* COLLISION_BENCHMARK */
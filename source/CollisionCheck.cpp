@@ -0,0 +1,190 @@
+/* This is the source file which contains the check of the collision step against ComputeQ_Direct
+ * (CheckEngine = True), for the MatrixFree engine and every option of the Direct engine.  The FFT &
+ * low-rank engines compare themselves with the matrix-free routines, so they are not checked here.
+ *
+ * The first time qHat is found (by ComputeQ, ComputeQLinear, ComputeQ_FandL or the batched step),
+ * it is compared with the quadrature sum of ComputeQ_Direct over every mode, reading tables of
+ * weights built just for the check by generate_conv_weights (and generate_conv_weights_linear).
+ * The check is therefore independent of how the weights of the run are stored (as floats, packed,
+ * by orbit, shared by the node or mapped from a weight store) and of how the modes are shared out
+ * (the mode schedules of the threads & processes), and it reports the largest
+ * difference relative to the largest mode, as the FFT & low-rank engines do.
+ *
+ * The tables take 8*size_ft^2 bytes each (2 MB for N = 8, 134 MB for N = 16), and are deleted
+ * again straight after the check.
+ *
+ * Functions included: InitCollisionCheck, CheckedPathName, DirectReference, CheckCollisionStep,
+ * CheckComputeQ, CheckComputeQLinear, CheckComputeQ_FandL, CheckComputeQ_Batched
+ *
+ */
+
+#include "CollisionCheck.h"																			// CollisionCheck.h is where the prototypes for the functions contained in this file are declared
+
+static bool collision_checked = false;																// declare collision_checked (set once the collision step has been compared with ComputeQ_Direct)
+static int gamma_check;																				// declare gamma_check (the value of gamma the weights of the check are built for)
+
+void InitCollisionCheck(int gamma)																	// Function to set the value of gamma the weights of the check are built for
+{
+	gamma_check = gamma;
+	collision_checked = false;
+}
+
+static const char *CheckedPathName()																// Function to return the name of the collision engine & the options of the Direct engine in use, as printed by the check
+{
+	static std::string name;
+
+	name = (collision_engine == ENGINE_MATRIXFREE) ? "MatrixFree" : "Direct";
+	if(collision_engine == ENGINE_DIRECT)
+	{
+		if(FloatWeights) name += "+FloatWeights";
+		else if(PackedWeights) name += "+PackedWeights";
+		else if(SymmetricWeights) name += "+SymmetricWeights";
+		else if(direct_kernel != KERNEL_SCALAR) name += "+SIMD";
+		if(SharedWeights) name += "+SharedWeights";
+		if(UseWeightStore) name += "+WeightStore";
+	}
+	if(! Homogeneous && BatchedCollisions) name += BatchedFFTs ? "+BatchedFFTs" : "+BatchedCollisions";
+	if(! Homogeneous && ConcurrentCells) name += "+ConcurrentCells";
+	return name.c_str();
+}
+
+static void DirectReference(fftw_complex *gHat, fftw_complex *fHat, double **weights, double **weights_linear, fftw_complex *qHat, fftw_complex *qHat_linear)	// Function to calculate qHat(ki) = sum over w of gHat3(ki,w)*gHat(w)*fHat(ki-w) for every mode, with the same quadrature as ComputeQ_Direct (and, if weights_linear is not NULL, the linear part of ComputeQ_FandL_Direct, which is also added to qHat)
+{
+	int ki, i, j, k, l, m, n, x, y, z, kw, kz;
+	int start_i, start_j, start_k, end_i, end_j, end_k;
+	double tempD, tempD1, tmp0, tmp1, tmp01, tmp11;
+	double prefactor = h_eta*h_eta*h_eta;
+
+	#pragma omp parallel for private(ki,i,j,k,l,m,n,x,y,z,kw,kz,start_i,start_j,start_k,end_i,end_j,end_k,tempD,tempD1,tmp0,tmp1,tmp01,tmp11) shared(gHat, fHat, weights, weights_linear, qHat, qHat_linear)
+	for(ki=0;ki<size_ft;ki++)
+	{
+		i = ki/(N*N); j = (ki/N)%N; k = ki%N;
+		ConvolutionWindow(i, &start_i, &end_i);
+		ConvolutionWindow(j, &start_j, &end_j);
+		ConvolutionWindow(k, &start_k, &end_k);
+
+		tmp0 = 0.; tmp1 = 0.; tmp01 = 0.; tmp11 = 0.;
+		for(l=start_i;l<end_i;l++)
+		{
+			x = i + N/2 - l;																		// eta[x] = ki[i] - eta[l]
+			for(m=start_j;m<end_j;m++)
+			{
+				y = j + N/2 - m;
+				for(n=start_k;n<end_k;n++)
+				{
+					z = k + N/2 - n;
+					kw = n + N*(m + N*l);
+					kz = z + N*(y + N*x);
+
+					tempD = weights[ki][kw];
+					if(weights_linear == NULL)														// the products of ComputeQ_Direct & ComputeQLinear_Direct
+					{
+						tmp0 += prefactor*wtN[l]*wtN[m]*wtN[n]*tempD*(gHat[kw][0]*fHat[kz][0] - gHat[kw][1]*fHat[kz][1]);
+						tmp1 += prefactor*wtN[l]*wtN[m]*wtN[n]*tempD*(gHat[kw][0]*fHat[kz][1] + gHat[kw][1]*fHat[kz][0]);
+					}
+					else																			// the products of ComputeQ_FandL_Direct
+					{
+						tempD1 = weights_linear[ki][kw];
+						tmp0 += prefactor*wtN[l]*wtN[m]*wtN[n]*(tempD*(gHat[kw][0]*fHat[kz][0] - gHat[kw][1]*fHat[kz][1]) + scale3*tempD1*fHat[kz][0]);
+						tmp1 += prefactor*wtN[l]*wtN[m]*wtN[n]*(tempD*(gHat[kw][0]*fHat[kz][1] + gHat[kw][1]*fHat[kz][0]) + scale3*tempD1*fHat[kz][1]);
+						tmp01 += prefactor*wtN[l]*wtN[m]*wtN[n]*scale3*tempD1*fHat[kz][0];
+						tmp11 += prefactor*wtN[l]*wtN[m]*wtN[n]*scale3*tempD1*fHat[kz][1];
+					}
+				}
+			}
+		}
+		qHat[ki][0] = tmp0;
+		qHat[ki][1] = tmp1;
+		if(weights_linear != NULL)
+		{
+			qHat_linear[ki][0] = tmp01;
+			qHat_linear[ki][1] = tmp11;
+		}
+	}
+}
+
+static void CheckCollisionStep(const char *routine, double **f, fftw_complex *Maxwell_fftOut, fftw_complex **qHat, fftw_complex **qHat_linear, int cells)	// Function to compare qHat[c] (and qHat_linear[c] if it is not NULL), found from f[c] for c = 0,...,cells-1, with ComputeQ_Direct the first time it is called
+{
+	int c, ki;
+	double **weights, **weights_linear = NULL;
+	fftw_complex *fHat, *q_run, *q_direct, *q_run_linear = NULL, *q_direct_linear = NULL;
+
+	if(! CheckCollisionEngine || collision_engine == ENGINE_FFT || collision_engine == ENGINE_LOWRANK)
+	{
+		return;
+	}
+
+	#pragma omp critical (collision_check)
+	if(! collision_checked)																		// only the first collision step is checked (the space-steps may be run concurrently)
+	{
+		weights = (double **)malloc(size_ft*sizeof(double *));									// tables of weights for the check alone, independent of how those of the run are held
+		weights[0] = (double *)malloc((long)size_ft*size_ft*sizeof(double));
+		for(ki=1;ki<size_ft;ki++)
+		{
+			weights[ki] = weights[0] + (long)ki*size_ft;
+		}
+		generate_conv_weights(weights, gamma_check);
+		if(qHat_linear != NULL)
+		{
+			weights_linear = (double **)malloc(size_ft*sizeof(double *));
+			weights_linear[0] = (double *)malloc((long)size_ft*size_ft*sizeof(double));
+			for(ki=1;ki<size_ft;ki++)
+			{
+				weights_linear[ki] = weights_linear[0] + (long)ki*size_ft;
+			}
+			generate_conv_weights_linear(weights_linear);
+		}
+
+		fHat = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		q_run = (fftw_complex *)fftw_malloc((long)cells*size_ft*sizeof(fftw_complex));			// the spectra of every space-step stored one after another, so that a single difference is reported
+		q_direct = (fftw_complex *)fftw_malloc((long)cells*size_ft*sizeof(fftw_complex));
+		if(qHat_linear != NULL)
+		{
+			q_run_linear = (fftw_complex *)fftw_malloc((long)cells*size_ft*sizeof(fftw_complex));
+			q_direct_linear = (fftw_complex *)fftw_malloc((long)cells*size_ft*sizeof(fftw_complex));
+		}
+		for(c=0;c<cells;c++)
+		{
+			fft3D(f[c], fHat);
+			DirectReference((Maxwell_fftOut != NULL) ? Maxwell_fftOut : fHat, fHat, weights, weights_linear,
+					q_direct + (long)c*size_ft, (qHat_linear != NULL) ? q_direct_linear + (long)c*size_ft : NULL);
+			memcpy(q_run + (long)c*size_ft, qHat[c], size_ft*sizeof(fftw_complex));
+			if(qHat_linear != NULL)
+			{
+				memcpy(q_run_linear + (long)c*size_ft, qHat_linear[c], size_ft*sizeof(fftw_complex));
+			}
+		}
+
+		ReportEngineDifference(CheckedPathName(), routine, q_run, q_direct, cells);
+		if(qHat_linear != NULL)
+		{
+			std::string routine_linear = std::string(routine) + " linear part";
+			ReportEngineDifference(CheckedPathName(), routine_linear.c_str(), q_run_linear, q_direct_linear, cells);
+			fftw_free(q_run_linear); fftw_free(q_direct_linear);
+			free(weights_linear[0]); free(weights_linear);
+		}
+		fftw_free(fHat); fftw_free(q_run); fftw_free(q_direct);
+		free(weights[0]); free(weights);
+		collision_checked = true;
+	}
+}
+
+void CheckComputeQ(double *f, fftw_complex *qHat)													// Function to compare qHat, found by ComputeQ from f, with ComputeQ_Direct the first time it is called
+{
+	CheckCollisionStep("ComputeQ", &f, NULL, &qHat, NULL, 1);
+}
+
+void CheckComputeQLinear(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat)				// Function to compare qHat, found by ComputeQLinear from f, with ComputeQLinear_Direct the first time it is called
+{
+	CheckCollisionStep("ComputeQLinear", &f, Maxwell_fftOut, &qHat, NULL, 1);
+}
+
+void CheckComputeQ_FandL(double *f, fftw_complex *qHat, fftw_complex *qHat_linear)					// Function to compare qHat & qHat_linear, found by ComputeQ_FandL from f, with ComputeQ_FandL_Direct the first time it is called
+{
+	CheckCollisionStep("ComputeQ_FandL", &f, NULL, &qHat, &qHat_linear, 1);
+}
+
+void CheckComputeQ_Batched(double **f, fftw_complex **qHat, int cells)								// Function to compare qHat[c], found by ComputeQ_Batched from f[c] for every space-step c of the batch, with ComputeQ_Direct the first time it is called
+{
+	CheckCollisionStep("ComputeQ_Batched", f, NULL, qHat, NULL, cells);
+}
@@ -0,0 +1,36 @@
+/* This is the header file associated to CollisionCheck.cpp in which the prototypes for the
+ * functions contained in that file are declared.  Any other header files which must be linked to
+ * for the functions here are also included.
+ *
+ */
+
+//************************//
+//     INCLUDE GUARDS     //
+//************************//
+
+#ifndef COLLISIONCHECK_H_
+#define COLLISIONCHECK_H_
+
+//************************//
+//        INCLUDES        //
+//************************//
+
+#include "LP_ompi.h"																				// allows the libraries included, macros defined and external variables declared in LP_ompi.h to be used in the CollisionCheck functions
+#include "collisionRoutines_1.h"																	// allows generate_conv_weights, generate_conv_weights_linear, fft3D & ConvolutionWindow to be used in the CollisionCheck functions
+#include "MatrixFreeCollision.h"																	// allows ReportEngineDifference to be used in the CollisionCheck functions
+
+//************************//
+//   FUNCTION PROTOTYPES  //
+//************************//
+
+void InitCollisionCheck(int gamma);
+
+void CheckComputeQ(double *f, fftw_complex *qHat);
+
+void CheckComputeQLinear(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat);
+
+void CheckComputeQ_FandL(double *f, fftw_complex *qHat, fftw_complex *qHat_linear);
+
+void CheckComputeQ_Batched(double **f, fftw_complex **qHat, int cells);
+
+#endif /* COLLISIONCHECK_H_ */
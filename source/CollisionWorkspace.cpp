@@ -0,0 +1,156 @@
+/* This is the source file which contains the workspaces of the collision step, which let the space-steps
+ * held by a process be given to different OpenMP threads when ConcurrentCells = True.  Without it, the
+ * space-steps are advanced one after another, as ComputeQ, fft3D, FS, RK4_Inhomo & the projection
+ * onto the DG basis all write to the same global buffers (fftOut, temp, Q, f1, Q1, Q1_fft, ...),
+ * and each of them is parallelised over the Fourier nodes instead.  For N = 8 these loops are too
+ * short to keep many threads busy.
+ *
+ * A workspace holds its own copy of every buffer written in the collision step of one space-step.
+ * Each thread has a pointer to the workspace it is using (current_workspace, which is threadprivate),
+ * and the routines above find their buffers through CurrentCollisionWorkspace before any of their
+ * loops start.  By default this is the shared workspace, whose buffers are the global ones, so
+ * nothing changes when the space-steps are advanced one after another.  RK4_Concurrent gives each
+ * thread a workspace of its own and shares the space-steps out between the threads with dynamic
+ * scheduling.  The inner parallel loops then run on the thread which encounters them.  The FFTs are
+ * executed on the temp of each workspace with the new-array execute functions of fftw3, which may
+ * be called from several threads at once with the same plans.
+ *
+ * Functions included: AllocProjectionScratch, FreeProjectionScratch, InitCollisionWorkspaces,
+ * FreeCollisionWorkspaces, CurrentCollisionWorkspace, RK4_Concurrent
+ *
+ */
+
+#include "CollisionWorkspace.h"																		// CollisionWorkspace.h is where the prototypes for the functions contained in this file are declared
+
+static CollisionWorkspace shared_workspace;															// declare shared_workspace (the workspace with the global buffers, used when the space-steps are advanced one after another)
+static CollisionWorkspace *workspaces = NULL;														// declare a pointer to workspaces (the workspaces of the threads of RK4_Concurrent)
+static int workspace_count = 0;																		// declare workspace_count (the number of workspaces, and so the most threads used by RK4_Concurrent)
+static CollisionWorkspace *current_workspace = &shared_workspace;									// declare a pointer to current_workspace (the workspace used by this thread)
+#pragma omp threadprivate(current_workspace)
+
+static void AllocProjectionScratch(CollisionWorkspace *ws)											// Function to allocate the partial sums & stages used to project a spectrum onto the DG basis in the workspace ws
+{
+	int a;
+
+	for(a=0;a<3;a++)
+	{
+		ws->SumK3[a] = (fftw_complex *)fftw_malloc(N*N*Nv*sizeof(fftw_complex));
+	}
+	for(a=0;a<5;a++)
+	{
+		ws->SumK2[a] = (fftw_complex *)fftw_malloc(N*Nv*Nv*sizeof(fftw_complex));
+	}
+	ws->Q_stages = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+	ws->proj = (double *)malloc(5*Nv*Nv*Nv*sizeof(double));
+}
+
+static void FreeProjectionScratch(CollisionWorkspace *ws)											// Function to delete the partial sums & stages of the workspace ws
+{
+	int a;
+
+	for(a=0;a<3;a++)
+	{
+		fftw_free(ws->SumK3[a]);
+	}
+	for(a=0;a<5;a++)
+	{
+		fftw_free(ws->SumK2[a]);
+	}
+	fftw_free(ws->Q_stages);
+	free(ws->proj);
+}
+
+void InitCollisionWorkspaces(int count)																// Function to set up the shared workspace with the global buffers (which must already be allocated) & allocate count more workspaces for RK4_Concurrent
+{
+	int w;
+	CollisionWorkspace *ws;
+
+	shared_workspace.temp = temp; shared_workspace.fftOut = fftOut;
+	shared_workspace.qHat = NULL;																	// the solver passes its own qHat to ComputeQ & RK4
+	shared_workspace.Q1_fft = Q1_fft; shared_workspace.Q2_fft = Q2_fft; shared_workspace.Q3_fft = Q3_fft;
+	shared_workspace.Q = Q; shared_workspace.f1 = f1; shared_workspace.Q1 = Q1;
+	shared_workspace.fft_threads = FFTThreads(N);
+	shared_workspace.owns_buffers = false;
+	AllocProjectionScratch(&shared_workspace);
+	current_workspace = &shared_workspace;
+
+	workspace_count = count;
+	if(count > 0)
+	{
+		workspaces = (CollisionWorkspace *)malloc(count*sizeof(CollisionWorkspace));
+	}
+	for(w=0;w<count;w++)
+	{
+		ws = workspaces + w;
+		ws->temp = (fftw_complex *)fftw_malloc(N*N*(N/2+1)*sizeof(fftw_complex));					// fftw_malloc aligns these as temp, so the plans made on temp can be executed on them
+		ws->fftOut = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		ws->qHat = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		ws->Q1_fft = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		ws->Q2_fft = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		ws->Q3_fft = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		ws->Q = (double *)malloc(size_ft*sizeof(double));
+		ws->f1 = (double *)malloc(size_ft*sizeof(double));
+		ws->Q1 = (double *)malloc(size_ft*sizeof(double));
+		ws->fft_threads = 1;																		// each space-step runs on one thread
+		ws->owns_buffers = true;
+		AllocProjectionScratch(ws);
+	}
+
+	if(count > 0 && myrank_mpi==0)
+	{
+		printf("The space-steps of each process are shared between up to %d threads, each with its own workspace (%g MB per thread).\n\n",
+				count, (size_ft*(5*sizeof(fftw_complex) + 3*sizeof(double)) + N*N*(N/2+1)*sizeof(fftw_complex)
+				+ (3*N*N*Nv + 5*N*Nv*Nv)*sizeof(fftw_complex) + 5*Nv*Nv*Nv*sizeof(double))/(1024.*1024.));
+	}
+}
+
+void FreeCollisionWorkspaces()																		// Function to delete the workspaces of RK4_Concurrent & the projection scratch of the shared workspace
+{
+	int w;
+	CollisionWorkspace *ws;
+
+	for(w=0;w<workspace_count;w++)
+	{
+		ws = workspaces + w;
+		fftw_free(ws->temp); fftw_free(ws->fftOut);
+		fftw_free(ws->qHat); fftw_free(ws->Q1_fft); fftw_free(ws->Q2_fft); fftw_free(ws->Q3_fft);
+		free(ws->Q); free(ws->f1); free(ws->Q1);
+		FreeProjectionScratch(ws);
+	}
+	free(workspaces);
+	workspaces = NULL; workspace_count = 0;
+	FreeProjectionScratch(&shared_workspace);
+}
+
+CollisionWorkspace *CurrentCollisionWorkspace()														// Function to return the workspace used by the calling thread
+{
+	return current_workspace;
+}
+
+void RK4_Concurrent(double **f, double **conv_weights, double *U, double *dU)						// Function to advance every space-step held by this process one time-step of the collisional problem, as the calls of ComputeQ, conserveMoments & RK4 for each space-step do, but with the space-steps shared out between the threads
+{
+	int l, first, last;
+
+	first = chunk_Nx*grid_rank_x;																	// the first space-step held by this process
+	last = first + chunk_Nx;
+	if(last > Nx)
+	{
+		last = Nx;
+	}
+
+	#pragma omp parallel num_threads(workspace_count) private(l) shared(f, conv_weights, U, dU, first, last)
+	{
+		CollisionWorkspace *ws = workspaces + omp_get_thread_num();
+		current_workspace = ws;																		// the routines called below find their buffers in this thread's workspace
+
+		#pragma omp for schedule(dynamic)
+		for(l=first;l<last;l++)
+		{
+			ComputeQ(f[l%chunk_Nx], ws->qHat, conv_weights);										// calculate the Fourier transform of Q(f,f) at the space-step l
+			conserveMoments(ws->qHat);																// perform the explicit conservation calculation
+			RK4(f[l%chunk_Nx], l, ws->qHat, conv_weights, U, dU);									// advance the space-step l to the next time step, storing the output in dU (each space-step writes to its own part of dU)
+		}
+
+		current_workspace = &shared_workspace;														// go back to the global buffers for anything called after this
+	}
+}
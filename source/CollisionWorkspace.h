@@ -0,0 +1,48 @@
+/* This is the header file associated to CollisionWorkspace.cpp in which the prototypes for the
+ * functions contained in that file are declared.  Any other header files which must be linked to
+ * for the functions here are also included.
+ *
+ */
+
+//************************//
+//     INCLUDE GUARDS     //
+//************************//
+
+#ifndef COLLISIONWORKSPACE_H_
+#define COLLISIONWORKSPACE_H_
+
+//************************//
+//        INCLUDES        //
+//************************//
+
+#include "LP_ompi.h"																				// allows the libraries included, macros defined and external variables declared in LP_ompi.h to be used in the CollisionWorkspace functions
+
+//************************//
+//  STRUCTURE DEFINITION  //
+//************************//
+
+struct CollisionWorkspace																			// the buffers written by the collision step of one space-step (ComputeQ_Direct, fft3D, FS, RK4_Inhomo & the projection onto the DG basis)
+{
+	fftw_complex *temp;																				// the half spectrum (or the padded real array) transformed in place by fft3D & FS
+	fftw_complex *fftOut;																			// the spectrum of f found by ComputeQ_Direct
+	fftw_complex *qHat, *Q1_fft, *Q2_fft, *Q3_fft;													// the Fourier transforms of the four stages of RK4
+	double *Q, *f1, *Q1;																			// the Fourier series of the stages & the intermediate solutions of RK4
+	fftw_complex *SumK3[3], *SumK2[5], *Q_stages;													// the partial sums & the combined stages of RK4 projected onto the DG basis by ProjectModes & ProjectRK4Stages
+	double *proj;																					// the values of tp0, tp2, tp3, tp4 & tp5 in each velocity cell returned by ProjectModes
+	int fft_threads;																				// the number of threads used for the shifts before & after each FFT
+	bool owns_buffers;																				// true if temp, fftOut, ..., Q1 were allocated for this workspace (false for the shared workspace, which uses the global buffers)
+};
+
+//************************//
+//   FUNCTION PROTOTYPES  //
+//************************//
+
+void InitCollisionWorkspaces(int count);
+
+void FreeCollisionWorkspaces();
+
+CollisionWorkspace *CurrentCollisionWorkspace();
+
+void RK4_Concurrent(double **f, double **conv_weights, double *U, double *dU);
+
+#endif /* COLLISIONWORKSPACE_H_ */
@@ -0,0 +1,353 @@
+/* This is the source file which contains the projection of a spectrum onto the DG basis in velocity
+ * (the last step of each of the RK4 routines of the collision problem, and ProjectedNodeValue).
+ * For every velocity cell (j1,j2,j3), this needs
+ *
+ * 		tp_m = Re sum_ki IntM_m(ki,j) Q(ki),		m = 0, 2, 3, 4, 5,
+ *
+ * where IntM_m(ki,j) is the integral over the cell of exp(i ki.v) times the mth basis function (as
+ * found by IntModes).  Each of these integrals is a product of three 1-D integrals over the cell in
+ * each direction, of exp(i eta v) times 1, (v - v_j)/dv or ((v - v_j)/dv)^2 (called A, B & C here):
+ *
+ * 		IntM_0 = A1 A2 A3,	IntM_2 = B1 A2 A3,	IntM_3 = A1 B2 A3,	IntM_4 = A1 A2 B3,
+ * 		IntM_5 = C1 A2 A3 + A1 C2 A3 + A1 A2 C3,
+ *
+ * and the 1-D integrals only depend on the index of eta & the index of the cell in that direction.
+ * They are tabulated once by InitDGProjection, and the sums are then found one direction at a time
+ * (sum factorisation): first over ki_3 for A, B & C, then over ki_2 for the five pairs AA, BA, AB,
+ * CA & AC, and finally over ki_1 in each cell.  This takes O(Nv*N^3 + Nv^2*N^2 + Nv^3*N) products
+ * read from the tables instead of O(Nv^3*N^3) calls of IntModes, each of which evaluates dozens of
+ * sines & cosines.
+ *
+ * With ProjectionGEMM = True, InitDGProjection also multiplies the tables out into the dense
+ * [5*size_v x 2*size_ft] operator which takes the interleaved real & imaginary parts of a spectrum
+ * to the values of tp0, tp2, tp3, tp4 & tp5 in every cell, provided it fits in ProjectionMemory.
+ * A spectrum is then projected with one call of dgemv, and the combined stages of all of the
+ * space-steps held by a process (stacked as the columns of a matrix) with one call of dgemm.  This
+ * does more arithmetic than the sum factorisation, but at the rate of BLAS-3 rather than of the
+ * short strided loops above.  If the operator does not fit, the tables are contracted as above.
+ *
+ * When the modes of each space-step are shared between several processes (see ProcessGrid.cpp),
+ * each of them only updates its chunk_kt cells from chunk_kt*grid_rank_modes on, so only the rows
+ * of the operator (or the final sums over ki_1) of those cells are computed.
+ *
+ * With CheckEngine = True as well, the first projection with the dense operator is compared with
+ * the sums over one direction at a time.
+ *
+ * Functions included: InitDGProjection, FreeDGProjection, ContractTables, CheckDenseProjection,
+ * ProjectModes, ProjectRK4Stages, ProjectRK4StagesBatched
+ *
+ */
+
+#include "DGProjection.h"																			// DGProjection.h is where the prototypes for the functions contained in this file are declared
+
+#define PROJ_A 0																					// the index of the 1-D integrals of exp(i eta v) over each cell in the tables
+#define PROJ_B 1																					// the index of the 1-D integrals of exp(i eta v)*(v - v_j)/dv over each cell in the tables
+#define PROJ_C 2																					// the index of the 1-D integrals of exp(i eta v)*((v - v_j)/dv)^2 over each cell in the tables
+
+static fftw_complex *IntTable[3];																	// declare pointers to IntTable[PROJ_A], IntTable[PROJ_B] & IntTable[PROJ_C] (the 1-D integrals, with the value for eta[k] & the cell j stored at k + N*j)
+static double *ProjOp;																				// declare a pointer to ProjOp (the dense projection operator, stored by columns, with the column 2*k_eta multiplying the real part & the column 2*k_eta+1 the imaginary part of mode k_eta)
+static fftw_complex *Q_batch;																		// declare a pointer to Q_batch (the combined stages of RK4 for each space-step of a batch, with space-step c stored at c*size_ft)
+static double *proj_batch;																			// declare a pointer to proj_batch (proj for each space-step of a batch, with space-step c stored at 5*size_v*c)
+static bool projection_checked = false;																// declare projection_checked (set once the dense operator has been compared with the sums over one direction at a time)
+static const int pair_k2[5] = {PROJ_A, PROJ_B, PROJ_A, PROJ_C, PROJ_A};								// the 1-D integral in the ki_2 direction of each of the five pairs
+static const int pair_k3[5] = {PROJ_A, PROJ_A, PROJ_B, PROJ_A, PROJ_C};								// the 1-D integral in the ki_3 direction of each of the five pairs
+
+static void IntModes1D(int k, int j, fftw_complex *result)											// Function to find the 1-D integrals over the cell j of exp(i eta[k] v) times 1, (v - v_j)/dv & ((v - v_j)/dv)^2, using the same expressions as IntModes
+{
+	double e = eta[k];
+	double vc = Gridv((double)j), vl = Gridv(j-0.5), vr = Gridv(j+0.5);
+	double a_re, a_im;
+
+	if(e != 0.)
+	{
+		result[PROJ_A][0] = (sin(e*vr) - sin(e*vl))/e;
+		result[PROJ_A][1] = (cos(e*vl) - cos(e*vr))/e;
+
+		a_re = (vr*sin(e*vr) - vl*sin(e*vl))/e + (cos(e*vr) - cos(e*vl))/e/e;						// \int exp(i eta v) v dv over the cell
+		a_im = (sin(e*vr) - sin(e*vl))/e/e + (vl*cos(e*vl) - vr*cos(e*vr))/e;
+
+		result[PROJ_B][0] = (a_re - vc*result[PROJ_A][0])/dv;
+		result[PROJ_B][1] = (a_im - vc*result[PROJ_A][1])/dv;
+
+		result[PROJ_C][0] = ((vr*vr*sin(e*vr) - vl*vl*sin(e*vl) - 2*a_im)/e - 2*vc*a_re + vc*vc*result[PROJ_A][0])/dv/dv;
+		result[PROJ_C][1] = ((vl*vl*cos(e*vl) - vr*vr*cos(e*vr) + 2*a_re)/e - 2*vc*a_im + vc*vc*result[PROJ_A][1])/dv/dv;
+	}
+	else
+	{
+		result[PROJ_A][0] = dv; result[PROJ_A][1] = 0.;
+		result[PROJ_B][0] = 0.; result[PROJ_B][1] = 0.;
+		result[PROJ_C][0] = dv/12.; result[PROJ_C][1] = 0.;
+	}
+}
+
+static inline void CMul(const double *a, const double *b, double *c)								// Function to set c to the product of the complex numbers a & b
+{
+	double re = a[0]*b[0] - a[1]*b[1];
+	c[1] = a[0]*b[1] + a[1]*b[0];
+	c[0] = re;
+}
+
+static void BuildProjectionOperator()																// Function to multiply the 1-D integrals out into the dense projection operator ProjOp
+{
+	int i, j, k, j1, j2, j3, k_eta, kt, m;
+	double A12[2], IntM[5][2], t[2], *col_re, *col_im;
+	const double *A1, *A2, *A3, *B1, *B2, *B3, *C1, *C2, *C3;
+
+	#pragma omp parallel for private(i,j,k,j1,j2,j3,kt,m,A12,IntM,t,col_re,col_im,A1,A2,A3,B1,B2,B3,C1,C2,C3) shared(ProjOp, IntTable)
+	for(k_eta=0;k_eta<size_ft;k_eta++)
+	{
+		k = k_eta % N; j = (k_eta/N) % N; i = k_eta/(N*N);
+		col_re = ProjOp + (size_t)5*size_v*(2*k_eta);
+		col_im = ProjOp + (size_t)5*size_v*(2*k_eta+1);
+		for(kt=0;kt<size_v;kt++)
+		{
+			j3 = kt % Nv; j2 = (kt/Nv) % Nv; j1 = kt/(Nv*Nv);
+			A1 = IntTable[PROJ_A][i + N*j1]; B1 = IntTable[PROJ_B][i + N*j1]; C1 = IntTable[PROJ_C][i + N*j1];
+			A2 = IntTable[PROJ_A][j + N*j2]; B2 = IntTable[PROJ_B][j + N*j2]; C2 = IntTable[PROJ_C][j + N*j2];
+			A3 = IntTable[PROJ_A][k + N*j3]; B3 = IntTable[PROJ_B][k + N*j3]; C3 = IntTable[PROJ_C][k + N*j3];
+
+			CMul(A1, A2, A12);
+			CMul(A12, A3, IntM[0]);																	// IntM_0 = A1 A2 A3
+			CMul(B1, A2, t); CMul(t, A3, IntM[1]);													// IntM_2 = B1 A2 A3
+			CMul(A1, B2, t); CMul(t, A3, IntM[2]);													// IntM_3 = A1 B2 A3
+			CMul(A12, B3, IntM[3]);																	// IntM_4 = A1 A2 B3
+			CMul(C1, A2, t); CMul(t, A3, IntM[4]);													// IntM_5 = C1 A2 A3 + A1 C2 A3 + A1 A2 C3
+			CMul(A1, C2, t); CMul(t, A3, t);
+			IntM[4][0] += t[0]; IntM[4][1] += t[1];
+			CMul(A12, C3, t);
+			IntM[4][0] += t[0]; IntM[4][1] += t[1];
+
+			for(m=0;m<5;m++)																		// tp_m = Re sum IntM_m Q = sum IntM_m_re Q_re - IntM_m_im Q_im
+			{
+				col_re[5*kt+m] = IntM[m][0];
+				col_im[5*kt+m] = -IntM[m][1];
+			}
+		}
+	}
+}
+
+void InitDGProjection()																				// Function to tabulate the 1-D integrals used to project spectra onto the DG basis (the partial sums are kept in each collision workspace)
+{
+	int a, k, j;
+	fftw_complex result[3];
+
+	for(a=0;a<3;a++)
+	{
+		IntTable[a] = (fftw_complex *)fftw_malloc(N*Nv*sizeof(fftw_complex));
+	}
+
+	for(j=0;j<Nv;j++)
+	{
+		for(k=0;k<N;k++)
+		{
+			IntModes1D(k, j, result);
+			for(a=0;a<3;a++)
+			{
+				IntTable[a][k + N*j][0] = result[a][0];
+				IntTable[a][k + N*j][1] = result[a][1];
+			}
+		}
+	}
+
+	if(ProjectionGEMM)
+	{
+		double op_MB = 10.*size_v*(double)size_ft*sizeof(double)/(1024.*1024.);				// the memory needed by the [5*size_v x 2*size_ft] operator
+		if(op_MB > projection_memory)
+		{
+			if(myrank_mpi==0)
+			{
+				printf("The dense projection operator needs %g MB, more than ProjectionMemory = %g MB, so the tables are contracted directly.\n\n",
+						op_MB, projection_memory);
+			}
+			ProjectionGEMM = false;
+		}
+		else
+		{
+			ProjOp = (double *)malloc((size_t)10*size_v*size_ft*sizeof(double));
+			Q_batch = (fftw_complex *)fftw_malloc((size_t)chunk_Nx*size_ft*sizeof(fftw_complex));
+			proj_batch = (double *)malloc((size_t)5*size_v*chunk_Nx*sizeof(double));
+			BuildProjectionOperator();
+			if(myrank_mpi==0)
+			{
+				printf("The increments of RK4 are projected onto the DG basis with a dense operator of %g MB.\n\n", op_MB);
+			}
+		}
+	}
+}
+
+void FreeDGProjection()																				// Function to delete the tables used to project spectra onto the DG basis
+{
+	int a;
+
+	for(a=0;a<3;a++)
+	{
+		fftw_free(IntTable[a]);
+	}
+	if(ProjectionGEMM)
+	{
+		free(ProjOp); fftw_free(Q_batch); free(proj_batch);
+	}
+}
+
+static void ContractTables(fftw_complex *Q_hat, double scale, double *proj)						// Function to find tp0, tp2, tp3, tp4 & tp5 of scale*Q_hat in the velocity cells of this process by summing over one direction at a time (see above), storing those of cell kt at proj[5*kt],...,proj[5*kt+4]
+{
+	int a, p, i, j, k, j1, j2, j3, kt;
+	int kt_start = chunk_kt*grid_rank_modes, kt_end = kt_start + chunk_kt;							// the cells updated by this process (all of them unless the modes are shared)
+	double s_re, s_im, tp0, tp2, tp3, tp4, tp5;
+	const fftw_complex *T, *TA, *TB, *TC, *S, *H;
+	CollisionWorkspace *ws = CurrentCollisionWorkspace();											// the partial sums are kept in the workspace of this thread, so that several space-steps can be projected at once
+	fftw_complex **SumK3 = ws->SumK3, **SumK2 = ws->SumK2;											// SumK3[PROJ_A/B/C] (the sums over ki_3 of the spectrum times each 1-D integral, with the value for (ki_1,ki_2) & the cell j3 stored at j3 + Nv*(ki_2 + N*ki_1)) & SumK2 (the sums over ki_2 of SumK3 times each 1-D integral for the pairs AA, BA, AB, CA & AC, with the value for ki_1 & the cells (j2,j3) stored at j3 + Nv*(j2 + Nv*ki_1))
+
+	#pragma omp parallel for private(a,i,j,k,j3,s_re,s_im,T) shared(Q_hat, SumK3, IntTable)
+	for(i=0;i<N*N;i++)																				// sum over ki_3 for each (ki_1,ki_2), with i = ki_2 + N*ki_1
+	{
+		for(j3=0;j3<Nv;j3++)
+		{
+			for(a=0;a<3;a++)
+			{
+				T = IntTable[a] + N*j3;
+				s_re = 0.; s_im = 0.;
+				for(k=0;k<N;k++)
+				{
+					s_re += T[k][0]*Q_hat[k + N*i][0] - T[k][1]*Q_hat[k + N*i][1];
+					s_im += T[k][0]*Q_hat[k + N*i][1] + T[k][1]*Q_hat[k + N*i][0];
+				}
+				SumK3[a][j3 + Nv*i][0] = scale*s_re;
+				SumK3[a][j3 + Nv*i][1] = scale*s_im;
+			}
+		}
+	}
+
+	#pragma omp parallel for private(p,i,j,j2,j3,s_re,s_im,T,S) shared(SumK2, SumK3, IntTable)
+	for(i=0;i<N*Nv;i++)																				// sum over ki_2 for each (ki_1,j2), with i = j2 + Nv*ki_1
+	{
+		j2 = i%Nv;
+		for(p=0;p<5;p++)
+		{
+			T = IntTable[pair_k2[p]] + N*j2;
+			S = SumK3[pair_k3[p]] + Nv*N*(i/Nv);
+			for(j3=0;j3<Nv;j3++)
+			{
+				s_re = 0.; s_im = 0.;
+				for(j=0;j<N;j++)
+				{
+					s_re += T[j][0]*S[j3 + Nv*j][0] - T[j][1]*S[j3 + Nv*j][1];
+					s_im += T[j][0]*S[j3 + Nv*j][1] + T[j][1]*S[j3 + Nv*j][0];
+				}
+				SumK2[p][j3 + Nv*i][0] = s_re;
+				SumK2[p][j3 + Nv*i][1] = s_im;
+			}
+		}
+	}
+
+	#pragma omp parallel for private(kt,i,j1,j2,j3,tp0,tp2,tp3,tp4,tp5,TA,TB,TC,H) shared(proj, SumK2, IntTable)
+	for(kt=kt_start;kt<kt_end;kt++)																	// sum over ki_1 in each cell, keeping only the real parts
+	{
+		j3 = kt % Nv; j2 = (kt/Nv) % Nv; j1 = kt/(Nv*Nv);
+		TA = IntTable[PROJ_A] + N*j1; TB = IntTable[PROJ_B] + N*j1; TC = IntTable[PROJ_C] + N*j1;
+		tp0=0.; tp2=0.; tp3=0.; tp4=0.; tp5=0.;
+		for(i=0;i<N;i++)
+		{
+			H = SumK2[0] + j3 + Nv*(j2 + Nv*i);														// the pair AA, for IntM_0, IntM_2 & the first term of IntM_5
+			tp0 += TA[i][0]*H[0][0] - TA[i][1]*H[0][1];
+			tp2 += TB[i][0]*H[0][0] - TB[i][1]*H[0][1];
+			tp5 += TC[i][0]*H[0][0] - TC[i][1]*H[0][1];
+			H = SumK2[1] + j3 + Nv*(j2 + Nv*i);														// the pair BA, for IntM_3
+			tp3 += TA[i][0]*H[0][0] - TA[i][1]*H[0][1];
+			H = SumK2[2] + j3 + Nv*(j2 + Nv*i);														// the pair AB, for IntM_4
+			tp4 += TA[i][0]*H[0][0] - TA[i][1]*H[0][1];
+			H = SumK2[3] + j3 + Nv*(j2 + Nv*i);														// the pairs CA & AC, for the other terms of IntM_5
+			tp5 += TA[i][0]*H[0][0] - TA[i][1]*H[0][1];
+			H = SumK2[4] + j3 + Nv*(j2 + Nv*i);
+			tp5 += TA[i][0]*H[0][0] - TA[i][1]*H[0][1];
+		}
+		proj[5*kt] = tp0; proj[5*kt+1] = tp2; proj[5*kt+2] = tp3; proj[5*kt+3] = tp4; proj[5*kt+4] = tp5;
+	}
+
+}
+
+static void CheckDenseProjection(const char *routine, fftw_complex *Q_hat, double scale, const double *proj, int cells)	// Function to compare the projections proj of the spectra scale*Q_hat of cells space-steps (stored one after another, with the values of space-step c at proj[5*size_v*c]), found with the dense operator, with the sums over one direction at a time the first time it is called (if CheckEngine is true)
+{
+	int c;
+	int kt_start = chunk_kt*grid_rank_modes;
+	double rel_diff = 0., *proj_ref;
+
+	if(! CheckCollisionEngine)
+	{
+		return;
+	}
+
+	#pragma omp critical (projection_check)
+	if(! projection_checked)
+	{
+		proj_ref = (double *)malloc(5*size_v*sizeof(double));
+		for(c=0;c<cells;c++)
+		{
+			ContractTables(Q_hat + (size_t)c*size_ft, scale, proj_ref);
+			rel_diff = fmax(rel_diff, RelativeMaxDiff(proj + (size_t)5*size_v*c + 5*kt_start, proj_ref + 5*kt_start, 5*chunk_kt));
+		}
+		free(proj_ref);
+		if(myrank_mpi==0)
+		{
+			printf("Dense projection check (%s, N = %d): max |proj - proj_factorised|/max |proj_factorised| = %g\n",
+					routine, N, rel_diff);
+		}
+		projection_checked = true;
+	}
+}
+
+double *ProjectModes(fftw_complex *Q_hat, double scale)												// Function to project the spectrum scale*Q_hat onto the DG basis in the velocity cells of this process, returning tp0, tp2, tp3, tp4 & tp5 of cell kt at 5*kt,...,5*kt+4
+{
+	int kt_start = chunk_kt*grid_rank_modes;														// the first cell updated by this process (all of them are unless the modes are shared)
+	double *proj = CurrentCollisionWorkspace()->proj;												// the values of tp0, tp2, tp3, tp4 & tp5 in each cell kt, stored at 5*kt,...,5*kt+4, in the workspace of this thread
+
+	if(ProjectionGEMM)																				// proj = scale*ProjOp*Q_hat, reading Q_hat as 2*size_ft interleaved doubles
+	{
+		cblas_dgemv(CblasColMajor, CblasNoTrans, 5*chunk_kt, 2*size_ft, scale, ProjOp + 5*kt_start, 5*size_v,
+				(const double *)Q_hat, 1, 0., proj + 5*kt_start, 1);
+		CheckDenseProjection("ProjectModes", Q_hat, scale, proj, 1);
+		return proj;
+	}
+
+	ContractTables(Q_hat, scale, proj);
+	return proj;
+}
+
+double *ProjectRK4Stages(fftw_complex *qHat, fftw_complex *Q1_hat, fftw_complex *Q2_hat, fftw_complex *Q3_hat, double nu_val)	// Function to project nu_val*(qHat/2 + (Q1_hat + Q2_hat + Q3_hat)/6), the combination of the four stages of RK4, onto the DG basis in every velocity cell
+{
+	int k_eta;
+	fftw_complex *Q_stages = CurrentCollisionWorkspace()->Q_stages;								// the combination of the four stages of RK4 which is projected, in the workspace of this thread
+
+	#pragma omp parallel for private(k_eta) shared(Q_stages, qHat, Q1_hat, Q2_hat, Q3_hat)
+	for(k_eta=0;k_eta<size_ft;k_eta++)
+	{
+		Q_stages[k_eta][0] = nu_val*(0.5*qHat[k_eta][0] + (Q1_hat[k_eta][0]+Q2_hat[k_eta][0]+Q3_hat[k_eta][0])/6.);
+		Q_stages[k_eta][1] = nu_val*(0.5*qHat[k_eta][1] + (Q1_hat[k_eta][1]+Q2_hat[k_eta][1]+Q3_hat[k_eta][1])/6.);
+	}
+
+	return ProjectModes(Q_stages, 1.);
+}
+
+double *ProjectRK4StagesBatched(fftw_complex **qHat, fftw_complex **Q1_hat, fftw_complex **Q2_hat, fftw_complex **Q3_hat, int cells, double nu_val)	// Function to project the combined stages of RK4 of the space-steps c = 0,...,cells-1 onto the DG basis with one call of dgemm (ProjectionGEMM only), returning those of space-step c at 5*size_v*c
+{
+	int c, k_eta;
+	fftw_complex *Qc;
+
+	for(c=0;c<cells;c++)																			// stack the combined stages of each space-step as the columns of Q_batch
+	{
+		Qc = Q_batch + (size_t)c*size_ft;
+		#pragma omp parallel for private(k_eta) shared(c, Qc, qHat, Q1_hat, Q2_hat, Q3_hat)
+		for(k_eta=0;k_eta<size_ft;k_eta++)
+		{
+			Qc[k_eta][0] = nu_val*(0.5*qHat[c][k_eta][0] + (Q1_hat[c][k_eta][0]+Q2_hat[c][k_eta][0]+Q3_hat[c][k_eta][0])/6.);
+			Qc[k_eta][1] = nu_val*(0.5*qHat[c][k_eta][1] + (Q1_hat[c][k_eta][1]+Q2_hat[c][k_eta][1]+Q3_hat[c][k_eta][1])/6.);
+		}
+	}
+
+	cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, 5*chunk_kt, cells, 2*size_ft, 1.,
+			ProjOp + 5*chunk_kt*grid_rank_modes, 5*size_v, (const double *)Q_batch, 2*size_ft, 0.,
+			proj_batch + 5*chunk_kt*grid_rank_modes, 5*size_v);										// only the rows of the cells of this process
+	CheckDenseProjection("ProjectRK4StagesBatched", Q_batch, 1., proj_batch, cells);
+
+	return proj_batch;
+}
@@ -0,0 +1,38 @@
+/* This is the header file associated to DGProjection.cpp in which the prototypes for the
+ * functions contained in that file are declared.  Any other header files which must be linked to
+ * for the functions here are also included.
+ *
+ */
+
+//************************//
+//     INCLUDE GUARDS     //
+//************************//
+
+#ifndef DGPROJECTION_H_
+#define DGPROJECTION_H_
+
+//************************//
+//        INCLUDES        //
+//************************//
+
+#include "LP_ompi.h"																				// allows the libraries included, macros defined and external variables declared in LP_ompi.h to be used in the DGProjection functions
+#include "advection_1.h"																			// allows Gridv to be used in the DGProjection functions
+#ifdef HAVE_OPENBLAS
+#include <cblas.h>																					// allows cblas_dgemm & cblas_dgemv to be used with OpenBLAS (they are declared by mkl.h with MKL)
+#endif
+
+//************************//
+//   FUNCTION PROTOTYPES  //
+//************************//
+
+void InitDGProjection();
+
+void FreeDGProjection();
+
+double *ProjectModes(fftw_complex *Q_hat, double scale);
+
+double *ProjectRK4Stages(fftw_complex *qHat, fftw_complex *Q1_hat, fftw_complex *Q2_hat, fftw_complex *Q3_hat, double nu_val);
+
+double *ProjectRK4StagesBatched(fftw_complex **qHat, fftw_complex **Q1_hat, fftw_complex **Q2_hat, fftw_complex **Q3_hat, int cells, double nu_val);
+
+#endif /* DGPROJECTION_H_ */
@@ -3,6 +3,10 @@
  *
  * Functions included: computeEntropy, computeEntropy_wAvg, computeRelEntropy
  *
+ * computeEntropy only adds up the cells held by this process in U (see advection_1.cpp) and combines the
+ * sums of all of the processes, so every process must call it.  computeEntropy_wAvg & computeRelEntropy
+ * still expect every cell and are not called by the solver.
+ *
  *  Created on: Nov 15, 2017
  */
 
@@ -28,8 +32,9 @@ double computeEntropy_Inhomo(double *U)																									// function to c
 	double x_0, v1_0, v2_0, v3_0, x_val, v1_val, v2_val, v3_val, f_val;																// declare x_0, v1_0, v2_0, v3_0 (to store the coordinates in the middle of the current cell), x_val, v1_val, v2_val, v3_val (to store the x & v values to be evaluated at) & f_val (to store the value of the function evaluated at the current x & v values)
 	double Ent;																														// declare Ent (the value of the entropy)
 	Ent = 0;																														// set Ent to 0 before any quadrature has began
+	int i_first = chunksize_dg*myrank_mpi/size_v, i_end = (chunksize_dg*(myrank_mpi+1) - 1)/size_v + 1;								// declare i_first & i_end (the space cells i_first,...,i_end-1 hold the cells of this process, since U only holds those)
 	#pragma omp parallel for private(k,i,j1,j2,j3,iNNN,j1NN,j2N,nx,nv1,nv2,nv3,x_0,v1_0,v2_0,v3_0,x_val,v1_val,v2_val,v3_val,f_val) shared(U,size_v,Nv,dv,dx,vt,wt) reduction(+:Ent)
-	for(i=0;i<Nx;i++)																												// loop through the space cells
+	for(i=i_first;i<i_end;i++)																										// loop through the space cells of this process
 	{
 		iNNN = i*size_v;																											// set iNNN to i*Nv^3
 		x_0 = Gridx((double)i);																												// set x_0 to the value of x at the center of the ith space cell
@@ -45,6 +50,10 @@ double computeEntropy_Inhomo(double *U)																									// function to c
 				for(j3=0;j3<Nv;j3++)																								// loop through the velocity cells in the v3 direction
 				{
 					k = iNNN + j1NN + j2N + j3;																						// set k to i*Nv^3 + j1*Nv^2 + j2*Nv + j3
+					if(! HoldsCell(k))																								// U only holds the cells of this process
+					{
+						continue;
+					}
 					v3_0 = Gridv((double)j3);																								// set v3_0 to the value of v3 at the center of the j3th velocity cell in that direction
 					for(nx=0;nx<5;nx++)																								// loop through the five quadrature points in the x direction of the cell
 					{
@@ -58,9 +67,9 @@ double computeEntropy_Inhomo(double *U)																									// function to c
 								for(nv3=0;nv3<5;nv3++)																				// loop through the five quadrature points in the v3 direction of the cell
 								{
 									v3_val = v3_0 + 0.5*vt[nv3]*dv;																	// set x_val to the nv3-th quadrature point in the cell
-									f_val = U[k*6+0] + U[k*6+1]*(x_val-x_0)/dx + U[k*6+2]*(v1_val-v1_0)/dv +
-											U[k*6+3]*(v2_val-v2_0)/dv + U[k*6+4]*(v3_val-v3_0)/dv +
-											U[k*6+5]*(((v1_val-v1_0)/dv)*((v1_val-v1_0)/dv)+((v2_val-v2_0)/dv)*((v2_val-v2_0)/dv)
+									f_val = U[SlabIndex(k, 0)] + U[SlabIndex(k, 1)]*(x_val-x_0)/dx + U[SlabIndex(k, 2)]*(v1_val-v1_0)/dv +
+											U[SlabIndex(k, 3)]*(v2_val-v2_0)/dv + U[SlabIndex(k, 4)]*(v3_val-v3_0)/dv +
+											U[SlabIndex(k, 5)]*(((v1_val-v1_0)/dv)*((v1_val-v1_0)/dv)+((v2_val-v2_0)/dv)*((v2_val-v2_0)/dv)
 													+((v3_val-v3_0)/dv)*((v3_val-v3_0)/dv));										// set f_val to the evaluation of the approximation at (x_val,v1_val,v2_val,v3_val)
 									if(f_val > 0)																					// only do this if f(x_val,v1_val,v2_val,v3_val) > 0 so that the log can be evaluated
 									{
@@ -74,6 +83,7 @@ double computeEntropy_Inhomo(double *U)																									// function to c
 			}
 		}
 	}
+	MPI_Allreduce(MPI_IN_PLACE, &Ent, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);														// add up the entropy of the cells of every process
 	Ent = Ent*0.5*dv*0.5*dv*0.5*dv*0.5*dx;																							// multiply the quadrature result by 0.5*dv*0.5*dv*0.5*dv*0.5*dx, since each quadrature is done over intervals of width dv (three times) or dx (once) instead of the standard interval [-1,1]
 	return Ent;
 }
@@ -96,6 +106,10 @@ double computeEntropy_Homo(double *U)																									// function to com
 			for(j3=0;j3<Nv;j3++)																								// loop through the velocity cells in the v3 direction
 			{
 				k = j1NN + j2N + j3;																							// set k to j1*Nv^2 + j2*Nv + j3
+				if(! HoldsCell(k))																								// U only holds the cells of this process
+				{
+					continue;
+				}
 				v3_0 = Gridv((double)j3);																						// set v3_0 to the value of v3 at the center of the j3th velocity cell in that direction
 				for(nv1=0;nv1<5;nv1++)																						// loop through the five quadrature points in the v1 direction of the cell
 				{
@@ -106,9 +120,9 @@ double computeEntropy_Homo(double *U)																									// function to com
 						for(nv3=0;nv3<5;nv3++)																				// loop through the five quadrature points in the v3 direction of the cell
 						{
 							v3_val = v3_0 + 0.5*vt[nv3]*dv;																	// set v3_val to the nv3-th quadrature point in the cell
-							f_val = U[k*6+0] + U[k*6+2]*(v1_val-v1_0)/dv
-									+ U[k*6+3]*(v2_val-v2_0)/dv + U[k*6+4]*(v3_val-v3_0)/dv
-									+ U[k*6+5]*(((v1_val-v1_0)/dv)*((v1_val-v1_0)/dv)+((v2_val-v2_0)/dv)*((v2_val-v2_0)/dv)
+							f_val = U[SlabIndex(k, 0)] + U[SlabIndex(k, 2)]*(v1_val-v1_0)/dv
+									+ U[SlabIndex(k, 3)]*(v2_val-v2_0)/dv + U[SlabIndex(k, 4)]*(v3_val-v3_0)/dv
+									+ U[SlabIndex(k, 5)]*(((v1_val-v1_0)/dv)*((v1_val-v1_0)/dv)+((v2_val-v2_0)/dv)*((v2_val-v2_0)/dv)
 									+ ((v3_val-v3_0)/dv)*((v3_val-v3_0)/dv));;										// set f_val to the evaluation of the approximation at (x_val,v1_val,v2_val,v3_val)
 							if(f_val > 0)																					// only do this if f(v1_val,v2_val,v3_val) > 0 so that the log can be evaluated
 							{
@@ -120,6 +134,7 @@ double computeEntropy_Homo(double *U)																									// function to com
 			}
 		}
 	}
+	MPI_Allreduce(MPI_IN_PLACE, &Ent, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);												// add up the entropy of the cells of every process
 	Ent = Ent*0.5*dv*0.5*dv*0.5*dv;																							// multiply the quadrature result by 0.5*dv*0.5*dv*0.5*dv, since each quadrature is done over intervals of width dv (three times) instead of the standard interval [-1,1]
 	return Ent;
 }
@@ -0,0 +1,360 @@
+/* This is the source file which contains the subroutines for the FFT collision engine
+ * (CollisionEngine = FFT), which computes the same quadrature as ComputeQ, ComputeQ_FandL &
+ * ComputeQLinear in O(N^3 log N) operations instead of O(N^6).
+ *
+ * Writing u = zeta - w for the argument of fHat in the convolution, the symmetry of S-hat(w) means
+ * that the weights split into a short sum of products of a function of w and a function of u:
+ *
+ *   gHat3(zeta, w)        = alpha(w) - sum_ij S_ij(w) u_i u_j,
+ *   gHat3_linear(zeta, w) = - sum_j (S(w) w)_j u_j - sum_ij S_ij(w) u_i u_j,
+ *
+ * with alpha(w) = sqrt(8/pi)(R_v|w| - sin(R_v|w|))/(R_v|w|) for gamma = -3 (0 at w = 0) and
+ * alpha(w) = w.S(w)w for gamma = 0 & 1 (where gHat3_linear always uses the gamma = -3 tensor).
+ * Each term is then a 3D linear convolution on the grid of eta, which is computed by zero-padding
+ * both factors to 2N points in each direction and multiplying their FFTs.  The transforms of all
+ * of the terms are summed before a single inverse FFT is taken.
+ *
+ * Functions included: PlanPaddedFFTs, InitFFTCollision, FreeFFTCollision, ComputeQ_FFT, ComputeQ_FandL_FFT,
+ * ComputeQLinear_FFT
+ *
+ */
+
+#include "FFTCollision.h"																			// FFTCollision.h is where the prototypes for the functions contained in this file are declared
+
+static const int term_i[6] = {0, 1, 2, 0, 0, 1};													// the indices (i,j) of the distinct entries of the symmetric tensor S-hat, in the order used for the terms 1 to 6 of gHat3
+static const int term_j[6] = {0, 1, 2, 1, 2, 2};
+
+int N_pad, size_pad;																				// declare N_pad (the number of points in each direction of the zero-padded grid, 2N) & size_pad (N_pad^3)
+double **w_terms;																					// declare a pointer to w_terms (the functions of w in the terms of gHat3, including the quadrature weights)
+fftw_complex **fft_linear_terms;																	// declare a pointer to fft_linear_terms (the FFTs of the functions of w in the terms of gHat3_linear, which do not depend on f so are only transformed once)
+fftw_complex *pad_w, *pad_u, *pad_acc, *pad_acc_linear;												// declare pointers to pad_w & pad_u (the zero-padded factors of a term) & pad_acc & pad_acc_linear (where the FFTs of the full & linear convolutions are summed)
+fftw_plan p_pad_forward, p_pad_backward;															// declare the fftw_plans p_pad_forward & p_pad_backward (for the FFTs on the zero-padded grid)
+bool fft_engine_checked;																			// declare fft_engine_checked (set once the FFT engine has been compared with the direct sum)
+
+static inline int PadIndex(int i, int j, int k)														// Function to find the index of the point (i,j,k) of the zero-padded grid
+{
+	return k + N_pad*(j + N_pad*i);
+}
+
+static void PadWTerm(const double *coeff, fftw_complex *gHat, fftw_complex *out)					// Function to zero-pad coeff(w)*gHat(w) (or just coeff(w) if gHat is NULL) into out
+{
+	int kw, l, m, n;
+
+	memset(out, 0, size_pad*sizeof(fftw_complex));
+	#pragma omp parallel for private(kw,l,m,n)
+	for(kw=0;kw<size_ft;kw++)
+	{
+		l = kw/(N*N); m = (kw/N)%N; n = kw%N;
+		if(gHat == NULL)
+		{
+			out[PadIndex(l,m,n)][0] = coeff[kw];
+		}
+		else
+		{
+			out[PadIndex(l,m,n)][0] = coeff[kw]*gHat[kw][0];
+			out[PadIndex(l,m,n)][1] = coeff[kw]*gHat[kw][1];
+		}
+	}
+}
+
+static void PadUTerm(fftw_complex *fHat, int a, int b, fftw_complex *out)							// Function to zero-pad u_a*u_b*fHat(u) into out (where a or b equal to -1 leave out that factor of u)
+{
+	int kz, x, y, z;
+	double u[3], factor;
+
+	memset(out, 0, size_pad*sizeof(fftw_complex));
+	#pragma omp parallel for private(kz,x,y,z,u,factor)
+	for(kz=0;kz<size_ft;kz++)
+	{
+		x = kz/(N*N); y = (kz/N)%N; z = kz%N;
+		u[0] = eta[x]; u[1] = eta[y]; u[2] = eta[z];
+		factor = 1.;
+		if(a >= 0) factor *= u[a];
+		if(b >= 0) factor *= u[b];
+		out[PadIndex(x,y,z)][0] = factor*fHat[kz][0];
+		out[PadIndex(x,y,z)][1] = factor*fHat[kz][1];
+	}
+}
+
+static void AccumulateProduct(fftw_complex *acc, fftw_complex *A, fftw_complex *B)					// Function to add the pointwise product A*B of two transformed terms to acc
+{
+	int k;
+
+	#pragma omp parallel for private(k)
+	for(k=0;k<size_pad;k++)
+	{
+		acc[k][0] += A[k][0]*B[k][0] - A[k][1]*B[k][1];
+		acc[k][1] += A[k][0]*B[k][1] + A[k][1]*B[k][0];
+	}
+}
+
+static void ExtractConvolution(fftw_complex *acc, fftw_complex *qHat)								// Function to invert the summed FFTs in acc and pick out the values of the convolution at each ki(i,j,k)
+{
+	int ki, i, j, k;
+	double scale_pad = 1./(double)size_pad;															// fftw does no scaling, so the inverse FFT must be divided by size_pad
+
+	fftw_execute_dft(p_pad_backward, acc, acc);
+	#pragma omp parallel for private(ki,i,j,k)
+	for(ki=0;ki<size_ft;ki++)
+	{
+		i = ki/(N*N); j = (ki/N)%N; k = ki%N;
+		qHat[ki][0] = scale_pad*acc[PadIndex(i+N/2,j+N/2,k+N/2)][0];								// eta[x] = ki[i] - eta[l] when x = i + N/2 - l, so the convolution at ki(i) is found at i + N/2
+		qHat[ki][1] = scale_pad*acc[PadIndex(i+N/2,j+N/2,k+N/2)][1];
+	}
+}
+
+static void PlanPaddedFFTs()																		// Function to plan the FFTs on the zero-padded grid with the flag fft_planner
+{
+	p_pad_forward = fftw_plan_dft_3d(N_pad, N_pad, N_pad, pad_w, pad_w, FFTW_FORWARD, fft_planner);	// plan the FFT of size N_pad^3 (it is applied to pad_w & pad_u in place)
+	p_pad_backward = fftw_plan_dft_3d(N_pad, N_pad, N_pad, pad_acc, pad_acc, FFTW_BACKWARD, fft_planner);	// plan the inverse FFT of size N_pad^3 (it is applied to pad_acc & pad_acc_linear in place)
+}
+
+void InitFFTCollision(int gamma)																	// Function to tabulate the functions of w in each term of the convolution weights and plan the FFTs on the zero-padded grid
+{
+	int kw, l, m, n, p, a, b, t;
+	double w[3], r, wt, Shat[3][3], Shat_linear[3][3];
+	double **w_linear;
+
+	N_pad = 2*N;
+	size_pad = N_pad*N_pad*N_pad;
+
+	pad_w = (fftw_complex *)fftw_malloc(size_pad*sizeof(fftw_complex));								// allocate enough space at the pointer pad_w for size_pad many complex numbers
+	pad_u = (fftw_complex *)fftw_malloc(size_pad*sizeof(fftw_complex));								// allocate enough space at the pointer pad_u for size_pad many complex numbers
+	pad_acc = (fftw_complex *)fftw_malloc(size_pad*sizeof(fftw_complex));							// allocate enough space at the pointer pad_acc for size_pad many complex numbers
+	fftw_plan_with_nthreads(FFTThreads(N_pad));														// the padded grid has 8 times the points of the NxNxN grid, so may be worth more threads
+	if(myrank_mpi==0)
+	{
+		PlanPaddedFFTs();																			// the process with rank 0 plans first, and the others look its plans up in the wisdom it sends them
+	}
+	ShareFFTWisdom();
+	if(myrank_mpi!=0)
+	{
+		PlanPaddedFFTs();
+	}
+	fftw_plan_with_nthreads(FFTThreads(N));															// go back to the number of threads for the NxNxN grid for any later plans
+
+	w_terms = (double **)malloc(FFT_LANDAU_TERMS*sizeof(double *));
+	for(t=0;t<FFT_LANDAU_TERMS;t++)
+	{
+		w_terms[t] = (double *)malloc(size_ft*sizeof(double));
+	}
+	w_linear = NULL;
+	fft_linear_terms = NULL;
+	pad_acc_linear = NULL;
+	if(FullandLinear)
+	{
+		w_linear = (double **)malloc(FFT_LINEAR_TERMS*sizeof(double *));
+		for(t=0;t<FFT_LINEAR_TERMS;t++)
+		{
+			w_linear[t] = (double *)malloc(size_ft*sizeof(double));
+		}
+	}
+
+	#pragma omp parallel for private(kw,l,m,n,p,a,b,w,r,wt,Shat,Shat_linear)
+	for(kw=0;kw<size_ft;kw++)
+	{
+		l = kw/(N*N); m = (kw/N)%N; n = kw%N;														// (l,m,n) are the indices of w, with kw = n + N*(m + N*l)
+		w[0] = eta[l]; w[1] = eta[m]; w[2] = eta[n];
+		wt = h_eta*h_eta*h_eta*wtN[l]*wtN[m]*wtN[n];												// the quadrature weight at w, as used in ComputeQ
+
+		ShatTensor(w[0], w[1], w[2], gamma, Shat);
+		if(gamma==-3)
+		{
+			r = sqrt(w[0]*w[0] + w[1]*w[1] + w[2]*w[2]);
+			if(r==0.) w_terms[0][kw] = 0.;
+			else w_terms[0][kw] = wt*(sqrt(8./PI))*(R_v*r-sin(R_v*r))/(R_v*r);
+		}
+		else
+		{
+			w_terms[0][kw] = 0.;
+			for(a=0;a<3;a++)
+			{
+				for(b=0;b<3;b++)
+				{
+					w_terms[0][kw] += wt*Shat[a][b]*w[a]*w[b];
+				}
+			}
+		}
+		for(p=0;p<6;p++)
+		{
+			a = term_i[p]; b = term_j[p];
+			w_terms[p+1][kw] = -wt*(a==b ? 1. : 2.)*Shat[a][b];										// the off-diagonal entries of S-hat appear twice in the sum over i & j
+		}
+
+		if(FullandLinear)
+		{
+			ShatTensor(w[0], w[1], w[2], -3, Shat_linear);
+			for(p=0;p<6;p++)
+			{
+				a = term_i[p]; b = term_j[p];
+				w_linear[p][kw] = -scale3*wt*(a==b ? 1. : 2.)*Shat_linear[a][b];
+			}
+			for(b=0;b<3;b++)
+			{
+				w_linear[6+b][kw] = -scale3*wt*(Shat_linear[0][b]*w[0] + Shat_linear[1][b]*w[1] + Shat_linear[2][b]*w[2]);
+			}
+		}
+	}
+
+	if(FullandLinear)																				// the terms of the linear part do not depend on f, so transform them once here
+	{
+		pad_acc_linear = (fftw_complex *)fftw_malloc(size_pad*sizeof(fftw_complex));
+		fft_linear_terms = (fftw_complex **)malloc(FFT_LINEAR_TERMS*sizeof(fftw_complex *));
+		for(t=0;t<FFT_LINEAR_TERMS;t++)
+		{
+			fft_linear_terms[t] = (fftw_complex *)fftw_malloc(size_pad*sizeof(fftw_complex));
+			PadWTerm(w_linear[t], NULL, fft_linear_terms[t]);
+			fftw_execute_dft(p_pad_forward, fft_linear_terms[t], fft_linear_terms[t]);
+			free(w_linear[t]);
+		}
+		free(w_linear);
+	}
+
+	fft_engine_checked = false;
+	if(CheckCollisionEngine)
+	{
+		InitMatrixFreeTables(gamma);																// the matrix-free routines give the direct sum without needing the tables of weights
+	}
+
+	if(myrank_mpi==0)
+	{
+		printf("FFT collision engine: %d terms on a %d^3 zero-padded grid (%g MB).\n",
+				FullandLinear ? FFT_LANDAU_TERMS + 3 : FFT_LANDAU_TERMS, N_pad,
+				((FullandLinear ? 4. + FFT_LINEAR_TERMS : 3.)*size_pad*sizeof(fftw_complex) + FFT_LANDAU_TERMS*size_ft*sizeof(double))/1.e6);
+	}
+}
+
+void FreeFFTCollision()																				// Function to delete the tables & plans built by InitFFTCollision
+{
+	int t;
+
+	for(t=0;t<FFT_LANDAU_TERMS;t++)
+	{
+		free(w_terms[t]);
+	}
+	free(w_terms);
+	if(FullandLinear)
+	{
+		for(t=0;t<FFT_LINEAR_TERMS;t++)
+		{
+			fftw_free(fft_linear_terms[t]);
+		}
+		free(fft_linear_terms);
+		fftw_free(pad_acc_linear);
+	}
+	fftw_destroy_plan(p_pad_forward); fftw_destroy_plan(p_pad_backward);
+	fftw_free(pad_w); fftw_free(pad_u); fftw_free(pad_acc);
+	if(CheckCollisionEngine)
+	{
+		FreeMatrixFreeTables();
+	}
+}
+
+static void FFTConvolution(fftw_complex *gHat, fftw_complex *fHat, fftw_complex *qHat, fftw_complex *qHat_linear)	// Function to calculate qHat(ki) = sum over w of gHat3(ki,w)*gHat(w)*fHat(ki-w) with the FFTs of each separable term (and, if qHat_linear is not NULL, the linear part of ComputeQ_FandL, which is also added to qHat)
+{
+	int t, k;
+
+	memset(pad_acc, 0, size_pad*sizeof(fftw_complex));
+	if(qHat_linear != NULL)
+	{
+		memset(pad_acc_linear, 0, size_pad*sizeof(fftw_complex));
+	}
+
+	for(t=0;t<FFT_LANDAU_TERMS;t++)
+	{
+		PadWTerm(w_terms[t], gHat, pad_w);
+		fftw_execute_dft(p_pad_forward, pad_w, pad_w);
+		if(t==0)
+		{
+			PadUTerm(fHat, -1, -1, pad_u);
+		}
+		else
+		{
+			PadUTerm(fHat, term_i[t-1], term_j[t-1], pad_u);
+		}
+		fftw_execute_dft(p_pad_forward, pad_u, pad_u);
+
+		AccumulateProduct(pad_acc, pad_w, pad_u);
+		if(qHat_linear != NULL && t > 0)
+		{
+			AccumulateProduct(pad_acc_linear, fft_linear_terms[t-1], pad_u);						// the linear part shares the terms in u_i u_j with the full part
+		}
+	}
+
+	if(qHat_linear != NULL)
+	{
+		for(t=0;t<3;t++)
+		{
+			PadUTerm(fHat, t, -1, pad_u);
+			fftw_execute_dft(p_pad_forward, pad_u, pad_u);
+			AccumulateProduct(pad_acc_linear, fft_linear_terms[6+t], pad_u);
+		}
+		ExtractConvolution(pad_acc_linear, qHat_linear);
+	}
+
+	ExtractConvolution(pad_acc, qHat);
+	if(qHat_linear != NULL)
+	{
+		for(k=0;k<size_ft;k++)
+		{
+			qHat[k][0] += qHat_linear[k][0];
+			qHat[k][1] += qHat_linear[k][1];
+		}
+	}
+}
+
+void ComputeQ_FFT(double *f, fftw_complex *qHat)													// Function to calculate the Fourier transform of Q(f,f), as in ComputeQ, with FFT-based convolutions
+{
+	fftw_complex *qHat_direct;
+
+	fft3D(f, fftOut);																			// perform the FFT of f and store the result in fftOut
+
+	FFTConvolution(fftOut, fftOut, qHat, NULL);
+
+	if(CheckCollisionEngine && ! fft_engine_checked)												// the first time through, compare with the direct sum
+	{
+		qHat_direct = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		ComputeQ_MatrixFree(f, qHat_direct);
+		ReportEngineDifference("FFT", "ComputeQ", qHat, qHat_direct);
+		fftw_free(qHat_direct);
+		fft_engine_checked = true;
+	}
+}
+
+void ComputeQLinear_FFT(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat)				// Function to calculate the Fourier transform of Q(f,M), as in ComputeQLinear, with FFT-based convolutions
+{
+	fftw_complex *qHat_direct;
+
+	fft3D(f, fftOut);																			// perform the FFT of f and store the result in fftOut
+
+	FFTConvolution(Maxwell_fftOut, fftOut, qHat, NULL);
+
+	if(CheckCollisionEngine && ! fft_engine_checked)												// the first time through, compare with the direct sum
+	{
+		qHat_direct = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		ComputeQLinear_MatrixFree(f, Maxwell_fftOut, qHat_direct);
+		ReportEngineDifference("FFT", "ComputeQLinear", qHat, qHat_direct);
+		fftw_free(qHat_direct);
+		fft_engine_checked = true;
+	}
+}
+
+void ComputeQ_FandL_FFT(double *f, fftw_complex *qHat, fftw_complex *qHat_linear)					// Function to calculate the Fourier transforms of the full & linear parts of Q, as in ComputeQ_FandL, with FFT-based convolutions
+{
+	fftw_complex *qHat_direct, *qHat_linear_direct;
+
+	fft3D(f, fftOut);																			// perform the FFT of f and store the result in fftOut
+
+	FFTConvolution(fftOut, fftOut, qHat, qHat_linear);
+
+	if(CheckCollisionEngine && ! fft_engine_checked)												// the first time through, compare with the direct sum
+	{
+		qHat_direct = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		qHat_linear_direct = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		ComputeQ_FandL_MatrixFree(f, qHat_direct, qHat_linear_direct);
+		ReportEngineDifference("FFT", "ComputeQ_FandL", qHat, qHat_direct);
+		ReportEngineDifference("FFT", "ComputeQ_FandL linear part", qHat_linear, qHat_linear_direct);
+		fftw_free(qHat_direct); fftw_free(qHat_linear_direct);
+		fft_engine_checked = true;
+	}
+}
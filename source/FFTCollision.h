@@ -0,0 +1,43 @@
+/* This is the header file associated to FFTCollision.cpp in which the prototypes for the
+ * functions contained in that file are declared.  Any other header files which must be linked to
+ * for the functions here are also included.
+ *
+ */
+
+//************************//
+//     INCLUDE GUARDS     //
+//************************//
+
+#ifndef FFTCOLLISION_H_
+#define FFTCOLLISION_H_
+
+//************************//
+//        INCLUDES        //
+//************************//
+
+#include "LP_ompi.h"																				// allows the libraries included, macros defined and external variables declared in LP_ompi.h to be used in the FFTCollision functions
+#include "collisionRoutines_1.h"																	// allows ShatTensor & fft3D to be used in the FFTCollision functions
+#include "MatrixFreeCollision.h"																	// allows the matrix-free routines to be used as the direct sum when checking the FFT engine
+
+//************************//
+//         MACROS         //
+//************************//
+
+#define FFT_LANDAU_TERMS 7																			// number of separable terms in gHat3 (the isotropic term & the 6 distinct entries of the symmetric tensor S-hat)
+#define FFT_LINEAR_TERMS 9																			// number of separable terms in gHat3_linear (the 6 distinct entries of S-hat & the 3 components of S-hat(w)w)
+
+//************************//
+//   FUNCTION PROTOTYPES  //
+//************************//
+
+void InitFFTCollision(int gamma);
+
+void FreeFFTCollision();
+
+void ComputeQ_FFT(double *f, fftw_complex *qHat);
+
+void ComputeQ_FandL_FFT(double *f, fftw_complex *qHat, fftw_complex *qHat_linear);
+
+void ComputeQLinear_FFT(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat);
+
+#endif /* FFTCOLLISION_H_ */
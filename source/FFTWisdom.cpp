@@ -0,0 +1,83 @@
+/* This is the source file which contains the subroutines which keep the wisdom of fftw3 (the record
+ * of the fastest way it found to take each FFT it has planned), so that the plans made at startup
+ * need not be measured again by every process on every run.
+ *
+ * Rank 0 reads the wisdom of earlier runs from wisdom_file (if UseWisdom = True) & plans each set of
+ * FFTs first.  ShareFFTWisdom then broadcasts the wisdom of rank 0 as a string & the other processes
+ * import it, so that their plans with the same sizes, threads & flags are looked up rather than
+ * measured.  Once every plan has been made, rank 0 writes all of its wisdom back to wisdom_file.
+ * Wisdom depends on the machine, so a wisdom file should only be reused on the same kind of node.
+ *
+ * Functions included: FFTPlannerName, LoadFFTWisdom, ShareFFTWisdom, SaveFFTWisdom
+ *
+ */
+
+#include "FFTWisdom.h"																				// FFTWisdom.h is where the prototypes for the functions contained in this file are declared
+
+const char *FFTPlannerName(unsigned planner)														// Function to return the name used in the input file for the planner flag planner
+{
+	if(planner == FFTW_ESTIMATE) return "Estimate";
+	if(planner == FFTW_PATIENT) return "Patient";
+	return "Measure";
+}
+
+void LoadFFTWisdom()																				// Function to import the wisdom in wisdom_file on the process with rank 0 (if UseWisdom is true)
+{
+	if(UseWisdom && myrank_mpi==0)
+	{
+		if(fftw_import_wisdom_from_filename(wisdom_file.c_str()))
+		{
+			printf("The fftw3 wisdom in %s was imported before planning the FFTs.\n\n", wisdom_file.c_str());
+		}
+		else
+		{
+			printf("No fftw3 wisdom could be read from %s, so the FFTs are planned from scratch.\n\n", wisdom_file.c_str());
+		}
+	}
+}
+
+void ShareFFTWisdom()																				// Function to send the wisdom of the process with rank 0 to all of the other processes (which must all call it), to be called once rank 0 has made a set of plans & before the others make the same plans
+{
+	char *wisdom;
+	int length;
+
+	if(nprocs_mpi == 1)
+	{
+		return;
+	}
+
+	wisdom = NULL;
+	length = 0;
+	if(myrank_mpi==0)
+	{
+		wisdom = fftw_export_wisdom_to_string();
+		length = strlen(wisdom) + 1;																// include the terminating null character
+	}
+	MPI_Bcast(&length, 1, MPI_INT, 0, MPI_COMM_WORLD);
+	if(myrank_mpi!=0)
+	{
+		wisdom = (char *)malloc(length*sizeof(char));
+	}
+	MPI_Bcast(wisdom, length, MPI_CHAR, 0, MPI_COMM_WORLD);
+
+	if(myrank_mpi==0)
+	{
+		fftw_free(wisdom);																			// the string exported by fftw3 is deleted with fftw_free
+	}
+	else
+	{
+		fftw_import_wisdom_from_string(wisdom);
+		free(wisdom);
+	}
+}
+
+void SaveFFTWisdom()																				// Function to export the wisdom of the process with rank 0 to wisdom_file (if UseWisdom is true), to be called once every plan has been made
+{
+	if(UseWisdom && myrank_mpi==0)
+	{
+		if(! fftw_export_wisdom_to_filename(wisdom_file.c_str()))
+		{
+			printf("Warning: the fftw3 wisdom could not be written to %s.\n\n", wisdom_file.c_str());
+		}
+	}
+}
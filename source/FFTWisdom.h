@@ -0,0 +1,32 @@
+/* This is the header file associated to FFTWisdom.cpp in which the prototypes for the
+ * functions contained in that file are declared.  Any other header files which must be linked to
+ * for the functions here are also included.
+ *
+ */
+
+//************************//
+//     INCLUDE GUARDS     //
+//************************//
+
+#ifndef FFTWISDOM_H_
+#define FFTWISDOM_H_
+
+//************************//
+//        INCLUDES        //
+//************************//
+
+#include "LP_ompi.h"																				// allows the libraries included, macros defined and external variables declared in LP_ompi.h to be used in the FFTWisdom functions
+
+//************************//
+//   FUNCTION PROTOTYPES  //
+//************************//
+
+const char *FFTPlannerName(unsigned planner);
+
+void LoadFFTWisdom();
+
+void ShareFFTWisdom();
+
+void SaveFFTWisdom();
+
+#endif /* FFTWISDOM_H_ */
@@ -3,7 +3,11 @@
  * problem.
  *
  * Functions included: rho_x, rho, computePhi_x_0, computePhi_x_0, computePhi, PrintFieldLoc, PrintFieldData, computeC_rho, Int_Int_rho
- * Int_Int_rho1st, Int_fE, Int_E, Int_E1st, Int_E2nd,
+ * Int_Int_rho1st, Int_fE, Int_E, Int_E1st, Int_E2nd, ChargeSums, FieldIntegralsFromCharge
+ *
+ * U only holds the cells of this process (see advection_1.cpp), so PrintFieldData adds up the sums of rho in
+ * each space cell over every process (ChargeSums) and computePhi & computeE work from those sums.  Every
+ * process must therefore call PrintFieldData, while only process 0 prints.
  *
  */
 
@@ -130,7 +134,7 @@ double Int_fE(double *U, int i, int j) // \int f * E(f) dxdv on element I_i * K_
 	k = i*size_v + j;
 
 	//retn = (U[k][0] + U[k][5]/4.)*Int_E(U,i) + U[k][1]*Int_E1st(U,i);
-	retn = (U[k*6+0] + U[k*6+5]/4.)*intE[i] + U[k*6+1]*intE1[i];
+	retn = (U[SlabIndex(k, 0)] + U[SlabIndex(k, 5)]/4.)*intE[i] + U[SlabIndex(k, 1)]*intE1[i];
 	return retn*scalev;
 }
 
@@ -146,40 +150,49 @@ double computePhi_x_0(double *U) 																				// wrapper for function to
 	}
 }
 
-double computePhi(double *U, double x, int ix)																	// wrapper for function to compute the potential Phi at a position x, contained in [x_(ix-1/2), x_(ix+1/2)]
+double computePhi(double *charge, double x, int ix)																// wrapper for function to compute the potential Phi at a position x, contained in [x_(ix-1/2), x_(ix+1/2)]
 {
 	if(Doping)
 	{
-		return computePhi_Doping(U, x, ix);
+		return computePhi_Doping(charge, x, ix);
 	}
 	else
 	{
-		return computePhi_Normal(U, x, ix);
+		return computePhi_Normal(charge, x, ix);
 	}
 }
 
-double computeE(double *U, double x, int ix)																	// wrapper for function to compute the field E at a position x, contained in [x_(ix-1/2), x_(ix+1/2)]
+double computeE(double *charge, double x, int ix)																// wrapper for function to compute the field E at a position x, contained in [x_(ix-1/2), x_(ix+1/2)]
 {
 	if(Doping)
 	{
-		return computeE_Doping(U, x, ix);
+		return computeE_Doping(charge, x, ix);
 	}
 	else
 	{
-		//return computeE_Normal(U, x, ix);
+		//return computeE_Normal(charge, x, ix);
 	}
 }
 
 void PrintFieldData(double* U_vals, FILE *phifile, FILE *Efile)													// wrapper for function to print the values of the potential and the field in the x1 & x2 directions in the file tagged as phifile, Ex1file & Ex2file, respectively, at the given timestep
 {
-	if(Doping)
-	{
-		PrintFieldData_Doping(U_vals, phifile, Efile);
-	}
-	else
+	double *charge = (double*)malloc(2*Nx*sizeof(double));														// declare charge (to store the sums of rho in each space cell which phi & E depend on) and allocate enough space for 2*Nx many doubles
+
+	ChargeSums(U_vals, chunksize_dg*myrank_mpi, chunksize_dg*(myrank_mpi+1), charge);							// U only holds the cells of this process (see advection_1.cpp), so the sums of rho in each space cell are added up over all of the processes
+	MPI_Allreduce(MPI_IN_PLACE, charge, 2*Nx, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+	FieldIntegralsFromCharge(charge);																			// set ce = computePhi_x_0(U) & cp[i] = computeC_rho(U,i), which phi & E are computed from
+	if(myrank_mpi==0)																							// only process 0 prints the values of phi & E
 	{
-		PrintFieldData_Normal(U_vals, phifile, Efile);
+		if(Doping)
+		{
+			PrintFieldData_Doping(charge, phifile, Efile);
+		}
+		else
+		{
+			PrintFieldData_Normal(charge, phifile, Efile);
+		}
 	}
+	free(charge);																								// delete the dynamic memory allocated for charge
 }
 
 double Int_E(double *U, int i) 		 						      												// wrapper for function to calculate the integral of E_h w.r.t. x over the interval I_i = [x_(i-1/2), x_(i+1/2))
@@ -218,6 +231,80 @@ double Int_E2nd(double *U, int i) 																				// wrapper for function to
 	}
 }
 
+void ChargeSums(double *U, int k_start, int k_end, double *charge)									// Function to add up, for each space cell i, charge[2*i] = sum_j U[k*6+0] + U[k*6+5]/4 & charge[2*i+1] = sum_j U[k*6+1] over the cells k = i*size_v + j with k_start <= k < k_end (the sums of rho which the field depends on), where U holds the cells from slab_first onwards (see SlabIndex)
+{
+	int i, k;
+
+	for(i=0;i<2*Nx;i++)
+	{
+		charge[i] = 0.;
+	}
+	for(k=k_start;k<k_end;k++)
+	{
+		i = k/size_v;
+		charge[2*i] += U[SlabIndex(k, 0)] + U[SlabIndex(k, 5)]/4.;
+		charge[2*i+1] += U[SlabIndex(k, 1)];
+	}
+}
+
+void FieldIntegralsFromCharge(double *charge)														// Function to set ce, cp, intE, intE1 & intE2 (as computePhi_x_0, computeC_rho, Int_E, Int_E1st & Int_E2nd do from all of U) from the sums in each space cell made by ChargeSums, so that the processes of RK3 only need to share 2*Nx numbers
+{
+	int i;
+	double ND, c1, c2, cum=0., tmp=0.;
+	double a_val = (a_i+1)*dx;
+	double b_val = (b_i+1)*dx;
+	double Phi_Lx = 1;																				// declare Phi_Lx (the Dirichlet BC, Phi(t, L_x) = Phi_Lx) and set its value (as in computePhi_x_0_Doping)
+
+	for(i=0;i<Nx;i++)
+	{
+		cp[i] = cum*dx*scalev;																		// cum is the sum over the space cells m < i, as in computeC_rho
+		intE[i] = cum + 0.5*charge[2*i] - charge[2*i+1]/12.;										// the sum in Int_E before it is scaled, which computePhi_x_0 adds up over every space cell
+		tmp += intE[i];
+		cum += charge[2*i];
+	}
+	tmp = tmp*scalev*dx*dx;
+
+	if(Doping)
+	{
+		ce = Phi_Lx/Lx + 0.5*NH*Lx/eps + (NL-NH)*(b_val-a_val)/eps - (0.5*(NL-NH)*(b_val*b_val - a_val*a_val) + tmp)/(Lx*eps);
+	}
+	else
+	{
+		ce = 0.5*Lx - tmp/Lx;
+	}
+
+	for(i=0;i<Nx;i++)
+	{
+		c1 = charge[2*i];
+		c2 = charge[2*i+1]*dx/2.;
+		if(Doping)
+		{
+			ND = DopingProfile(i);
+			intE[i] = - intE[i]*dx*dx*scalev + ND*Gridx((double)i)*dx;
+			intE1[i] = (ND-c1*scalev)*dx*dx/(12.*eps);
+			intE2[i] = (-cp[i] +scalev*(c1*Gridx(i-0.5) + 0.25*c2))*dx/12. + (ND-scalev*c1)*dx*Gridx((double)i)/12. - scalev*c2*dx/80.;
+			if(i > a_i)																				// if x > a then there are extra terms to add (as in Int_E_Doping & Int_E2nd_Doping)
+			{
+				intE[i] += (NH-NL)*a_val*dx;
+				intE2[i] += (NH-NL)*a_val*dx/12.;
+			}
+			if(i > b_i)																				// if x > b then there are extra terms to add
+			{
+				intE[i] += (NL-NH)*b_val*dx;
+				intE2[i] += (NL-NH)*b_val*dx/12.;
+			}
+			intE[i] = intE[i]/eps - ce*dx;
+			intE2[i] = intE2[i]/eps - ce*dx/12.;
+		}
+		else
+		{
+			intE[i] = -ce*dx - intE[i]*dx*dx*scalev + Gridx((double)i)*dx;
+			intE1[i] = (1-c1*scalev)*dx*dx/12.;
+			intE2[i] = (-cp[i] - ce+scalev*(c1*Gridx(i-0.5) + 0.25*c2))*dx/12. + (1-scalev*c1)*dx*Gridx((double)i)/12. - scalev*c2*dx/80.;
+		}
+	}
+}
+
 // REGULAR SUBROUTINES WITH UNIFORM DOPING PROFILE (When Doping = False):
 
 double computePhi_x_0_Normal(double *U) // compute the constant coefficient of x in phi, which is actually phi_x(0) (Calculate C_E in the paper -between eq. 52 & 53?)
@@ -242,9 +329,9 @@ double computePhi_x_0_Normal(double *U) // compute the constant coefficient of x
 	return 0.5*Lx - tmp/Lx;
 }
 
-double computePhi_Normal(double *U, double x, int ix)									// function to compute the potential Phi at a position x, contained in [x_(ix-1/2), x_(ix+1/2)]
+double computePhi_Normal(double *charge, double x, int ix)								// function to compute the potential Phi at a position x, contained in [x_(ix-1/2), x_(ix+1/2)], from the sums of rho in each space cell made by ChargeSums (with ce set by FieldIntegralsFromCharge)
 {
-	int i_out, i, j1, j2, j3, iNNN, j1NN, j2N, k;										// declare counters i_out (for the outer sum of i values), i, j1, j2, j3 for summing the contribution from cell I_i x K_(j1, j2, j3), iNNN (the value of i*Nv^3), j1NN (the value of j1*Nv^2), j2N (the value of j2*N) & k (the location in U of the cell I_i x K_(j1, j2, j3))
+	int i_out, i;																		// declare counters i_out (for the outer sum of i values) & i for summing the contribution from the space cell I_i
 	double retn, sum1, sum3, sum4, x_diff, x_diff_mid, x_diff_sq, x_eval, C_E;			// declare retn (the value of Phi returned at the end), sum1 (the value of the first two sums), sum3 (the value of the third sum), sum4 (the value of the fourth sum), x_diff (the value of x - x_(ix-1/2)), x_diff_mid (the value of x - x_ix), x_diff_sq (the value of x_diff^2), x_eval (the value associated to the integral of (x - x_i)^2) & C_E (the value of the constant in the formula for phi)
 	sum1 = 0;
 	sum3 = 0;
@@ -259,76 +346,24 @@ double computePhi_Normal(double *U, double x, int ix)									// function to com
 	{
 		for(i = 0; i < i_out; i++)
 		{
-			iNNN = i*Nv*Nv*Nv;
-			for(j1 = 0; j1 < Nv; j1++)
-			{
-				j1NN = j1*Nv*Nv;
-				for(j2 = 0; j2 < Nv; j2++)
-				{
-					j2N = j2*Nv;
-					for(j3 = 0; j3 < Nv; j3++)
-					{
-						k = iNNN + j1NN + j2N + j3;
-						sum1 += U[6*k] + U[6*k+5]/4.;
-					}
-				}
-			}
-		}
-		iNNN = i_out*Nv*Nv*Nv;
-		for(j1 = 0; j1 < Nv; j1++)
-		{
-			j1NN = j1*Nv*Nv;
-			for(j2 = 0; j2 < Nv; j2++)
-			{
-				j2N = j2*Nv;
-				for(j3 = 0; j3 < Nv; j3++)
-				{
-					k = iNNN + j1NN + j2N + j3;
-					sum1 += U[6*k]/2 - U[6*k+1]/12. +  U[6*k+5]/8;
-				}
-			}
+			sum1 += charge[2*i];
 		}
+		sum1 += charge[2*i_out]/2 - charge[2*i_out+1]/12.;
 	}
 	sum1 = sum1*dx*dx;
 	for(i = 0; i < i_out; i++)
 	{
-		iNNN = i*Nv*Nv*Nv;
-		for(j1 = 0; j1 < Nv; j1++)
-		{
-			j1NN = j1*Nv*Nv;
-			for(j2 = 0; j2 < Nv; j2++)
-			{
-				j2N = j2*Nv;
-				for(j3 = 0; j3 < Nv; j3++)
-				{
-					k = iNNN + j1NN + j2N + j3;
-					sum3 += (U[6*k] + U[6*k+5]/4.);
-				}
-			}
-		}
+		sum3 += charge[2*i];
 	}
 	sum3 = sum3*dx*x_diff;
-	iNNN = ix*Nv*Nv*Nv;
-	for(j1 = 0; j1 < Nv; j1++)
-	{
-		j1NN = j1*Nv*Nv;
-		for(j2 = 0; j2 < Nv; j2++)
-		{
-			j2N = j2*Nv;
-			for(j3 = 0; j3 < Nv; j3++)
-			{
-				k = iNNN + j1NN + j2N + j3;
-				sum4 += U[6*k]*x_diff_sq/2. + U[6*k+1]*x_eval +  U[6*k+5]*x_diff_sq/8.;
-			}
-		}
-	}
+	sum4 = charge[2*ix]*x_diff_sq/2. + charge[2*ix+1]*x_eval;
 
-	C_E = computePhi_x_0(U);
+	C_E = ce;
 	retn = (sum1 + sum3 + sum4)*dv*dv*dv - x*x/2 - C_E*x;
 	return retn;
 }
 
-void PrintFieldData_Normal(double* U_vals, FILE *phifile, FILE *Efile)							// function to print the values of the potential and the field in the x1 & x2 directions in the file tagged as phifile, Ex1file & Ex2file, respectively, at the given timestep
+void PrintFieldData_Normal(double *charge, FILE *phifile, FILE *Efile)							// function to print the values of the potential and the field in the x1 & x2 directions in the file tagged as phifile, Ex1file & Ex2file, respectively, at the given timestep, from the sums of rho in each space cell made by ChargeSums
 {
 	double x_0, x_val, phi_val, E_val, ddx;								// declare x_0 (the x value at the left edge of a given cell), x_val (the x value to be evaluated at), phi_val (the value of phi evaluated at x_val), E_val (the value of E evaluated at x_val) & ddx (the space between x values)
 	int np = 4;															// declare np (the number of points to evaluate in a given space cell) and set its value
@@ -341,10 +376,10 @@ void PrintFieldData_Normal(double* U_vals, FILE *phifile, FILE *Efile)							//
 		{
 			x_val = x_0 + nx*ddx;										// set x_val to x_0 plus nx increments of width ddx
 
-			phi_val = computePhi(U_vals, x_val, i);							// calculate the value of phi, evaluated at x_val by using the function in the space cell i
+			phi_val = computePhi(charge, x_val, i);							// calculate the value of phi, evaluated at x_val by using the function in the space cell i
 //			rho_val = rho_x(x_val, U, i);														// calculate the value of rho, evaluated at x_val by using the function in the space cell
 //			M_0 = rho_val/(sqrt(1.8*PI));
-//			E_val = computeE(U_vals, x_val, i);								// calculate the value of E, evaluated at x_val by using the function in the space cell i
+//			E_val = computeE(charge, x_val, i);								// calculate the value of E, evaluated at x_val by using the function in the space cell i
 			fprintf(phifile, "%11.8g ", phi_val);						// in the file tagged as phifile, print the value of the potential phi(t, x_val)
 //			fprintf(Efile, "%11.8g ", E_val);							// in the file tagged as Efile, print the value of the field E(t, x_val)
 		}
@@ -449,9 +484,9 @@ double computePhi_x_0_Doping(double *U) /* DIFFERENT FOR withND */
 	return Phi_Lx/Lx + 0.5*NH*Lx/eps + (NL-NH)*(b_val-a_val)/eps - (0.5*(NL-NH)*(b_val*b_val - a_val*a_val) + tmp)/(Lx*eps);
 }
 
-double computePhi_Doping(double *U, double x, int ix)	/* DIFFERENT FOR withND */											// function to compute the potential Phi at a position x, contained in [x_(ix-1/2), x_(ix+1/2)]
+double computePhi_Doping(double *charge, double x, int ix)	/* DIFFERENT FOR withND */										// function to compute the potential Phi at a position x, contained in [x_(ix-1/2), x_(ix+1/2)], from the sums of rho in each space cell made by ChargeSums (with ce & cp set by FieldIntegralsFromCharge)
 {
-	int i_out, i, j1, j2, j3, iNNN, j1NN, j2N, k;										// declare counters i_out (for the outer sum of i values), i, j1, j2, j3 for summing the contribution from cell I_i x K_(j1, j2, j3), iNNN (the value of i*Nv^3), j1NN (the value of j1*Nv^2), j2N (the value of j2*N) & k (the location in U of the cell I_i x K_(j1, j2, j3))
+	int i_out;																			// declare i_out (the counter for the sum over the space cells I_i_out)
 	double retn, sum1, sum3, sum4, x_diff, x_diff_mid, x_diff_sq, x_eval, C_E;			// declare retn (the value of Phi returned at the end), sum1 (the value of the first two sums), sum3 (the value of the third sum), sum4 (the value of the fourth sum), x_diff (the value of x - x_(ix-1/2)), x_diff_mid (the value of x - x_ix), x_diff_sq (the value of x_diff^2), x_eval (the value associated to the integral of (x - x_i)^2) & C_E (the value of the constant in the formula for phi)
 	double ND;																			// declare ND (the value of the doping profile at the given x)
 	sum1 = 0;
@@ -466,45 +501,18 @@ double computePhi_Doping(double *U, double x, int ix)	/* DIFFERENT FOR withND */
 
 	for(i_out = 0; i_out < ix; i_out++)
 	{
-		sum1 += computeC_rho(U, i_out);
-
-		iNNN = i_out*Nv*Nv*Nv;
-		for(j1 = 0; j1 < Nv; j1++)
-		{
-			j1NN = j1*Nv*Nv;
-			for(j2 = 0; j2 < Nv; j2++)
-			{
-				j2N = j2*Nv;
-				for(j3 = 0; j3 < Nv; j3++)
-				{
-					k = iNNN + j1NN + j2N + j3;
-					sum1 += (U[6*k]/2 - U[6*k+1]/12. +  U[6*k+5]/8)*dx*scalev;
-				}
-			}
-		}
+		sum1 += cp[i_out];
+		sum1 += (charge[2*i_out]/2 - charge[2*i_out+1]/12.)*dx*scalev;
 	}
 	sum1 = sum1*dx;//*dx;
 
-	sum3 = computeC_rho(U, ix);
+	sum3 = cp[ix];
 
 	sum3 = sum3*x_diff;
-	iNNN = ix*Nv*Nv*Nv;
-	for(j1 = 0; j1 < Nv; j1++)
-	{
-		j1NN = j1*Nv*Nv;
-		for(j2 = 0; j2 < Nv; j2++)
-		{
-			j2N = j2*Nv;
-			for(j3 = 0; j3 < Nv; j3++)
-			{
-				k = iNNN + j1NN + j2N + j3;
-				sum4 += U[6*k]*x_diff_sq/2. + U[6*k+1]*x_eval +  U[6*k+5]*x_diff_sq/8.;
-			}
-		}
-	}
+	sum4 = charge[2*ix]*x_diff_sq/2. + charge[2*ix+1]*x_eval;
 	sum4 = sum4*scalev;
 
-	C_E = computePhi_x_0(U);
+	C_E = ce;
 	retn = sum1 + sum3 + sum4 - ND*x*x/2.;// + C_E*x;
 	if(ix > a_i)																						// if x > a then there is an extra term to add
 	{
@@ -521,26 +529,20 @@ double computePhi_Doping(double *U, double x, int ix)	/* DIFFERENT FOR withND */
 	return retn;																						// return the value of phi at x
 }
 
-double computeE_Doping(double *U, double x, int ix)	/* DIFFERENT FOR withND */								// function to compute the field E at a position x, contained in [x_(ix-1/2), x_(ix+1/2)]
+double computeE_Doping(double *charge, double x, int ix)	/* DIFFERENT FOR withND */						// function to compute the field E at a position x, contained in [x_(ix-1/2), x_(ix+1/2)], from the sums of rho in each space cell made by ChargeSums (with ce & cp set by FieldIntegralsFromCharge)
 {
-	int iNNN, j, k;																						// declare j (a counter for summing the contribution from the velocity cells), iNNN (the value of i*Nv^3) & k (the location in U of the cell I_ix x K_(j1, j2, j3))
 	double retn, sum, x_diff, x_diff_mid, x_eval, C_E;													// declare retn (the value of E returned at the end), sum (the value of the sum to calculate the integral of rho), x_diff (the value of x - x_(ix-1/2)), x_diff_mid (the value of x - x_ix), x_eval (the value associated to the integral of (x - x_i)^2) & C_E (the value of the constant in the formula for E)
 	double ND;																							// declare ND (the value of the doping profile at the given x)
 	sum = 0;																							// initialise the sum at 0
 	ND = DopingProfile(ix);																				// set ND to the value of the doping profile at ix
-	C_E = computePhi_x_0(U);
+	C_E = ce;
 	x_diff = x - Gridx(ix-0.5);
 	x_diff_mid = x - Gridx(ix);
 	x_eval = x_diff_mid*x_diff_mid/(2.*dx) - dx/8.;
 
-	iNNN = ix*size_v;
-	for(j=0;j<size_v;j++)
-	{
-		k = iNNN + j;
-		sum += U[6*k+0]*x_diff + U[6*k+1]*x_eval + U[6*k+5]*x_diff/4.;
-	}
+	sum = charge[2*ix]*x_diff + charge[2*ix+1]*x_eval;
 	sum = sum*scalev;
-	sum += computeC_rho(U, ix);
+	sum += cp[ix];
 
 	retn = ND*x - sum;//- C_E;
 	if(ix > a_i)																						// if x > a then there is an extra term to add
@@ -559,7 +561,7 @@ double computeE_Doping(double *U, double x, int ix)	/* DIFFERENT FOR withND */
 
 }
 
-void PrintFieldData_Doping(double* U_vals, FILE *phifile, FILE *Efile)							// function to print the values of the potential and the field in the x1 & x2 directions in the file tagged as phifile, Ex1file & Ex2file, respectively, at the given timestep
+void PrintFieldData_Doping(double *charge, FILE *phifile, FILE *Efile)							// function to print the values of the potential and the field in the x1 & x2 directions in the file tagged as phifile, Ex1file & Ex2file, respectively, at the given timestep, from the sums of rho in each space cell made by ChargeSums
 {
 	double x_0, x_val, phi_val, E_val, ddx;								// declare x_0 (the x value at the left edge of a given cell), x_val (the x value to be evaluated at), phi_val (the value of phi evaluated at x_val), E_val (the value of E evaluated at x_val) & ddx (the space between x values)
 	int np = 4;															// declare np (the number of points to evaluate in a given space cell) and set its value
@@ -572,8 +574,8 @@ void PrintFieldData_Doping(double* U_vals, FILE *phifile, FILE *Efile)							//
 		{
 			x_val = x_0 + nx*ddx;										// set x_val to x_0 plus nx increments of width ddx
 
-			phi_val = computePhi(U_vals, x_val, i);							// calculate the value of phi, evaluated at x_val by using the function in the space cell i
-			E_val = computeE(U_vals, x_val, i);								// calculate the value of E, evaluated at x_val by using the function in the space cell i
+			phi_val = computePhi(charge, x_val, i);							// calculate the value of phi, evaluated at x_val by using the function in the space cell i
+			E_val = computeE(charge, x_val, i);								// calculate the value of E, evaluated at x_val by using the function in the space cell i
 			fprintf(phifile, "%11.8g ", phi_val);						// in the file tagged as phifile, print the value of the potential phi(t, x_val)
 			fprintf(Efile, "%11.8g ", E_val);							// in the file tagged as Efile, print the value of the field E(t, x_val)
 		}
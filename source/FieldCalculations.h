@@ -41,9 +41,9 @@ double Int_fE(double *U, int i, int j);
 
 double computePhi_x_0(double *U);
 
-double computePhi(double *U, double x, int ix);
+double computePhi(double *charge, double x, int ix);
 
-double computeE(double *U, double x, int ix);
+double computeE(double *charge, double x, int ix);
 
 double Int_E(double *U, int i);
 
@@ -51,6 +51,10 @@ double Int_E1st(double *U, int i);
 
 double Int_E2nd(double *U, int i);
 
+void ChargeSums(double *U, int k_start, int k_end, double *charge);
+
+void FieldIntegralsFromCharge(double *charge);
+
 void PrintFieldData(double* U_vals, FILE *phifile, FILE *Efile);
 
 double Int_E(double *U, int i);
@@ -61,9 +65,9 @@ double Int_E2nd(double *U, int i);
 
 double computePhi_x_0_Normal(double *U);
 
-double computePhi_Normal(double *U, double x, int ix);
+double computePhi_Normal(double *charge, double x, int ix);
 
-void PrintFieldData_Normal(double* U_vals, FILE *phifile, FILE *Efile);
+void PrintFieldData_Normal(double *charge, FILE *phifile, FILE *Efile);
 
 double Int_E_Normal(double *U, int i);
 
@@ -77,11 +81,11 @@ double computePhi_x_0_Doping(double *U);
 
 double computePhi_x_0_Doping(double *U);
 
-double computePhi_Doping(double *U, double x, int ix);
+double computePhi_Doping(double *charge, double x, int ix);
 
-double computeE_Doping(double *U, double x, int ix);
+double computeE_Doping(double *charge, double x, int ix);
 
-void PrintFieldData_Doping(double* U_vals, FILE *phifile, FILE *Efile);
+void PrintFieldData_Doping(double *charge, FILE *phifile, FILE *Efile);
 
 double Int_E_Doping(double *U, int i);
 
@@ -0,0 +1,262 @@
+/* This is the source file which contains the quadrature sums used by the Direct collision engine
+ * when FloatWeights = True.  They compute the same sums as ComputeQ_Direct, ComputeQ_FandL_Direct &
+ * ComputeQLinear_Direct, but read the convolution weights from tables stored as 32-bit floats.  Each
+ * weight is converted to double as it is read and the sums are still accumulated in double, so only
+ * the rounding of the weights themselves (a relative error of about 6e-8) changes the results.
+ *
+ * With CompareFloatWeights = True the tables of double weights are also kept, and every call is
+ * repeated with them.  The moments of Q (mass, momentum & energy, i.e. C qHat, before the
+ * conservation routines remove them) are then found for both, and the largest values over the run
+ * are printed side by side when the tables are freed, so that the moment drift caused by the float
+ * weights can be compared with that of the double weights.
+ *
+ * Functions included: InitFloatWeights, FreeFloatWeights, ComputeQ_FloatWeights,
+ * ComputeQ_FandL_FloatWeights, ComputeQLinear_FloatWeights
+ *
+ */
+
+#include "FloatWeightCollision.h"																	// FloatWeightCollision.h is where the prototypes for the functions contained in this file are declared
+
+static float **conv_weights_float, **conv_weights_linear_float;										// declare pointers to the rows of the tables of gHat3 & gHat3_linear weights stored as floats
+static double **conv_weights_double, **conv_weights_linear_double;									// declare pointers to the rows of the tables of double weights (only used with CompareFloatWeights)
+static fftw_complex *qHat_double, *qHat_linear_double;												// declare pointers to qHat_double & qHat_linear_double (the results with the double weights, only used with CompareFloatWeights)
+static double moment_drift[3][5];																	// declare moment_drift (the largest |C qHat| found with the double weights, the float weights & their difference, for mass, the 3 components of momentum & energy)
+static double qHat_difference;																		// declare qHat_difference (the largest value of max |qHat_float - qHat_double|/max |qHat_double|)
+static int compare_calls;																			// declare compare_calls (the number of calls which were compared)
+
+void InitFloatWeights(int gamma)																	// Function to build the tables of weights stored as floats (and keep the double tables if CompareFloatWeights is true)
+{
+	conv_weights_float = GetFloatWeightTable(WEIGHTS_LANDAU, gamma);
+	if(FullandLinear)
+	{
+		conv_weights_linear_float = GetFloatWeightTable(WEIGHTS_LINEAR, gamma);
+	}
+
+	if(CompareFloatWeights)
+	{
+		conv_weights_double = GetWeightTable(WEIGHTS_LANDAU, gamma);
+		qHat_double = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		if(FullandLinear)
+		{
+			conv_weights_linear_double = GetWeightTable(WEIGHTS_LINEAR, gamma);
+			qHat_linear_double = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		}
+		memset(moment_drift, 0, sizeof(moment_drift));
+		qHat_difference = 0.;
+		compare_calls = 0;
+	}
+}
+
+void FreeFloatWeights()																				// Function to print the comparison with the double weights (if CompareFloatWeights is true) and delete its buffers (the tables themselves are deleted by FreeWeightTables)
+{
+	double drift[3][5], difference;
+	int calls, i;
+	const char *moment_names[5] = {"mass", "momentum_1", "momentum_2", "momentum_3", "energy"};
+
+	if(! CompareFloatWeights)
+	{
+		return;
+	}
+
+	MPI_Reduce(moment_drift, drift, 15, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);					// find the largest values over all of the processes
+	MPI_Reduce(&qHat_difference, &difference, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+	MPI_Reduce(&compare_calls, &calls, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+	if(myrank_mpi==0)
+	{
+		printf("\nFloat weights compared with double weights over %d calls of the collision operator\n", calls);
+		printf("(largest moments of Q before conservation, i.e. the rate of drift of each moment):\n");
+		printf("%12s %16s %16s %16s\n", "moment", "double weights", "float weights", "difference");
+		for(i=0;i<(MassConsOnly ? 1 : 5);i++)
+		{
+			printf("%12s %16.6e %16.6e %16.6e\n", moment_names[i], drift[0][i], drift[1][i], drift[2][i]);
+		}
+		printf("max |qHat_float - qHat_double|/max |qHat_double| = %g\n\n", difference);
+	}
+
+	fftw_free(qHat_double);
+	if(FullandLinear)
+	{
+		fftw_free(qHat_linear_double);
+	}
+}
+
+static void MomentsOfQ(fftw_complex *qHat, double *moments)											// Function to find C qHat (the rates of change of mass, momentum & energy caused by Q), as in the conservation routines
+{
+	double tmp0=0., tmp1=0., tmp2=0., tmp3=0., tmp4=0.;
+	int k_eta;
+
+	if(MassConsOnly)
+	{
+		#pragma omp parallel for private(k_eta) reduction(+:tmp0)
+		for(k_eta=0;k_eta<size_ft;k_eta++)
+		{
+			tmp0 += qHat[k_eta][0]*C1_1[k_eta];
+		}
+	}
+	else
+	{
+		#pragma omp parallel for private(k_eta) reduction(+:tmp0,tmp1,tmp2,tmp3,tmp4)
+		for(k_eta=0;k_eta<size_ft;k_eta++)
+		{
+			tmp0 += qHat[k_eta][0]*C1_5[0][k_eta];
+			tmp1 += qHat[k_eta][1]*C2[1][k_eta];
+			tmp2 += qHat[k_eta][1]*C2[2][k_eta];
+			tmp3 += qHat[k_eta][1]*C2[3][k_eta];
+			tmp4 += qHat[k_eta][0]*C1_5[4][k_eta];
+		}
+	}
+	moments[0] = tmp0; moments[1] = tmp1; moments[2] = tmp2; moments[3] = tmp3; moments[4] = tmp4;
+}
+
+static void CompareWithDouble(fftw_complex *qHat, fftw_complex *qHat_ref)							// Function to add the moments of qHat (from the float weights) & qHat_ref (from the double weights) to the largest values found so far
+{
+	double m_float[5], m_double[5];
+	int i;
+
+	MomentsOfQ(qHat, m_float);
+	MomentsOfQ(qHat_ref, m_double);
+	for(i=0;i<5;i++)
+	{
+		moment_drift[0][i] = fmax(moment_drift[0][i], fabs(m_double[i]));
+		moment_drift[1][i] = fmax(moment_drift[1][i], fabs(m_float[i]));
+		moment_drift[2][i] = fmax(moment_drift[2][i], fabs(m_float[i] - m_double[i]));
+	}
+
+	qHat_difference = fmax(qHat_difference, RelativeMaxDiff(qHat, qHat_ref, size_ft));
+	compare_calls++;
+}
+
+static void FloatConvolution(fftw_complex *gHat, fftw_complex *fHat, fftw_complex *qHat)			// Function to calculate qHat(ki) = sum over w of gHat3(ki,w)*gHat(w)*fHat(ki-w) (with the same quadrature as ComputeQ), reading the weights stored as floats
+{
+	int ki, i, j, k, l, m, n, x, y, z, kw, kz;
+	int t, ki_end, threads = ModeThreads();
+	int start_i, start_j, start_k, end_i, end_j, end_k;
+	double tempD, tmp0, tmp1;
+	double prefactor = h_eta*h_eta*h_eta;
+	const float *W;
+
+	#pragma omp parallel for schedule(static,1) num_threads(threads) private(t,ki_end,ki,i,j,k,l,m,n,x,y,z,kw,kz,start_i,start_j,start_k,end_i,end_j,end_k,tempD,tmp0,tmp1,W) shared(qHat, gHat, fHat)
+	for(t=0;t<threads;t++)																			// give each thread one range of modes of about the same cost (see ModeSchedule.cpp)
+	{
+		for(ki=ModeStart(t, threads), ki_end=ModeStart(t+1, threads);ki<ki_end;ki++)
+		{
+			i = ki/(N*N); j = (ki/N)%N; k = ki%N;
+			W = conv_weights_float[ki];
+
+			ConvolutionWindow(i, &start_i, &end_i);
+			ConvolutionWindow(j, &start_j, &end_j);
+			ConvolutionWindow(k, &start_k, &end_k);
+
+			tmp0=0.; tmp1=0.;
+			for(l=start_i;l<end_i;l++)
+			{
+				x = i + N/2 - l;																	// eta[x] = ki[i] - eta[l]
+				for(m=start_j;m<end_j;m++)
+				{
+					y = j + N/2 - m;
+					for(n=start_k;n<end_k;n++)
+					{
+						z = k + N/2 - n;
+						kw = n + N*(m + N*l);
+						kz = z + N*(y + N*x);
+
+						tempD = (double)W[kw];														// the weight is rounded to float, but the sum is accumulated in double
+						tmp0 += prefactor*wtN[l]*wtN[m]*wtN[n]*tempD*(gHat[kw][0]*fHat[kz][0] - gHat[kw][1]*fHat[kz][1]);
+						tmp1 += prefactor*wtN[l]*wtN[m]*wtN[n]*tempD*(gHat[kw][0]*fHat[kz][1] + gHat[kw][1]*fHat[kz][0]);
+					}
+				}
+			}
+			qHat[ki][0] = tmp0;
+			qHat[ki][1] = tmp1;
+		}
+	}
+}
+
+void ComputeQ_FloatWeights(double *f, fftw_complex *qHat)											// Function to calculate the Fourier transform of Q(f,f), as in ComputeQ, with the weights stored as floats
+{
+	fft3D(f, fftOut);																			// perform the FFT of f and store the result in fftOut
+
+	FloatConvolution(fftOut, fftOut, qHat);
+
+	if(CompareFloatWeights)
+	{
+		ComputeQ_Direct(f, qHat_double, conv_weights_double);
+		CompareWithDouble(qHat, qHat_double);
+	}
+}
+
+void ComputeQ_FandL_FloatWeights(double *f, fftw_complex *qHat, fftw_complex *qHat_linear)			// Function to calculate the Fourier transforms of the full & linear parts of Q, as in ComputeQ_FandL, with the weights stored as floats
+{
+	int ki, i, j, k, l, m, n, x, y, z, kw, kz;
+	int t, ki_end, threads = ModeThreads();
+	int start_i, start_j, start_k, end_i, end_j, end_k;
+	double tempD, tempD1, tmp0, tmp1, tmp01, tmp11;
+	double prefactor = h_eta*h_eta*h_eta;
+	const float *W, *W1;
+
+	fft3D(f, fftOut);																			// perform the FFT of f and store the result in fftOut
+
+	#pragma omp parallel for schedule(static,1) num_threads(threads) private(t,ki_end,ki,i,j,k,l,m,n,x,y,z,kw,kz,start_i,start_j,start_k,end_i,end_j,end_k,tempD,tempD1,tmp0,tmp1,tmp01,tmp11,W,W1) shared(qHat, qHat_linear, fftOut)
+	for(t=0;t<threads;t++)																			// give each thread one range of modes of about the same cost (see ModeSchedule.cpp)
+	{
+		for(ki=ModeStart(t, threads), ki_end=ModeStart(t+1, threads);ki<ki_end;ki++)
+		{
+			i = ki/(N*N); j = (ki/N)%N; k = ki%N;
+			W = conv_weights_float[ki];
+			W1 = conv_weights_linear_float[ki];
+
+			ConvolutionWindow(i, &start_i, &end_i);
+			ConvolutionWindow(j, &start_j, &end_j);
+			ConvolutionWindow(k, &start_k, &end_k);
+
+			tmp0=0.; tmp1=0.; tmp01=0.; tmp11=0.;
+			for(l=start_i;l<end_i;l++)
+			{
+				x = i + N/2 - l;
+				for(m=start_j;m<end_j;m++)
+				{
+					y = j + N/2 - m;
+					for(n=start_k;n<end_k;n++)
+					{
+						z = k + N/2 - n;
+						kw = n + N*(m + N*l);
+						kz = z + N*(y + N*x);
+
+						tempD = (double)W[kw];
+						tempD1 = (double)W1[kw];
+						tmp0 += prefactor*wtN[l]*wtN[m]*wtN[n]*(tempD*(fftOut[kw][0]*fftOut[kz][0] - fftOut[kw][1]*fftOut[kz][1]) + scale3*tempD1*fftOut[kz][0]);
+						tmp1 += prefactor*wtN[l]*wtN[m]*wtN[n]*(tempD*(fftOut[kw][0]*fftOut[kz][1] + fftOut[kw][1]*fftOut[kz][0]) + scale3*tempD1*fftOut[kz][1]);
+
+						tmp01 += prefactor*wtN[l]*wtN[m]*wtN[n]*scale3*tempD1*fftOut[kz][0];
+						tmp11 += prefactor*wtN[l]*wtN[m]*wtN[n]*scale3*tempD1*fftOut[kz][1];
+					}
+				}
+			}
+			qHat[ki][0] = tmp0;
+			qHat[ki][1] = tmp1;
+			qHat_linear[ki][0] = tmp01;
+			qHat_linear[ki][1] = tmp11;
+		}
+	}
+
+
+	if(CompareFloatWeights)
+	{
+		ComputeQ_FandL_Direct(f, qHat_double, conv_weights_double, qHat_linear_double, conv_weights_linear_double);
+		CompareWithDouble(qHat, qHat_double);
+		CompareWithDouble(qHat_linear, qHat_linear_double);
+	}
+}
+
+void ComputeQLinear_FloatWeights(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat)		// Function to calculate the Fourier transform of Q(f,M), as in ComputeQLinear, with the weights stored as floats
+{
+	fft3D(f, fftOut);																			// perform the FFT of f and store the result in fftOut
+
+	FloatConvolution(Maxwell_fftOut, fftOut, qHat);
+
+	if(CompareFloatWeights)
+	{
+		ComputeQLinear_Direct(f, Maxwell_fftOut, qHat_double, conv_weights_double);
+		CompareWithDouble(qHat, qHat_double);
+	}
+}
@@ -0,0 +1,37 @@
+/* This is the header file associated to FloatWeightCollision.cpp in which the prototypes for the
+ * functions contained in that file are declared.  Any other header files which must be linked to
+ * for the functions here are also included.
+ *
+ */
+
+//************************//
+//     INCLUDE GUARDS     //
+//************************//
+
+#ifndef FLOATWEIGHTCOLLISION_H_
+#define FLOATWEIGHTCOLLISION_H_
+
+//************************//
+//        INCLUDES        //
+//************************//
+
+#include "LP_ompi.h"																				// allows the libraries included, macros defined and external variables declared in LP_ompi.h to be used in the FloatWeightCollision functions
+#include "collisionRoutines_1.h"																	// allows fft3D & the Direct ComputeQ routines to be used in the FloatWeightCollision functions
+#include "WeightStore.h"																			// allows the WEIGHTS_ kernel variants to be used
+#include "WeightTables.h"																			// allows GetWeightTable & GetFloatWeightTable to be used
+
+//************************//
+//   FUNCTION PROTOTYPES  //
+//************************//
+
+void InitFloatWeights(int gamma);
+
+void FreeFloatWeights();
+
+void ComputeQ_FloatWeights(double *f, fftw_complex *qHat);
+
+void ComputeQ_FandL_FloatWeights(double *f, fftw_complex *qHat, fftw_complex *qHat_linear);
+
+void ComputeQLinear_FloatWeights(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat);
+
+#endif /* FLOATWEIGHTCOLLISION_H_ */
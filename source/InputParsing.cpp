@@ -1,574 +1,975 @@
-/* This is the source file which contains the subroutines necessary for reading and checking
- * the input data.
- *
- * Functions included: 	ReadICOptions, CheckICOptions, ReadICName, ReadFirstOrSecond,
- * CheckFirstOrSecond, ReadFullandLinear & PrintError.
- *
- *  Created on: Dec 18, 2018
- */
-
-#include "InputParsing.h"																		// InputParsing.h is where the prototypes for the functions contained in this file are declared
-
-void ReadICOptions(GRVY_Input_Class& iparse)													// Function to read the Boolean options for the initital conditions from the input file
-{
-	// Print a header for the Boolean options from the processor with rank 0:
-	if(myrank_mpi==0)																			// only the process with rank 0 will do this
-	{
-		std::cout << "#=====================================================#" << std::endl;
-		std::cout << "#   BOOLEAN OPTIONS TO CHOOSE CURRENT RUN BEHAVIOUR   #" << std::endl;
-		std::cout << "#=====================================================#" << std::endl << std::endl;
-	}
-	
-	// Check if each of the IC options have been set and print their values from the 
-	// processor with rank 0 (if not, set default value to false):
-	if( iparse.Read_Var("Damping",&Damping,false) )													
-	{
-		if(myrank_mpi==0)
-		{
-			std::cout << "--> Damping = " << Damping << std::endl;
-		}
-	}
-	if( iparse.Read_Var("TwoStream",&TwoStream,false) )
-	{
-		if(myrank_mpi==0)
-		{
-			std::cout << "--> TwoStream = " << TwoStream << std::endl;
-		}
-	}
-	if( iparse.Read_Var("FourHump",&FourHump,false) )
-	{
-		if(myrank_mpi==0)
-		{
-			std::cout << "--> FourHump = " << FourHump << std::endl;
-		}
-	}
-	if( iparse.Read_Var("TwoHump",&TwoHump,false) )
-	{
-		if(myrank_mpi==0)
-		{
-			std::cout << "--> TwoHump = " << TwoHump << std::endl;
-		}
-	}
-	if( iparse.Read_Var("Doping",&Doping,false) )
-	{
-		if(myrank_mpi==0)
-		{
-			std::cout << "--> Doping = " << Doping << std::endl;
-		}
-	}
-}
-
-void CheckICOptions(std::string& IC_flag)															// Function to verify the IC options were set correctly
-{
-	// declare IC_count to count how many ICs have been set
-	int IC_count = 0;																				
-
-	// For each IC option, add one to the IC count if it's true and set IC_flag to
-	// the relevant location
-	if(Damping)
-	{
-		IC_count++;
-		IC_flag.assign("Damping/IC_name");
-	}
-	if(TwoStream)
-	{
-		IC_count++;
-		IC_flag.assign("TwoStream/IC_name");
-	}
-	if(FourHump)
-	{
-		IC_count++;
-		IC_flag.assign("FourHump/IC_name");
-	}
-	if(TwoHump)
-	{
-		IC_count++;
-		IC_flag.assign("TwoHump/IC_name");
-	}
-	if(Doping)
-	{
-		IC_count++;
-		IC_flag.assign("Doping/IC_name");
-	}
-	
-	// Exit the program if no IC option has been chosen and print a messgage from the
-	// processor with rank 0
-	if(IC_count == 0)
-	{
-		if(myrank_mpi==0)
-		{
-			std::cout << "Program cannot run... No initial condition has been chosen. \n"
-					"Please set one of Damping, TwoStream, FourHump or TwoHump to true "
-					"in LPsolver-input.txt." << std::endl;
-		}
-		exit(1);
-	}
-	// Exit the program if too many IC options are chosen and print a messgage from the
-	// processor with rank 0
-	if(IC_count > 1)
-	{
-		if(myrank_mpi==0)
-		{
-			std::cout << "Program cannot run..." << IC_count << "initial conditions have been chosen." 
-						<< std::endl;
-			std::cout << "Please ONLY set ONE of Damping, TwoStream, FourHump or TwoHump to true "
-							"in LPsolver-input.txt." << std::endl;
-		}
-		exit(1);
-	}
-}
-
-void ReadICName(GRVY_Input_Class& iparse, std::string IC_flag, std::string& IC_name)			// Function to read the name of the initital conditions being used from the input file
-{
-	// Try to read the name of the initial conditions being used for this run
-	// (if not available, print a general statement from the process with rank 0)
-	if( iparse.Read_Var(IC_flag.c_str(),&IC_name))
-	{
-		if(myrank_mpi==0)
-		{
-			std::cout << std::endl << "Using the " << IC_name
-					<< " initial conditions for this run." << std::endl << std::endl;
-		}
-	}
-	else
-	{
-		if(myrank_mpi==0)
-		{
-			std::cout << std::endl << "The above initial condition which is set equal to 1 "
-					"is being used for this run." << std::endl << std::endl;
-		}
-	}
-}
-
-void ReadFirstOrSecond(GRVY_Input_Class& iparse)												// Function to read the Boolean options to decide if this is the first run or not
-{
-	// Check if each of First or Second have been set and print their values from the
-	// processor with rank 0 (if not, set default value to false)
-	if( iparse.Read_Var("First",&First,false) )
-	{
-		if(myrank_mpi==0)
-		{
-			std::cout << "--> First = " << First << std::endl;
-		}
-	}
-	if( iparse.Read_Var("Second",&Second,false) )
-	{
-		if(myrank_mpi==0)
-		{
-			std::cout << "--> Second = " << Second << std::endl << std::endl;
-		}
-	}
-}
-
-void CheckFirstOrSecond()																		// Function to verify the First or Second options were set correctly
-{
-	// declare run_count to check if first or second has been set
-	int run_count = 0;
-
-	// For each option First or Second, add one to run_count if it's true and print that
-	// it's true from the processor with rank 0
-	if(First)
-	{
-		run_count++;
-		if(myrank_mpi==0)
-		{
-			std::cout << "Running for the first time with the above initial conditions."
-						<< std::endl << std::endl;
-		}
-	}
-	if(Second)
-	{
-		run_count++;
-		if(myrank_mpi==0)
-		{
-			std::cout << "Code is picking up from a previous run which should have the above "
-					"initial conditions." << std::endl << std::endl;
-		}
-	}
-	// Exit the program more or less than one of these options were set
-	if(run_count != 1)
-	{
-		if(myrank_mpi==0)
-		{
-			std::cout << "Program cannot run... Need to choose if this is a first run or a subsequent one."
-						<< std::endl;
-			std::cout << "Please set ONE of First or Second to true in LPsolver-input.txt to decide "
-						"if this is the first run or picking up from a previous run." << std::endl;
-		}
-		exit(1);
-	}
-}
-
-void ReadGamma(GRVY_Input_Class& iparse, int& gamma)												// Function to read the Boolean options to decide if this is the first run or not
-{
-	// Check if the value of gamma has been set and print its value from the
-	// processor with rank 0 (if not, set default value to -3)
-	if( iparse.Read_Var("gamma",&gamma,-3) )
-	{
-		std::cout << "--> gamma = " << gamma << std::endl << std::endl;
-		if(gamma==-3)
-		{
-			if(myrank_mpi==0)
-			{
-				std::cout << "Running with 'True Landau' collisions." << std::endl << std::endl;
-			}
-		}
-		else if(gamma==0)
-		{
-			if(myrank_mpi==0)
-			{
-				std::cout << "Running with Maxwell Molecule collisions." << std::endl << std::endl;
-			}
-		}
-		else if(gamma==1)
-		{
-			if(myrank_mpi==0)
-			{
-				std::cout << "Running with Hard Sphere collisions." << std::endl << std::endl;
-			}
-		}
-		else
-		{
-			if(myrank_mpi==0)
-			{
-				std::cout << "Program cannot run... Please choose a different value for gamma." << std::endl;
-				std::cout << "Currently the code can only use gamma = -3 (True Landau), 0 (Maxwell Molecules) or 1 (Hard Spheres)" << std::endl;
-			}
-			exit(1);
-		}
-	}
-}
-
-void ReadFullandLinear(GRVY_Input_Class& iparse)												// Function to read the Boolean option to decide if running with single species collisions or mixed
-{
-	// Check if FullandLinear has been set and print its value from the 
-	// processor with rank 0 (if not, set default value to false):
-	if( iparse.Read_Var("FullandLinear",&FullandLinear,false) )
-	{
-		if(myrank_mpi==0)
-		{
-			std::cout << "--> FullandLinear = " << FullandLinear << std::endl << std::endl;
-			if(FullandLinear)
-			{
-				std::cout << "Running with both regular collisions and mixed collisions."
-					<< std::endl << std::endl;
-			}
-			else
-			{
-				std::cout << "Running with regular single-species collisions." << std::endl << std::endl;
-			}
-		}
-	}
-}
-
-void ReadHomogeneous(GRVY_Input_Class& iparse)												// Function to read the Boolean option to decide if running with single species collisions or mixed
-{
-	// Check if Homogeneous has been set and print its value from the
-	// processor with rank 0 (if not, set default value to false):
-	if( iparse.Read_Var("Homogeneous",&Homogeneous,false) )
-	{
-		if(myrank_mpi==0)
-		{
-			std::cout << "--> Homogeneous = " << Homogeneous << std::endl << std::endl;
-			if(Homogeneous)
-			{
-				std::cout << "Running the code in the space homogeneous setting."
-					<< std::endl << std::endl;
-			}
-			else
-			{
-				std::cout << "Running the code in the full space inhomogeneous setting." << std::endl << std::endl;
-			}
-		}
-	}
-}
-
-void ReadLinearLandau(GRVY_Input_Class& iparse)												// Function to read the Boolean option to decide if running with single species collisions or mixed
-{
-	// Check if FullandLinear has been set and print its value from the
-	// processor with rank 0 (if not, set default value to false):
-	if( iparse.Read_Var("LinearLandau",&LinearLandau,false) )
-	{
-		if(myrank_mpi==0)
-		{
-			std::cout << "--> LinearLandau = " << LinearLandau << std::endl << std::endl;
-			if(LinearLandau)
-			{
-				std::cout << "Collisions are being modeled by the linear Landau operator (particles collide with those with a Maxwellian density)."
-					<< std::endl << std::endl;
-			}
-			else
-			{
-				std::cout << "Running with the full Landau collision operator." << std::endl << std::endl;
-			}
-		}
-	}
-}
-
-void ReadMassConsOnly(GRVY_Input_Class& iparse)												// Function to read the Boolean option to decide if running with single species collisions or mixed
-{
-	// Check if FullandLinear has been set and print its value from the
-	// processor with rank 0 (if not, set default value to false):
-	if( iparse.Read_Var("MassConsOnly",&MassConsOnly,false) )
-	{
-		if(myrank_mpi==0)
-		{
-			std::cout << "--> MassConsOnly = " << MassConsOnly << std::endl << std::endl;
-			if(MassConsOnly)
-			{
-				std::cout << "Only mass is being conserved."
-					<< std::endl << std::endl;
-			}
-			else
-			{
-				std::cout << "All of mass, momentum and energy are being conserved." << std::endl << std::endl;
-			}
-		}
-	}
-}
-
-
-void ReadInputParameters(GRVY_Input_Class& iparse, std::string& flag, int& nT, 
-							int& Nx, int& Nv, int& N, double& nu, double& dt, double& A_amp, 
-							double& k_wave, double& Lv, double& Lx)								// Function to read all input parameters (IC_flag, nT,  Nx, Nv, N, nu, dt, A_amp, k_wave, L_v & L_x)
-{
-	// Print a header for the input parameters from the processor with rank 0:
-	if(myrank_mpi==0)
-	{
-		std::cout << "#=====================================================#" << std::endl;
-		std::cout << "#           INPUT PARAMETERS FOR CURRENT RUN          #" << std::endl;
-		std::cout << "#=====================================================#" << std::endl << std::endl;
-	}
-	
-	// Check if the variable flag has been set and print it from the processor with rank 0
-	// (if not, exit)
-	if(! iparse.Read_Var("flag",&flag))
-	{
-		if(myrank_mpi==0)
-		{
-			std::cout << "Program cannot run..." << std::endl;
-			std::cout << "Please set the name of 'flag' in the input file." << std::endl;
-		}
-		exit(1);
-	}
-	if(myrank_mpi==0)
-	{
-		std::cout << "--> Flag associated to this run: " << flag << std::endl << std::endl;
-	}
-
-	// Try to read all input parameters to be used for this run and print them from the
-	// processor with rank 0 (exit if not available)
-	if (! iparse.Read_Var("nT",&nT) )
-	{
-		PrintError("nT");
-		exit(1);
-	}
-	if(myrank_mpi==0)
-	{
-		printf("--> %-11s = %d\n","nT",nT);
-	}
-	if (! iparse.Read_Var("Nx",&Nx) )
-	{
-		PrintError("Nx");
-		exit(1);
-	}
-	if(myrank_mpi==0)
-	{
-		printf("--> %-11s = %d\n","Nx",Nx);
-	}
-	if (! iparse.Read_Var("Nv",&Nv) )
-	{
-		PrintError("Nv");
-		exit(1);
-	}
-	if(myrank_mpi==0)
-	{
-		printf("--> %-11s = %d\n","Nv",Nv);
-	}
-	if (! iparse.Read_Var("N",&N) )
-	{
-		PrintError("N");
-		exit(1);
-	}
-	if(myrank_mpi==0)
-	{
-		printf("--> %-11s = %d\n","N",N);
-	}
-	if (! iparse.Read_Var("nu",&nu) )
-	{
-		PrintError("nu");
-		exit(1);
-	}
-	if(myrank_mpi==0)
-	{
-		printf("--> %-11s = %g\n","nu",nu);
-	}
-	if (! iparse.Read_Var("dt",&dt) )
-	{
-		PrintError("dt");
-		exit(1);
-	}
-	if(myrank_mpi==0)
-	{
-		printf("--> %-11s = %g\n","dt",dt);
-	}
-
-	// Try to read all input parameters associated to the Damping option 
-	// (some have default values but others will exit if not available)
-	
-	grvy_log_setlevel(GRVY_NOLOG);
-	
-	if(Damping)
-	{
-		if (! iparse.Read_Var("Damping/A_amp",&A_amp) )
-		{
-			PrintError("Damping/A_amp");
-			exit(1);
-		}
-		if (! iparse.Read_Var("Damping/k_wave",&k_wave) )
-		{
-			PrintError("Damping/k_wave");
-			exit(1);
-		}
-		if (! iparse.Read_Var("Damping/Lv",&Lv) )
-		{
-			PrintError("Damping/Lv");
-			exit(1);
-		}
-		iparse.Read_Var("Damping/Lx",&Lx,2*PI/k_wave);
-	}
-
-	// Try to read all input parameters associated to the TwoStream option 
-	// (some have default values but others will exit if not available)
-	if(TwoStream)
-	{
-		if (! iparse.Read_Var("TwoStream/A_amp",&A_amp) )
-		{
-			PrintError("TwoStream/A_amp");
-			exit(1);
-		}
-		if (! iparse.Read_Var("TwoStream/Lv",&Lv) )
-		{
-			PrintError("TwoStream/Lv");
-			exit(1);
-		}
-		iparse.Read_Var("TwoStream/Lx",&Lx,2*PI/k_wave);
-		k_wave=2*PI/4.;
-	}
-
-	// Try to read all input parameters associated to the FourHump option 
-	// (some have default values but others will exit if not available)
-	if(FourHump)
-	{
-		iparse.Read_Var("FourHump/A_amp",&A_amp,0.);
-		iparse.Read_Var("FourHump/k_wave",&k_wave,0.5);
-		if (! iparse.Read_Var("FourHump/Lv",&Lv) )
-		{
-			PrintError("FourHump/Lv");
-			exit(1);
-		}
-		iparse.Read_Var("FourHump/Lx",&Lx,2*PI/k_wave);
-	}
-
-	// Try to read all input parameters associated to the TwoHump option 
-	// (some have default values but others will exit if not available)
-	if(TwoHump)
-	{
-		iparse.Read_Var("TwoHump/A_amp",&A_amp,0.);
-		iparse.Read_Var("TwoHump/k_wave",&k_wave,0.5);
-		if (! iparse.Read_Var("TwoHump/Lv",&Lv) )
-		{
-			PrintError("TwoHump/Lv");
-			exit(1);
-		}
-		iparse.Read_Var("TwoHump/Lx",&Lx,2*PI/k_wave);
-	}
-
-	if(Doping)
-	{
-		iparse.Read_Var("Doping/A_amp",&A_amp,0.);
-		iparse.Read_Var("Doping/k_wave",&k_wave,0.5);
-		if (! iparse.Read_Var("Doping/Lv",&Lv) )
-		{
-			PrintError("Doping/Lv");
-			exit(1);
-		}
-		iparse.Read_Var("Doping/Lx",&Lx,2*PI/k_wave);
-	}
-
-	grvy_log_setlevel(GRVY_INFO);
-
-	// Print the values of the parameters read from the specific options from the processor
-	// with rank 0
-	if(myrank_mpi==0)
-	{
-		printf("--> %-11s = %g\n","A_amp",A_amp);
-		printf("--> %-11s = %g\n","k_wave",k_wave);
-		printf("--> %-11s = %g\n","Lv",Lv);
-		printf("--> %-11s = %g\n\n","Lx",Lx);
-	}
-}
-
-void ReadDopingParameters(GRVY_Input_Class& iparse, double& NL, double& NH,
-							double& T_L, double& T_R, double& eps)								// Function to read all parameters for a non-uniform doping profile (NL, NH, T_L, T_R, eps)
-{
-	if(myrank_mpi==0)
-	{
-		std::cout << "Code is running with a non-uniform background density..." << std::endl;
-		std::cout << "Parameters associated to this non-uniform doping profile:" << std::endl << std::endl;
-	}
-
-	// Try to read all doping parameters to be used for this run and print them from the
-	// processor with rank 0 (exit if not available)
-	if (! iparse.Read_Var("Doping/NL",&NL) )
-	{
-		PrintError("Doping/NL");
-		exit(1);
-	}
-	if(myrank_mpi==0)
-	{
-		printf("--> %-11s = %g\n","NL",NL);
-	}
-	if (! iparse.Read_Var("Doping/NH",&NH) )
-	{
-		PrintError("Doping/NH");
-		exit(1);
-	}
-	if(myrank_mpi==0)
-	{
-		printf("--> %-11s = %g\n","NH",NH);
-	}
-	if (! iparse.Read_Var("Doping/eps",&eps) )
-	{
-		PrintError("Doping/eps");
-		exit(1);
-	}
-	if(myrank_mpi==0)
-	{
-		printf("--> %-11s = %g\n","eps",eps);
-	}
-	if( iparse.Read_Var("Doping/T_L",&T_L,0.4) )
-	{
-		if(myrank_mpi==0)
-		{
-			printf("--> %-11s = %g\n","T_L",T_L);
-		}
-	}
-	if( iparse.Read_Var("Doping/T_R",&T_R,0.4) )
-	{
-		if(myrank_mpi==0)
-		{
-			printf("--> %-11s = %g\n","T_R",T_R);
-		}
-	}
-}
-
-void PrintError(std::string var_name)
-{
-	if(myrank_mpi==0)
-	{
-		std::cout << "Program cannot run..." << std::endl;
-		std::cout << "Please set the value of '" << var_name << "' in the input file." << std::endl;
-	}
-}
-
+/* This is the source file which contains the subroutines necessary for reading and checking
+ * the input data.
+ *
+ * Functions included: 	ReadICOptions, CheckICOptions, ReadICName, ReadFirstOrSecond,
+ * CheckFirstOrSecond, ReadFullandLinear, ReadCollisionEngine, ReadWeightStoreOptions, ReadFFTWOptions
+ * & PrintError.
+ *
+ *  Created on: Dec 18, 2018
+ */
+
+#include "InputParsing.h"																		// InputParsing.h is where the prototypes for the functions contained in this file are declared
+
+void ReadICOptions(GRVY_Input_Class& iparse)													// Function to read the Boolean options for the initital conditions from the input file
+{
+	// Print a header for the Boolean options from the processor with rank 0:
+	if(myrank_mpi==0)																			// only the process with rank 0 will do this
+	{
+		std::cout << "#=====================================================#" << std::endl;
+		std::cout << "#   BOOLEAN OPTIONS TO CHOOSE CURRENT RUN BEHAVIOUR   #" << std::endl;
+		std::cout << "#=====================================================#" << std::endl << std::endl;
+	}
+	
+	// Check if each of the IC options have been set and print their values from the 
+	// processor with rank 0 (if not, set default value to false):
+	if( iparse.Read_Var("Damping",&Damping,false) )													
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "--> Damping = " << Damping << std::endl;
+		}
+	}
+	if( iparse.Read_Var("TwoStream",&TwoStream,false) )
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "--> TwoStream = " << TwoStream << std::endl;
+		}
+	}
+	if( iparse.Read_Var("FourHump",&FourHump,false) )
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "--> FourHump = " << FourHump << std::endl;
+		}
+	}
+	if( iparse.Read_Var("TwoHump",&TwoHump,false) )
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "--> TwoHump = " << TwoHump << std::endl;
+		}
+	}
+	if( iparse.Read_Var("Doping",&Doping,false) )
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "--> Doping = " << Doping << std::endl;
+		}
+	}
+}
+
+void CheckICOptions(std::string& IC_flag)															// Function to verify the IC options were set correctly
+{
+	// declare IC_count to count how many ICs have been set
+	int IC_count = 0;																				
+
+	// For each IC option, add one to the IC count if it's true and set IC_flag to
+	// the relevant location
+	if(Damping)
+	{
+		IC_count++;
+		IC_flag.assign("Damping/IC_name");
+	}
+	if(TwoStream)
+	{
+		IC_count++;
+		IC_flag.assign("TwoStream/IC_name");
+	}
+	if(FourHump)
+	{
+		IC_count++;
+		IC_flag.assign("FourHump/IC_name");
+	}
+	if(TwoHump)
+	{
+		IC_count++;
+		IC_flag.assign("TwoHump/IC_name");
+	}
+	if(Doping)
+	{
+		IC_count++;
+		IC_flag.assign("Doping/IC_name");
+	}
+	
+	// Exit the program if no IC option has been chosen and print a messgage from the
+	// processor with rank 0
+	if(IC_count == 0)
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "Program cannot run... No initial condition has been chosen. \n"
+					"Please set one of Damping, TwoStream, FourHump or TwoHump to true "
+					"in LPsolver-input.txt." << std::endl;
+		}
+		exit(1);
+	}
+	// Exit the program if too many IC options are chosen and print a messgage from the
+	// processor with rank 0
+	if(IC_count > 1)
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "Program cannot run..." << IC_count << "initial conditions have been chosen." 
+						<< std::endl;
+			std::cout << "Please ONLY set ONE of Damping, TwoStream, FourHump or TwoHump to true "
+							"in LPsolver-input.txt." << std::endl;
+		}
+		exit(1);
+	}
+}
+
+void ReadICName(GRVY_Input_Class& iparse, std::string IC_flag, std::string& IC_name)			// Function to read the name of the initital conditions being used from the input file
+{
+	// Try to read the name of the initial conditions being used for this run
+	// (if not available, print a general statement from the process with rank 0)
+	if( iparse.Read_Var(IC_flag.c_str(),&IC_name))
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << std::endl << "Using the " << IC_name
+					<< " initial conditions for this run." << std::endl << std::endl;
+		}
+	}
+	else
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << std::endl << "The above initial condition which is set equal to 1 "
+					"is being used for this run." << std::endl << std::endl;
+		}
+	}
+}
+
+void ReadFirstOrSecond(GRVY_Input_Class& iparse)												// Function to read the Boolean options to decide if this is the first run or not
+{
+	// Check if each of First or Second have been set and print their values from the
+	// processor with rank 0 (if not, set default value to false)
+	if( iparse.Read_Var("First",&First,false) )
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "--> First = " << First << std::endl;
+		}
+	}
+	if( iparse.Read_Var("Second",&Second,false) )
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "--> Second = " << Second << std::endl << std::endl;
+		}
+	}
+}
+
+void CheckFirstOrSecond()																		// Function to verify the First or Second options were set correctly
+{
+	// declare run_count to check if first or second has been set
+	int run_count = 0;
+
+	// For each option First or Second, add one to run_count if it's true and print that
+	// it's true from the processor with rank 0
+	if(First)
+	{
+		run_count++;
+		if(myrank_mpi==0)
+		{
+			std::cout << "Running for the first time with the above initial conditions."
+						<< std::endl << std::endl;
+		}
+	}
+	if(Second)
+	{
+		run_count++;
+		if(myrank_mpi==0)
+		{
+			std::cout << "Code is picking up from a previous run which should have the above "
+					"initial conditions." << std::endl << std::endl;
+		}
+	}
+	// Exit the program more or less than one of these options were set
+	if(run_count != 1)
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "Program cannot run... Need to choose if this is a first run or a subsequent one."
+						<< std::endl;
+			std::cout << "Please set ONE of First or Second to true in LPsolver-input.txt to decide "
+						"if this is the first run or picking up from a previous run." << std::endl;
+		}
+		exit(1);
+	}
+}
+
+void ReadGamma(GRVY_Input_Class& iparse, int& gamma)												// Function to read the Boolean options to decide if this is the first run or not
+{
+	// Check if the value of gamma has been set and print its value from the
+	// processor with rank 0 (if not, set default value to -3)
+	if( iparse.Read_Var("gamma",&gamma,-3) )
+	{
+		std::cout << "--> gamma = " << gamma << std::endl << std::endl;
+		if(gamma==-3)
+		{
+			if(myrank_mpi==0)
+			{
+				std::cout << "Running with 'True Landau' collisions." << std::endl << std::endl;
+			}
+		}
+		else if(gamma==0)
+		{
+			if(myrank_mpi==0)
+			{
+				std::cout << "Running with Maxwell Molecule collisions." << std::endl << std::endl;
+			}
+		}
+		else if(gamma==1)
+		{
+			if(myrank_mpi==0)
+			{
+				std::cout << "Running with Hard Sphere collisions." << std::endl << std::endl;
+			}
+		}
+		else
+		{
+			if(myrank_mpi==0)
+			{
+				std::cout << "Program cannot run... Please choose a different value for gamma." << std::endl;
+				std::cout << "Currently the code can only use gamma = -3 (True Landau), 0 (Maxwell Molecules) or 1 (Hard Spheres)" << std::endl;
+			}
+			exit(1);
+		}
+	}
+}
+
+void ReadFullandLinear(GRVY_Input_Class& iparse)												// Function to read the Boolean option to decide if running with single species collisions or mixed
+{
+	// Check if FullandLinear has been set and print its value from the 
+	// processor with rank 0 (if not, set default value to false):
+	if( iparse.Read_Var("FullandLinear",&FullandLinear,false) )
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "--> FullandLinear = " << FullandLinear << std::endl << std::endl;
+			if(FullandLinear)
+			{
+				std::cout << "Running with both regular collisions and mixed collisions."
+					<< std::endl << std::endl;
+			}
+			else
+			{
+				std::cout << "Running with regular single-species collisions." << std::endl << std::endl;
+			}
+		}
+	}
+}
+
+void ReadHomogeneous(GRVY_Input_Class& iparse)												// Function to read the Boolean option to decide if running with single species collisions or mixed
+{
+	// Check if Homogeneous has been set and print its value from the
+	// processor with rank 0 (if not, set default value to false):
+	if( iparse.Read_Var("Homogeneous",&Homogeneous,false) )
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "--> Homogeneous = " << Homogeneous << std::endl << std::endl;
+			if(Homogeneous)
+			{
+				std::cout << "Running the code in the space homogeneous setting."
+					<< std::endl << std::endl;
+			}
+			else
+			{
+				std::cout << "Running the code in the full space inhomogeneous setting." << std::endl << std::endl;
+			}
+		}
+	}
+}
+
+void ReadLinearLandau(GRVY_Input_Class& iparse)												// Function to read the Boolean option to decide if running with single species collisions or mixed
+{
+	// Check if FullandLinear has been set and print its value from the
+	// processor with rank 0 (if not, set default value to false):
+	if( iparse.Read_Var("LinearLandau",&LinearLandau,false) )
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "--> LinearLandau = " << LinearLandau << std::endl << std::endl;
+			if(LinearLandau)
+			{
+				std::cout << "Collisions are being modeled by the linear Landau operator (particles collide with those with a Maxwellian density)."
+					<< std::endl << std::endl;
+			}
+			else
+			{
+				std::cout << "Running with the full Landau collision operator." << std::endl << std::endl;
+			}
+		}
+	}
+}
+
+void ReadMassConsOnly(GRVY_Input_Class& iparse)												// Function to read the Boolean option to decide if running with single species collisions or mixed
+{
+	// Check if FullandLinear has been set and print its value from the
+	// processor with rank 0 (if not, set default value to false):
+	if( iparse.Read_Var("MassConsOnly",&MassConsOnly,false) )
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "--> MassConsOnly = " << MassConsOnly << std::endl << std::endl;
+			if(MassConsOnly)
+			{
+				std::cout << "Only mass is being conserved."
+					<< std::endl << std::endl;
+			}
+			else
+			{
+				std::cout << "All of mass, momentum and energy are being conserved." << std::endl << std::endl;
+			}
+		}
+	}
+}
+
+
+void ReadCollisionEngine(GRVY_Input_Class& iparse)											// Function to read the option to decide how the convolution weights of the collision operator are evaluated
+{
+	std::string engine;																			// declare engine (the name of the collision engine read from the input file)
+	std::string kernel;																			// declare kernel (the name of the kernel used for the quadrature sums of the Direct engine)
+
+	// Check if CollisionEngine has been set and print its value from the
+	// processor with rank 0 (if not, set default value to Direct):
+	iparse.Read_Var("CollisionEngine",&engine,std::string("Direct"));
+	if(engine == "Direct")
+	{
+		collision_engine = ENGINE_DIRECT;
+	}
+	else if(engine == "MatrixFree")
+	{
+		collision_engine = ENGINE_MATRIXFREE;
+	}
+	else if(engine == "FFT")
+	{
+		collision_engine = ENGINE_FFT;
+	}
+	else if(engine == "LowRank")
+	{
+		collision_engine = ENGINE_LOWRANK;
+	}
+	else
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "Program cannot run... " << engine << " is not a collision engine." << std::endl;
+			std::cout << "Please set CollisionEngine to one of Direct, MatrixFree, FFT or LowRank in LPsolver-input.txt." << std::endl;
+		}
+		exit(1);
+	}
+	if(myrank_mpi==0)
+	{
+		std::cout << "--> CollisionEngine = " << engine << std::endl << std::endl;
+		if(collision_engine == ENGINE_MATRIXFREE)
+		{
+			std::cout << "The convolution weights are evaluated as they are needed (no tables of weights are stored)."
+				<< std::endl << std::endl;
+		}
+		if(collision_engine == ENGINE_FFT)
+		{
+			std::cout << "The convolutions are calculated with FFTs of the separable terms of the weights (no tables of weights are stored)."
+				<< std::endl << std::endl;
+		}
+		if(collision_engine == ENGINE_LOWRANK)
+		{
+			std::cout << "The convolution weights are replaced by a low-rank factorisation (no tables of weights are stored)."
+				<< std::endl << std::endl;
+		}
+	}
+
+	// Check if DirectKernel has been set and print its value from the processor with rank 0 (if not,
+	// set default value to Scalar; it is only used by the Direct engine):
+	iparse.Read_Var("DirectKernel",&kernel,std::string("Scalar"));
+	for(direct_kernel=KERNEL_SCALAR;direct_kernel<=KERNEL_AUTO;direct_kernel++)
+	{
+		if(kernel == DirectKernelName(direct_kernel)) break;
+	}
+	if(direct_kernel > KERNEL_AUTO)
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "Program cannot run... " << kernel << " is not a kernel for the Direct collision engine." << std::endl;
+			std::cout << "Please set DirectKernel to one of Scalar, Split, AVX2, AVX512 or Auto in LPsolver-input.txt." << std::endl;
+		}
+		exit(1);
+	}
+	if(collision_engine != ENGINE_DIRECT)
+	{
+		direct_kernel = KERNEL_SCALAR;
+	}
+	else if(direct_kernel != KERNEL_SCALAR && myrank_mpi==0)
+	{
+		std::cout << "--> DirectKernel = " << kernel << std::endl << std::endl;
+	}
+
+	// Check if FloatWeights & CompareFloatWeights have been set and print their values from the
+	// processor with rank 0 (if not, set default values to false; they are only used by the Direct engine):
+	iparse.Read_Var("FloatWeights",&FloatWeights,false);
+	iparse.Read_Var("CompareFloatWeights",&CompareFloatWeights,false);
+	if(collision_engine != ENGINE_DIRECT)
+	{
+		FloatWeights = false;
+	}
+	CompareFloatWeights = CompareFloatWeights && FloatWeights;
+	if(FloatWeights)
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "--> FloatWeights = " << FloatWeights << std::endl;
+			std::cout << "--> CompareFloatWeights = " << CompareFloatWeights << std::endl << std::endl;
+			std::cout << "The convolution weights are stored as floats (the quadrature sums are still accumulated in double)."
+				<< std::endl << std::endl;
+			if(direct_kernel != KERNEL_SCALAR)
+			{
+				std::cout << "DirectKernel is not used with FloatWeights." << std::endl << std::endl;
+			}
+		}
+		direct_kernel = KERNEL_SCALAR;
+	}
+
+	// Check if BatchedCollisions has been set and print its value from the processor with rank 0 (if
+	// not, set default value to false; it is only used for Q(f,f) in the space inhomogeneous problem,
+	// with the tables of double weights of the Direct engine):
+	iparse.Read_Var("BatchedCollisions",&BatchedCollisions,false);
+	if(BatchedCollisions)
+	{
+		if(collision_engine != ENGINE_DIRECT || FloatWeights || Homogeneous || FullandLinear || LinearLandau)
+		{
+			if(myrank_mpi==0)
+			{
+				std::cout << "BatchedCollisions is only used for Q(f,f) in the space inhomogeneous problem with the Direct engine"
+					<< " (and without FloatWeights), so the space-steps are not batched." << std::endl << std::endl;
+			}
+			BatchedCollisions = false;
+		}
+		else
+		{
+			if(myrank_mpi==0)
+			{
+				std::cout << "--> BatchedCollisions = " << BatchedCollisions << std::endl << std::endl;
+				if(direct_kernel != KERNEL_SCALAR)
+				{
+					std::cout << "DirectKernel is not used for the batched quadrature sums." << std::endl << std::endl;
+				}
+			}
+			direct_kernel = KERNEL_SCALAR;
+		}
+	}
+
+	// Check if BatchedFFTs has been set and print its value from the processor with rank 0 (if not,
+	// set default value to false; it is only used with BatchedCollisions):
+	iparse.Read_Var("BatchedFFTs",&BatchedFFTs,false);
+	if(BatchedFFTs)
+	{
+		if(! BatchedCollisions)
+		{
+			if(myrank_mpi==0)
+			{
+				std::cout << "BatchedFFTs is only used with BatchedCollisions, so the FFTs are not batched." << std::endl << std::endl;
+			}
+			BatchedFFTs = false;
+		}
+		else if(myrank_mpi==0)
+		{
+			std::cout << "--> BatchedFFTs = " << BatchedFFTs << std::endl << std::endl;
+		}
+	}
+
+	// Check if ConcurrentCells has been set and print its value from the processor with rank 0 (if not,
+	// set default value to false; like BatchedCollisions, it is only used for Q(f,f) in the space
+	// inhomogeneous problem with the tables of double weights of the Direct engine, whose Scalar sums
+	// keep all of their buffers in the workspace of each thread):
+	iparse.Read_Var("ConcurrentCells",&ConcurrentCells,false);
+	if(ConcurrentCells)
+	{
+		if(collision_engine != ENGINE_DIRECT || FloatWeights || Homogeneous || FullandLinear || LinearLandau || BatchedCollisions)
+		{
+			if(myrank_mpi==0)
+			{
+				std::cout << "ConcurrentCells is only used for Q(f,f) in the space inhomogeneous problem with the Direct engine"
+					<< " (and without FloatWeights or BatchedCollisions), so the space-steps are advanced one after another." << std::endl << std::endl;
+			}
+			ConcurrentCells = false;
+		}
+		else
+		{
+			if(myrank_mpi==0)
+			{
+				std::cout << "--> ConcurrentCells = " << ConcurrentCells << std::endl << std::endl;
+				if(direct_kernel != KERNEL_SCALAR)
+				{
+					std::cout << "DirectKernel is not used when the space-steps are shared out between the threads." << std::endl << std::endl;
+				}
+			}
+			direct_kernel = KERNEL_SCALAR;
+		}
+	}
+
+	// Check if PackedWeights & PackedHugePages have been set and print their values from the processor
+	// with rank 0 (if not, set default values to false; the packed tables are only read by the Scalar
+	// sums of the Direct engine, so not with FloatWeights or BatchedCollisions):
+	iparse.Read_Var("PackedWeights",&PackedWeights,false);
+	iparse.Read_Var("PackedHugePages",&PackedHugePages,false);
+	if(PackedWeights)
+	{
+		if(collision_engine != ENGINE_DIRECT || FloatWeights || BatchedCollisions)
+		{
+			if(myrank_mpi==0)
+			{
+				std::cout << "PackedWeights is only used with the Direct engine (and without FloatWeights or BatchedCollisions),"
+					<< " so the full tables of weights are stored." << std::endl << std::endl;
+			}
+			PackedWeights = false;
+		}
+		else
+		{
+			if(myrank_mpi==0)
+			{
+				std::cout << "--> PackedWeights = " << PackedWeights << std::endl;
+				std::cout << "--> PackedHugePages = " << PackedHugePages << std::endl << std::endl;
+				std::cout << "Only the convolution weights inside the convolution windows are stored, scaled by the quadrature weights."
+					<< std::endl << std::endl;
+				if(direct_kernel != KERNEL_SCALAR)
+				{
+					std::cout << "DirectKernel is not used with PackedWeights." << std::endl << std::endl;
+				}
+			}
+			direct_kernel = KERNEL_SCALAR;
+		}
+	}
+	PackedHugePages = PackedHugePages && PackedWeights;
+
+	// Check if SymmetricWeights has been set and print its value from the processor with rank 0 (if
+	// not, set default value to false; the tables with one weight per orbit are only read by the
+	// Scalar sums of the Direct engine, so not with FloatWeights, PackedWeights or BatchedCollisions):
+	iparse.Read_Var("SymmetricWeights",&SymmetricWeights,false);
+	if(SymmetricWeights)
+	{
+		if(collision_engine != ENGINE_DIRECT || FloatWeights || PackedWeights || BatchedCollisions)
+		{
+			if(myrank_mpi==0)
+			{
+				std::cout << "SymmetricWeights is only used with the Direct engine (and without FloatWeights, PackedWeights or BatchedCollisions),"
+					<< " so the full tables of weights are stored." << std::endl << std::endl;
+			}
+			SymmetricWeights = false;
+		}
+		else
+		{
+			if(myrank_mpi==0)
+			{
+				std::cout << "--> SymmetricWeights = " << SymmetricWeights << std::endl << std::endl;
+				std::cout << "Only one convolution weight is stored for each orbit of the octahedral symmetry of the kernel."
+					<< std::endl << std::endl;
+				if(direct_kernel != KERNEL_SCALAR)
+				{
+					std::cout << "DirectKernel is not used with SymmetricWeights." << std::endl << std::endl;
+				}
+			}
+			direct_kernel = KERNEL_SCALAR;
+		}
+	}
+
+	// Check if ProjectionGEMM & ProjectionMemory have been set and print their values from the
+	// processor with rank 0 (if not, set default values to false & 2048 MB; the operator is only
+	// built by InitDGProjection if it fits in ProjectionMemory):
+	iparse.Read_Var("ProjectionGEMM",&ProjectionGEMM,false);
+	iparse.Read_Var("ProjectionMemory",&projection_memory,2048.);
+	if(ProjectionGEMM && myrank_mpi==0)
+	{
+		std::cout << "--> ProjectionGEMM = " << ProjectionGEMM << std::endl;
+		std::cout << "--> ProjectionMemory = " << projection_memory << " MB" << std::endl << std::endl;
+	}
+
+	// Check if ModeProcesses has been set and print its value from the processor with rank 0 (if not,
+	// set default value to 0, so that InitProcessGrid chooses it from the number of processes):
+	if( iparse.Read_Var("ModeProcesses",&mode_processes,0) )
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "--> ModeProcesses = " << mode_processes << std::endl << std::endl;
+		}
+	}
+
+	// Check if the tolerance & largest rank of the low-rank factorisation have been set and print
+	// their values from the processor with rank 0 (if not, set default values of 1e-10 & no limit):
+	iparse.Read_Var("LowRankTol",&lowrank_tol,1.e-10);
+	iparse.Read_Var("LowRankMaxRank",&lowrank_max_rank,0);
+	if(collision_engine == ENGINE_LOWRANK)
+	{
+		if(lowrank_tol <= 0.)
+		{
+			if(myrank_mpi==0)
+			{
+				std::cout << "Program cannot run... LowRankTol must be positive." << std::endl;
+			}
+			exit(1);
+		}
+		if(myrank_mpi==0)
+		{
+			std::cout << "--> LowRankTol = " << lowrank_tol << std::endl;
+			std::cout << "--> LowRankMaxRank = " << lowrank_max_rank << std::endl << std::endl;
+		}
+	}
+
+	// Check if CheckEngine has been set and print its value from the
+	// processor with rank 0 (if not, set default value to false):
+	if( iparse.Read_Var("CheckEngine",&CheckCollisionEngine,false) )
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "--> CheckEngine = " << CheckCollisionEngine << std::endl << std::endl;
+		}
+	}
+}
+
+void ReadWeightStoreOptions(GRVY_Input_Class& iparse)										// Function to read the options to decide if the convolution weights are mapped from a weight store on disk or shared by the processes of each node
+{
+	// Check if UseStore has been set in the Weights section and print its value from the
+	// processor with rank 0 (if not, set default value to false):
+	if( iparse.Read_Var("Weights/UseStore",&UseWeightStore,false) )
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "--> UseWeightStore = " << UseWeightStore << std::endl << std::endl;
+		}
+	}
+	if(UseWeightStore)
+	{
+		// Read the directory of the weight stores (default Weights) and if their checksums
+		// are checked when they are loaded (default false):
+		iparse.Read_Var("Weights/Directory",&weight_store_dir,std::string("Weights"));
+		iparse.Read_Var("Weights/Verify",&VerifyWeightStore,false);
+		if(myrank_mpi==0)
+		{
+			std::cout << "The convolution weights are taken from the weight stores in " << weight_store_dir
+				<< " (generating them if they do not exist yet)." << std::endl;
+			if(VerifyWeightStore)
+			{
+				std::cout << "The checksum of each weight store is verified when it is loaded." << std::endl;
+			}
+			std::cout << std::endl;
+		}
+	}
+
+	// Check if Shared has been set in the Weights section and print its value from the processor
+	// with rank 0 (if not, set default value to false):
+	if( iparse.Read_Var("Weights/Shared",&SharedWeights,false) )
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "--> SharedWeights = " << SharedWeights << std::endl << std::endl;
+		}
+	}
+	if(SharedWeights && UseWeightStore)
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "SharedWeights is not used with UseStore, since the pages of each weight store are already mapped once per node." << std::endl << std::endl;
+		}
+		SharedWeights = false;
+	}
+}
+
+void ReadFFTWOptions(GRVY_Input_Class& iparse)											// Function to read the options to decide how the FFTs are planned by fftw3 & if its wisdom is kept on disk
+{
+	std::string planner;																		// declare planner (the name of the planner flag read from the input file)
+
+	// Check if Planner has been set in the FFTW section and print its value from the processor
+	// with rank 0 (if not, set default value to Measure):
+	iparse.Read_Var("FFTW/Planner",&planner,std::string("Measure"));
+	if(planner == "Estimate")
+	{
+		fft_planner = FFTW_ESTIMATE;
+	}
+	else if(planner == "Measure")
+	{
+		fft_planner = FFTW_MEASURE;
+	}
+	else if(planner == "Patient")
+	{
+		fft_planner = FFTW_PATIENT;
+	}
+	else
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "Program cannot run... " << planner << " is not a planner of fftw3." << std::endl;
+			std::cout << "Please set Planner to one of Estimate, Measure or Patient in the FFTW section of LPsolver-input.txt." << std::endl;
+		}
+		exit(1);
+	}
+	if(myrank_mpi==0)
+	{
+		std::cout << "--> FFTW Planner = " << FFTPlannerName(fft_planner) << std::endl << std::endl;
+	}
+
+	// Check if UseWisdom has been set in the FFTW section and print its value from the
+	// processor with rank 0 (if not, set default value to false):
+	if( iparse.Read_Var("FFTW/UseWisdom",&UseWisdom,false) )
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "--> UseWisdom = " << UseWisdom << std::endl << std::endl;
+		}
+	}
+	if(UseWisdom)
+	{
+		// Read the file where the wisdom is kept (default fftw-wisdom.dat):
+		iparse.Read_Var("FFTW/WisdomFile",&wisdom_file,std::string("fftw-wisdom.dat"));
+		if(myrank_mpi==0)
+		{
+			std::cout << "The wisdom of fftw3 is read from & written back to " << wisdom_file << "." << std::endl << std::endl;
+		}
+	}
+}
+
+void ReadInputParameters(GRVY_Input_Class& iparse, std::string& flag, int& nT, 
+							int& Nx, int& Nv, int& N, double& nu, double& dt, double& A_amp, 
+							double& k_wave, double& Lv, double& Lx)								// Function to read all input parameters (IC_flag, nT,  Nx, Nv, N, nu, dt, A_amp, k_wave, L_v & L_x)
+{
+	// Print a header for the input parameters from the processor with rank 0:
+	if(myrank_mpi==0)
+	{
+		std::cout << "#=====================================================#" << std::endl;
+		std::cout << "#           INPUT PARAMETERS FOR CURRENT RUN          #" << std::endl;
+		std::cout << "#=====================================================#" << std::endl << std::endl;
+	}
+	
+	// Check if the variable flag has been set and print it from the processor with rank 0
+	// (if not, exit)
+	if(! iparse.Read_Var("flag",&flag))
+	{
+		if(myrank_mpi==0)
+		{
+			std::cout << "Program cannot run..." << std::endl;
+			std::cout << "Please set the name of 'flag' in the input file." << std::endl;
+		}
+		exit(1);
+	}
+	if(myrank_mpi==0)
+	{
+		std::cout << "--> Flag associated to this run: " << flag << std::endl << std::endl;
+	}
+
+	// Try to read all input parameters to be used for this run and print them from the
+	// processor with rank 0 (exit if not available)
+	if (! iparse.Read_Var("nT",&nT) )
+	{
+		PrintError("nT");
+		exit(1);
+	}
+	if(myrank_mpi==0)
+	{
+		printf("--> %-11s = %d\n","nT",nT);
+	}
+	if (! iparse.Read_Var("Nx",&Nx) )
+	{
+		PrintError("Nx");
+		exit(1);
+	}
+	if(myrank_mpi==0)
+	{
+		printf("--> %-11s = %d\n","Nx",Nx);
+	}
+	if (! iparse.Read_Var("Nv",&Nv) )
+	{
+		PrintError("Nv");
+		exit(1);
+	}
+	if(myrank_mpi==0)
+	{
+		printf("--> %-11s = %d\n","Nv",Nv);
+	}
+	if (! iparse.Read_Var("N",&N) )
+	{
+		PrintError("N");
+		exit(1);
+	}
+	if(myrank_mpi==0)
+	{
+		printf("--> %-11s = %d\n","N",N);
+	}
+	if (! iparse.Read_Var("nu",&nu) )
+	{
+		PrintError("nu");
+		exit(1);
+	}
+	if(myrank_mpi==0)
+	{
+		printf("--> %-11s = %g\n","nu",nu);
+	}
+	if (! iparse.Read_Var("dt",&dt) )
+	{
+		PrintError("dt");
+		exit(1);
+	}
+	if(myrank_mpi==0)
+	{
+		printf("--> %-11s = %g\n","dt",dt);
+	}
+
+	// Try to read all input parameters associated to the Damping option 
+	// (some have default values but others will exit if not available)
+	
+	grvy_log_setlevel(GRVY_NOLOG);
+	
+	if(Damping)
+	{
+		if (! iparse.Read_Var("Damping/A_amp",&A_amp) )
+		{
+			PrintError("Damping/A_amp");
+			exit(1);
+		}
+		if (! iparse.Read_Var("Damping/k_wave",&k_wave) )
+		{
+			PrintError("Damping/k_wave");
+			exit(1);
+		}
+		if (! iparse.Read_Var("Damping/Lv",&Lv) )
+		{
+			PrintError("Damping/Lv");
+			exit(1);
+		}
+		iparse.Read_Var("Damping/Lx",&Lx,2*PI/k_wave);
+	}
+
+	// Try to read all input parameters associated to the TwoStream option 
+	// (some have default values but others will exit if not available)
+	if(TwoStream)
+	{
+		if (! iparse.Read_Var("TwoStream/A_amp",&A_amp) )
+		{
+			PrintError("TwoStream/A_amp");
+			exit(1);
+		}
+		if (! iparse.Read_Var("TwoStream/Lv",&Lv) )
+		{
+			PrintError("TwoStream/Lv");
+			exit(1);
+		}
+		iparse.Read_Var("TwoStream/Lx",&Lx,2*PI/k_wave);
+		k_wave=2*PI/4.;
+	}
+
+	// Try to read all input parameters associated to the FourHump option 
+	// (some have default values but others will exit if not available)
+	if(FourHump)
+	{
+		iparse.Read_Var("FourHump/A_amp",&A_amp,0.);
+		iparse.Read_Var("FourHump/k_wave",&k_wave,0.5);
+		if (! iparse.Read_Var("FourHump/Lv",&Lv) )
+		{
+			PrintError("FourHump/Lv");
+			exit(1);
+		}
+		iparse.Read_Var("FourHump/Lx",&Lx,2*PI/k_wave);
+	}
+
+	// Try to read all input parameters associated to the TwoHump option 
+	// (some have default values but others will exit if not available)
+	if(TwoHump)
+	{
+		iparse.Read_Var("TwoHump/A_amp",&A_amp,0.);
+		iparse.Read_Var("TwoHump/k_wave",&k_wave,0.5);
+		if (! iparse.Read_Var("TwoHump/Lv",&Lv) )
+		{
+			PrintError("TwoHump/Lv");
+			exit(1);
+		}
+		iparse.Read_Var("TwoHump/Lx",&Lx,2*PI/k_wave);
+	}
+
+	if(Doping)
+	{
+		iparse.Read_Var("Doping/A_amp",&A_amp,0.);
+		iparse.Read_Var("Doping/k_wave",&k_wave,0.5);
+		if (! iparse.Read_Var("Doping/Lv",&Lv) )
+		{
+			PrintError("Doping/Lv");
+			exit(1);
+		}
+		iparse.Read_Var("Doping/Lx",&Lx,2*PI/k_wave);
+	}
+
+	grvy_log_setlevel(GRVY_INFO);
+
+	// Print the values of the parameters read from the specific options from the processor
+	// with rank 0
+	if(myrank_mpi==0)
+	{
+		printf("--> %-11s = %g\n","A_amp",A_amp);
+		printf("--> %-11s = %g\n","k_wave",k_wave);
+		printf("--> %-11s = %g\n","Lv",Lv);
+		printf("--> %-11s = %g\n\n","Lx",Lx);
+	}
+}
+
+void ReadDopingParameters(GRVY_Input_Class& iparse, double& NL, double& NH,
+							double& T_L, double& T_R, double& eps)								// Function to read all parameters for a non-uniform doping profile (NL, NH, T_L, T_R, eps)
+{
+	if(myrank_mpi==0)
+	{
+		std::cout << "Code is running with a non-uniform background density..." << std::endl;
+		std::cout << "Parameters associated to this non-uniform doping profile:" << std::endl << std::endl;
+	}
+
+	// Try to read all doping parameters to be used for this run and print them from the
+	// processor with rank 0 (exit if not available)
+	if (! iparse.Read_Var("Doping/NL",&NL) )
+	{
+		PrintError("Doping/NL");
+		exit(1);
+	}
+	if(myrank_mpi==0)
+	{
+		printf("--> %-11s = %g\n","NL",NL);
+	}
+	if (! iparse.Read_Var("Doping/NH",&NH) )
+	{
+		PrintError("Doping/NH");
+		exit(1);
+	}
+	if(myrank_mpi==0)
+	{
+		printf("--> %-11s = %g\n","NH",NH);
+	}
+	if (! iparse.Read_Var("Doping/eps",&eps) )
+	{
+		PrintError("Doping/eps");
+		exit(1);
+	}
+	if(myrank_mpi==0)
+	{
+		printf("--> %-11s = %g\n","eps",eps);
+	}
+	if( iparse.Read_Var("Doping/T_L",&T_L,0.4) )
+	{
+		if(myrank_mpi==0)
+		{
+			printf("--> %-11s = %g\n","T_L",T_L);
+		}
+	}
+	if( iparse.Read_Var("Doping/T_R",&T_R,0.4) )
+	{
+		if(myrank_mpi==0)
+		{
+			printf("--> %-11s = %g\n","T_R",T_R);
+		}
+	}
+}
+
+void PrintError(std::string var_name)
+{
+	if(myrank_mpi==0)
+	{
+		std::cout << "Program cannot run..." << std::endl;
+		std::cout << "Please set the value of '" << var_name << "' in the input file." << std::endl;
+	}
+}
+
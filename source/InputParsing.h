@@ -41,6 +41,12 @@ extern void ReadLinearLandau(GRVY_Input_Class& iparse);
 
 extern void ReadMassConsOnly(GRVY_Input_Class& iparse);
 
+extern void ReadCollisionEngine(GRVY_Input_Class& iparse);
+
+extern void ReadWeightStoreOptions(GRVY_Input_Class& iparse);
+
+extern void ReadFFTWOptions(GRVY_Input_Class& iparse);
+
 extern void ReadInputParameters(GRVY_Input_Class& iparse, std::string& flag, int& nT,
 								int& Nx, int& Nv, int& N, double& nu, double& dt, double& A_amp,
 								double& k_wave, double& Lv, double& Lx);
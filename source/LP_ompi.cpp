@@ -44,13 +44,13 @@ double *wtN;																						// declare wtN (the trapezoidal rule weights t
 double scale, scale3, scaleL, scalev;																// declare scale (the 1/sqrt(2pi) factor appearing in Gaussians), scale (the 1/(sqrt(2pi))^3 factor appearing in the Maxwellian), scaleL (the volume of the velocity domain) & scalev (the volume of a discretised velocity element)
 
 
-double *U1, *Utmp, *output_buffer_vp;//, **H;														// declare pointers to U1, Utmp (both used to help store the values in U, declared later) & output_buffer_vp (a buffer used when sending the data between MPI processes during the VP method)
-double *Q, *f1, *Q1, *Utmp_coll;//*f2, *f3;															// declare pointers to Q (the discretised collision operator), f1 (used to help store the solution during the collisional problem), Q1 (used in calculation of the collision operator) & Utmp_coll (used to store calculations from the RK4 method used in the collisional problem)
+double *U1, *Utmp;//, **H;																			// declare pointers to U1 (the cells of this process, with the ghost cells either side of them, in each stage of RK3) & Utmp (used to help store the values in U, declared later)
+double *Q, *f1, *Q1, *U_coll, *Utmp_coll;//*f2, *f3;												// declare pointers to Q (the discretised collision operator), f1 (used to help store the solution during the collisional problem), Q1 (used in calculation of the collision operator), U_coll (the cells of U needed by this process in the collisional problem, see FetchCollisionCells) & Utmp_coll (used to store calculations from the RK4 method used in the collisional problem)
 fftw_complex *Q1_fft, *Q2_fft, *Q3_fft;																// declare pointers to the complex numbers Q1_fft, Q2_fft & Q3_fft (involved in storing the FFT of Q)
 
 fftw_complex *Q1_fft_linear, *Q2_fft_linear, *Q3_fft_linear;										// declare pointers to the complex numbers Q1_fft_linear, Q2_fft_linear & Q3_fft_linear (involved in storing the FFT of the two species collison operator Q)
 
-fftw_complex *fftIn, *fftOut;																		// declare pointers to the FFT variables fftIn (a vector to be to have the FFT applied to it) & fftOut (the output of an FFT)
+fftw_complex *fftOut;																				// declare a pointer to the FFT variable fftOut (the output of an FFT)
 
 double ce, *cp, *intE, *intE1, *intE2;																// declare ce and pointers to cp, intE, intE1 & intE2 (precomputed quantities for advections)
 
@@ -61,10 +61,11 @@ fftw_complex *temp;																					// declare a pointer to complex number t
 
 int myrank_mpi, nprocs_mpi, nprocs_Nx;																// declare myrank_mpi (the rank of the current MPI process running), nprocs_mpi (the total number of MPI processes) & nprocs_Nx (the amount of MPI processes used for the collisionless VP problem)
 int chunksize_dg, chunksize_ft, chunk_Nx;															// declare chunksize_dg (the amount of data each processes works on during the DG method in the VP problem), chunksize_ft (the amount of data each process works on during the collisional problem) & chunk_Nx (the number of space-steps sent to each process in the collisional problem)
+int nprocs_modes, grid_rank_x, grid_rank_modes, chunk_kt;											// declare nprocs_modes (the number of processes holding each space-step, between which the modes of the collision operator are shared), grid_rank_x & grid_rank_modes (the coordinates of the current process in the grid of processes of ProcessGrid.cpp) & chunk_kt (the number of velocity cells each process updates in the last step of RK4)
+MPI_Comm comm_modes;																				// declare comm_modes (the communicator of the processes holding the same space-steps)
 
 int *fNegVals;																						// declare fNegVals (to store where DG solution goes negative - a 1 if negative and a 0 if positive)
 double *fAvgVals;																					// declare fAvgVals (to store the average values of f on each cell)
-double *fEquiVals;																					// declare f_equivals (to store the equilibrium solution)
 
 bool Damping, TwoStream, FourHump, TwoHump, Doping;													// declare Boolean variables which will determine the ICs for the problem
 bool Homogeneous;																					// declare a Boolean variable to determine if running the space homogeneous code or not
@@ -72,16 +73,37 @@ bool FullandLinear;																					// declare a Boolean variable to determi
 bool First, Second;																					// declare Boolean variables which will determine if this is the first or a subsequent run
 bool LinearLandau;																					// declare a Boolean variable to determine if running with the full collision operator or linear collisions with a Maxwellian
 bool MassConsOnly;																					// declare a Boolean variable to determine if conserving all moments or all mass
+bool UseWeightStore, VerifyWeightStore;																// declare Boolean variables to determine if the convolution weights are mapped from a weight store on disk & if its checksum is verified when it is loaded
+bool SharedWeights;																					// declare a Boolean variable to determine if the tables of convolution weights computed in memory are shared by the processes of each node
+int collision_engine;																				// declare collision_engine (which of the ENGINE_ macros is used to evaluate the collision operator)
+int direct_kernel;																					// declare direct_kernel (which of the KERNEL_ macros is used for the quadrature sums of the Direct collision engine)
+bool FloatWeights, CompareFloatWeights;																// declare Boolean variables to determine if the convolution weights are stored as floats & if the moment drift this causes is compared with the double weights
+bool PackedWeights, PackedHugePages;																// declare Boolean variables to determine if only the entries of the convolution weights inside the convolution windows are stored, packed & scaled by the quadrature weights, & if they are placed on transparent huge pages
+bool SymmetricWeights;																				// declare a Boolean variable to determine if only one convolution weight is stored for each orbit of the octahedral symmetry of the kernel
+bool BatchedCollisions;																				// declare a Boolean variable to determine if the collision step of the space inhomogeneous problem is batched over all of the space-steps held by each process
+bool BatchedFFTs;																					// declare a Boolean variable to determine if the FFTs of the batched collision step are taken for all of the space-steps held by each process at once
+bool ConcurrentCells;																				// declare a Boolean variable to determine if the space-steps held by each process are shared out between the OpenMP threads in the collision step, each with its own workspace
+bool ProjectionGEMM;																				// declare a Boolean variable to determine if the increments of RK4 are projected onto the DG basis by one matrix product with a precomputed dense operator
+double projection_memory;																			// declare projection_memory (the most memory, in MB, the dense projection operator may use on each process)
+int mode_processes;																					// declare mode_processes (the number of processes the modes of each space-step are shared between, as read from the input file, or 0 to choose it from the number of processes)
+bool CheckCollisionEngine;																			// declare CheckCollisionEngine (a flag to compare the first collision step of the chosen engine with the direct sum)
+double lowrank_tol;																					// declare lowrank_tol (the relative tolerance to which the low-rank collision engine approximates the convolution weights)
+int lowrank_max_rank;																				// declare lowrank_max_rank (the largest rank the low-rank collision engine may use, or 0 for no limit)
+std::string weight_store_dir;																		// declare weight_store_dir (the directory where the weight stores are kept)
+unsigned fft_planner;																				// declare fft_planner (the flag, FFTW_ESTIMATE, FFTW_MEASURE or FFTW_PATIENT, with which every FFT is planned)
+bool UseWisdom;																						// declare a Boolean variable to determine if the wisdom of fftw3 is imported from wisdom_file before planning the FFTs & exported to it afterwards
+std::string wisdom_file;																			// declare wisdom_file (the file where the wisdom of fftw3 is kept)
+
+#if !defined(WEIGHT_GENERATOR) && !defined(COLLISION_BENCHMARK)										// the MPI_WeightGenerator & CollisionBenchmark targets are built from the same sources but have their own mains (in MPI_WeightGenerator.cpp & CollisionBenchmark.cpp)
 
 int main()
 {
-	int i, j, k, j1, j2, j3, l; 																	// declare i, j, k (counters), j1, j2, j3 (velocity space counters) & l (the index of the current DG basis function being integrated against)
+	int i, j, j1, j2, j3, l; 																		// declare i, j (counters), j1, j2, j3 (velocity space counters) & l (the index of the current DG basis function being integrated against)
 	int  tp, t=0; 																					// declare tp (the amount size of the data which stores the DG coefficients of the solution read from a previous run) & t (the current time-step) and set it to 0
-	int k_v, k_eta, k_local, nprocs_vlasov;															// declare k_v (the index of a DG coefficient), k_eta (the index of a DG coefficient in Fourier space), k_local (the index of a DG coefficient, local to the space chunk on the current process) & nprocs_vlasov (the number of processes used for solving the Vlasov equation)
+	int k_eta, nprocs_vlasov, nprocs_x;																// declare k_eta (the index of a DG coefficient in Fourier space), nprocs_vlasov (the number of processes used for solving the Vlasov equation) & nprocs_x (the number of processes along the space-steps of the grid of processes)
 	double tmp, mass, a[3], KiE, EleE, KiEratio, ent1, l_ent1, ll_ent1;								// declare tmp (the square root of electric energy), mass (the mass/density rho), a (the momentum vector J), KiE (the kinetic energy), EleE (the electric energy), KiEratio (the ratio of kinetic energy between where f is positive and negative),  ent1 (the entropy with negatives discarded), l_ent1 (log of the ent1) & ll_ent1 (log of log of ent1)
-	double *U, **f, *output_buffer;//, **conv_weights_local;										// declare pointers to U (the vector containing the coefficients of the DG basis functions for the solution f(x,v,t) at the given time t), f (the solution which has been transformed from the DG discretisation to the appropriate spectral discretisation) & output_buffer (from where to send MPI messages)
-	double **conv_weights, **conv_weights_linear;													// declare a pointer to conv_weights (a matrix of the weights for the convolution in Fourier space of single species collisions) & conv_weights_linear (a matrix of convolution weights in Fourier space of two species collisions)
-	double **conv_weights1, **conv_weights2;														// declare a pointer to conv_weights1 (the first matrix in the sum of matrices for the weights of the convolution in Fourier space of single species collisions) & conv_weights2 (the second matrix in the sum of matrices for the weights of the convolution in Fourier space of single species collisions)
+	double *U, **f;//, **conv_weights_local;														// declare pointers to U (the vector containing the coefficients of the DG basis functions for the solution f(x,v,t) at the given time t) & f (the solution which has been transformed from the DG discretisation to the appropriate spectral discretisation)
+	double **conv_weights = NULL, **conv_weights_linear = NULL;										// declare a pointer to conv_weights (a matrix of the weights for the convolution in Fourier space of single species collisions) & conv_weights_linear (a matrix of convolution weights in Fourier space of two species collisions)
 	std::string flag;																				// declare a string flag (used to identify files generated associated to the current run)
 	std::string IC_name;																			// declare a string IC_name (used to identify the initial condions being run)
 	std::string old_run_name;																		// declare a string old_run_name (the name of the previous run if running for second time)
@@ -97,7 +119,6 @@ int main()
 	//************************
 	int required=MPI_THREAD_MULTIPLE;																// declare required and set it to MPI_THREAD_MULTIPLE (so that in the hybrid OpenMP/MPI routines, multiple threads may call MPI, with no restrictions)           . MPI_THREAD_SERIALIZED; // Required level of MPI threading support
 	int provided;                       															// declare provided (the actual provided level of MPI thread support)
-	MPI_Status status;																				// declare status (to store any status required for MPI operations)
 
 	MPI_Init_thread(NULL, NULL, required, &provided);												// initialise the hybrid MPI & OpenMP environment, requesting the level of thread support to be required and store the actual thread support provided in provided
 	MPI_Comm_rank(MPI_COMM_WORLD, &myrank_mpi);														// store the rank of the current process in the MPI_COMM_WORLD communicator in myrank_mpi
@@ -151,6 +172,9 @@ int main()
 	ReadFullandLinear(iparse);																		// Read in if running multi-species collisions
 	ReadLinearLandau(iparse);																		// Read in if running full or linear Landau
 	ReadMassConsOnly(iparse);																		// Read in if running conservation of all moments or just mass
+	ReadWeightStoreOptions(iparse);																	// Read in if the convolution weights are taken from a weight store on disk
+	ReadCollisionEngine(iparse);																	// Read in which engine is used to calculate the convolutions in the collision operator
+	ReadFFTWOptions(iparse);																		// Read in how the FFTs are planned & if the wisdom of fftw3 is kept on disk
 
 	ReadInputParameters(iparse, flag, nT, Nx, Nv, N, nu, dt, A_amp, k_wave, Lv, Lx);				// Read in all input parameters
 
@@ -204,16 +228,20 @@ int main()
 
 	chunksize_dg = size/nprocs_mpi;																	// set chunksize_dg to size/nprocs_mpi (which will be an integer since nprocs_mpi is a facot of size_v and size = Nx*size_v)
 	chunksize_ft = size_ft/nprocs_mpi; 																// set chunksize_ft to size_ft/nprocs_mpi
+	slab_first = chunksize_dg*myrank_mpi;															// U only holds the chunksize_dg cells of this process, from the cell chunksize_dg*myrank_mpi onwards (see SlabIndex)
+
+	InitProcessGrid();																				// arrange the processes in a grid, with the space-steps shared out along its first axis (of nprocs_mpi/nprocs_modes processes) & the modes of each space-step along its second
 
 	if(! Homogeneous)
 	{
-		if(Nx%nprocs_mpi == 0)
+		nprocs_x = nprocs_mpi/nprocs_modes;
+		if(Nx%nprocs_x == 0)
 		{
-			chunk_Nx = Nx/nprocs_mpi;																	// if nprocs_mpi divides into Nx, set chunk_Nx to Nx/nprocs_mpi
+			chunk_Nx = Nx/nprocs_x;																	// if nprocs_x divides into Nx, set chunk_Nx to Nx/nprocs_x
 		}
 		else
 		{
-			chunk_Nx = Nx/nprocs_mpi + 1;																// if nprocs_mpi does not divide into Nx, set chunk_Nx to Nx/nprocs_mpi + 1
+			chunk_Nx = Nx/nprocs_x + 1;																// if nprocs_x does not divide into Nx, set chunk_Nx to Nx/nprocs_x + 1
 		}
 
 		nprocs_Nx = (int)((double)Nx/(double)chunk_Nx + 0.5);											// set nprocs_Nx to Nx/chunk_Nx + 0.5 and store the result as an integer
@@ -224,23 +252,21 @@ int main()
 		nprocs_Nx = nprocs_mpi;
 	}
 	
-	U = (double*)malloc(size*6*sizeof(double));														// allocate enough space at the pointer U for 6*size many double numbers
-	U1 = (double*)malloc(size*6*sizeof(double));													// allocate enough space at the pointer U1 for 6*size many floating point numbers
+	U = (double*)malloc(chunksize_dg*6*sizeof(double));												// allocate enough space at the pointer U for the 6*chunksize_dg coefficients of the cells of this process (see advection_1.cpp)
+	U1 = (double*)malloc((chunksize_dg + 2*size_v)*6*sizeof(double));								// allocate enough space at the pointer U1 for the 6*chunksize_dg coefficients of this process & the 6*size_v on either side of them
  
 	Utmp = (double*)malloc(chunksize_dg*6*sizeof(double));											// allocate enough space at the pointer Utmp for 6*chunksize_dg many floating point numbers
   
 	if(! Homogeneous)
 	{
-		output_buffer_vp = (double *) malloc(chunksize_dg*6*sizeof(double));							// allocate enough space at the pointer output_buffer_vp for 6*chunksize_dg many floating point numbers
 		cp = (double*)malloc(Nx*sizeof(double));														// allocate enough space at the pointer cp for Nx many double numbers
 		intE = (double*)malloc(Nx*sizeof(double));														// allocate enough space at the pointer intE for Nx many double numbers
 		intE1 = (double*)malloc(Nx*sizeof(double));														// allocate enough space at the pointer intE1 for Nx many double numbers
 		intE2 = (double*)malloc(Nx*sizeof(double));														// allocate enough space at the pointer intE2 for Nx many double numbers
 	}
 
-	fNegVals = (int*)malloc(size*sizeof(int));														// allocate enough space at the pointer fNegVals for size many integers
-	fAvgVals = (double*)malloc(size*sizeof(double));												// allocate enough space at the pointer fAvgVals for size many doubles
-	fEquiVals = (double*)malloc(5*5*5*5*size*sizeof(double));										// allocate enough space at the pointer fEquiVals for 5*Nx*(5*Nv)^3 many doubles
+	fNegVals = (int*)malloc(chunksize_dg*sizeof(int));												// allocate enough space at the pointer fNegVals for chunksize_dg many integers
+	fAvgVals = (double*)malloc(chunksize_dg*sizeof(double));										// allocate enough space at the pointer fAvgVals for chunksize_dg many doubles
 
 	if(nu > 0.)
 	{
@@ -263,32 +289,8 @@ int main()
 		{
 			f[i] = (double *)malloc(size_ft*sizeof(double));										// allocate enough space at the ith entry of f for size_ft many double numbers
 		}
-		conv_weights = (double **)malloc(size_ft*sizeof(double *));									// allocate enough space at the pointer conv_weights for size_ft many pointers to float numbers
-		for (i=0;i<size_ft;i++)
-		{
-			conv_weights[i] = (double *)malloc(size_ft*sizeof(double));								// allocate enough space at the ith entry of conv_weights for size_ft many float numbers
-		}
-
-		conv_weights1 = (double **)malloc(size_ft*sizeof(double *));								// allocate enough space at the pointer conv_weights1 for size_ft many pointers to float numbers
-		for (i=0;i<size_ft;i++)
-		{
-			conv_weights1[i] = (double *)malloc(size_ft*sizeof(double));							// allocate enough space at the ith entry of conv_weights1 for size_ft many float numbers
-		}
-
-		conv_weights2 = (double **)malloc(size_ft*sizeof(double *));								// allocate enough space at the pointer conv_weights2 for size_ft many pointers to float numbers
-		for (i=0;i<size_ft;i++)
-		{
-			conv_weights2[i] = (double *)malloc(size_ft*sizeof(double));							// allocate enough space at the ith entry of conv_weights2 for size_ft many float numbers
-		}
-
 		if(FullandLinear)																			// only do this if FullandLinear is true
 		{
-			conv_weights_linear = (double **)malloc(size_ft*sizeof(double *));						// allocate enough space at the pointer conv_weight_linear for size_ft many pointers to float numbers
-			for (i=0;i<size_ft;i++)
-			{
-				conv_weights_linear[i] = (double *)malloc(size_ft*sizeof(double));					// allocate enough space at the ith entry of conv_weights_linear for size_ft many float numbers
-			}
-
 			Q1_fft_linear = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));				// allocate enough space at the pointer Q1_fft_linear for size_ft many complex numbers
 			Q2_fft_linear = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));				// allocate enough space at the pointer Q2_fft_linear for size_ft many complex numbers
 			Q3_fft_linear = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));				// allocate enough space at the pointer Q3_fft_linear for size_ft many complex numbers
@@ -301,13 +303,13 @@ int main()
 		Q1 = (double*)malloc(size_ft*sizeof(double));												// allocate enough space at the pointer Q1 for size_ft many double numbers
 		if(Homogeneous)
 		{
+			U_coll = (double*)malloc(size_v*6*sizeof(double));											// allocate enough space at the pointer U_coll for the 6*size_v coefficients of every velocity cell (since f is found from all of them)
 			Utmp_coll = (double*)malloc(chunksize_dg*5*sizeof(double));								// allocate enough space at the pointer Utmp_coll for 5*chunk_Nx*size_v many double numbers
-			output_buffer = (double*)malloc(chunksize_dg*5*sizeof(double));							// allocate enough space at the pointer output_buffer for 5*chunk_Nx*size_v many double numbers
 		}
 		else
 		{
+			U_coll = (double*)malloc(chunk_Nx*size_v*6*sizeof(double));									// allocate enough space at the pointer U_coll for the 6*chunk_Nx*size_v coefficients of the cells of the space-steps of this process
 			Utmp_coll = (double*)malloc(chunk_Nx*size_v*5*sizeof(double));								// allocate enough space at the pointer Utmp_coll for 5*chunk_Nx*size_v many double numbers
-			output_buffer = (double*)malloc(chunk_Nx*size_v*5*sizeof(double));							// allocate enough space at the pointer output_buffer for 5*chunk_Nx*size_v many double numbers
 		}
 
 		//f2 = (double *)malloc(size_ft*sizeof(double));
@@ -315,17 +317,25 @@ int main()
 		//f3 = (double *)malloc(size_ft*sizeof(double));
 		//Q3 = (double *)malloc(N*N*N*sizeof(double));
 
-		temp = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));							// allocate enough space at the pointer temp for size_ft many complex numbers
+		temp = (fftw_complex *)fftw_malloc(N*N*(N/2+1)*sizeof(fftw_complex));						// allocate enough space at the pointer temp for the N*N*(N/2+1) complex numbers of the half spectrum of a real function (or the padded real array it is transformed from)
 		//qHat_local = (fftw_complex *)fftw_malloc(chunksize_ft*sizeof(fftw_complex));
 		qHat = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));							// allocate enough space at the pointer qHat for size_ft many complex numbers
   
 		// INITIALISE FFTW FOR USE WITH THREADING (MUST BE DONE BEFORE ANY PLAN IS CREATED):
 		fftw_init_threads();																		// initialise the environment for using the fftw3 routines with multiple threads
-		fftw_plan_with_nthreads(nthread);															// set the number of threads used by fftw3 routines to nthread
+		fftw_plan_with_nthreads(FFTThreads(N));														// set the number of threads used by fftw3 routines to the number worth using on an NxNxN grid (at most nthread)
 
-		// SET UP PLANS FOR FFTs (EXECUTED BY USING nThreads):
-		p_forward = fftw_plan_dft_3d (N, N, N, temp, temp, FFTW_FORWARD, FFTW_MEASURE);				// set p_forward to a 3D fftw plan of dimension NxNxN, which will take the FFT of the vector in temp, store the result back in temp, set the sign to FFTW_FORWARD (so that this is an FFT) and set the flag to FFT_MEASURE so that at this stage fftw3 finds the most efficient way to compute the FFT of this size
-		p_backward = fftw_plan_dft_3d (N, N, N, temp, temp, FFTW_BACKWARD, FFTW_MEASURE);			// set p_backward to a 3D fftw plan of dimension NxNxN, which will take the FFT of the vector in temp, store the result back in temp, set the sign to FFTW_BACKWARD (so that this is an inverse FFT) and set the flag to FFT_MEASURE so that at this stage fftw3 finds the most efficient way to compute the FFT of this size
+		// SET UP PLANS FOR FFTs (EXECUTED BY USING nThreads), PLANNED FIRST BY THE PROCESS WITH RANK 0 AND THEN BY THE OTHERS WITH ITS WISDOM:
+		LoadFFTWisdom();																			// import the wisdom of earlier runs on the process with rank 0 (if UseWisdom is true)
+		if(myrank_mpi==0)
+		{
+			PlanFFTs(fft_planner);																	// set p_forward & p_backward to 3D fftw plans of dimension NxNxN, which take the real-to-complex FFT & the complex-to-real inverse FFT in place in temp, with the flag fft_planner (FFTW_MEASURE by default, so that at this stage fftw3 finds the most efficient way to compute FFTs of this size)
+		}
+		ShareFFTWisdom();																			// send the wisdom of the process with rank 0 to the others
+		if(myrank_mpi!=0)
+		{
+			PlanFFTs(fft_planner);																	// make the same plans on the other processes, which look them up in the wisdom of rank 0 rather than measuring them again
+		}
 
 		wtN = (double *)malloc(N*sizeof(double));													// allocate enough space at the pointer wtN to store N many double numbers
 		v = (double *)malloc(N*sizeof(double));														// allocate enough space at the pointer v to store N many double numbers
@@ -336,7 +346,6 @@ int main()
 		Q3_fft = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));							// allocate enough space at the pointer Q3_fft for size_ft many complex numbers
   
 		fftOut = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));							// allocate enough space at the pointer fftOut for size_ft many complex numbers
-		fftIn = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));							// allocate enough space at the pointer fftIn for size_ft many complex numbers
  
 		if(LinearLandau)																			// only do this is LinearLandau is true, for using Q(f,M)
 		{
@@ -347,14 +356,6 @@ int main()
 			}
 		}
 
-		char buffer_weights[100], loading_buffer[100];												// declare the arrays buffer_weights (to store a string which displays the values of N & L_v) & loading_buffer (...?)
-		sprintf(buffer_weights,"Weights/N%d_L%g_Landau.wts",N,L_v);									// store the values of N & L_v in buffer_weights
-		if(FullandLinear)																			// only do this if Fullandlinear is true
-		{
-			char buffer_weights1[100];																// declare the array buffer_weights1 (to store a string which displays the values of N & L_v for the linear case)
-			sprintf(buffer_weights1,"Weights/N%d_L%g_Landau_linear.wts",N,L_v);						// store the values of N & L_v in buffer_weights1 and note that it's for the linear Landau damping
-		}
-
 		// COMMONLY USED CONSTANTS:
 		scale = 1.0/sqrt(2.0*M_PI);																	// set scale to 1/sqrt(2*pi)
 		scale3 = pow(scale, 3.0);																	// set scale3 to scale^3
@@ -371,63 +372,61 @@ int main()
 		}
 
 		trapezoidalRule(N, wtN);																	// set wtN to the weights required for a trapezoidal rule with N points
+		InitFFTShifts();																			// tabulate the 1-D factors which shift the FFTs in fft3D, ifft3D & FS to the v & eta domains
+		if(ConcurrentCells)
+		{
+			InitCollisionWorkspaces(nthread < chunk_Nx ? nthread : chunk_Nx);						// point the shared collision workspace at the global buffers, and give each thread (up to one per space-step) a workspace of its own
+		}
+		else
+		{
+			InitCollisionWorkspaces(0);																// point the shared collision workspace at the global buffers used by fft3D, FS, ComputeQ & RK4
+		}
   
 		createCCtAndPivot();																		// calculate the values of the conservation matrices
+		InitDGProjection();																			// tabulate the 1-D integrals used to project the spectra found in each step of RK4 onto the DG basis
+		InitModeSchedule();																			// tabulate the cost of the quadrature sum of each mode, so that the modes can be shared out evenly between the threads (and the processes holding the same space-steps)
 
-		FILE *fidWeights;																			// declare a pointer to the file fidWeights (which will store the precomputed weights in Fourier transform of Q)
-		//check to see if these convolution weights have already been pre-computed
-		/*if(myrank_mpi==0){
-		if(fidWeights = fopen(buffer_weights,"r")) { //checks if we've already stored a file
-		printf("Stored weights found. Reading in weights... \n");
-			for(i=0;i<size_ft;i++)
+		if(collision_engine == ENGINE_MATRIXFREE)													// only do this if the matrix-free collision engine was chosen
+		{
+			InitMatrixFreeTables(gamma);															// tabulate S-hat(w) at each Fourier node w (no tables of convolution weights are needed)
+		}
+		else if(collision_engine == ENGINE_FFT)														// only do this if the FFT collision engine was chosen
+		{
+			InitFFTCollision(gamma);																// tabulate the separable terms of the convolution weights and plan their FFTs (no tables of convolution weights are needed)
+		}
+		else if(collision_engine == ENGINE_LOWRANK)													// only do this if the low-rank collision engine was chosen
+		{
+			InitLowRankCollision(gamma);															// compress the convolution weights into a low-rank factorisation (no tables of convolution weights are needed)
+		}
+		else
+		{
+			SetupOperatorWeights(gamma, &conv_weights, &conv_weights_linear);						// build (or map) only the tables of convolution weights which the chosen collision operator uses, reporting the memory & time spent on each
+			if(FloatWeights)
+			{
+				InitFloatWeights(gamma);															// round the weights to tables of floats (keeping the double tables as well if CompareFloatWeights is true)
+			}
+			if(PackedWeights)
 			{
-				tp=fread(conv_weights[i], sizeof(double), size_ft, fidWeights);
-				if(tp != size_ft){printf("reaing error! tp=%d\n", tp);exit(0);}
+				InitPackedWeights(gamma);															// pack the entries of the weights inside the convolution windows, scaled by the quadrature weights, into one aligned block for each table
 			}
-		  fclose(fidWeights);
+			if(SymmetricWeights)
+			{
+				InitSymmetricWeights(gamma);														// compute one weight for each orbit of the octahedral symmetry of the kernel
 			}
-			else {
-		  printf("Stored weights NOT found. Please go back and launch MPI_WeightGenerator. \n");
-		  MPI_Finalize();
-		  exit (1);
+			if(direct_kernel != KERNEL_SCALAR)
+			{
+				InitSIMDCollision();																// choose the vectorised kernel for the quadrature sums and allocate its split-complex streams
 			}
-		  }
-
-		  for(k=0;k<size_ft;k++)MPI_Bcast(conv_weights[k], size_ft, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-	  MPI_Barrier(MPI_COMM_WORLD);
-  
-		  if(FullandLinear)
-		  {
-			  FILE *fidWeights1;
-			  if(myrank_mpi==0){
-				if(fidWeights1 = fopen(buffer_weights1,"r")) { //checks if we've already stored a file
-			  printf("Stored weights found. Reading in weights... \n");
-			  for(i=0;i<size_ft;i++) {
-				tp=fread(conv_weights_linear[i], sizeof(double), size_ft, fidWeights1);
-				if(tp != size_ft){printf("reaing error! tp=%d\n", tp);exit(0);}
-			  }
-			  fclose(fidWeights1);
-				}
-				else {
-				  printf("Stored weights NOT found. Please go back and launch MPI_WeightGenerator. \n");
-				  MPI_Finalize();
-				  exit (1);
-				}
-			  }
-
-			  for(k=0;k<size_ft;k++)MPI_Bcast(conv_weights_linear[k], size_ft, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-			MPI_Barrier(MPI_COMM_WORLD);
-		  }
-		 */
-  
-		// Directly compute the weights; not from precomputed (for small number of nodes, it's very fast)
-		generate_conv_weights(conv_weights, gamma); 														// calculate the values of the convolution weights (the matrix G_Hat(xi, omega), for xi = (xi_i, xi_j, xi_k), omega = (omega_l, omega_m, omega_n), i,j,k,l,m,n = 0,1,...,N-1) and store the values in conv_weights
-		generate_conv_weights2(conv_weights1, 0); 													// calculate the values in the first matrix of the convolution weights (the matrix G_Hat(xi, omega), for xi = (xi_i, xi_j, xi_k), omega = (omega_l, omega_m, omega_n), i,j,k,l,m,n = 0,1,...,N-1) and store the values in conv_weights1
-		generate_conv_weights2(conv_weights2, 1); 													// calculate the values in the second matrix of the convolution weights (the matrix G_Hat(xi, omega), for xi = (xi_i, xi_j, xi_k), omega = (omega_l, omega_m, omega_n), i,j,k,l,m,n = 0,1,...,N-1) and store the values in conv_weights2
-		if(FullandLinear)																			// only do this FullandLinear is true
+			if(BatchedCollisions)
+			{
+				InitBatchedCollision(chunk_Nx);														// allocate the spectra & stages of RK4 for the chunk_Nx space-steps of each process, so that each row of weights is read once per stage
+			}
+		}
+		if(CheckCollisionEngine)
 		{
-			generate_conv_weights_linear(conv_weights_linear);										// calculate the values of the convolution weights for the linear case (the matrix G_Hat(xi, omega), for xi = (xi_i, xi_j, xi_k), omega = (omega_l, omega_m, omega_n), i,j,k,l,m,n = 0,1,...,N-1) and store the values in conv_weights_linear
+			InitCollisionCheck(gamma);																// the first collision step is compared with ComputeQ_Direct, with tables of weights built just for the check
 		}
+		SaveFFTWisdom();																			// write the wisdom of every plan made above to wisdom_file (if UseWisdom is true)
 
 		MPI_Barrier(MPI_COMM_WORLD);																// set an MPI barrier to ensure that all processes have reached this point before continuing
 	}
@@ -515,7 +514,8 @@ int main()
 			}
 			if(LinearLandau)																			// only do this is LinearLandau is true, for using Q(f,M)
 			{
-				ComputeDFTofMaxwellian(U, f, DFTMaxwell);												// compute the Fourier transform of the initial Maxwellian currently stored in U and store the output in DFTMaxwell
+				FetchCollisionCells(U, U_coll);															// copy the cells of the space-steps of this process from the processes which hold them in U into U_coll
+				ComputeDFTofMaxwellian(U_coll, f, DFTMaxwell);											// compute the Fourier transform of the initial Maxwellian currently stored in U_coll and store the output in DFTMaxwell
 			}
 		}
 	}
@@ -525,51 +525,64 @@ int main()
 	if(myrank_mpi==0)																				// only the process with rank 0 will do this
 	{
 		printf("MPI info: chunk_Nx = %d, nprocs_Nx = %d\n\n", chunk_Nx, nprocs_Nx);					// print MPI related info for this run
+	}
 
-		if(Second)																					// only do this if Second is true (picking up data from a previous run)
+	if(Second)																						// only do this if Second is true (picking up data from a previous run)
+	{
+		if(! iparse.Read_Var("Second/Name",&old_run_name))											// Check if the variable Second/Name has been set and, if not, exit
 		{
-			if(! iparse.Read_Var("Second/Name",&old_run_name))										// Check if the variable Second/Name has been set and, if not, exit
+			if(myrank_mpi==0)
 			{
 				printf("This run should pick up from a previous run... \n"
 						"Please set the name of the file containing the DG coefficients "
 						"from the previous run under Second/Name in LPsolver-input.txt. \n");
-				exit(1);
 			}
+			exit(1);
+		}
+		if(myrank_mpi==0)
+		{
 			std::cout << "--> Name of file from previous run: " << old_run_name
 						<< std::endl << std::endl;													// Print the name of the file being used as the input for this run
-
-			if(LinearLandau)																		// only do this is LinearLandau is true, for using Q(f,M)
-			{
-				//SetInit_ND(U);																	// set initial DG solution appropriate for the non-constant doping profile. For the first time run t=0, use this to give init solution (otherwise, comment out)
-				ComputeDFTofMaxwellian(U, f, DFTMaxwell);											// compute the Fourier transform of the initial Maxwellian currently stored in U and store the output in DFTMaxwell
-			}
+		}
 
 //			char old_run_path[old_run_name.size() + 6]												// declare the array old_run_path (to store Data/old_run_name)
 //        	strcpy(old_run_path, "Data/" + old_run_name.c_str());									// copy the contents of old_run_name to old_run_path and prepend Data/
 
-			fu=fopen(("Data/" + old_run_name).c_str(),"r");									 		// set fu to be a file with the name from old_run_name, stored in the directory Data, and set the file access mode of fu to r (which means the file must exist already and will be read from)
+		fu=fopen(("Data/" + old_run_name).c_str(),"r");												// set fu to be a file with the name from old_run_name, stored in the directory Data, and set the file access mode of fu to r (which means the file must exist already and will be read from)
 
-			fseek(fu ,0 ,SEEK_END);																	// find the final entry of the file fu
-			tp = ftell(fu);																			// use the final entry to determine the size of the file
+		fseek(fu ,0 ,SEEK_END);																		// find the final entry of the file fu
+		tp = ftell(fu);																				// use the final entry to determine the size of the file
 
-			//printf("tp = %d. \n", tp);															// display in the output file the value of tp
-			float NoSol = (float)tp/(size*6*sizeof(double));										// calculate the number of solutions of U that must be in the file
-			//printf("no. of set of U = %f \n", NoSol);												// display in the output file the number of solutions of U that must be in the file
+		//printf("tp = %d. \n", tp);															// display in the output file the value of tp
+		float NoSol = (float)tp/(size*6*sizeof(double));											// calculate the number of solutions of U that must be in the file
+		//printf("no. of set of U = %f \n", NoSol);												// display in the output file the number of solutions of U that must be in the file
 
-			if(tp%(size*6) != 0)																	// check that the number of elements read was a multiple of 6*size
+		if(tp%(size*6) != 0)																		// check that the number of elements read was a multiple of 6*size
+		{
+			if(myrank_mpi==0)
 			{
 				printf("Error reading file\n");														// if tp was not a multiple of 6*size then display that there was an error
-				exit(1);																			// then exit the program
-			}
-			else
-			{
-				fseek(fu, tp - size*6*sizeof(double), SEEK_SET);									// find the last solution that was printed in the file
-				fread(U,sizeof(double),size*6,fu);													// store the contents of the final solution in the file fu in U, expecting 6*size many entries of datatype double
 			}
+			exit(1);																				// then exit the program
+		}
+		else
+		{
+			fseek(fu, tp - size*6*sizeof(double) + (long)chunksize_dg*myrank_mpi*6*sizeof(double), SEEK_SET);	// find the cells of this process in the last solution that was printed in the file
+			fread(U,sizeof(double),chunksize_dg*6,fu);												// store them in U, expecting 6*chunksize_dg many entries of datatype double
+		}
+
+		fclose(fu);																					// close the file fu
 
-			fclose(fu);																				// close the file fu
+		if(LinearLandau)																			// only do this is LinearLandau is true, for using Q(f,M)
+		{
+			//SetInit_ND(U);																	// set initial DG solution appropriate for the non-constant doping profile. For the first time run t=0, use this to give init solution (otherwise, comment out)
+			FetchCollisionCells(U, U_coll);															// copy the cells of the space-steps of this process from the processes which hold them in U into U_coll
+			ComputeDFTofMaxwellian(U_coll, f, DFTMaxwell);												// compute the Fourier transform of the initial Maxwellian currently stored in U_coll and store the output in DFTMaxwell
 		}
+	}
 
+	if(myrank_mpi==0)																				// only the process with rank 0 will do this
+	{
 		grvy_check_file_path(buffer_moment);														// have GRVY check if the directory Data/ exists and, if not, create it
       
 		fmom=fopen(buffer_moment,"w");																// set fmom to be a file with the name stored in buffer_moment and set the file access mode of fmom to w (which creates an empty file and allows it to be written to)
@@ -579,42 +592,27 @@ int main()
 		fE=fopen(buffer_E,"w");																		// set fE to be a file with the name stored in buffer_E and set the file access mode of fphi to w (which creates an empty file and allows it to be written to)
 		fent=fopen(buffer_ent,"w");																	// set fent to be a file with the name stored in buffer_ent and set the file access mode of fent to w (which creates an empty file and allows it to be written to)
 
-		FindNegVals(U, fNegVals, fAvgVals);															// find out in which cells the approximate solution goes negative and record it in fNegVals
-
-		/* DEBUG TEST
-		for(int i=0;i<Nx;i++)
-		{
-			printf("i = %d: ", i);
-			for(int j1=0;j1<Nv;j1++)
-			{
-				for(int j2=0;j2<Nv;j2++)
-				{
-					for(int j3=0;j3<Nv;j3++)
-					{
-						printf("%g ", fEquiVals[5*(5*(5*(5*(i*size_v + j1*Nv*Nv+j2*Nv+j3)+2) + 2) + 2) + 2]);
-					}
-				}
-			}
-			printf("\n");
-		}
-		*/
-
 		// Print a header to introduce the output data:
 		std::cout << "#=====================================================#" << std::endl;
 		std::cout << "#                     OUTPUT DATA                     #" << std::endl;
 		std::cout << "#=====================================================#" << std::endl << std::endl;
+	}
 
-		mass=computeMass(U);																		// set mass to the value calculated through computeMass, for the solution f(x,v,t) at the current time t, using its DG coefficients stored U
-		computeMomentum(U, a);																		// calculate the momentum for the solution f(x,v,t) at the current time t, using its DG coefficients stored U, and store it in a
-		KiE=computeKiE(U);																			// set KiE to the value calculated through computeKiE, for the solution f(x,v,t) at the current time t, using its DG coefficients stored U
-		if(! Homogeneous)
-		{
-			EleE=computeEleE(U);																		// set EleE to the value calculated through computeEleE, for the solution f(x,v,t) at the current time t, using its DG coefficients stored U
-			tmp = sqrt(EleE);																			// set tmp to the square root of EleE
-		}
-		ent1 = computeEntropy(U);																	// set ent1 the value calculated through computeEntropy
-		l_ent1 = log(fabs(ent1));																	// set l_ent1 to the log of ent1
-		ll_ent1 = log(fabs(l_ent1));																// set ll_ent1 to the log of l_ent1
+	FindNegVals(U, fNegVals, fAvgVals);																// find out in which cells the approximate solution goes negative and record it in fNegVals
+
+	mass=computeMass(U);																			// set mass to the value calculated through computeMass, for the solution f(x,v,t) at the current time t, using its DG coefficients stored U
+	computeMomentum(U, a);																			// calculate the momentum for the solution f(x,v,t) at the current time t, using its DG coefficients stored U, and store it in a
+	KiE=computeKiE(U);																				// set KiE to the value calculated through computeKiE, for the solution f(x,v,t) at the current time t, using its DG coefficients stored U
+	if(! Homogeneous)
+	{
+		EleE=computeEleE(U);																			// set EleE to the value calculated through computeEleE, for the solution f(x,v,t) at the current time t, using its DG coefficients stored U
+		tmp = sqrt(EleE);																				// set tmp to the square root of EleE
+	}
+	ent1 = computeEntropy(U);																		// set ent1 the value calculated through computeEntropy
+	l_ent1 = log(fabs(ent1));																		// set l_ent1 to the log of ent1
+	ll_ent1 = log(fabs(l_ent1));																	// set ll_ent1 to the log of l_ent1
+	if(myrank_mpi==0)																				// only the process with rank 0 will do this
+	{
 		if(Homogeneous)
 		{
 			printf("step 0: %11.8g  %11.8g  %11.8g  %11.8g  %11.8g %11.8g \n",
@@ -630,8 +628,11 @@ int main()
 					mass, a[0], a[1], a[2], KiE, EleE, tmp, log(tmp), KiE+EleE);						// in the file tagged as fmom, print the initial mass, 3 components of momentum, kinetic energy, electric energy, sqrt(electric energy), log(sqrt(electric energy)) & total energy
 		}
 		fprintf(fent, "%11.8g %11.8g %11.8g \n", ent1, l_ent1, ll_ent1);							// in the file tagged as fent, print the entropy, its log and the log of that
+	}
 
-		KiEratio = computeKiEratio(U, fNegVals);													// compute the ratio of the kinetic energy where f is negative to that where it is positive and store it in KiEratio
+	KiEratio = computeKiEratio(U, fNegVals);														// compute the ratio of the kinetic energy where f is negative to that where it is positive and store it in KiEratio
+	if(myrank_mpi==0)																				// only the process with rank 0 will do this
+	{
 		printf("Kinetic Energy Ratio = %g\n", KiEratio);											// print the ratio of the kinetic energy where f is negative to that where it is positive
 
 		//fufull=fopen("Data/U_nu0.02A0.5k1.5708Nx48Lx4Nv32Lv4SpectralN24dt0.004_non_nu002_time15s.dc", "w");
@@ -646,16 +647,18 @@ int main()
 		}*/
 
 		PrintMarginalLoc(fmarg);																	// print the values of x & v1 that the marginal will be evaluated at in the file tagged as fmarg
-		PrintMarginal(U, fmarg);																	// print the marginal distribution for the initial condition, using the DG coefficients in U, in the file tagged as fmarg
+	}
+	PrintMarginal(U, fmarg);																		// print the marginal distribution for the initial condition, using the DG coefficients in U, in the file tagged as fmarg
 
-		if(! Homogeneous)
+	if(! Homogeneous)
+	{
+		if(myrank_mpi==0)
 		{
 			PrintFieldLoc(fphi, fE);																	// print the values of x that phi & E will be evaluated at in the files tagged as fphi & fE, respectively
-			PrintFieldData(U, fphi, fE);																// print the values of phi & E for the initial condition, using the DG coefficients in U, in the files tagged as fphi & fE, respectively
 		}
+		PrintFieldData(U, fphi, fE);																	// print the values of phi & E for the initial condition, using the DG coefficients in U, in the files tagged as fphi & fE, respectively
 	}
   
-	MPI_Bcast(U, size*6, MPI_DOUBLE, 0, MPI_COMM_WORLD);   											// send the contents of U, which will be 6*size entries of datatype MPI_DOUBLE, from the process with rank 0 to all processes, using the communicator MPI_COMM_WORLD
 	MPI_Barrier(MPI_COMM_WORLD);																	// set an MPI barrier to ensure that all processes have reached this point before continuing
   
 	MPIt1 = MPI_Wtime();																			// set MPIt1 to the current time in the MPI process
@@ -668,167 +671,90 @@ int main()
 
 		if(nu > 0.)
 		{
-			setInit_spectral(U, f); 																// Take the coefficient of the DG solution from the advection step, and project them onto the grid used for the spectral method to perform the collision step
+			FetchCollisionCells(U, U_coll);																// copy the cells of the space-steps of this process from the processes which hold them in U into U_coll
+			setInit_spectral(U_coll, f); 																// Take the coefficient of the DG solution from the advection step, and project them onto the grid used for the spectral method to perform the collision step
 
-			for(int l0=chunk_Nx*myrank_mpi;l0<chunk_Nx*(myrank_mpi+1) && l0<Nx;l0++) 						// divide the number of discretised space points equally over the number of MPI processes, so that each process receives a different chunk of space to work on
+			if(BatchedCollisions)
 			{
-				if(Homogeneous)
-				{
-					l = 0;
-				}
-				else
-				{
-					l = l0;
-				}
-				if(FullandLinear)																	// only do this if FullandLinear is true
-				{
-					ComputeQ_FandL(f[l%chunk_Nx], qHat, conv_weights, qHat_linear, conv_weights_linear);	// using the coefficients of the current solution stored in f (but only for the chunk of space being taken care of by the current MPI process), calculate the Fourier tranform of Q(f,f) using conv_weights for the weights in the convolution in the full part of Q & conv_weights_linear in the convolution in the linear part of Q, then store the results of each Fourier transform in qHat & qHat_linear, respectively
-					conserveMoments(qHat, qHat_linear);											// perform the explicit conservation calculation
-					RK4_FandL(f[l%chunk_Nx], l, qHat, conv_weights, qHat_linear, conv_weights_linear,
-							U, Utmp_coll);															// advance to the next time step in the collisional problem using RK4 at the given space-step l, taking the current solution stored in f (but only for the chunk of space being taken care of by the current MPI process), as well as qHat, conv_weights, qHat_linear & conv_weights_linear (to allow more Fourier transforms of Q to be made), storing the output partially in U and partially in Utmp_coll
-				}
-				else																				// otherwise, if FullandLinear is false...
+				RK4_Batched(f, conv_weights, U_coll, Utmp_coll);											// advance all of the space-steps held by the current MPI process to the next time step in the collisional problem at once, reading each row of conv_weights once for all of them in each stage of RK4, and storing the output in Utmp_coll
+			}
+			else if(ConcurrentCells)
+			{
+				RK4_Concurrent(f, conv_weights, U_coll, Utmp_coll);										// advance the space-steps held by the current MPI process to the next time step in the collisional problem, with whole space-steps given to the OpenMP threads, and store the output in Utmp_coll
+			}
+			else
+			{
+				for(int l0=chunk_Nx*grid_rank_x;l0<chunk_Nx*(grid_rank_x+1) && l0<Nx;l0++)			// divide the number of discretised space points equally over the processes along the first axis of the grid, so that each of them receives a different chunk of space to work on
 				{
-					if(LinearLandau)																// only do this is LinearLandau is true, for using Q(f,M)
+					if(Homogeneous)
 					{
-						ComputeQLinear(f[l%chunk_Nx], DFTMaxwell[l%chunk_Nx], qHat, conv_weights);	// using the coefficients of the current solution stored in f (but only for the chunk of space being taken care of by the current MPI process), calculate the Fourier tranform of Q(f,M) using conv_weights1 & conv_weights2 for the weights in the convolution, then store the results of the Fourier transform in qHat
-						conserveMoments(qHat);														// perform the explicit conservation calculation
-						RK4Linear(f[l%chunk_Nx], DFTMaxwell[l%chunk_Nx], l, qHat, conv_weights, U, Utmp_coll);		// advance to the next time step in the collisional problem using RK4 at the given space-step l, taking the current solution stored in f (but only for the chunk of space being taken care of by the current MPI process), as well as qHat, conv_weights1 & conv_weights2 (to allow more Fourier transforms of Q to be made), storing the output partially in U and partially in Utmp_coll
+						l = 0;
 					}
-					else																			// otherwise, if FullandLinear is false...
+					else
 					{
-						ComputeQ(f[l%chunk_Nx], qHat, conv_weights);								// using the coefficients of the current solution stored in f (but only for the chunk of space being taken care of by the current MPI process), calculate the Fourier tranform of Q(f,f) using conv_weights for the weights in the convolution, then store the results of the Fourier transform in qHat
-						conserveMoments(qHat);														// perform the explicit conservation calculation
-						RK4(f[l%chunk_Nx], l, qHat, conv_weights, U, Utmp_coll);					// advance to the next time step in the collisional problem using RK4 at the given space-step l, taking the current solution stored in f (but only for the chunk of space being taken care of by the current MPI process), as well as qHat & conv_weights (to allow more Fourier transforms of Q to be made), storing the output partially in U and partially in Utmp_coll
+						l = l0;
 					}
-	/*				//DEBUG CHECK:
-					double qHat_real, qHat_imag;
-					for(int j1=0;j1<N;j1++)
+					if(FullandLinear)																// only do this if FullandLinear is true
 					{
-						for(int j2=0;j2<N;j2++)
-						{
-							for(int j3=0;j3<N;j3++)
-							{
-								qHat_real = qHat[k][0];
-								qHat_imag = qHat[k][1];
-								k = j1*N*N + j2*N + j3;
-								printf("l = %d: k = %d, qHat(%d,%d,%d) = %g + %g i \n", l, k , j1, j2, j3, qHat_real, qHat_imag);
-							}
-						}
-					}
-					*/
-				}
-			}
-
-			MPI_Barrier(MPI_COMM_WORLD);															// set an MPI barrier to ensure that all processes have reached this point before continuing
-			if(myrank_mpi == 0) 																	// only the process with rank 0 will do this
-			{
-				// TRANSFER CONTENTS OF THE dU (Utmp_coll) THAT HAVE BEEN COMPUTED INTO U1 (U):
-				if(Homogeneous)
-				{
-					for(k=0;k<chunksize_dg;k++)															// cycle through all size_v (= Nv^3) many velocity-steps (which will exist for each space-step)
-					{
-						k_v = k;																	// set k_v to be the value associated with the k-th velocity-step for the l-th space-step
-						U[k_v*6+0] = Utmp_coll[k_v*5];												// set the 6*k_v-th entry of U to the 5*k_v-th entry of Utmp_coll
-						U[k_v*6+5] = Utmp_coll[k_v*5+4]; 											// set the (6*k_v + 5)-th entry of U to the (5*k_v + 4)-th entry of Utmp_coll
-						U[k_v*6+2] = Utmp_coll[k_v*5+1];  											// set the (6*k_v + 2)-th entry of U to the (5*k_v + 1)-th entry of Utmp_coll
-						U[k_v*6+3] = Utmp_coll[k_v*5+2];	 										// set the (6*k_v + 3)-th entry of U to the (5*k_v + 2)-th entry of Utmp_coll
-						U[k_v*6+4] = Utmp_coll[k_v*5+3];											// set the (6*k_v + 4)-th entry of U to the (5*k_v + 3)-th entry of Utmp_coll
+						ComputeQ_FandL(f[l%chunk_Nx], qHat, conv_weights, qHat_linear, conv_weights_linear);	// using the coefficients of the current solution stored in f (but only for the chunk of space being taken care of by the current MPI process), calculate the Fourier tranform of Q(f,f) using conv_weights for the weights in the convolution in the full part of Q & conv_weights_linear in the convolution in the linear part of Q, then store the results of each Fourier transform in qHat & qHat_linear, respectively
+						conserveMoments(qHat, qHat_linear);											// perform the explicit conservation calculation
+						RK4_FandL(f[l%chunk_Nx], l, qHat, conv_weights, qHat_linear, conv_weights_linear,
+								U_coll, Utmp_coll);														// advance to the next time step in the collisional problem using RK4 at the given space-step l, taking the current solution stored in f (but only for the chunk of space being taken care of by the current MPI process), as well as qHat, conv_weights, qHat_linear & conv_weights_linear (to allow more Fourier transforms of Q to be made), storing the output partially in U and partially in Utmp_coll
 					}
-				}
-				else
-				{
-					for(l=0;l<chunk_Nx;l++) 															// cycle through all space-steps stored in the first chunk of the space interval (which is stored on the process with rank 0)
+					else																			// otherwise, if FullandLinear is false...
 					{
-						for(k=0;k<size_v;k++)															// cycle through all size_v (= Nv^3) many velocity-steps (which will exist for each space-step)
+						if(LinearLandau)															// only do this is LinearLandau is true, for using Q(f,M)
 						{
-							k_v = l*size_v + k;															// set k_v to be the value associated with the k-th velocity-step for the l-th space-step
-							U[k_v*6+0] = Utmp_coll[k_v*5];												// set the 6*k_v-th entry of U to the 5*k_v-th entry of Utmp_coll
-							U[k_v*6+5] = Utmp_coll[k_v*5+4]; 											// set the (6*k_v + 5)-th entry of U to the (5*k_v + 4)-th entry of Utmp_coll
-							U[k_v*6+2] = Utmp_coll[k_v*5+1];  											// set the (6*k_v + 2)-th entry of U to the (5*k_v + 1)-th entry of Utmp_coll
-							U[k_v*6+3] = Utmp_coll[k_v*5+2];	 										// set the (6*k_v + 3)-th entry of U to the (5*k_v + 2)-th entry of Utmp_coll
-							U[k_v*6+4] = Utmp_coll[k_v*5+3];											// set the (6*k_v + 4)-th entry of U to the (5*k_v + 3)-th entry of Utmp_coll
+							ComputeQLinear(f[l%chunk_Nx], DFTMaxwell[l%chunk_Nx], qHat, conv_weights);	// using the coefficients of the current solution stored in f (but only for the chunk of space being taken care of by the current MPI process), calculate the Fourier tranform of Q(f,M) using conv_weights for the weights in the convolution, then store the results of the Fourier transform in qHat
+							conserveMoments(qHat);													// perform the explicit conservation calculation
+							RK4Linear(f[l%chunk_Nx], DFTMaxwell[l%chunk_Nx], l, qHat, conv_weights, U_coll, Utmp_coll);	// advance to the next time step in the collisional problem using RK4 at the given space-step l, taking the current solution stored in f (but only for the chunk of space being taken care of by the current MPI process), as well as qHat & conv_weights (to allow more Fourier transforms of Q to be made), storing the output partially in U and partially in Utmp_coll
 						}
-					}
-				}
-				// RECEIVE FROM ALL OTHER PROCESSES CONSECUTIVELY TO ENSURE THE WEIGHTS ARE STORED IN THE FILE U CONSECUTIVELY:
-				for(i=1;i<nprocs_Nx;i++)															// store the DG coefficients of the current solution in U that were calculated by the remaining processes (with ranks i = 1, 2, ..., nprocs_Nx-1) for their corresponding chunk of space
-				{
-					if(Homogeneous)
-					{
-						MPI_Recv(output_buffer, chunksize_dg*5, MPI_DOUBLE, i, i,
-								MPI_COMM_WORLD, &status);											 	// receive a message of 5*chunk_Nx_size_v entries of datatype MPI_DOUBLE from the process with rank i (storing the i-th space chunk of U, containing the DG coefficients calculate on the processor with corresponding rank), storing the data in output_buffer, with tag i in the communicator MPI_COMM_WORLD, storing the status of the receive in status
-						for(int k_loc=0;k_loc<chunksize_dg;k_loc++)													// cycle through all size_v (= Nv^3) many velocity-steps (which will exist for each space-step)
+						else																		// otherwise, if FullandLinear is false...
 						{
-							k_v = chunksize_dg*i + k_loc; 															// set k_v to be the value associated with the k-th velocity-step for the (chunk_Nx*i + l)-th space-step (which is the l-th space-step in the current chunk)
-							// Store contents of the receive buffer in the correct portion of U to add this part of the solution
-							U[k_v*6+0] = output_buffer[k_loc*5];								// set the 6*k_v-th entry of U to the 5*k_local-th entry of Utmp_coll
-							U[k_v*6+5] = output_buffer[k_loc*5+4];							// set the (6*k_v + 5)-th entry of U to the (5*k_local + 4)-th entry of Utmp_coll
-							U[k_v*6+2] = output_buffer[k_loc*5+1];  							// set the (6*k_v + 2)-th entry of U to the (5*k_local + 1)-th entry of Utmp_coll
-							U[k_v*6+3] = output_buffer[k_loc*5+2];	 						// set the (6*k_v + 3)-th entry of U to the (5*k_local + 2)-th entry of Utmp_coll
-							U[k_v*6+4] = output_buffer[k_loc*5+3];							// set the (6*k_v + 4)-th entry of U to the (5*k_local + 3)-th entry of Utmp_coll
+							ComputeQ(f[l%chunk_Nx], qHat, conv_weights);							// using the coefficients of the current solution stored in f (but only for the chunk of space being taken care of by the current MPI process), calculate the Fourier tranform of Q(f,f) using conv_weights for the weights in the convolution, then store the results of the Fourier transform in qHat
+							conserveMoments(qHat);													// perform the explicit conservation calculation
+							RK4(f[l%chunk_Nx], l, qHat, conv_weights, U_coll, Utmp_coll);				// advance to the next time step in the collisional problem using RK4 at the given space-step l, taking the current solution stored in f (but only for the chunk of space being taken care of by the current MPI process), as well as qHat & conv_weights (to allow more Fourier transforms of Q to be made), storing the output partially in U and partially in Utmp_coll
 						}
-					}
-					else
-					{
-						MPI_Recv(output_buffer, chunk_Nx*size_v*5, MPI_DOUBLE, i, i,
-								MPI_COMM_WORLD, &status);											 	// receive a message of 5*chunk_Nx_size_v entries of datatype MPI_DOUBLE from the process with rank i (storing the i-th space chunk of U, containing the DG coefficients calculate on the processor with corresponding rank), storing the data in output_buffer, with tag i in the communicator MPI_COMM_WORLD, storing the status of the receive in status
-						for(l=0;l<chunk_Nx;l++)															// cycle through all space-steps stored in the chunk of the space interval dealt with by the i-th process
+		/*				//DEBUG CHECK:
+						double qHat_real, qHat_imag;
+						for(int j1=0;j1<N;j1++)
 						{
-							if((chunk_Nx*i+l)<Nx)														// ensure that the space-step being dealt with exists
+							for(int j2=0;j2<N;j2++)
 							{
-								for(k=0;k<size_v;k++)													// cycle through all size_v (= Nv^3) many velocity-steps (which will exist for each space-step)
+								for(int j3=0;j3<N;j3++)
 								{
-									k_v = (chunk_Nx*i+l)*size_v + k; 									// set k_v to be the value associated with the k-th velocity-step for the (chunk_Nx*i + l)-th space-step (which is the l-th space-step in the current chunk)
-									k_local = l*size_v + k;												// set k_local to be the value associated with the k-th veolcity-step for the l-th local space step (which is the current one, as indicated in the previous line)
-
-									// STORE CONTENTS OF THE RECEIVE BUFFER IN THE CORRECT PORTION OF U TO ADD THIS PART OF THE SOLUTION:
-									U[k_v*6+0] = output_buffer[k_local*5];								// set the 6*k_v-th entry of U to the 5*k_local-th entry of Utmp_coll
-									U[k_v*6+5] = output_buffer[k_local*5+4];							// set the (6*k_v + 5)-th entry of U to the (5*k_local + 4)-th entry of Utmp_coll
-									U[k_v*6+2] = output_buffer[k_local*5+1];  							// set the (6*k_v + 2)-th entry of U to the (5*k_local + 1)-th entry of Utmp_coll
-									U[k_v*6+3] = output_buffer[k_local*5+2];	 						// set the (6*k_v + 3)-th entry of U to the (5*k_local + 2)-th entry of Utmp_coll
-									U[k_v*6+4] = output_buffer[k_local*5+3];							// set the (6*k_v + 4)-th entry of U to the (5*k_local + 3)-th entry of Utmp_coll
+									qHat_real = qHat[k][0];
+									qHat_imag = qHat[k][1];
+									k = j1*N*N + j2*N + j3;
+									printf("l = %d: k = %d, qHat(%d,%d,%d) = %g + %g i \n", l, k , j1, j2, j3, qHat_real, qHat_imag);
 								}
 							}
 						}
+						*/
 					}
 				}
 			}
-			else 																					// the remaining processes, with rank 1, 2, ..., nprocs_Nx-1 will do this
-			{
-				if(myrank_mpi<nprocs_Nx)
-				{
-					if(Homogeneous)
-					{
-						MPI_Send(Utmp_coll, chunksize_dg*5, MPI_DOUBLE, 0, myrank_mpi,
-								MPI_COMM_WORLD);														// send the contents of Utmp_coll, which will be 5*chunk_Nx*size_v entries of datatype MPI_DOUBLE, to the process with rank 0, tagged with the rank of the current process, via the MPI_COMM_WORLD communicator
-					}
-					else
-					{
-						MPI_Send(Utmp_coll, chunk_Nx*size_v*5, MPI_DOUBLE, 0, myrank_mpi,
-								MPI_COMM_WORLD);														// send the contents of Utmp_coll, which will be 5*chunk_Nx*size_v entries of datatype MPI_DOUBLE, to the process with rank 0, tagged with the rank of the current process, via the MPI_COMM_WORLD communicator
-					}
-				}
-			}
-		    MPI_Bcast(U, size*6, MPI_DOUBLE, 0, MPI_COMM_WORLD);    								// send the contents of U, from the process with rank 0, which contains 6*size entries of datatype MPI_DOUBLE, to all processes via the communicator MPI_COMM_WORLD (so that all processes have the coefficients of the DG approximation to f at the current time-step for the start of the next calculation)
+
+			GatherProjectedCells(Utmp_coll);														// collect the velocity cells updated by each process holding the same space-steps onto the first of them (only when the modes are shared out)
+			ScatterCollisionStep(Utmp_coll, U);														// copy the DG coefficients updated by every process from Utmp_coll into U on the processes which hold those cells
 		}
    
 		MPI_Barrier(MPI_COMM_WORLD);
+		FindNegVals(U, fNegVals, fAvgVals);																	// find out in which cells the approximate solution goes negative and record it in fNegVals
+
+		mass=computeMass(U);																		// set mass to the value calculated through computeMass, for the solution f(x,v,t) at the current time t, using its DG coefficients stored U
+		computeMomentum(U, a);																		// calculate the momentum for the solution f(x,v,t) at the current time t, using its DG coefficients stored U, and store it in a
+		KiE=computeKiE(U);																			// set KiE to the value calculated through computeKiE, for the solution f(x,v,t) at the current time t, using its DG coefficients stored U
+		if(! Homogeneous)
+		{
+			EleE=computeEleE(U);																			// set EleE to the value calculated through computeEleE, for the solution f(x,v,t) at the current time t, using its DG coefficients stored U
+			tmp = sqrt(EleE);																				// set tmp to the square root of EleE
+		}
+		ent1 = computeEntropy(U);																		// set ent1 the value calculated through computeEntropy
+		l_ent1 = log(fabs(ent1));																		// set l_ent1 to the log of ent1
+		ll_ent1 = log(fabs(l_ent1));																	// set ll_ent1 to the log of l_ent1
 		if(myrank_mpi==0)																			// only the process with rank 0 will do this
 		{
-			FindNegVals(U, fNegVals, fAvgVals);																// find out in which cells the approximate solution goes negative and record it in fNegVals
-
-			mass=computeMass(U);																	// set mass to the value calculated through computeMass, for the solution f(x,v,t) at the current time t, using its DG coefficients stored U
-			computeMomentum(U, a);																	// calculate the momentum for the solution f(x,v,t) at the current time t, using its DG coefficients stored U, and store it in a
-			KiE=computeKiE(U);																		// set KiE to the value calculated through computeKiE, for the solution f(x,v,t) at the current time t, using its DG coefficients stored U
-			if(! Homogeneous)
-			{
-				EleE=computeEleE(U);																		// set EleE to the value calculated through computeEleE, for the solution f(x,v,t) at the current time t, using its DG coefficients stored U
-				tmp = sqrt(EleE);																			// set tmp to the square root of EleE
-			}
-			ent1 = computeEntropy(U);																	// set ent1 the value calculated through computeEntropy
-			l_ent1 = log(fabs(ent1));																	// set l_ent1 to the log of ent1
-			ll_ent1 = log(fabs(l_ent1));																// set ll_ent1 to the log of l_ent1
 			if(Homogeneous)
 			{
 				printf("step %d: %11.8g  %11.8g  %11.8g  %11.8g  %11.8g %11.8g \n",
@@ -844,8 +770,11 @@ int main()
 						mass, a[0], a[1], a[2], KiE, EleE, tmp, log(tmp), KiE+EleE);						// in the file tagged as fmom, print the initial mass, 3 components of momentum, kinetic energy, electric energy, sqrt(electric energy), log(sqrt(electric energy)) & total energy
 			}
 			fprintf(fent, "%11.8g %11.8g %11.8g \n", ent1, l_ent1, ll_ent1);						// in the file tagged as fent, print the entropy, its log and the log of that
+		}
 
-			KiEratio = computeKiEratio(U, fNegVals);												// compute the ratio of the kinetic energy where f is negative to that where it is positive and store it in KiEratio
+		KiEratio = computeKiEratio(U, fNegVals);													// compute the ratio of the kinetic energy where f is negative to that where it is positive and store it in KiEratio
+		if(myrank_mpi==0)																			// only the process with rank 0 will do this
+		{
 			printf("Kinetic Energy Ratio = %g\n", KiEratio);										// print the ratio of the kinetic energy where f is negative to that where it is positive
 
 			//fprintf(fmom, "%11.8g  %11.8g\n", EleE, log(tmp));
@@ -862,16 +791,15 @@ int main()
 					  fprintf(fufull,"\n\n");
 				  }
 			  }*/
-      
+		}
 
 	    	//if(t%400==0)fwrite(U,sizeof(double),size*6,fu);
-			if(t%20==0)		// DEGUG CHECK: PRINTING MARGINALS EVERY STEP INSTEAD OF EVERY 20
+		if(t%20==0)			// DEGUG CHECK: PRINTING MARGINALS EVERY STEP INSTEAD OF EVERY 20
+		{
+			PrintMarginal(U, fmarg);																// print the marginal distribution, using the DG coefficients in U, in the file tagged as fmarg
+			if(! Homogeneous)
 			{
-				PrintMarginal(U, fmarg);															// print the marginal distribution, using the DG coefficients in U, in the file tagged as fmarg
-				if(! Homogeneous)
-				{
-					PrintFieldData(U, fphi, fE);														// print the values of phi & E, using the DG coefficients in U, in the files tagged as fphi & fE, respectively
-				}
+				PrintFieldData(U, fphi, fE);															// print the values of phi & E, using the DG coefficients in U, in the files tagged as fphi & fE, respectively
 			}
 		}
 	
@@ -893,11 +821,20 @@ int main()
 		std::cout << std::endl;
 		std::cout << "#----------END OF INPUT FILE DUMP AND PROGRAM---------#" << std::endl << std::endl;
 
-		fwrite(U,sizeof(double),size*6,fu);															// write the coefficients of the DG approximation at the end, stored in U, which is 6*size entires, each of the size of a double datatype, in the file tagged as fu
+		fwrite(U,sizeof(double),chunksize_dg*6,fu);													// write the coefficients of the DG approximation at the end in the cells of this process, stored in U, which is 6*chunksize_dg entries, each of the size of a double datatype, in the file tagged as fu
+		for(int r=1;r<nprocs_mpi;r++)
+		{
+			MPI_Recv(Utmp, chunksize_dg*6, MPI_DOUBLE, r, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);	// receive the coefficients of the cells of the process r in Utmp
+			fwrite(Utmp,sizeof(double),chunksize_dg*6,fu);											// and write them after those of the processes before it, so that fu holds all 6*size coefficients in order
+		}
 		//PrintPhiVals(U, fphi);																	// print the values of the potential in the file tagged as filephi at the given timestep
 	
 		fclose(fu);  																				// remove the tag fu to close the file
 	}
+	else
+	{
+		MPI_Send(U, chunksize_dg*6, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD);								// send the coefficients of the cells of this process to the process with rank 0, to be written in fu
+	}
 	MPI_Barrier(MPI_COMM_WORLD);																	// set an MPI barrier to ensure that all processes have reached this point before continuing
   
 	if(myrank_mpi==0)																				// only the process with rank 0 will do this
@@ -910,6 +847,9 @@ int main()
 	}
 	if(nu > 0.)
 	{
+		FreeFFTShifts();																			// delete the tables of the factors which shift the FFTs
+		FreeModeSchedule();																			// delete the running total of the costs of the modes
+		FreeCollisionWorkspaces();																	// delete the workspaces of the threads & the partial sums of the projection onto the DG basis
 		free(v); free(eta); free(wtN); 																// delete the dynamic memory allocated for v, eta & wtN
 		if(MassConsOnly)																			// only do this if MassConsOnly is true and only conserving mass
 		{
@@ -919,34 +859,60 @@ int main()
 		{
 			free(C1_5); free(C2);																	// delete the dynamic memory allocated for C1_5 & C2
 		}
-		free(f); free(conv_weights); free(output_buffer); 											// delete the dynamic memory allocated for f, conv_weights, output_buffer
+		free(f);																					// delete the dynamic memory allocated for f
 		fftw_free(temp); fftw_free(qHat);															// delete the dynamic memory allocated for temp & qhat
-		free(conv_weights1); free(conv_weights2); 													// delete the dynamic memory allocated for conv_weights1 & conv_weights2
-		fftw_free(Q1_fft); fftw_free(Q2_fft); fftw_free(Q3_fft); fftw_free(fftOut); fftw_free(fftIn); // delete the dynamic memory allocated for Q1_fft, Q2_fft, Q3_fft, fftOut & fftIn
-		free(Q);free(f1);free(Q1); free(Utmp_coll);// free(f2); free(f3);//free(Q3);				// delete the dynamic memory allocated for Q, f1, Q1 & Utmp_coll
+		if(FloatWeights)
+		{
+			FreeFloatWeights();																		// print the moment drift of the float weights next to that of the double weights (if CompareFloatWeights is true)
+		}
+		FreeWeightTables();																			// delete the tables of convolution weights (or unmap their weight stores)
+		fftw_free(Q1_fft); fftw_free(Q2_fft); fftw_free(Q3_fft); fftw_free(fftOut); // delete the dynamic memory allocated for Q1_fft, Q2_fft, Q3_fft & fftOut
+		free(Q);free(f1);free(Q1); free(U_coll); free(Utmp_coll);// free(f2); free(f3);//free(Q3);	// delete the dynamic memory allocated for Q, f1, Q1, U_coll & Utmp_coll
 		if(FullandLinear)																			// only do this if FullandLinear is true
 		{
 			fftw_free(qHat_linear); fftw_free(Q1_fft_linear); 										// delete the dynamic memory allocated for qHat_linear & Q1_fft_linear
 			fftw_free(Q2_fft_linear); fftw_free(Q3_fft_linear); 									// delete the dynamic memory allocated for Q2_fft_linear & Q3_fft_linear
-			free(conv_weights_linear);																// delete the dynamic memory allocated for conv_weights_linear
 
 		}
+		if(collision_engine == ENGINE_MATRIXFREE)
+		{
+			FreeMatrixFreeTables();																	// delete the tables of S-hat(w) used by the matrix-free collision engine
+		}
+		else if(collision_engine == ENGINE_FFT)
+		{
+			FreeFFTCollision();																		// delete the tables & plans used by the FFT collision engine
+		}
+		else if(collision_engine == ENGINE_LOWRANK)
+		{
+			FreeLowRankCollision();																	// delete the factorisations used by the low-rank collision engine
+		}
+		else if(direct_kernel != KERNEL_SCALAR)
+		{
+			FreeSIMDCollision();																	// delete the split-complex streams used by the vectorised kernels
+		}
+		FreeDGProjection();																			// delete the tables used to project the spectra onto the DG basis
+		if(BatchedCollisions)
+		{
+			FreeBatchedCollision();																	// delete the spectra & stages of RK4 used by the batched collision step
+		}
 		if(LinearLandau)																			// only do this is LinearLandau is true, for using Q(f,M)
 		{
 			fftw_free(DFTMaxwell);																	// delete the dynamic memory allocated for DFTMaxwell
 		}
 	}
-	free(output_buffer_vp);																			// delete the dynamic memory allocated for output_buffer_vp
 	free(U); free(U1); free(Utmp); // free(H);														// delete the dynamic memory allocated for U, U1 & Utmp
 	if(! Homogeneous)
 	{
 		free(cp); free(intE); free(intE1); free(intE2);													// delete the dynamic memory allocated for cp, intE, intE1 & inteE2
 	}
 
-	free(fNegVals); free(fAvgVals);	free (fEquiVals);												// delete the dynamic memory allocated for fNegVals, fAvgVals & fEquiVals
+	free(fNegVals); free(fAvgVals);																	// delete the dynamic memory allocated for fNegVals & fAvgVals
   
 	iparse.Close();																					// close the input file
 
+	FreeProcessGrid();																				// free the communicators & datatypes of the grid of processes
 	MPI_Finalize();																					// ensure that MPI exits cleanly
 	return 0;																						// return 0, since main is of type int (and this shows the program completed correctly)
 }
+
+#endif /* !WEIGHT_GENERATOR && !COLLISION_BENCHMARK */
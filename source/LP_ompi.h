@@ -41,6 +41,16 @@ using namespace GRVY;
 //         MACROS         //
 //************************//
 
+#define ENGINE_DIRECT 0																				// collision engine which reads the convolution weights from the precomputed tables in conv_weights (CollisionEngine = Direct)
+#define ENGINE_MATRIXFREE 1																			// collision engine which evaluates the convolution weights as they are needed from small per-w tables (CollisionEngine = MatrixFree)
+#define ENGINE_FFT 2																				// collision engine which evaluates the convolutions with FFTs of the separable terms of the convolution weights (CollisionEngine = FFT)
+#define ENGINE_LOWRANK 3																			// collision engine which applies a low-rank factorisation of the convolution weights found by adaptive cross approximation (CollisionEngine = LowRank)
+#define KERNEL_SCALAR 0																				// quadrature sums of the Direct engine computed with the original loops over interleaved complex numbers (DirectKernel = Scalar)
+#define KERNEL_SPLIT 1																				// quadrature sums of the Direct engine computed with a portable loop over split-complex streams (DirectKernel = Split)
+#define KERNEL_AVX2 2																				// quadrature sums of the Direct engine computed over split-complex streams with AVX2 & FMA intrinsics (DirectKernel = AVX2)
+#define KERNEL_AVX512 3																				// quadrature sums of the Direct engine computed over split-complex streams with AVX-512 intrinsics (DirectKernel = AVX512)
+#define KERNEL_AUTO 4																				// use the fastest of the split-complex kernels supported by the processor (DirectKernel = Auto)
+
 //************************//
 //   EXTERNAL VARIABLES   //
 //************************//
@@ -70,14 +80,14 @@ extern double CCt[5*5], lamb[5];																	// declare matrices CCt (C*C^T,
 extern double CCt_linear[2*2], lamb_linear[2];														// declare the arrays CCt_linear (C*C^T, for the conservation matrix C, in the two species collision operator) & lamb_linear (to hold 2 values)
 extern int M;																						// declare M (the number of collision invarients)
 
-extern double *U1, *Utmp, *output_buffer_vp;//, **H;												// declare pointers to U1, Utmp (both used to help store the values in U, declared later) & output_buffer_vp (a buffer used when sending the data between MPI processes during the VP method)
-extern double *Q, *f1, *Q1, *Utmp_coll;//*f2, *f3;													// declare pointers to Q (the discretised collision operator), f1 (used to help store the solution during the collisional problem), Q1 (used in calculation of the collision operator) & Utmp_coll (used to store calculations from the RK4 method used in the collisional problem)
+extern double *U1, *Utmp;//, **H;																	// declare pointers to U1 (the cells of this process, with the ghost cells either side of them, in each stage of RK3) & Utmp (used to help store the values in U, declared later)
+extern double *Q, *f1, *Q1, *U_coll, *Utmp_coll;//*f2, *f3;											// declare pointers to Q (the discretised collision operator), f1 (used to help store the solution during the collisional problem), Q1 (used in calculation of the collision operator), U_coll (the cells of U needed by this process in the collisional problem, see FetchCollisionCells) & Utmp_coll (used to store calculations from the RK4 method used in the collisional problem)
 extern fftw_complex *Q1_fft, *Q2_fft, *Q3_fft;														// declare pointers to the complex numbers Q1_fft, Q2_fft & Q3_fft (involved in storing the FFT of Q)
 
 // FullandLinear variables:
 extern fftw_complex *Q1_fft_linear, *Q2_fft_linear, *Q3_fft_linear;									// declare pointers to the complex numbers Q1_fft_linear, Q2_fft_linear & Q3_fft_linear (involved in storing the FFT of the two species collison operator Q)
 
-extern fftw_complex *fftIn, *fftOut;																// declare pointers to the FFT variables fftIn (a vector to be to have the FFT applied to it) & fftOut (the output of an FFT)
+extern fftw_complex *fftOut;																		// declare a pointer to the FFT variable fftOut (the output of an FFT)
 
 extern double ce, *cp, *intE, *intE1, *intE2;														// declare ce and pointers to cp, intE, intE1 & intE2 (precomputed quantities for advections)
 
@@ -87,10 +97,11 @@ extern fftw_complex *temp;																			// declare a pointer to complex num
 
 extern int myrank_mpi, nprocs_mpi, nprocs_Nx;														// declare myrank_mpi (the rank of the current MPI process running), nprocs_mpi (the total number of MPI processes) & nprocs_Nx (the amount of MPI processes used for the collisionless VP problem)
 extern int chunksize_dg, chunksize_ft, chunk_Nx;													// declare chunksize_dg (the amount of data each processes works on during the DG method in the VP problem), chunksize_ft (the amount of data each process works on during the collisional problem) & chunk_Nx (the number of space-steps sent to each process in the collisional problem)
+extern int nprocs_modes, grid_rank_x, grid_rank_modes, chunk_kt;									// declare nprocs_modes (the number of processes holding each space-step, between which the modes of the collision operator are shared), grid_rank_x & grid_rank_modes (the coordinates of the current process in the grid of processes of ProcessGrid.cpp) & chunk_kt (the number of velocity cells each process updates in the last step of RK4)
+extern MPI_Comm comm_modes;																			// declare comm_modes (the communicator of the processes holding the same space-steps)
 
 extern int *fNegVals;																				// declare fNegVals (to store where DG solution goes negative - a 1 if negative and a 0 if positive)
 extern double *fAvgVals;																			// declare fAvgVals (to store the average values of f on each cell)
-extern double *fEquiVals;																			// declare f_equivals (to store the equilibrium solution)
 
 extern bool Damping, TwoStream, FourHump, TwoHump, Doping;											// declare Boolean variables which will determin the ICs for the problem
 extern bool First, Second;																			// declare Boolean variables which will determine if this is the first or a subsequent run
@@ -98,6 +109,26 @@ extern bool Homogeneous;																			// declare a Boolean variable to dete
 extern bool FullandLinear;																			// declare a Boolean variable to determine if running with a mixture
 extern bool LinearLandau;																			// declare a Boolean variable to determine if running with the full collision operator or linear collisions with a Maxwellian
 extern bool MassConsOnly;																			// declare a Boolean variable to determine if conserving all moments or all mass
+extern bool UseWeightStore, VerifyWeightStore;														// declare Boolean variables to determine if the convolution weights are mapped from a weight store on disk & if its checksum is verified when it is loaded
+extern bool SharedWeights;																			// declare a Boolean variable to determine if the tables of convolution weights computed in memory are shared by the processes of each node
+extern int collision_engine;																		// declare collision_engine (which of the ENGINE_ macros is used to evaluate the collision operator)
+extern int direct_kernel;																			// declare direct_kernel (which of the KERNEL_ macros is used for the quadrature sums of the Direct collision engine)
+extern bool FloatWeights, CompareFloatWeights;														// declare Boolean variables to determine if the convolution weights are stored as floats & if the moment drift this causes is compared with the double weights
+extern bool PackedWeights, PackedHugePages;															// declare Boolean variables to determine if only the entries of the convolution weights inside the convolution windows are stored, packed & scaled by the quadrature weights, & if they are placed on transparent huge pages
+extern bool SymmetricWeights;																		// declare a Boolean variable to determine if only one convolution weight is stored for each orbit of the octahedral symmetry of the kernel
+extern bool BatchedCollisions;																		// declare a Boolean variable to determine if the collision step of the space inhomogeneous problem is batched over all of the space-steps held by each process
+extern bool BatchedFFTs;																			// declare a Boolean variable to determine if the FFTs of the batched collision step are taken for all of the space-steps held by each process at once
+extern bool ConcurrentCells;																		// declare a Boolean variable to determine if the space-steps held by each process are shared out between the OpenMP threads in the collision step, each with its own workspace
+extern bool ProjectionGEMM;																			// declare a Boolean variable to determine if the increments of RK4 are projected onto the DG basis by one matrix product with a precomputed dense operator
+extern double projection_memory;																	// declare projection_memory (the most memory, in MB, the dense projection operator may use on each process)
+extern int mode_processes;																			// declare mode_processes (the number of processes the modes of each space-step are shared between, as read from the input file, or 0 to choose it from the number of processes)
+extern bool CheckCollisionEngine;																	// declare CheckCollisionEngine (a flag to compare the first collision step of the chosen engine with the direct sum)
+extern double lowrank_tol;																			// declare lowrank_tol (the relative tolerance to which the low-rank collision engine approximates the convolution weights)
+extern int lowrank_max_rank;																		// declare lowrank_max_rank (the largest rank the low-rank collision engine may use, or 0 for no limit)
+extern std::string weight_store_dir;																// declare weight_store_dir (the directory where the weight stores are kept)
+extern unsigned fft_planner;																		// declare fft_planner (the flag, FFTW_ESTIMATE, FFTW_MEASURE or FFTW_PATIENT, with which every FFT is planned)
+extern bool UseWisdom;																				// declare a Boolean variable to determine if the wisdom of fftw3 is imported from wisdom_file before planning the FFTs & exported to it afterwards
+extern std::string wisdom_file;																		// declare wisdom_file (the file where the wisdom of fftw3 is kept)
 
 //************************//
 //        INCLUDES        //
@@ -114,5 +145,21 @@ extern bool MassConsOnly;																			// declare a Boolean variable to det
 #include "NegativityChecks.h"																		// allows computeCellAvg, FindNegVals & CheckNegVals to be used
 #include "FieldCalculations.h"																		// allows PrintPhiVals to be used
 #include "InputParsing.h"																			// allows
+#include "WeightStore.h"																			// allows AttachWeightStore & GenerateWeightStore to be used
+#include "MatrixFreeCollision.h"																	// allows InitMatrixFreeTables & the matrix-free ComputeQ routines to be used
+#include "FFTCollision.h"																			// allows InitFFTCollision & the FFT-based ComputeQ routines to be used
+#include "LowRankCollision.h"																		// allows InitLowRankCollision & the low-rank ComputeQ routines to be used
+#include "SIMDCollision.h"																			// allows InitSIMDCollision & the vectorised ComputeQ routines of the Direct engine to be used
+#include "FloatWeightCollision.h"																	// allows InitFloatWeights & the ComputeQ routines which read the weights stored as floats to be used
+#include "PackedWeightCollision.h"																	// allows InitPackedWeights & the ComputeQ routines which read the packed weights to be used
+#include "ModeSchedule.h"																			// allows the modes of the quadrature sums to be shared out between the threads (and the processes holding the same space-steps) by their cost
+#include "SymmetricWeightCollision.h"																// allows InitSymmetricWeights & the ComputeQ routines which read the tables with one weight per orbit to be used
+#include "BatchedCollision.h"																		// allows InitBatchedCollision & RK4_Batched to be used
+#include "CollisionWorkspace.h"																	// allows InitCollisionWorkspaces, CurrentCollisionWorkspace & RK4_Concurrent to be used
+#include "FFTWisdom.h"																				// allows LoadFFTWisdom, ShareFFTWisdom & SaveFFTWisdom to be used
+#include "WeightTables.h"																			// allows SetupOperatorWeights, GetWeightTable & FreeWeightTables to be used
+#include "DGProjection.h"																			// allows InitDGProjection & the projection of the stages of RK4 onto the DG basis to be used
+#include "ProcessGrid.h"																			// allows InitProcessGrid, GatherProjectedCells, FetchCollisionCells & ScatterCollisionStep to be used
+#include "CollisionCheck.h"																	// allows InitCollisionCheck & the checks of the collision step against ComputeQ_Direct to be used
 
 #endif /* LP_OMPI_H_ */
@@ -0,0 +1,370 @@
+/* This is the source file which contains the subroutines for the low-rank collision engine
+ * (CollisionEngine = LowRank), which replaces the size_ft x size_ft matrix of convolution weights
+ * by a factorisation
+ *
+ *   conv_weights[ki][kw] ~ sum_{r < rank} U_r(ki) V_r(kw),
+ *
+ * found by adaptive cross approximation (ACA) with partial pivoting, so that only O(rank) rows and
+ * columns of gHat3 (or gHat3_linear) are ever evaluated.  The rank is increased until the norm of
+ * the latest term falls below LowRankTol times the norm of the whole approximation (or LowRankMaxRank
+ * is reached), and the achieved rank & error against gHat3 are reported.  This works for any
+ * gamma.  For each w, gHat3 & gHat3_linear are quadratic polynomials in zeta, so the rank needed is
+ * never more than 10 and the factorisation is exact up to rounding once it has converged.
+ *
+ * ComputeQ then needs, for each ki, one windowed sum over w of V_r(w)*gHat(w)*fHat(ki-w) for each
+ * r, which takes O(rank*N^3*window) operations instead of O(N^6).
+ *
+ * Functions included: InitLowRankCollision, FreeLowRankCollision, ComputeQ_LowRank,
+ * ComputeQ_FandL_LowRank, ComputeQLinear_LowRank
+ *
+ */
+
+#include "LowRankCollision.h"																		// LowRankCollision.h is where the prototypes for the functions contained in this file are declared
+
+struct LowRankFactors																				// a factorisation of a matrix of convolution weights
+{
+	int rank;																						// the number of terms in the factorisation
+	double *U;																						// the values U_r(ki), stored as U[r + rank*ki]
+	double *V;																						// the values V_r(kw) multiplied by the quadrature weight at w (and by scale3 for the linear weights), stored as V[r + rank*kw]
+};
+
+LowRankFactors lowrank_weights, lowrank_weights_linear;												// declare the factorisations of the gHat3 weights for the chosen gamma & of the gHat3_linear weights
+bool lowrank_engine_checked;																		// declare lowrank_engine_checked (set once the low-rank engine has been compared with the direct sum)
+
+static double WeightEntry(int ki, int kw, int gamma, int variant)									// Function to evaluate the entry conv_weights[ki][kw] (or conv_weights_linear[ki][kw] if variant is WEIGHTS_LINEAR)
+{
+	int i = ki/(N*N), j = (ki/N)%N, k = ki%N;
+	int l = kw/(N*N), m = (kw/N)%N, n = kw%N;
+
+	if(variant == WEIGHTS_LINEAR)
+	{
+		return gHat3_linear(eta[i], eta[j], eta[k], eta[l], eta[m], eta[n]);
+	}
+	return gHat3(eta[i], eta[j], eta[k], eta[l], eta[m], eta[n], gamma);
+}
+
+static int CompressWeights(int gamma, int variant, double **U_cols, double **V_rows)				// Function to build the ACA factorisation of the weights for the given kernel variant, storing U_r in (*U_cols)[r*size_ft + ki] & V_r in (*V_rows)[r*size_ft + kw] and returning the rank
+{
+	int rank = 0, capacity = 0, max_rank, ki, kw, r, i_piv, j_piv;
+	double *row, *col, *u, *v, norm2 = 0., uu, vv, uv_cross, piv, best;
+	bool *row_used;
+
+	max_rank = (lowrank_max_rank > 0 && lowrank_max_rank < size_ft) ? lowrank_max_rank : size_ft;
+	row = (double *)malloc(size_ft*sizeof(double));
+	col = (double *)malloc(size_ft*sizeof(double));
+	row_used = (bool *)calloc(size_ft, sizeof(bool));
+	*U_cols = NULL;
+	*V_rows = NULL;
+
+	i_piv = 0;
+	while(rank < max_rank)
+	{
+		// Find the residual of the row i_piv and its largest entry:
+		row_used[i_piv] = true;
+		#pragma omp parallel for private(kw,r)
+		for(kw=0;kw<size_ft;kw++)
+		{
+			row[kw] = WeightEntry(i_piv, kw, gamma, variant);
+			for(r=0;r<rank;r++)
+			{
+				row[kw] -= (*U_cols)[(long)r*size_ft + i_piv]*(*V_rows)[(long)r*size_ft + kw];
+			}
+		}
+		j_piv = 0;
+		for(kw=1;kw<size_ft;kw++)
+		{
+			if(fabs(row[kw]) > fabs(row[j_piv])) j_piv = kw;
+		}
+		piv = row[j_piv];
+
+		if(fabs(piv) <= lowrank_tol*sqrt(norm2) || piv == 0.)										// this row is already approximated, so try the next one which has not been used
+		{
+			for(ki=0;ki<size_ft && row_used[ki];ki++);
+			if(ki == size_ft) break;
+			i_piv = ki;
+			continue;
+		}
+
+		// Add the cross through (i_piv, j_piv) as the next term:
+		if(rank == capacity)
+		{
+			capacity += LOWRANK_RANK_BLOCK;
+			*U_cols = (double *)realloc(*U_cols, (long)capacity*size_ft*sizeof(double));
+			*V_rows = (double *)realloc(*V_rows, (long)capacity*size_ft*sizeof(double));
+		}
+		u = *U_cols + (long)rank*size_ft;
+		v = *V_rows + (long)rank*size_ft;
+		#pragma omp parallel for private(ki,r)
+		for(ki=0;ki<size_ft;ki++)
+		{
+			v[ki] = row[ki]/piv;
+			col[ki] = WeightEntry(ki, j_piv, gamma, variant);
+			for(r=0;r<rank;r++)
+			{
+				col[ki] -= (*U_cols)[(long)r*size_ft + ki]*(*V_rows)[(long)r*size_ft + j_piv];
+			}
+			u[ki] = col[ki];
+		}
+
+		// Update the Frobenius norm of the approximation, |S_rank|^2 = |S_(rank-1)|^2 + 2 sum_r (u_r.u)(v_r.v) + |u|^2|v|^2:
+		uu = 0.; vv = 0.;
+		for(ki=0;ki<size_ft;ki++)
+		{
+			uu += u[ki]*u[ki];
+			vv += v[ki]*v[ki];
+		}
+		uv_cross = 0.;
+		#pragma omp parallel for private(r,ki) reduction(+:uv_cross)
+		for(r=0;r<rank;r++)
+		{
+			double ur_u = 0., vr_v = 0.;
+			for(ki=0;ki<size_ft;ki++)
+			{
+				ur_u += (*U_cols)[(long)r*size_ft + ki]*u[ki];
+				vr_v += (*V_rows)[(long)r*size_ft + ki]*v[ki];
+			}
+			uv_cross += ur_u*vr_v;
+		}
+		norm2 += 2.*uv_cross + uu*vv;
+		rank++;
+
+		if(sqrt(uu*vv) <= lowrank_tol*sqrt(norm2))													// the latest term is small enough compared to the whole approximation
+		{
+			break;
+		}
+
+		// The next row is the one where the latest column is largest:
+		best = -1.;
+		for(ki=0;ki<size_ft;ki++)
+		{
+			if(! row_used[ki] && fabs(u[ki]) > best)
+			{
+				best = fabs(u[ki]);
+				i_piv = ki;
+			}
+		}
+		if(best < 0.) break;																		// every row has been used
+	}
+
+	free(row); free(col); free(row_used);
+	return rank;
+}
+
+static double FactorisationError(int gamma, int variant, const double *U_cols, const double *V_rows, int rank)	// Function to find the relative Frobenius error of the factorisation against gHat3 (or gHat3_linear) over LOWRANK_SAMPLE_ROWS evenly spread rows
+{
+	int s, ki, kw, r, n_rows;
+	double exact, approx, err2 = 0., ref2 = 0.;
+
+	n_rows = (size_ft < LOWRANK_SAMPLE_ROWS) ? size_ft : LOWRANK_SAMPLE_ROWS;
+	#pragma omp parallel for private(s,ki,kw,r,exact,approx) reduction(+:err2,ref2)
+	for(s=0;s<n_rows;s++)
+	{
+		ki = (int)(((long)s*size_ft)/n_rows);
+		for(kw=0;kw<size_ft;kw++)
+		{
+			exact = WeightEntry(ki, kw, gamma, variant);
+			approx = 0.;
+			for(r=0;r<rank;r++)
+			{
+				approx += U_cols[(long)r*size_ft + ki]*V_rows[(long)r*size_ft + kw];
+			}
+			err2 += (exact - approx)*(exact - approx);
+			ref2 += exact*exact;
+		}
+	}
+
+	return (ref2 > 0.) ? sqrt(err2/ref2) : sqrt(err2);
+}
+
+static void BuildFactors(int gamma, int variant, const char *name, LowRankFactors *F)				// Function to compress the weights for the given kernel variant, report the rank & error achieved and store the factors in the layout used by LowRankConvolution
+{
+	int ki, r, l, m, n;
+	double *U_cols, *V_rows, err, wt, t1, t2;
+
+	t1 = MPI_Wtime();
+	F->rank = CompressWeights(gamma, variant, &U_cols, &V_rows);
+	err = FactorisationError(gamma, variant, U_cols, V_rows, F->rank);
+
+	F->U = (double *)malloc((long)F->rank*size_ft*sizeof(double));
+	F->V = (double *)malloc((long)F->rank*size_ft*sizeof(double));
+	#pragma omp parallel for private(ki,r,l,m,n,wt)
+	for(ki=0;ki<size_ft;ki++)
+	{
+		l = ki/(N*N); m = (ki/N)%N; n = ki%N;
+		wt = h_eta*h_eta*h_eta*wtN[l]*wtN[m]*wtN[n];												// the quadrature weight at w (when ki is read as the index of w), as used in ComputeQ
+		if(variant == WEIGHTS_LINEAR)
+		{
+			wt *= scale3;																			// the linear part of ComputeQ_FandL carries an extra factor of scale3
+		}
+		for(r=0;r<F->rank;r++)
+		{
+			F->U[r + F->rank*ki] = U_cols[(long)r*size_ft + ki];
+			F->V[r + F->rank*ki] = wt*V_rows[(long)r*size_ft + ki];
+		}
+	}
+	free(U_cols); free(V_rows);
+	t2 = MPI_Wtime();
+
+	if(myrank_mpi==0)
+	{
+		printf("Low-rank collision engine: %s compressed to rank %d (%g MB instead of %g MB) in %g seconds, relative error %g against %s over %d rows.\n",
+				name, F->rank, 2.*F->rank*size_ft*sizeof(double)/1.e6, (double)size_ft*(double)size_ft*sizeof(double)/1.e6,
+				t2-t1, err, name, (size_ft < LOWRANK_SAMPLE_ROWS) ? size_ft : LOWRANK_SAMPLE_ROWS);
+	}
+}
+
+void InitLowRankCollision(int gamma)																// Function to build the low-rank factorisations of the weights used by the chosen collision operator
+{
+	BuildFactors(gamma, WEIGHTS_LANDAU, "gHat3", &lowrank_weights);
+	lowrank_weights_linear.rank = 0;
+	lowrank_weights_linear.U = NULL;
+	lowrank_weights_linear.V = NULL;
+	if(FullandLinear)
+	{
+		BuildFactors(gamma, WEIGHTS_LINEAR, "gHat3_linear", &lowrank_weights_linear);
+	}
+
+	lowrank_engine_checked = false;
+	if(CheckCollisionEngine)
+	{
+		InitMatrixFreeTables(gamma);																// the matrix-free routines give the direct sum without needing the tables of weights
+	}
+}
+
+void FreeLowRankCollision()																			// Function to delete the factorisations built by InitLowRankCollision
+{
+	free(lowrank_weights.U); free(lowrank_weights.V);
+	free(lowrank_weights_linear.U); free(lowrank_weights_linear.V);
+	if(CheckCollisionEngine)
+	{
+		FreeMatrixFreeTables();
+	}
+}
+
+static void LowRankConvolution(LowRankFactors *F, fftw_complex *gHat, fftw_complex *fHat, fftw_complex *qHat)	// Function to calculate qHat(ki) = sum over w of conv_weights[ki][w]*gHat(w)*fHat(ki-w) from the factorisation F (leaving out gHat if it is NULL)
+{
+	int rank = F->rank;
+
+	#pragma omp parallel
+	{
+		int ki, i, j, k, l, m, n, x, y, z, kw, kz, r;
+		int start_i, start_j, start_k, end_i, end_j, end_k;
+		double gf0, gf1;
+		double *acc = (double *)malloc(2*(rank > 0 ? rank : 1)*sizeof(double));						// the windowed sums for each term r (real & imaginary parts)
+		const double *Vw, *Uk;
+
+		#pragma omp for schedule(dynamic)
+		for(ki=0;ki<size_ft;ki++)
+		{
+			i = ki/(N*N); j = (ki/N)%N; k = ki%N;
+			ConvolutionWindow(i, &start_i, &end_i);
+			ConvolutionWindow(j, &start_j, &end_j);
+			ConvolutionWindow(k, &start_k, &end_k);
+
+			memset(acc, 0, 2*rank*sizeof(double));
+			for(l=start_i;l<end_i;l++)
+			{
+				x = i + N/2 - l;
+				for(m=start_j;m<end_j;m++)
+				{
+					y = j + N/2 - m;
+					for(n=start_k;n<end_k;n++)
+					{
+						z = k + N/2 - n;
+						kw = n + N*(m + N*l);
+						kz = z + N*(y + N*x);
+						if(gHat == NULL)
+						{
+							gf0 = fHat[kz][0];
+							gf1 = fHat[kz][1];
+						}
+						else
+						{
+							gf0 = gHat[kw][0]*fHat[kz][0] - gHat[kw][1]*fHat[kz][1];
+							gf1 = gHat[kw][0]*fHat[kz][1] + gHat[kw][1]*fHat[kz][0];
+						}
+						Vw = F->V + (long)rank*kw;
+						for(r=0;r<rank;r++)
+						{
+							acc[2*r] += Vw[r]*gf0;
+							acc[2*r+1] += Vw[r]*gf1;
+						}
+					}
+				}
+			}
+
+			Uk = F->U + (long)rank*ki;
+			qHat[ki][0] = 0.;
+			qHat[ki][1] = 0.;
+			for(r=0;r<rank;r++)
+			{
+				qHat[ki][0] += Uk[r]*acc[2*r];
+				qHat[ki][1] += Uk[r]*acc[2*r+1];
+			}
+		}
+		free(acc);
+	}
+}
+
+void ComputeQ_LowRank(double *f, fftw_complex *qHat)												// Function to calculate the Fourier transform of Q(f,f), as in ComputeQ, from the low-rank factorisation of the weights
+{
+	fftw_complex *qHat_direct;
+
+	fft3D(f, fftOut);																			// perform the FFT of f and store the result in fftOut
+
+	LowRankConvolution(&lowrank_weights, fftOut, fftOut, qHat);
+
+	if(CheckCollisionEngine && ! lowrank_engine_checked)											// the first time through, compare with the direct sum
+	{
+		qHat_direct = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		ComputeQ_MatrixFree(f, qHat_direct);
+		ReportEngineDifference("LowRank", "ComputeQ", qHat, qHat_direct);
+		fftw_free(qHat_direct);
+		lowrank_engine_checked = true;
+	}
+}
+
+void ComputeQLinear_LowRank(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat)			// Function to calculate the Fourier transform of Q(f,M), as in ComputeQLinear, from the low-rank factorisation of the weights
+{
+	fftw_complex *qHat_direct;
+
+	fft3D(f, fftOut);																			// perform the FFT of f and store the result in fftOut
+
+	LowRankConvolution(&lowrank_weights, Maxwell_fftOut, fftOut, qHat);
+
+	if(CheckCollisionEngine && ! lowrank_engine_checked)											// the first time through, compare with the direct sum
+	{
+		qHat_direct = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		ComputeQLinear_MatrixFree(f, Maxwell_fftOut, qHat_direct);
+		ReportEngineDifference("LowRank", "ComputeQLinear", qHat, qHat_direct);
+		fftw_free(qHat_direct);
+		lowrank_engine_checked = true;
+	}
+}
+
+void ComputeQ_FandL_LowRank(double *f, fftw_complex *qHat, fftw_complex *qHat_linear)				// Function to calculate the Fourier transforms of the full & linear parts of Q, as in ComputeQ_FandL, from the low-rank factorisations of the weights
+{
+	int i;
+	fftw_complex *qHat_direct, *qHat_linear_direct;
+
+	fft3D(f, fftOut);																			// perform the FFT of f and store the result in fftOut
+
+	LowRankConvolution(&lowrank_weights, fftOut, fftOut, qHat);
+	LowRankConvolution(&lowrank_weights_linear, NULL, fftOut, qHat_linear);							// the linear part does not multiply by fHat(w)
+	for(i=0;i<size_ft;i++)
+	{
+		qHat[i][0] += qHat_linear[i][0];
+		qHat[i][1] += qHat_linear[i][1];
+	}
+
+	if(CheckCollisionEngine && ! lowrank_engine_checked)											// the first time through, compare with the direct sum
+	{
+		qHat_direct = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		qHat_linear_direct = (fftw_complex *)fftw_malloc(size_ft*sizeof(fftw_complex));
+		ComputeQ_FandL_MatrixFree(f, qHat_direct, qHat_linear_direct);
+		ReportEngineDifference("LowRank", "ComputeQ_FandL", qHat, qHat_direct);
+		ReportEngineDifference("LowRank", "ComputeQ_FandL linear part", qHat_linear, qHat_linear_direct);
+		fftw_free(qHat_direct); fftw_free(qHat_linear_direct);
+		lowrank_engine_checked = true;
+	}
+}
@@ -0,0 +1,44 @@
+/* This is the header file associated to LowRankCollision.cpp in which the prototypes for the
+ * functions contained in that file are declared.  Any other header files which must be linked to
+ * for the functions here are also included.
+ *
+ */
+
+//************************//
+//     INCLUDE GUARDS     //
+//************************//
+
+#ifndef LOWRANKCOLLISION_H_
+#define LOWRANKCOLLISION_H_
+
+//************************//
+//        INCLUDES        //
+//************************//
+
+#include "LP_ompi.h"																				// allows the libraries included, macros defined and external variables declared in LP_ompi.h to be used in the LowRankCollision functions
+#include "collisionRoutines_1.h"																	// allows gHat3, gHat3_linear & fft3D to be used in the LowRankCollision functions
+#include "WeightStore.h"																			// allows the WEIGHTS_ kernel variants to be used
+#include "MatrixFreeCollision.h"																	// allows the matrix-free routines to be used as the direct sum when checking the low-rank engine
+
+//************************//
+//         MACROS         //
+//************************//
+
+#define LOWRANK_SAMPLE_ROWS 32																		// number of rows of the weights compared with gHat3 when reporting the error of a factorisation
+#define LOWRANK_RANK_BLOCK 16																		// number of terms the storage of a factorisation grows by at a time
+
+//************************//
+//   FUNCTION PROTOTYPES  //
+//************************//
+
+void InitLowRankCollision(int gamma);
+
+void FreeLowRankCollision();
+
+void ComputeQ_LowRank(double *f, fftw_complex *qHat);
+
+void ComputeQ_FandL_LowRank(double *f, fftw_complex *qHat, fftw_complex *qHat_linear);
+
+void ComputeQLinear_LowRank(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat);
+
+#endif /* LOWRANKCOLLISION_H_ */
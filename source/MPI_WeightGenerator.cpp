@@ -0,0 +1,102 @@
+/* This is the main source file for the MPI_WeightGenerator target, which fills the weight stores
+ * used by the solver ahead of time (so that a run, or a whole parameter sweep, can map the
+ * convolution weights from disk instead of computing them at start-up).
+ *
+ * It reads the same input file as the solver (LPsolver-input.txt) and generates the weight store
+ * for the values of N, Lv & gamma found there (as well as the store for the linear weights if
+ * FullandLinear is true), sharing the rows of each store between all of the MPI processes.
+ * The stores are written to the directory set by Directory in the Weights section of the input
+ * file.
+ *
+ * This file is only compiled with a main when WEIGHT_GENERATOR is defined.
+ *
+ */
+
+#include "LP_ompi.h"																				// LP_ompi.h is where the libraries required by the program included, all macros are defined and all variables to be used throughout the various files are defined as external
+
+#ifdef WEIGHT_GENERATOR
+
+int main()
+{
+	int i, gamma;																					// declare i (a counter) & gamma (the power of |u| in the collision kernel)
+	int provided;																					// declare provided (the actual provided level of MPI thread support)
+	std::string flag, IC_flag, IC_name, input_filename;												// declare the strings flag, IC_flag, IC_name & input_filename (which are read from the input file in the same way as in the solver)
+	char filename[WEIGHTSTORE_NAME_LENGTH];															// declare filename (to store the name of the weight store being generated)
+	bool generated;																					// declare generated (to check if the weight store was written successfully)
+
+	MPI_Init_thread(NULL, NULL, MPI_THREAD_FUNNELED, &provided);									// initialise the hybrid MPI & OpenMP environment (only the master thread makes MPI calls here)
+	MPI_Comm_rank(MPI_COMM_WORLD, &myrank_mpi);														// store the rank of the current process in the MPI_COMM_WORLD communicator in myrank_mpi
+	MPI_Comm_size(MPI_COMM_WORLD, &nprocs_mpi);														// store the total number of processes running in the MPI_COMM_WORLD communicator in nprocs_mpi
+
+	//************************
+	//GRVY input parsing
+	//************************
+
+	GRVY_Input_Class iparse;																		// define a GRVY input parsing object
+	input_filename.assign("./LPsolver-input.txt");													// set a name for the input file to be ready by GRVY
+
+	if(! iparse.Open(input_filename.c_str()))														// Initialise and read in the GRVY file with the input paramters
+	{
+		std::cout << "Program cannot run... The file " << input_filename << " cannot be found."
+			<< std::endl << "Please create an appropriate input file before running again."
+			<< std::endl;																			// Print an error message if the file does not exist
+		exit(1);																					// Exit if it does not exist
+	}
+
+	ReadICOptions(iparse);																			// Read the initial condition for this run from the input file (Lv is read from its section)
+	CheckICOptions(IC_flag);																		// Check just one initial condition was set for this run
+	ReadICName(iparse, IC_flag, IC_name);															// Read in a string of the name of the initial conditions chosen
+
+	ReadGamma(iparse, gamma);																		// Read in gamma to find the types of collisions being used
+	ReadFullandLinear(iparse);																		// Read in if the linear weights are also needed
+	ReadInputParameters(iparse, flag, nT, Nx, Nv, N, nu, dt, A_amp, k_wave, Lv, Lx);				// Read in all input parameters
+
+	UseWeightStore = true;																			// the generator always writes to the weight stores, so only the directory & Verify are read
+	iparse.Read_Var("Weights/Directory",&weight_store_dir,std::string("Weights"));
+	iparse.Read_Var("Weights/Verify",&VerifyWeightStore,false);
+
+	//INITIALISE VELOCITY AND FOURIER DOMAINS (IN THE SAME WAY AS THE SOLVER):
+	size_ft = N*N*N;																				// set size_ft to N^3
+	L_v = Lv;																						// set L_v to Lv
+	R_v = Lv;																						// set R_v to Lv
+	L_eta = 0.5*(double)(N-1)*PI/L_v;																// set L_eta to (N-1)*Pi/(2*L_v)
+	h_v = 2.0*L_v/(double)(N-1);																	// set h_v to 2*L_v/(N-1)
+	h_eta = 2.0*L_eta/(double)(N);																	// set h_eta to 2*L_eta/N
+	eta = (double *)malloc(N*sizeof(double));														// allocate enough space at the pointer eta to store N many double numbers
+	v = (double *)malloc(N*sizeof(double));															// allocate enough space at the pointer v to store N many double numbers
+	for(i=0;i<N;i++)
+	{
+		eta[i] = -L_eta + (double)i*h_eta;															// set the ith value of eta to -L_eta + i*h_eta
+		v[i] = -L_v + (double)i*h_v;																// set the ith value of v to -L_v + i*h_v
+	}
+
+	WeightStoreFilename(filename, gamma, WEIGHTS_LANDAU);
+	if(myrank_mpi==0)
+	{
+		printf("Generating %s (%g GB) with %d processes... \n", filename,
+				(double)size_ft*(double)size_ft*sizeof(double)/1.e9, nprocs_mpi);
+	}
+	generated = GenerateWeightStore(filename, gamma, WEIGHTS_LANDAU);								// fill the weight store used by ComputeQ
+
+	if(generated && FullandLinear)																	// only do this if FullandLinear is true
+	{
+		WeightStoreFilename(filename, gamma, WEIGHTS_LINEAR);
+		if(myrank_mpi==0)
+		{
+			printf("Generating %s with %d processes... \n", filename, nprocs_mpi);
+		}
+		generated = GenerateWeightStore(filename, gamma, WEIGHTS_LINEAR);							// fill the weight store used by the linear part of ComputeQ_FandL
+	}
+
+	free(eta); free(v);																				// delete the dynamic memory allocated for eta & v
+	iparse.Close();																					// close the input file
+
+	MPI_Finalize();																					// ensure that MPI exits cleanly
+	if(! generated)
+	{
+		return 1;																					// return 1 so that a job script can tell the weight stores were not written
+	}
+	return 0;
+}
+
+#endif /* WEIGHT_GENERATOR */
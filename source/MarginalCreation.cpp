@@ -3,6 +3,10 @@
  *
  * Functions included: f_marg, PrintMarginalLoc, PrintMarginal
  *
+ * U only holds the cells of this process (see advection_1.cpp), so f_marg only adds up those cells and
+ * PrintMarginal adds up the values of every process on process 0 before printing them.  Every process
+ * must therefore call PrintMarginal, while only process 0 needs margfile to be open.
+ *
  *  Created on: Nov 15, 2017
  */
 
@@ -25,8 +29,12 @@ double f_marg_Inhomo(double *U, int i, int j1, double x, double v1)
 		for(j3=0; j3<Nv; j3++)
 		{
 			k = k0 + j2N + j3;																	// set k to i*Nv^3 + j1*Nv^2 + j2*Nv + j3
-			retn += dv*dv*U[6*k+0] + dv*dv*U[6*k+1]*x_dif/dx + dv*U[6*k+2]*v1_dif
-							+ U[6*k+5]*(v1_dif*v1_dif +dv*dv/6);								// add dv*dv*U[6*k+0] + dv*dv*U[6*k+1]*x_dif/dx + dv*U[6*k+2]*v1_dif + U[6*k+5]*(v1_dif*v1_dif +dv*dv/6) for the given j2 & j3 in the sum for retn
+			if(! HoldsCell(k))																	// U only holds the cells of this process
+			{
+				continue;
+			}
+			retn += dv*dv*U[SlabIndex(k, 0)] + dv*dv*U[SlabIndex(k, 1)]*x_dif/dx + dv*U[SlabIndex(k, 2)]*v1_dif
+							+ U[SlabIndex(k, 5)]*(v1_dif*v1_dif +dv*dv/6);						// add dv*dv*U[SlabIndex(k, 0)] + dv*dv*U[SlabIndex(k, 1)]*x_dif/dx + dv*U[SlabIndex(k, 2)]*v1_dif + U[SlabIndex(k, 5)]*(v1_dif*v1_dif +dv*dv/6) for the given j2 & j3 in the sum for retn
 		}
 	}
 	return retn;																				// return the value of the marginal evaluated at x & v1
@@ -47,8 +55,12 @@ double f_marg_Homo(double *U, int j1, int j2, double v1, double v2)
 	for(j3=0; j3<Nv; j3++)
 	{
 		k = k0 + j3;																			// set k to i*Nv^3 + j1*Nv^2 + j2*Nv + j3
-		retn += dv*U[6*k+0] + U[6*k+2]*v1_dif + U[6*k+3]*v2_dif
-						+ U[6*k+5]*(v_squares/dv +dv/12);										// add dv*U[6*k+0] + U[6*k+2]*v1_dif + U[6*k+3]*v2_dif + U[6*k+5]*((v1_dif*v1_dif + v2_diff*v2_diff)/dv +dv/12) for the given j3 in the sum for retn
+		if(! HoldsCell(k))																		// U only holds the cells of this process
+		{
+			continue;
+		}
+		retn += dv*U[SlabIndex(k, 0)] + U[SlabIndex(k, 2)]*v1_dif + U[SlabIndex(k, 3)]*v2_dif
+						+ U[SlabIndex(k, 5)]*(v_squares/dv +dv/12);								// add dv*U[SlabIndex(k, 0)] + U[SlabIndex(k, 2)]*v1_dif + U[SlabIndex(k, 3)]*v2_dif + U[SlabIndex(k, 5)]*((v1_dif*v1_dif + v2_diff*v2_diff)/dv +dv/12) for the given j3 in the sum for retn
 	}
 	return retn;																				// return the value of the marginal evaluated at x & v1
 }
@@ -162,13 +174,16 @@ void PrintMarginal(double *U, FILE *margfile)
 
 void PrintMarginal_Inhomo(double *U, FILE *margfile)													// function to print the values of the marginal in the file tagged as margfile at the given timestep
 {
-	int i, j1, np, nx, nv;																		// declare i (the index of the space cell),  j1 (the index of the velocity cell in the v1 direction), np (the number of points to evaluate in a given space/velocity cell), nx (a counter for the points in the space cell) & nv (a counter for the points in the velocity cell)
-	double x_0, x_val, v1_0, v1_val, fM_val, ddx, ddv;											// declare x_0 (the x value at the left edge of a given cell), x_val (the x value to be evaluated at), declare v1_0 (the v1 value at the left edge of a given cell), v1_val (the v1 value to be evaluated at), fM_val (the value of the marginal evaluated at (x_val, v1_val), ddx (the space between x values) & ddv (the space between v1 values)
+	int i, j1, np, nx, nv, m;																	// declare i (the index of the space cell),  j1 (the index of the velocity cell in the v1 direction), np (the number of points to evaluate in a given space/velocity cell), nx (a counter for the points in the space cell), nv (a counter for the points in the velocity cell) & m (the index of the point in fM_vals)
+	double x_0, x_val, v1_0, v1_val, ddx, ddv;													// declare x_0 (the x value at the left edge of a given cell), x_val (the x value to be evaluated at), declare v1_0 (the v1 value at the left edge of a given cell), v1_val (the v1 value to be evaluated at), ddx (the space between x values) & ddv (the space between v1 values)
+	double *fM_vals;																			// declare fM_vals (to store the values of the marginal at every point, in the order they are printed)
 
 	np = 4;																						// set np to 4
 	ddx = dx/np;																				// set ddx to the space cell width divided by np
 	ddv = dv/np;																				// set ddv to the velocity cell width divided by np
-	for(i=0; i<Nx; i++)
+	fM_vals = (double*)calloc(Nx*np*Nv*np, sizeof(double));										// allocate enough space at the pointer fM_vals for Nx*np*Nv*np many doubles, all set to 0 (the space cells of the other processes are left at 0)
+	int i_first = chunksize_dg*myrank_mpi/size_v, i_end = (chunksize_dg*(myrank_mpi+1) - 1)/size_v + 1;	// declare i_first & i_end (the space cells i_first,...,i_end-1 hold the cells of this process, since U only holds those)
+	for(i=i_first; i<i_end; i++)																// loop through the space cells of this process
 	{
 		x_0 = Gridx((double)i - 0.5);															// set x_0 to the value of x at the left edge of the i-th space cell
 		for (nx=0; nx<np; nx++)
@@ -180,23 +195,37 @@ void PrintMarginal_Inhomo(double *U, FILE *margfile)													// function to
 				for (nv=0; nv<np; nv++)
 				{
 					v1_val = v1_0 + nv*ddv;														// set v1_val to v1_0 plus nv increments of width ddv
-
-					fM_val = f_marg_Inhomo(U, i, j1, x_val, v1_val);							// calculate the value of the marginal, evaluated at x_val & v1_val by using the function in the space cell i and velocity cell j1 in the v1 direction
-					fprintf(margfile, "%11.8g  ", fM_val);										// in the file tagged as fmarg, print the value of the marginal f_M(t, x, v1)
+					m = ((i*np + nx)*Nv + j1)*np + nv;											// set m to the index of the point (x_val, v1_val) in the order the marginal is printed
+					fM_vals[m] = f_marg_Inhomo(U, i, j1, x_val, v1_val);						// calculate the value of the marginal, evaluated at x_val & v1_val by using the function in the space cell i and velocity cell j1 in the v1 direction
 				}
 			}
 		}
 	}
-	fprintf(margfile, "\n");																	// print a new line in the file tagged as fmarg
+	if(myrank_mpi==0)
+	{
+		MPI_Reduce(MPI_IN_PLACE, fM_vals, Nx*np*Nv*np, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);	// add up the values of the marginal from every process on process 0
+		for(m=0; m<Nx*np*Nv*np; m++)
+		{
+			fprintf(margfile, "%11.8g  ", fM_vals[m]);											// in the file tagged as fmarg, print the value of the marginal f_M(t, x, v1)
+		}
+		fprintf(margfile, "\n");																// print a new line in the file tagged as fmarg
+	}
+	else
+	{
+		MPI_Reduce(fM_vals, NULL, Nx*np*Nv*np, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);			// send the values of the marginal from the cells of this process to process 0
+	}
+	free(fM_vals);																				// delete the dynamic memory allocated for fM_vals
 }
 
 void PrintMarginal_Homo(double *U, FILE *margfile)													// function to print the values of the marginal in the file tagged as margfile at the given timestep
 {
-	int j1, j2, np, nv1, nv2;																	// declare j1 (the index of the velocity cell in the v1 direction), j2 (the index of the velocity cell in the v2 direction), np (the number of points to evaluate in a given space/velocity cell), nv1 & nv2 (counters for the points in the velocity cell)
-	double v1_0, v1_val, v2_0, v2_val, fM_val, ddx, ddv;										// declare v1_0 (the v1 value at the left edge of a given cell), v1_val (the v1 value to be evaluated at), v2_0 (the v2 value at the left edge of a given cell), v2_val (the v2 value to be evaluated at), fM_val (the value of the marginal evaluated at (x_val, v1_val), ddx (the space between x values) & ddv (the space between v1 values)
+	int j1, j2, np, nv1, nv2, m;																// declare j1 (the index of the velocity cell in the v1 direction), j2 (the index of the velocity cell in the v2 direction), np (the number of points to evaluate in a given space/velocity cell), nv1 & nv2 (counters for the points in the velocity cell) & m (the index of the point in fM_vals)
+	double v1_0, v1_val, v2_0, v2_val, ddv;														// declare v1_0 (the v1 value at the left edge of a given cell), v1_val (the v1 value to be evaluated at), v2_0 (the v2 value at the left edge of a given cell), v2_val (the v2 value to be evaluated at) & ddv (the space between v values)
+	double *fM_vals;																			// declare fM_vals (to store the values of the marginal at every point, in the order they are printed)
 
 	np = 4;																						// set np to 4
 	ddv = dv/np;																				// set ddv to the velocity cell width divided by np
+	fM_vals = (double*)malloc(Nv*np*Nv*np*sizeof(double));										// allocate enough space at the pointer fM_vals for Nv*np*Nv*np many doubles
 	for(j1=0; j1<Nv; j1++)
 	{
 		v1_0 = Gridv((double)j1 - 0.5);															// set v1_0 to the value of v1 at the left edge of the j1-th velocity cell in the v1 direction
@@ -209,12 +238,24 @@ void PrintMarginal_Homo(double *U, FILE *margfile)													// function to pr
 				for (nv2=0; nv2<np; nv2++)
 				{
 					v2_val = v2_0 + nv2*ddv;													// set v2_val to v2_0 plus nv2 increments of width ddv
-
-					fM_val = f_marg_Homo(U, j1, j2, v1_val, v2_val);									// calculate the value of the marginal, evaluated at x_val & v1_val by using the function in the space cell i and velocity cell j1 in the v1 direction
-					fprintf(margfile, "%11.8g  ", fM_val);										// in the file tagged as fmarg, print the value of the marginal f_M(t, x, v1)
+					m = ((j1*np + nv1)*Nv + j2)*np + nv2;										// set m to the index of the point (v1_val, v2_val) in the order the marginal is printed
+					fM_vals[m] = f_marg_Homo(U, j1, j2, v1_val, v2_val);						// calculate the value of the marginal, evaluated at v1_val & v2_val by using the function in the velocity cell j1 in the v1 direction and j2 in the v2 direction (only adding up the cells of this process)
 				}
 			}
 		}
 	}
-	fprintf(margfile, "\n");																	// print a new line in the file tagged as fmarg
+	if(myrank_mpi==0)
+	{
+		MPI_Reduce(MPI_IN_PLACE, fM_vals, Nv*np*Nv*np, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);	// add up the values of the marginal from every process on process 0
+		for(m=0; m<Nv*np*Nv*np; m++)
+		{
+			fprintf(margfile, "%11.8g  ", fM_vals[m]);											// in the file tagged as fmarg, print the value of the marginal f_M(t, x, v1)
+		}
+		fprintf(margfile, "\n");																// print a new line in the file tagged as fmarg
+	}
+	else
+	{
+		MPI_Reduce(fM_vals, NULL, Nv*np*Nv*np, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);			// send the values of the marginal from the cells of this process to process 0
+	}
+	free(fM_vals);																				// delete the dynamic memory allocated for fM_vals
 }
@@ -0,0 +1,232 @@
+/* This is the source file which contains the subroutines for the matrix-free collision engine
+ * (CollisionEngine = MatrixFree), which computes the same quadrature as ComputeQ, ComputeQ_FandL &
+ * ComputeQLinear but never forms the size_ft x size_ft tables of convolution weights.
+ *
+ * Instead, the 3x3 tensor S-hat(w) (and, for gamma = -3, the isotropic term of gHat3) is tabulated
+ * once for each of the size_ft values of w, and the weight gHat3(xi, w) is rebuilt from these and
+ * the values of eta whenever it is needed.  This takes the memory needed for the weights from
+ * O(N^6) to O(N^3).  The weights are rebuilt by TabulatedWeight (in collisionRoutines_1.h), which
+ * also generates the tables of the Direct engine, so both engines give the same results.
+ *
+ * Functions included: InitMatrixFreeTables, FreeMatrixFreeTables, MatrixFreeWeight, RelativeMaxDiff,
+ * ReportEngineDifference, ComputeQ_MatrixFree, ComputeQ_FandL_MatrixFree, ComputeQLinear_MatrixFree
+ *
+ */
+
+#include "MatrixFreeCollision.h"																	// MatrixFreeCollision.h is where the prototypes for the functions contained in this file are declared
+
+double *Shat_w, *Shat_w_linear;																		// declare pointers to Shat_w (the 3x3 tensor S-hat(w), stored row by row for each w, used by gHat3) & Shat_w_linear (the same for gHat3_linear, which always uses the gamma = -3 tensor)
+double *Aiso_w;																						// declare a pointer to Aiso_w (the isotropic term sqrt(8/pi)(R_v|w| - sin(R_v|w|))/(R_v|w|) of gHat3 for gamma = -3, or 0 at w = 0)
+int gamma_mf;																						// declare gamma_mf (the value of gamma the tables were built for)
+static int matrixfree_table_users = 0;																// declare matrixfree_table_users (the number of calls of InitMatrixFreeTables not yet matched by FreeMatrixFreeTables, as the tables are also used by the checks of the FFT & low-rank engines)
+
+void InitMatrixFreeTables(int gamma)																// Function to tabulate S-hat(w) (and the isotropic term for gamma = -3) at each of the size_ft Fourier nodes w (unless they have already been tabulated)
+{
+	if(matrixfree_table_users++ > 0)
+	{
+		return;
+	}
+	gamma_mf = gamma;
+	Shat_w = (double *)malloc(9*size_ft*sizeof(double));											// allocate enough space at the pointer Shat_w for 9*size_ft many double numbers
+	Aiso_w = (double *)malloc(size_ft*sizeof(double));												// allocate enough space at the pointer Aiso_w for size_ft many double numbers
+	if(FullandLinear && gamma != -3)
+	{
+		Shat_w_linear = (double *)malloc(9*size_ft*sizeof(double));									// the linear part needs its own tensor only if gamma is not -3
+	}
+	else
+	{
+		Shat_w_linear = Shat_w;
+	}
+
+	TabulateShat(gamma, Shat_w, Aiso_w);															// the same tables are used to generate the weights of the Direct engine
+	if(Shat_w_linear != Shat_w)
+	{
+		TabulateShat(-3, Shat_w_linear, NULL);
+	}
+
+	if(myrank_mpi==0 && collision_engine != ENGINE_DIRECT)
+	{
+		printf("Matrix-free collision engine: tabulated S-hat(w) at %d nodes (%g MB instead of %g MB for each table of weights).\n",
+				size_ft, (Shat_w_linear != Shat_w ? 19. : 10.)*size_ft*sizeof(double)/1.e6,
+				(double)size_ft*(double)size_ft*sizeof(double)/1.e6);
+	}
+}
+
+void FreeMatrixFreeTables()																			// Function to delete the tables built by InitMatrixFreeTables (once every user has finished with them)
+{
+	if(--matrixfree_table_users > 0)
+	{
+		return;
+	}
+	if(Shat_w_linear != Shat_w)
+	{
+		free(Shat_w_linear);
+	}
+	free(Shat_w); free(Aiso_w);
+}
+
+double MatrixFreeWeight(int ki, int kw, int variant)												// Function to return the convolution weight which the Direct engine would read from conv_weights[ki][kw] (or conv_weights_linear[ki][kw] if variant is WEIGHTS_LINEAR)
+{
+	double zeta[3] = {eta[ki/(N*N)], eta[(ki/N)%N], eta[ki%N]};
+	double w[3] = {eta[kw/(N*N)], eta[(kw/N)%N], eta[kw%N]};
+	const double *Shat = (variant == WEIGHTS_LINEAR) ? &Shat_w_linear[9*kw] : &Shat_w[9*kw];
+
+	return TabulatedWeight(zeta, w, Shat, Aiso_w[kw], gamma_mf, variant == WEIGHTS_LINEAR);
+}
+
+double RelativeMaxDiff(const fftw_complex *a, const fftw_complex *ref, int n)						// Function to return the largest of |a[k] - ref[k]| over the n complex numbers k, relative to the largest |ref[k]| (or not relative if ref is zero)
+{
+	int k;
+	double diff, max_diff = 0., max_ref = 0.;
+
+	for(k=0;k<n;k++)
+	{
+		diff = sqrt((a[k][0]-ref[k][0])*(a[k][0]-ref[k][0]) + (a[k][1]-ref[k][1])*(a[k][1]-ref[k][1]));
+		if(diff > max_diff) max_diff = diff;
+		diff = sqrt(ref[k][0]*ref[k][0] + ref[k][1]*ref[k][1]);
+		if(diff > max_ref) max_ref = diff;
+	}
+	return (max_ref > 0.) ? max_diff/max_ref : max_diff;
+}
+
+double RelativeMaxDiff(const double *a, const double *ref, int n)									// Function to return the largest of |a[k] - ref[k]| over the n real numbers k, relative to the largest |ref[k]| (or not relative if ref is zero)
+{
+	int k;
+	double max_diff = 0., max_ref = 0.;
+
+	for(k=0;k<n;k++)
+	{
+		max_diff = fmax(max_diff, fabs(a[k] - ref[k]));
+		max_ref = fmax(max_ref, fabs(ref[k]));
+	}
+	return (max_ref > 0.) ? max_diff/max_ref : max_diff;
+}
+
+void ReportEngineDifference(const char *engine, const char *routine, fftw_complex *qHat, fftw_complex *qHat_direct, int cells)	// Function to print the largest difference between qHat from the given collision engine and from the direct sum, relative to the largest value of the direct sum (over the spectra of cells space-steps stored one after another)
+{
+	double rel_diff = RelativeMaxDiff(qHat, qHat_direct, cells*size_ft);
+
+	if(myrank_mpi==0)
+	{
+		printf("%s collision engine check (%s, N = %d): max |qHat - qHat_direct|/max |qHat_direct| = %g\n",
+				engine, routine, N, rel_diff);
+	}
+}
+
+static void MatrixFreeConvolution(fftw_complex *gHat, fftw_complex *fHat, fftw_complex *qHat)	// Function to calculate qHat(ki) = sum over w of gHat3(ki,w)*gHat(w)*fHat(ki-w) (with the same quadrature as ComputeQ), evaluating the weights from the tables
+{
+	int ki, i, j, k, l, m, n, x, y, z, kw, kz;
+	int t, ki_end, threads = ModeThreads();
+	int start_i, start_j, start_k, end_i, end_j, end_k;
+	double tempD, tmp0, tmp1, zeta[3], w[3];
+	double prefactor = h_eta*h_eta*h_eta;
+
+	#pragma omp parallel for schedule(static,1) num_threads(threads) private(t,ki_end,ki,i,j,k,l,m,n,x,y,z,kw,kz,start_i,start_j,start_k,end_i,end_j,end_k,tempD,tmp0,tmp1,zeta,w) shared(qHat, gHat, fHat)
+	for(t=0;t<threads;t++)																			// give each thread one range of modes of about the same cost (see ModeSchedule.cpp)
+	{
+		for(ki=ModeStart(t, threads), ki_end=ModeStart(t+1, threads);ki<ki_end;ki++)				// loop through the modes ki(i,j,k) of this range
+		{
+			i = ki/(N*N); j = (ki/N)%N; k = ki%N;
+			zeta[0] = eta[i]; zeta[1] = eta[j]; zeta[2] = eta[k];
+
+			ConvolutionWindow(i, &start_i, &end_i);
+			ConvolutionWindow(j, &start_j, &end_j);
+			ConvolutionWindow(k, &start_k, &end_k);
+
+			tmp0=0.; tmp1=0.;
+			for(l=start_i;l<end_i;l++)
+			{
+				w[0] = eta[l];
+				x = i + N/2 - l;																	// eta[x] = ki[i] - eta[l]
+				for(m=start_j;m<end_j;m++)
+				{
+					w[1] = eta[m];
+					y = j + N/2 - m;
+					for(n=start_k;n<end_k;n++)
+					{
+						w[2] = eta[n];
+						z = k + N/2 - n;
+						kw = n + N*(m + N*l);
+						kz = z + N*(y + N*x);
+
+						tempD = TabulatedWeight(zeta, w, &Shat_w[9*kw], Aiso_w[kw], gamma_mf, false);
+						tmp0 += prefactor*wtN[l]*wtN[m]*wtN[n]*tempD*(gHat[kw][0]*fHat[kz][0] - gHat[kw][1]*fHat[kz][1]);
+						tmp1 += prefactor*wtN[l]*wtN[m]*wtN[n]*tempD*(gHat[kw][0]*fHat[kz][1] + gHat[kw][1]*fHat[kz][0]);
+					}
+				}
+			}
+			qHat[ki][0] = tmp0;
+			qHat[ki][1] = tmp1;
+		}
+	}
+}
+
+void ComputeQ_MatrixFree(double *f, fftw_complex *qHat)												// Function to calculate the Fourier transform of Q(f,f), as in ComputeQ, without the table of convolution weights
+{
+	fft3D(f, fftOut);																			// perform the FFT of f and store the result in fftOut
+
+	MatrixFreeConvolution(fftOut, fftOut, qHat);
+}
+
+void ComputeQLinear_MatrixFree(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat)			// Function to calculate the Fourier transform of Q(f,M), as in ComputeQLinear, without the table of convolution weights
+{
+	fft3D(f, fftOut);																			// perform the FFT of f and store the result in fftOut
+
+	MatrixFreeConvolution(Maxwell_fftOut, fftOut, qHat);
+}
+
+void ComputeQ_FandL_MatrixFree(double *f, fftw_complex *qHat, fftw_complex *qHat_linear)			// Function to calculate the Fourier transforms of the full & linear parts of Q, as in ComputeQ_FandL, without the tables of convolution weights
+{
+	int ki, i, j, k, l, m, n, x, y, z, kw, kz;
+	int t, ki_end, threads = ModeThreads();
+	int start_i, start_j, start_k, end_i, end_j, end_k;
+	double tempD, tempD1, tmp0, tmp1, tmp01, tmp11, zeta[3], w[3];
+	double prefactor = h_eta*h_eta*h_eta;
+
+	fft3D(f, fftOut);																			// perform the FFT of f and store the result in fftOut
+
+	#pragma omp parallel for schedule(static,1) num_threads(threads) private(t,ki_end,ki,i,j,k,l,m,n,x,y,z,kw,kz,start_i,start_j,start_k,end_i,end_j,end_k,tempD,tempD1,tmp0,tmp1,tmp01,tmp11,zeta,w) shared(qHat, qHat_linear, fftOut)
+	for(t=0;t<threads;t++)																			// give each thread one range of modes of about the same cost (see ModeSchedule.cpp)
+	{
+		for(ki=ModeStart(t, threads), ki_end=ModeStart(t+1, threads);ki<ki_end;ki++)
+		{
+			i = ki/(N*N); j = (ki/N)%N; k = ki%N;
+			zeta[0] = eta[i]; zeta[1] = eta[j]; zeta[2] = eta[k];
+
+			ConvolutionWindow(i, &start_i, &end_i);
+			ConvolutionWindow(j, &start_j, &end_j);
+			ConvolutionWindow(k, &start_k, &end_k);
+
+			tmp0=0.; tmp1=0.; tmp01=0.; tmp11=0.;
+			for(l=start_i;l<end_i;l++)
+			{
+				w[0] = eta[l];
+				x = i + N/2 - l;
+				for(m=start_j;m<end_j;m++)
+				{
+					w[1] = eta[m];
+					y = j + N/2 - m;
+					for(n=start_k;n<end_k;n++)
+					{
+						w[2] = eta[n];
+						z = k + N/2 - n;
+						kw = n + N*(m + N*l);
+						kz = z + N*(y + N*x);
+
+						tempD = TabulatedWeight(zeta, w, &Shat_w[9*kw], Aiso_w[kw], gamma_mf, false);
+						tempD1 = TabulatedWeight(zeta, w, &Shat_w_linear[9*kw], Aiso_w[kw], gamma_mf, true);
+						tmp0 += prefactor*wtN[l]*wtN[m]*wtN[n]*(tempD*(fftOut[kw][0]*fftOut[kz][0] - fftOut[kw][1]*fftOut[kz][1]) + scale3*tempD1*fftOut[kz][0]);
+						tmp1 += prefactor*wtN[l]*wtN[m]*wtN[n]*(tempD*(fftOut[kw][0]*fftOut[kz][1] + fftOut[kw][1]*fftOut[kz][0]) + scale3*tempD1*fftOut[kz][1]);
+
+						tmp01 += prefactor*wtN[l]*wtN[m]*wtN[n]*scale3*tempD1*fftOut[kz][0];
+						tmp11 += prefactor*wtN[l]*wtN[m]*wtN[n]*scale3*tempD1*fftOut[kz][1];
+					}
+				}
+			}
+			qHat[ki][0] = tmp0;
+			qHat[ki][1] = tmp1;
+			qHat_linear[ki][0] = tmp01;
+			qHat_linear[ki][1] = tmp11;
+		}
+	}
+}
@@ -0,0 +1,43 @@
+/* This is the header file associated to MatrixFreeCollision.cpp in which the prototypes for the
+ * functions contained in that file are declared.  Any other header files which must be linked to
+ * for the functions here are also included.
+ *
+ */
+
+//************************//
+//     INCLUDE GUARDS     //
+//************************//
+
+#ifndef MATRIXFREECOLLISION_H_
+#define MATRIXFREECOLLISION_H_
+
+//************************//
+//        INCLUDES        //
+//************************//
+
+#include "LP_ompi.h"																				// allows the libraries included, macros defined and external variables declared in LP_ompi.h to be used in the MatrixFreeCollision functions
+#include "collisionRoutines_1.h"																	// allows TabulateShat, TabulatedWeight & fft3D to be used in the MatrixFreeCollision functions
+
+//************************//
+//   FUNCTION PROTOTYPES  //
+//************************//
+
+void InitMatrixFreeTables(int gamma);
+
+void FreeMatrixFreeTables();
+
+double MatrixFreeWeight(int ki, int kw, int variant);
+
+double RelativeMaxDiff(const fftw_complex *a, const fftw_complex *ref, int n);
+
+double RelativeMaxDiff(const double *a, const double *ref, int n);
+
+void ReportEngineDifference(const char *engine, const char *routine, fftw_complex *qHat, fftw_complex *qHat_direct, int cells = 1);
+
+void ComputeQ_MatrixFree(double *f, fftw_complex *qHat);
+
+void ComputeQ_FandL_MatrixFree(double *f, fftw_complex *qHat, fftw_complex *qHat_linear);
+
+void ComputeQLinear_MatrixFree(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat);
+
+#endif /* MATRIXFREECOLLISION_H_ */
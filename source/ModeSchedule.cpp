@@ -0,0 +1,172 @@
+/* This is the source file which contains the schedule used to share the modes ki of the quadrature
+ * sums of the collision operator (ComputeQ_Direct, ComputeQ_FandL_Direct, ComputeQLinear_Direct
+ * and the sums of the FloatWeights, PackedWeights, SymmetricWeights, MatrixFree & BatchedCollisions
+ * paths) out between the OpenMP threads.
+ *
+ * The sum for ki runs over the convolution window of ki, so its cost is the volume of the window,
+ * (end_i - start_i)*(end_j - start_j)*(end_k - start_k).  This ranges from (N/2+1)^3 at the corners
+ * of the Fourier domain to N^3 at its centre.  Parallelising only the outer loop over i gives just N
+ * pieces of work of different sizes, which leaves most of the threads idle for N = 8.  Instead,
+ * InitModeSchedule tabulates the running total of the costs of the modes, and thread t of T is given
+ * the contiguous range of modes ModeStart(t, T) <= ki < ModeStart(t+1, T), in which the running
+ * total passes through t/T and (t+1)/T of the whole.  Each thread then does the same amount of work
+ * (to within one mode), with no scheduling overheads, and its modes are next to each other in the
+ * tables of weights.
+ *
+ * The ranges are found by a binary search of the running total, so they suit any number of threads.
+ * Inside RK4_Concurrent (ConcurrentCells = True) the loops are run by a single thread, which walks
+ * through every range in turn.
+ *
+ * When more than one process holds each space-step (every process in Homogeneous runs, and the
+ * nprocs_modes processes of comm_modes in the grid of ProcessGrid.cpp otherwise), the modes are
+ * first shared out between those processes in the same way (for the Direct & MatrixFree engines,
+ * whose sums are split up by ModeStart): process r of P is given the modes in which the running
+ * total passes from r/P to (r+1)/P of the whole, and the threads of each process share out its
+ * range.  After each sum, GatherModes gives every process of comm_modes the modes of qHat computed
+ * by the others with a single MPI_Allgatherv, so the rest of RK4 is unchanged.
+ *
+ * Functions included: ConvolutionVolume, FirstModeFrom, InitModeSchedule, FreeModeSchedule,
+ * ModeThreads, ModeStart, GatherModes, ModeScheduleBalance
+ *
+ */
+
+#include "ModeSchedule.h"																			// ModeSchedule.h is where the prototypes for the functions contained in this file are declared
+
+static long *mode_cost_total = NULL;																// declare a pointer to mode_cost_total (the total cost of the modes before ki, at mode_cost_total[ki], for 0 <= ki <= size_ft)
+static int mode_share_start, mode_share_end;														// declare mode_share_start & mode_share_end (the range of modes of this process, which is all of them unless the modes are shared between the processes)
+static int *mode_share_counts = NULL, *mode_share_displs = NULL;									// declare pointers to mode_share_counts & mode_share_displs (the number of doubles in the range of modes of each process & the offset of its first, for MPI_Allgatherv; NULL unless the modes are shared between the processes)
+
+long ConvolutionVolume(int ki)																		// Function to return the number of terms in the quadrature sum for the mode ki
+{
+	int start_i, start_j, start_k, end_i, end_j, end_k;
+
+	ConvolutionWindow(ki/(N*N), &start_i, &end_i);
+	ConvolutionWindow((ki/N)%N, &start_j, &end_j);
+	ConvolutionWindow(ki%N, &start_k, &end_k);
+
+	return (long)(end_i - start_i)*(end_j - start_j)*(end_k - start_k);
+}
+
+static int FirstModeFrom(long target)																// Function to return the first mode ki with mode_cost_total[ki] >= target
+{
+	int lo = 0, hi = size_ft, mid;
+
+	while(lo < hi)
+	{
+		mid = (lo + hi)/2;
+		if(mode_cost_total[mid] < target)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+void InitModeSchedule()																				// Function to tabulate the running total of the costs of the modes
+{
+	int ki, r;
+
+	FreeModeSchedule();
+	mode_cost_total = (long *)malloc((size_ft+1)*sizeof(long));
+	mode_cost_total[0] = 0;
+	for(ki=0;ki<size_ft;ki++)
+	{
+		mode_cost_total[ki+1] = mode_cost_total[ki] + ConvolutionVolume(ki);
+	}
+
+	mode_share_start = 0;
+	mode_share_end = size_ft;
+	if(nprocs_modes > 1 && (collision_engine == ENGINE_DIRECT || collision_engine == ENGINE_MATRIXFREE) && ! CompareFloatWeights)
+	{
+		// The processes of comm_modes hold the same f, so share the modes out between them by their cost:
+		mode_share_counts = (int *)malloc(nprocs_modes*sizeof(int));
+		mode_share_displs = (int *)malloc(nprocs_modes*sizeof(int));
+		for(r=0;r<nprocs_modes;r++)
+		{
+			ki = FirstModeFrom((long)((double)mode_cost_total[size_ft]*r/nprocs_modes));
+			mode_share_displs[r] = 2*ki;															// each mode of qHat is two doubles
+			if(r > 0)
+			{
+				mode_share_counts[r-1] = mode_share_displs[r] - mode_share_displs[r-1];
+			}
+		}
+		mode_share_counts[nprocs_modes-1] = 2*size_ft - mode_share_displs[nprocs_modes-1];
+		mode_share_start = mode_share_displs[grid_rank_modes]/2;
+		mode_share_end = mode_share_start + mode_share_counts[grid_rank_modes]/2;
+		if(myrank_mpi==0)
+		{
+			printf("The modes of the collision operator are shared between the %d processes holding each space-step by their cost.\n\n", nprocs_modes);
+		}
+	}
+}
+
+void FreeModeSchedule()																				// Function to delete the running total of the costs of the modes
+{
+	free(mode_cost_total); free(mode_share_counts); free(mode_share_displs);
+	mode_cost_total = NULL;
+	mode_share_counts = NULL;
+	mode_share_displs = NULL;
+}
+
+int ModeThreads()																					// Function to return the number of ranges to share the modes out between (one per thread, or one if the caller is already inside a parallel region, where the loops are not split up again)
+{
+	if(omp_in_parallel())
+	{
+		return 1;
+	}
+	return omp_get_max_threads();
+}
+
+int ModeStart(int t, int threads)																	// Function to return the first mode of the range given to thread t of threads (ModeStart(0, threads) & ModeStart(threads, threads) are the ends of the range of this process, 0 & size_ft unless the modes are shared between the processes)
+{
+	long cost_start, cost_end;
+	int ki;
+
+	if(mode_cost_total == NULL)
+	{
+		return (t >= threads) ? size_ft : (int)((long)size_ft*t/threads);							// share the modes out evenly if the costs have not been tabulated
+	}
+	if(t <= 0)
+	{
+		return mode_share_start;
+	}
+	if(t >= threads)
+	{
+		return mode_share_end;
+	}
+
+	cost_start = mode_cost_total[mode_share_start];
+	cost_end = mode_cost_total[mode_share_end];
+	ki = FirstModeFrom(cost_start + (long)((double)(cost_end - cost_start)*t/threads));
+	return (ki < mode_share_start) ? mode_share_start : (ki > mode_share_end) ? mode_share_end : ki;	// keep the range inside the share of this process
+}
+
+void GatherModes(fftw_complex *qHat)																// Function to give every process of comm_modes the modes of qHat computed by the others (nothing is done unless the modes are shared between the processes)
+{
+	if(mode_share_counts == NULL)
+	{
+		return;
+	}
+	MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, qHat, mode_share_counts, mode_share_displs, MPI_DOUBLE, comm_modes);
+}
+
+double ModeScheduleBalance(int threads)																// Function to return the mean cost of the ranges of the modes given to threads threads divided by the largest (the parallel efficiency the schedule allows)
+{
+	int t;
+	long cost, max_cost = 0;
+
+	if(mode_cost_total == NULL || mode_cost_total[mode_share_end] == mode_cost_total[mode_share_start])
+	{
+		return 1.;
+	}
+	for(t=0;t<threads;t++)
+	{
+		cost = mode_cost_total[ModeStart(t+1, threads)] - mode_cost_total[ModeStart(t, threads)];
+		if(cost > max_cost) max_cost = cost;
+	}
+	return (double)(mode_cost_total[mode_share_end] - mode_cost_total[mode_share_start])/((double)threads*max_cost);
+}
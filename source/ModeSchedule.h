@@ -0,0 +1,39 @@
+/* This is the header file associated to ModeSchedule.cpp in which the prototypes for the
+ * functions contained in that file are declared.  Any other header files which must be linked to
+ * for the functions here are also included.
+ *
+ */
+
+//************************//
+//     INCLUDE GUARDS     //
+//************************//
+
+#ifndef MODESCHEDULE_H_
+#define MODESCHEDULE_H_
+
+//************************//
+//        INCLUDES        //
+//************************//
+
+#include "LP_ompi.h"																				// allows the libraries included, macros defined and external variables declared in LP_ompi.h to be used in the ModeSchedule functions
+#include "collisionRoutines_1.h"																	// allows ConvolutionWindow to be used when finding the cost of each mode
+
+//************************//
+//   FUNCTION PROTOTYPES  //
+//************************//
+
+long ConvolutionVolume(int ki);
+
+void InitModeSchedule();
+
+void FreeModeSchedule();
+
+int ModeThreads();
+
+int ModeStart(int t, int threads);
+
+void GatherModes(fftw_complex *qHat);
+
+double ModeScheduleBalance(int threads);
+
+#endif /* MODESCHEDULE_H_ */
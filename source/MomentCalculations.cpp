@@ -3,6 +3,10 @@
  *
  * Functions included: computeMass, computeMomentum, computeKiE, computeKiEratio, computeEleE
  *
+ * U only holds the chunksize_dg cells of each process (see advection_1.cpp), so each moment is added up
+ * over the cells of this process and the sums of all of the processes are then combined with
+ * MPI_Allreduce.  Every process must therefore call these functions, and they all get the same result.
+ *
  *  Created on: Nov 15, 2017
  */
 
@@ -25,7 +29,8 @@ double computeMass_Inhomo(double *U)
   int k;
   double tmp=0.;
   #pragma omp parallel for shared(U) reduction(+:tmp)
-  for(k=0;k<Nx*size_v;k++) tmp += U[k*6+0] + U[k*6+5]/4.;
+  for(k=chunksize_dg*myrank_mpi;k<chunksize_dg*(myrank_mpi+1);k++) tmp += U[SlabIndex(k, 0)] + U[SlabIndex(k, 5)]/4.;
+  MPI_Allreduce(MPI_IN_PLACE, &tmp, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
 
   return tmp*dx*scalev;
 }
@@ -35,7 +40,8 @@ double computeMass_Homo(double *U)
   int k;
   double tmp=0.;
   #pragma omp parallel for shared(U) reduction(+:tmp)
-  for(k=0;k<size_v;k++) tmp += U[k*6+0] + U[k*6+5]/4.;
+  for(k=chunksize_dg*myrank_mpi;k<chunksize_dg*(myrank_mpi+1);k++) tmp += U[SlabIndex(k, 0)] + U[SlabIndex(k, 5)]/4.;
+  MPI_Allreduce(MPI_IN_PLACE, &tmp, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
 
   return tmp*scalev;
 }
@@ -58,14 +64,16 @@ void computeMomentum_Inhomo(double *U, double *a)
   double tmp1=0., tmp2=0., tmp3=0.;
   a[0]=0.; a[1]=0.; a[2]=0.; // the three momentum
   #pragma omp parallel for private(k,i,j,j1,j2,j3) shared(U) reduction(+:tmp1, tmp2, tmp3)  //reduction directive may change the result a little bit
-  for(k=0;k<Nx*size_v;k++){
+  for(k=chunksize_dg*myrank_mpi;k<chunksize_dg*(myrank_mpi+1);k++){
     j=k%size_v; i=(k-j)/size_v;
     j3=j%Nv; j2=((j-j3)%(Nv*Nv))/Nv; j1=(j-j3-j2*Nv)/(Nv*Nv);
-    tmp1 += Gridv((double)j1)*dv*U[k*6+0] + U[k*6+2]*dv*dv/12. + U[k*6+5]*Gridv((double)j1)*dv/4.;
-    tmp2 += Gridv((double)j2)*dv*U[k*6+0] + U[k*6+3]*dv*dv/12. + U[k*6+5]*Gridv((double)j2)*dv/4.;
-    tmp3 += Gridv((double)j3)*dv*U[k*6+0] + U[k*6+4]*dv*dv/12. + U[k*6+5]*Gridv((double)j3)*dv/4.;
+    tmp1 += Gridv((double)j1)*dv*U[SlabIndex(k, 0)] + U[SlabIndex(k, 2)]*dv*dv/12. + U[SlabIndex(k, 5)]*Gridv((double)j1)*dv/4.;
+    tmp2 += Gridv((double)j2)*dv*U[SlabIndex(k, 0)] + U[SlabIndex(k, 3)]*dv*dv/12. + U[SlabIndex(k, 5)]*Gridv((double)j2)*dv/4.;
+    tmp3 += Gridv((double)j3)*dv*U[SlabIndex(k, 0)] + U[SlabIndex(k, 4)]*dv*dv/12. + U[SlabIndex(k, 5)]*Gridv((double)j3)*dv/4.;
   }
-  a[0]=tmp1*dx*dv*dv; a[1]=tmp2*dx*dv*dv; a[2]=tmp3*dx*dv*dv;
+  double sums[3] = {tmp1, tmp2, tmp3};
+  MPI_Allreduce(MPI_IN_PLACE, sums, 3, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+  a[0]=sums[0]*dx*dv*dv; a[1]=sums[1]*dx*dv*dv; a[2]=sums[2]*dx*dv*dv;
 }
 
 void computeMomentum_Homo(double *U, double *a)
@@ -74,14 +82,16 @@ void computeMomentum_Homo(double *U, double *a)
   double tmp1=0., tmp2=0., tmp3=0.;
   a[0]=0.; a[1]=0.; a[2]=0.; // the three momentum
   #pragma omp parallel for private(k,j,j1,j2,j3) shared(U) reduction(+:tmp1, tmp2, tmp3)  //reduction directive may change the result a little bit
-  for(k=0;k<size_v;k++){
+  for(k=chunksize_dg*myrank_mpi;k<chunksize_dg*(myrank_mpi+1);k++){
     j=k%size_v;
     j3=j%Nv; j2=((j-j3)%(Nv*Nv))/Nv; j1=(j-j3-j2*Nv)/(Nv*Nv);
-    tmp1 += Gridv((double)j1)*dv*U[k*6+0] + U[k*6+2]*dv*dv/12. + U[k*6+5]*Gridv((double)j1)*dv/4.;
-    tmp2 += Gridv((double)j2)*dv*U[k*6+0] + U[k*6+3]*dv*dv/12. + U[k*6+5]*Gridv((double)j2)*dv/4.;
-    tmp3 += Gridv((double)j3)*dv*U[k*6+0] + U[k*6+4]*dv*dv/12. + U[k*6+5]*Gridv((double)j3)*dv/4.;
+    tmp1 += Gridv((double)j1)*dv*U[SlabIndex(k, 0)] + U[SlabIndex(k, 2)]*dv*dv/12. + U[SlabIndex(k, 5)]*Gridv((double)j1)*dv/4.;
+    tmp2 += Gridv((double)j2)*dv*U[SlabIndex(k, 0)] + U[SlabIndex(k, 3)]*dv*dv/12. + U[SlabIndex(k, 5)]*Gridv((double)j2)*dv/4.;
+    tmp3 += Gridv((double)j3)*dv*U[SlabIndex(k, 0)] + U[SlabIndex(k, 4)]*dv*dv/12. + U[SlabIndex(k, 5)]*Gridv((double)j3)*dv/4.;
   }
-  a[0]=tmp1*dv*dv; a[1]=tmp2*dv*dv; a[2]=tmp3*dv*dv;
+  double sums[3] = {tmp1, tmp2, tmp3};
+  MPI_Allreduce(MPI_IN_PLACE, sums, 3, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+  a[0]=sums[0]*dv*dv; a[1]=sums[1]*dv*dv; a[2]=sums[2]*dv*dv;
 }
 
 double computeKiE(double *U)
@@ -101,14 +111,15 @@ double computeKiE_Inhomo(double *U)
   int k, i, j,j1,j2,j3;
   double tmp=0., tp=0., tp1=0.;
   //#pragma omp parallel for private(k,i,j,j1,j2,j3,tp, tp1) shared(U) reduction(+:tmp)
-  for(k=0;k<Nx*size_v;k++){
+  for(k=chunksize_dg*myrank_mpi;k<chunksize_dg*(myrank_mpi+1);k++){
     j=k%size_v; i=(k-j)/size_v;
     j3=j%Nv; j2=((j-j3)%(Nv*Nv))/Nv; j1=(j-j3-j2*Nv)/(Nv*Nv);
     //tp = ( pow(Gridv(j1+0.5), 3)- pow(Gridv(j1-0.5), 3) + pow(Gridv(j2+0.5), 3)- pow(Gridv(j2-0.5), 3) + pow(Gridv(j3+0.5), 3)- pow(Gridv(j3-0.5), 3) )/3.;
     tp1 = Gridv((double)j1)*Gridv((double)j1) + Gridv((double)j2)*Gridv((double)j2) + Gridv((double)j3)*Gridv((double)j3);
     //tmp += U[k][0]*tp + (Gridv(j1)*U[k][2]+Gridv(j2)*U[k][3]+Gridv(j3)*U[k][4])*dv*dv/6. + U[k][5]*( dv*(dv*dv*3./80. + tp1/12.) + tp/6. );
-    tmp += U[k*6+0]*(tp1 + dv*dv/4.)*dv + (Gridv(j1)*U[k*6+2]+Gridv(j2)*U[k*6+3]+Gridv(j3)*U[k*6+4])*dv*dv/6. + U[k*6+5]*( dv*dv*dv*19./240. + tp1*dv/4.);
+    tmp += U[SlabIndex(k, 0)]*(tp1 + dv*dv/4.)*dv + (Gridv(j1)*U[SlabIndex(k, 2)]+Gridv(j2)*U[SlabIndex(k, 3)]+Gridv(j3)*U[SlabIndex(k, 4)])*dv*dv/6. + U[SlabIndex(k, 5)]*( dv*dv*dv*19./240. + tp1*dv/4.);
   }
+  MPI_Allreduce(MPI_IN_PLACE, &tmp, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
   tmp *= dx*dv*dv;
   return 0.5*tmp;
 }
@@ -118,14 +129,15 @@ double computeKiE_Homo(double *U)			// int f |v|^2 dv
   int k, j,j1,j2,j3;
   double tmp=0., tp=0., tp1=0.;
   //#pragma omp parallel for private(k,j,j1,j2,j3,tp, tp1) shared(U) reduction(+:tmp)
-  for(k=0;k<size_v;k++){
+  for(k=chunksize_dg*myrank_mpi;k<chunksize_dg*(myrank_mpi+1);k++){
     j=k%size_v;
     j3=j%Nv; j2=((j-j3)%(Nv*Nv))/Nv; j1=(j-j3-j2*Nv)/(Nv*Nv);
     //tp = ( pow(Gridv(j1+0.5), 3)- pow(Gridv(j1-0.5), 3) + pow(Gridv(j2+0.5), 3)- pow(Gridv(j2-0.5), 3) + pow(Gridv(j3+0.5), 3)- pow(Gridv(j3-0.5), 3) )/3.;
     tp1 = Gridv((double)j1)*Gridv((double)j1) + Gridv((double)j2)*Gridv((double)j2) + Gridv((double)j3)*Gridv((double)j3);
     //tmp += U[k][0]*tp + (Gridv(j1)*U[k][2]+Gridv(j2)*U[k][3]+Gridv(j3)*U[k][4])*dv*dv/6. + U[k][5]*( dv*(dv*dv*3./80. + tp1/12.) + tp/6. );
-    tmp += U[k*6+0]*(tp1 + dv*dv/4.)*dv + (Gridv(j1)*U[k*6+2]+Gridv(j2)*U[k*6+3]+Gridv(j3)*U[k*6+4])*dv*dv/6. + U[k*6+5]*( dv*dv*dv*19./240. + tp1*dv/4.);
+    tmp += U[SlabIndex(k, 0)]*(tp1 + dv*dv/4.)*dv + (Gridv(j1)*U[SlabIndex(k, 2)]+Gridv(j2)*U[SlabIndex(k, 3)]+Gridv(j3)*U[SlabIndex(k, 4)])*dv*dv/6. + U[SlabIndex(k, 5)]*( dv*dv*dv*19./240. + tp1*dv/4.);
   }
+  MPI_Allreduce(MPI_IN_PLACE, &tmp, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
   tmp *= dv*dv;
   return 0.5*tmp;
 }
@@ -150,24 +162,26 @@ double computeKiEratio_Inhomo(double *U, int *NegVals)
 	KiEpos = 0;
 	KiEneg = 0;
 	#pragma omp parallel for private(k,i,j,j1,j2,j3,tp, tp1) shared(U) reduction(+:KiEpos,KiEneg)
-	for(k=0;k<Nx*size_v;k++)
+	for(k=chunksize_dg*myrank_mpi;k<chunksize_dg*(myrank_mpi+1);k++)
 	{
-		if(NegVals[k] == 0)
+		if(NegVals[k - chunksize_dg*myrank_mpi] == 0)
 		{
 			j=k%size_v; i=(k-j)/size_v;
 			j3=j%Nv; j2=((j-j3)%(Nv*Nv))/Nv; j1=(j-j3-j2*Nv)/(Nv*Nv);
 			tp1 = Gridv((double)j1)*Gridv((double)j1) + Gridv((double)j2)*Gridv((double)j2) + Gridv((double)j3)*Gridv((double)j3);
-			KiEpos += U[k*6+0]*(tp1 + dv*dv/4.)*dv + (Gridv(j1)*U[k*6+2]+Gridv(j2)*U[k*6+3]+Gridv(j3)*U[k*6+4])*dv*dv/6. + U[k*6+5]*( dv*dv*dv*19./240. + tp1*dv/4.);
+			KiEpos += U[SlabIndex(k, 0)]*(tp1 + dv*dv/4.)*dv + (Gridv(j1)*U[SlabIndex(k, 2)]+Gridv(j2)*U[SlabIndex(k, 3)]+Gridv(j3)*U[SlabIndex(k, 4)])*dv*dv/6. + U[SlabIndex(k, 5)]*( dv*dv*dv*19./240. + tp1*dv/4.);
 		}
 		else
 		{
 			j=k%size_v; i=(k-j)/size_v;
 			j3=j%Nv; j2=((j-j3)%(Nv*Nv))/Nv; j1=(j-j3-j2*Nv)/(Nv*Nv);
 			tp1 = Gridv((double)j1)*Gridv((double)j1) + Gridv((double)j2)*Gridv((double)j2) + Gridv((double)j3)*Gridv((double)j3);
-			KiEneg += U[k*6+0]*(tp1 + dv*dv/4.)*dv + (Gridv(j1)*U[k*6+2]+Gridv(j2)*U[k*6+3]+Gridv(j3)*U[k*6+4])*dv*dv/6. + U[k*6+5]*( dv*dv*dv*19./240. + tp1*dv/4.);
+			KiEneg += U[SlabIndex(k, 0)]*(tp1 + dv*dv/4.)*dv + (Gridv(j1)*U[SlabIndex(k, 2)]+Gridv(j2)*U[SlabIndex(k, 3)]+Gridv(j3)*U[SlabIndex(k, 4)])*dv*dv/6. + U[SlabIndex(k, 5)]*( dv*dv*dv*19./240. + tp1*dv/4.);
 		}
 	}
-	return KiEneg/KiEpos;
+	double KiE_sums[2] = {KiEpos, KiEneg};
+	MPI_Allreduce(MPI_IN_PLACE, KiE_sums, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+	return KiE_sums[1]/KiE_sums[0];
 }
 
 double computeKiEratio_Homo(double *U, int *NegVals)
@@ -178,53 +192,57 @@ double computeKiEratio_Homo(double *U, int *NegVals)
 	KiEpos = 0;
 	KiEneg = 0;
 	#pragma omp parallel for private(k,j,j1,j2,j3,tp, tp1) shared(U) reduction(+:KiEpos,KiEneg)
-	for(k=0;k<size_v;k++)
+	for(k=chunksize_dg*myrank_mpi;k<chunksize_dg*(myrank_mpi+1);k++)
 	{
-		if(NegVals[k] == 0)
+		if(NegVals[k - chunksize_dg*myrank_mpi] == 0)
 		{
 			j=k%size_v;
 			j3=j%Nv; j2=((j-j3)%(Nv*Nv))/Nv; j1=(j-j3-j2*Nv)/(Nv*Nv);
 			tp1 = Gridv((double)j1)*Gridv((double)j1) + Gridv((double)j2)*Gridv((double)j2) + Gridv((double)j3)*Gridv((double)j3);
-			KiEpos += U[k*6+0]*(tp1 + dv*dv/4.)*dv + (Gridv(j1)*U[k*6+2]+Gridv(j2)*U[k*6+3]+Gridv(j3)*U[k*6+4])*dv*dv/6. + U[k*6+5]*( dv*dv*dv*19./240. + tp1*dv/4.);
+			KiEpos += U[SlabIndex(k, 0)]*(tp1 + dv*dv/4.)*dv + (Gridv(j1)*U[SlabIndex(k, 2)]+Gridv(j2)*U[SlabIndex(k, 3)]+Gridv(j3)*U[SlabIndex(k, 4)])*dv*dv/6. + U[SlabIndex(k, 5)]*( dv*dv*dv*19./240. + tp1*dv/4.);
 		}
 		else
 		{
 			j=k%size_v;
 			j3=j%Nv; j2=((j-j3)%(Nv*Nv))/Nv; j1=(j-j3-j2*Nv)/(Nv*Nv);
 			tp1 = Gridv((double)j1)*Gridv((double)j1) + Gridv((double)j2)*Gridv((double)j2) + Gridv((double)j3)*Gridv((double)j3);
-			KiEneg += U[k*6+0]*(tp1 + dv*dv/4.)*dv + (Gridv(j1)*U[k*6+2]+Gridv(j2)*U[k*6+3]+Gridv(j3)*U[k*6+4])*dv*dv/6. + U[k*6+5]*( dv*dv*dv*19./240. + tp1*dv/4.);
+			KiEneg += U[SlabIndex(k, 0)]*(tp1 + dv*dv/4.)*dv + (Gridv(j1)*U[SlabIndex(k, 2)]+Gridv(j2)*U[SlabIndex(k, 3)]+Gridv(j3)*U[SlabIndex(k, 4)])*dv*dv/6. + U[SlabIndex(k, 5)]*( dv*dv*dv*19./240. + tp1*dv/4.);
 		}
 	}
-	return KiEneg/KiEpos;
+	double KiE_sums[2] = {KiEpos, KiEneg};
+	MPI_Allreduce(MPI_IN_PLACE, KiE_sums, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+	return KiE_sums[1]/KiE_sums[0];
 }
 
 double computeEleE(double *U)
 {
-  int k, i, j;
+  int i;
   double retn, tmp1=0., tmp2=0., tmp3=0., tmp4=0., tmp5=0., tmp6=0., tmp7=0., tp1, tp2, c;
   double ce1, cp1;
-  ce1 = computePhi_x_0(U);
+  double *charge = (double*)malloc(2*Nx*sizeof(double));
+
+  ChargeSums(U, chunksize_dg*myrank_mpi, chunksize_dg*(myrank_mpi+1), charge); // the electric energy only depends on two sums of U in each space cell (as in RK3), so these are added up over all of the processes
+  MPI_Allreduce(MPI_IN_PLACE, charge, 2*Nx, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+  FieldIntegralsFromCharge(charge); // sets ce = computePhi_x_0(U) & cp[i] = computeC_rho(U,i)
+  ce1 = ce;
 
   tmp1 = ce1*ce1*Lx;
   tmp2 = Lx*Lx*Lx/3.; tmp3 = -ce1*Lx*Lx;
 
-  //#pragma omp parallel for private(j,k, i, tp1, tp2, cp1, c) shared(U) reduction(+:tmp4, tmp5, tmp6)
+  //#pragma omp parallel for private(i, tp1, tp2, cp1, c) shared(charge) reduction(+:tmp4, tmp5, tmp6)
   for(i=0;i<Nx;i++){
-    c = Int_Int_rho(U,i);
-    cp1 = computeC_rho(U,i);
+    tp1 = charge[2*i];
+    tp2 = charge[2*i+1];
+    c = (0.5*tp1 - tp2/12.)*dx*dx*scalev; // Int_Int_rho(U,i)
+    cp1 = cp[i];
     tmp4 += dx*cp1 + c;
     tmp5 += dx*Gridx((double)i)*cp1;
-    tp1=0.; tp2=0.;
-    for(j=0;j<size_v;j++){
-      k = i*size_v + j;
-      tp1 += (U[k*6+0] + U[k*6+5]/4.);
-      tp2 += U[k*6+1];
-    }
     tmp5 += scalev* (tp1*( (pow(Gridx(i+0.5), 3) - pow(Gridx(i-0.5), 3))/3. - Gridx(i-0.5)*Gridx((double)i)*dx ) - tp2 * dx*dx*Gridx((double)i)/12.);
 
     tp2 *= dx/2.;
     tmp6 +=  cp1*cp1*dx + 2*cp1*c + pow(dv, 6)* ( tp1*tp1*dx*dx*dx/3. + tp2*tp2*dx/30. - tp1*tp2*dx*dx/6.);//+ tp1*tp2*(dx*Gridx((double)i)/6. - dx*dx/4.) ); //Int_Cumulativerho_sqr(i);
   }
+  free(charge);
   retn = tmp1 + tmp2 + tmp3 + 2*ce1*tmp4 - 2*tmp5 + tmp6;
   return 0.5*retn;
 }
@@ -3,6 +3,9 @@
  *
  * Functions included: computeCellAvg, FindNegVals, FindNegVals_old, CheckNegVals
  *
+ * The cell averages are only found for the cells held by this process in U (see advection_1.cpp), so
+ * NegVals & AvgVals hold chunksize_dg entries, one for each of those cells.
+ *
  *  Created on: Nov 15, 2017
  */
 
@@ -46,9 +49,9 @@ double computeCellAvg_Inhomo(double *U, int i, int j1, int j2, int j3)
 				for(nv3=0;nv3<5;nv3++)																								// loop through the five quadrature points in the v3 direction of the cell
 				{
 					v3_val = v3_0 + 0.5*vt[nv3]*dv;																					// set x_val to the nv3-th quadrature point in the cell
-					f_val = U[k*6+0] + U[k*6+1]*(x_val-x_0)/dx + U[k*6+2]*(v1_val-v1_0)/dv +
-							U[k*6+3]*(v2_val-v2_0)/dv + U[k*6+4]*(v3_val-v3_0)/dv +
-							U[k*6+5]*(((v1_val-v1_0)/dv)*((v1_val-v1_0)/dv)+((v2_val-v2_0)/dv)*((v2_val-v2_0)/dv)
+					f_val = U[SlabIndex(k, 0)] + U[SlabIndex(k, 1)]*(x_val-x_0)/dx + U[SlabIndex(k, 2)]*(v1_val-v1_0)/dv +
+							U[SlabIndex(k, 3)]*(v2_val-v2_0)/dv + U[SlabIndex(k, 4)]*(v3_val-v3_0)/dv +
+							U[SlabIndex(k, 5)]*(((v1_val-v1_0)/dv)*((v1_val-v1_0)/dv)+((v2_val-v2_0)/dv)*((v2_val-v2_0)/dv)
 									+((v3_val-v3_0)/dv)*((v3_val-v3_0)/dv));														// set f_val to the evaluation of the approximation at (x_val,v1_val,v2_val,v3_val)
 					avg += wt[nx]*wt[nv1]*wt[nv2]*wt[nv3]*f_val;																	// add f(x_val,v1_val,v2_val,v3_val) times the quadrature weights corresponding to the current x & v values to the current quadrature value
 				}
@@ -79,9 +82,9 @@ double computeCellAvg_Homo(double *U, int j1, int j2, int j3)
 			for(nv3=0;nv3<5;nv3++)																									// loop through the five quadrature points in the v3 direction of the cell
 			{
 				v3_val = v3_0 + 0.5*vt[nv3]*dv;																						// set x_val to the nv3-th quadrature point in the cell
-				f_val = U[k*6+0] + U[k*6+2]*(v1_val-v1_0)/dv +
-						U[k*6+3]*(v2_val-v2_0)/dv + U[k*6+4]*(v3_val-v3_0)/dv +
-						U[k*6+5]*(((v1_val-v1_0)/dv)*((v1_val-v1_0)/dv)+((v2_val-v2_0)/dv)*((v2_val-v2_0)/dv)
+				f_val = U[SlabIndex(k, 0)] + U[SlabIndex(k, 2)]*(v1_val-v1_0)/dv +
+						U[SlabIndex(k, 3)]*(v2_val-v2_0)/dv + U[SlabIndex(k, 4)]*(v3_val-v3_0)/dv +
+						U[SlabIndex(k, 5)]*(((v1_val-v1_0)/dv)*((v1_val-v1_0)/dv)+((v2_val-v2_0)/dv)*((v2_val-v2_0)/dv)
 								+((v3_val-v3_0)/dv)*((v3_val-v3_0)/dv));															// set f_val to the evaluation of the approximation at (x_val,v1_val,v2_val,v3_val)
 				avg += wt[nv1]*wt[nv2]*wt[nv3]*f_val;																				// add f(x_val,v1_val,v2_val,v3_val) times the quadrature weights corresponding to the current x & v values to the current quadrature value
 			}
@@ -107,8 +110,9 @@ void FindNegVals_Inhomo(double *U, int *NegVals, double *AvgVals)
 {
 	int i, j1, j2, j3, iNNN, j1NN, j2N, k, nx, nv1, nv2, nv3;																		// declare i (the index of the space cell), j1, j2, j3 (the indices of the velocity cell), iNNN (to store i*Nv^3), j1NN (to store j1*Nv^2), j2N (to store j2*Nv), k (the location of the given cell in U), nx (a counter for the space cell) & nv1, nv2, nv3 (counters for the velocity cell)
 	double x_val, v1_val, v2_val, v3_val, f_avg;																					// declare x_val, v1_val, v2_val, v3_val (to store the x & v values to be evaluated at) & f_val (to store the value of the function evaluated at the current x & v values)
+	int i_first = chunksize_dg*myrank_mpi/size_v, i_end = (chunksize_dg*(myrank_mpi+1) - 1)/size_v + 1;												// declare i_first & i_end (the space cells i_first,...,i_end-1 hold the cells of this process, since U only holds those)
 	#pragma omp parallel for private(i,j1,j2,j3,k,iNNN,j1NN,j2N,f_avg) shared(U,NegVals,AvgVals,size_v,Nv)
-	for(i=0;i<Nx;i++)																												// loop through the space cells
+	for(i=i_first;i<i_end;i++)																														// loop through the space cells of this process
 	{
 		iNNN = i*size_v;																											// set iNNN to i*Nv^3
 		for(j1=0;j1<Nv;j1++)																										// loop through the velocity cells in the v1 direction
@@ -120,12 +124,16 @@ void FindNegVals_Inhomo(double *U, int *NegVals, double *AvgVals)
 				for(j3=0;j3<Nv;j3++)																								// loop through the velocity cells in the v3 direction
 				{
 					k = iNNN + j1NN + j2N + j3;																						// set k to i*Nv^3 + j1*Nv^2 + j2*Nv + j3
-					NegVals[k] = 0;																									// set NegVals[k] to 0, which assumes at first that there will be no negative values in the kth cell
+					if(! HoldsCell(k))																								// U only holds the cells of this process
+					{
+						continue;
+					}
+					NegVals[k - chunksize_dg*myrank_mpi] = 0;																		// set NegVals[k - chunksize_dg*myrank_mpi] to 0, which assumes at first that there will be no negative values in the kth cell
 					f_avg = computeCellAvg_Inhomo(U,i,j1,j2,j3);																			// calculate the average value of the approximate solution in the current cell and set it to f_avg
-					AvgVals[k] = f_avg;																								// store f_avg in AvgVals[k]
+					AvgVals[k - chunksize_dg*myrank_mpi] = f_avg;																	// store f_avg in AvgVals[k - chunksize_dg*myrank_mpi]
 					if(f_avg < 0)																									// check if this value was negative
 					{
-						NegVals[k] = 1;																								// if so, set NegVals[k] to 1 to indicate that there was a negative value in this cell
+						NegVals[k - chunksize_dg*myrank_mpi] = 1;																	// if so, set NegVals[k - chunksize_dg*myrank_mpi] to 1 to indicate that there was a negative value in this cell
 					}
 				}
 			}
@@ -147,12 +155,16 @@ void FindNegVals_Homo(double *U, int *NegVals, double *AvgVals)
 			for(j3=0;j3<Nv;j3++)																									// loop through the velocity cells in the v3 direction
 			{
 				k = j1NN + j2N + j3;																								// set k to j1*Nv^2 + j2*Nv + j3
-				NegVals[k] = 0;																										// set NegVals[k] to 0, which assumes at first that there will be no negative values in the kth cell
+				if(! HoldsCell(k))																									// U only holds the cells of this process
+				{
+					continue;
+				}
+				NegVals[k - chunksize_dg*myrank_mpi] = 0;																			// set NegVals[k - chunksize_dg*myrank_mpi] to 0, which assumes at first that there will be no negative values in the kth cell
 				f_avg = computeCellAvg_Homo(U,j1,j2,j3);																					// calculate the average value of the approximate solution in the current cell and set it to f_avg
-				AvgVals[k] = f_avg;																									// store f_avg in AvgVals[k]
+				AvgVals[k - chunksize_dg*myrank_mpi] = f_avg;																		// store f_avg in AvgVals[k - chunksize_dg*myrank_mpi]
 				if(f_avg < 0)																										// check if this value was negative
 				{
-					NegVals[k] = 1;																									// if so, set NegVals[k] to 1 to indicate that there was a negative value in this cell
+					NegVals[k - chunksize_dg*myrank_mpi] = 1;																		// if so, set NegVals[k - chunksize_dg*myrank_mpi] to 1 to indicate that there was a negative value in this cell
 				}
 			}
 		}
@@ -229,7 +241,8 @@ void CheckNegVals_Inhomo(double *U, int *NegVals, double *AvgVals)
 {
 	int i, j1, j2, j3, iNNN, j1NN, j2N, k;																							// declare i (the index of the space cell), j1, j2, j3 (the indices of the velocity cell), iNNN (to store i*Nv^3), j1NN (to store j1*Nv^2), j2N (to store j2*Nv), k (the location of the given cell in U), nx (a counter for the space cell) & nv1, nv2, nv3 (counters for the velocity cell)
 	double f_avg;																													// declare x_0, v1_0, v2_0, v3_0 (to store the coordinates in the middle of the current cell), x_val, v1_val, v2_val, v3_val (to store the x & v values to be evaluated at) & f_val (to store the value of the function evaluated at the current x & v values)
-	for(i=0;i<Nx;i++)
+	int i_first = chunksize_dg*myrank_mpi/size_v, i_end = (chunksize_dg*(myrank_mpi+1) - 1)/size_v + 1;												// declare i_first & i_end (the space cells i_first,...,i_end-1 hold the cells of this process, since U only holds those)
+	for(i=i_first;i<i_end;i++)																														// loop through the space cells of this process
 	{
 		iNNN = i*size_v;																											// set iNNN to i*Nv^3
 		for(j1=0;j1<Nv;j1++)																										// loop through the velocity cells in the v1 direction
@@ -241,7 +254,11 @@ void CheckNegVals_Inhomo(double *U, int *NegVals, double *AvgVals)
 				for(j3=0;j3<Nv;j3++)																								// loop through the velocity cells in the v3 direction
 				{
 					k = iNNN + j1NN + j2N + j3;																						// set k to i*Nv^3 + j1*Nv^2 + j2*Nv + j3
-					printf("%d ~ (%d, %d, %d, %d) f_avg = %g \n", NegVals[k], i, j1, j2, j3, AvgVals[k]);
+					if(! HoldsCell(k))																								// U only holds the cells of this process
+					{
+						continue;
+					}
+					printf("%d ~ (%d, %d, %d, %d) f_avg = %g \n", NegVals[k - chunksize_dg*myrank_mpi], i, j1, j2, j3, AvgVals[k - chunksize_dg*myrank_mpi]);
 					printf(" \n");
 				}
 			}
@@ -262,7 +279,11 @@ void CheckNegVals_Homo(double *U, int *NegVals, double *AvgVals)
 			for(j3=0;j3<Nv;j3++)																									// loop through the velocity cells in the v3 direction
 			{
 				k = j1NN + j2N + j3;																								// set k to j1*Nv^2 + j2*Nv + j3
-				printf("%d ~ (%d, %d, %d) f_avg = %g \n", NegVals[k], j1, j2, j3, AvgVals[k]);
+				if(! HoldsCell(k))																									// U only holds the cells of this process
+				{
+					continue;
+				}
+				printf("%d ~ (%d, %d, %d) f_avg = %g \n", NegVals[k - chunksize_dg*myrank_mpi], j1, j2, j3, AvgVals[k - chunksize_dg*myrank_mpi]);
 				printf(" \n");
 			}
 		}
@@ -0,0 +1,141 @@
+/* This is the source file which contains the quadrature sums used by the Direct collision engine
+ * when PackedWeights = True.  They compute the same sums as ComputeQ_Direct, ComputeQ_FandL_Direct &
+ * ComputeQLinear_Direct, but read the convolution weights from the packed tables built by
+ * GetPackedWeightTable.  Each row of a packed table only holds the entries inside the convolution
+ * window of ki, in the order the loops over (l,m,n) below visit them, so the weights of each row are
+ * read as one contiguous stream from a single aligned block.  The factor h_eta^3*wtN[l]*wtN[m]*wtN[n]
+ * is already multiplied into each entry, so it is no longer found for every term of the sums (only
+ * the rounding of these products changes the results).
+ *
+ * Functions included: InitPackedWeights, PackedConvolution, ComputeQ_PackedWeights,
+ * ComputeQ_FandL_PackedWeights, ComputeQLinear_PackedWeights
+ *
+ */
+
+#include "PackedWeightCollision.h"																	// PackedWeightCollision.h is where the prototypes for the functions contained in this file are declared
+
+static double *conv_weights_packed, *conv_weights_linear_packed;									// declare pointers to the packed tables of gHat3 & gHat3_linear weights
+static const long *row_start;																		// declare a pointer to row_start (the index in the packed tables of the first entry of each row)
+
+void InitPackedWeights(int gamma)																	// Function to build the packed tables of weights (they are deleted by FreeWeightTables)
+{
+	conv_weights_packed = GetPackedWeightTable(WEIGHTS_LANDAU, gamma, &row_start);
+	if(FullandLinear)
+	{
+		conv_weights_linear_packed = GetPackedWeightTable(WEIGHTS_LINEAR, gamma, &row_start);
+	}
+}
+
+static void PackedConvolution(fftw_complex *gHat, fftw_complex *fHat, fftw_complex *qHat)			// Function to calculate qHat(ki) = sum over w of gHat3(ki,w)*gHat(w)*fHat(ki-w) (with the same quadrature as ComputeQ), reading the packed weights
+{
+	int ki, i, j, k, l, m, n, x, y, z, kw, kz;
+	int t, ki_end, threads = ModeThreads();
+	int start_i, start_j, start_k, end_i, end_j, end_k;
+	double tmp0, tmp1;
+	const double *W;
+
+	#pragma omp parallel for schedule(static,1) num_threads(threads) private(t,ki_end,ki,i,j,k,l,m,n,x,y,z,kw,kz,start_i,start_j,start_k,end_i,end_j,end_k,tmp0,tmp1,W) shared(qHat, gHat, fHat)
+	for(t=0;t<threads;t++)																			// give each thread one range of modes of about the same cost (see ModeSchedule.cpp)
+	{
+		for(ki=ModeStart(t, threads), ki_end=ModeStart(t+1, threads);ki<ki_end;ki++)
+		{
+			i = ki/(N*N); j = (ki/N)%N; k = ki%N;
+			W = conv_weights_packed + row_start[ki];												// the entries of the row ki, which are read in order by the loops below
+
+			ConvolutionWindow(i, &start_i, &end_i);
+			ConvolutionWindow(j, &start_j, &end_j);
+			ConvolutionWindow(k, &start_k, &end_k);
+
+			tmp0=0.; tmp1=0.;
+			for(l=start_i;l<end_i;l++)
+			{
+				x = i + N/2 - l;																	// eta[x] = ki[i] - eta[l]
+				for(m=start_j;m<end_j;m++)
+				{
+					y = j + N/2 - m;
+					for(n=start_k;n<end_k;n++)
+					{
+						z = k + N/2 - n;
+						kw = n + N*(m + N*l);
+						kz = z + N*(y + N*x);
+
+						tmp0 += *W*(gHat[kw][0]*fHat[kz][0] - gHat[kw][1]*fHat[kz][1]);
+						tmp1 += *W*(gHat[kw][0]*fHat[kz][1] + gHat[kw][1]*fHat[kz][0]);
+						W++;
+					}
+				}
+			}
+			qHat[ki][0] = tmp0;
+			qHat[ki][1] = tmp1;
+		}
+	}
+}
+
+void ComputeQ_PackedWeights(double *f, fftw_complex *qHat)											// Function to calculate the Fourier transform of Q(f,f), as in ComputeQ, with the packed weights
+{
+	fftw_complex *fftOut = CurrentCollisionWorkspace()->fftOut;										// the spectrum of f is stored in this thread's workspace (the global fftOut unless the space-steps are run concurrently)
+
+	fft3D(f, fftOut);																				// perform the FFT of f and store the result in fftOut
+
+	PackedConvolution(fftOut, fftOut, qHat);
+}
+
+void ComputeQ_FandL_PackedWeights(double *f, fftw_complex *qHat, fftw_complex *qHat_linear)			// Function to calculate the Fourier transforms of the full & linear parts of Q, as in ComputeQ_FandL, with the packed weights
+{
+	int ki, i, j, k, l, m, n, x, y, z, kw, kz;
+	int t, ki_end, threads = ModeThreads();
+	int start_i, start_j, start_k, end_i, end_j, end_k;
+	double tmp0, tmp1, tmp01, tmp11;
+	const double *W, *W1;
+
+	fft3D(f, fftOut);																				// perform the FFT of f and store the result in fftOut
+
+	#pragma omp parallel for schedule(static,1) num_threads(threads) private(t,ki_end,ki,i,j,k,l,m,n,x,y,z,kw,kz,start_i,start_j,start_k,end_i,end_j,end_k,tmp0,tmp1,tmp01,tmp11,W,W1) shared(qHat, qHat_linear, fftOut)
+	for(t=0;t<threads;t++)																			// give each thread one range of modes of about the same cost (see ModeSchedule.cpp)
+	{
+		for(ki=ModeStart(t, threads), ki_end=ModeStart(t+1, threads);ki<ki_end;ki++)
+		{
+			i = ki/(N*N); j = (ki/N)%N; k = ki%N;
+			W = conv_weights_packed + row_start[ki];
+			W1 = conv_weights_linear_packed + row_start[ki];
+
+			ConvolutionWindow(i, &start_i, &end_i);
+			ConvolutionWindow(j, &start_j, &end_j);
+			ConvolutionWindow(k, &start_k, &end_k);
+
+			tmp0=0.; tmp1=0.; tmp01=0.; tmp11=0.;
+			for(l=start_i;l<end_i;l++)
+			{
+				x = i + N/2 - l;
+				for(m=start_j;m<end_j;m++)
+				{
+					y = j + N/2 - m;
+					for(n=start_k;n<end_k;n++)
+					{
+						z = k + N/2 - n;
+						kw = n + N*(m + N*l);
+						kz = z + N*(y + N*x);
+
+						tmp0 += *W*(fftOut[kw][0]*fftOut[kz][0] - fftOut[kw][1]*fftOut[kz][1]);
+						tmp1 += *W*(fftOut[kw][0]*fftOut[kz][1] + fftOut[kw][1]*fftOut[kz][0]);
+
+						tmp01 += *W1*fftOut[kz][0];
+						tmp11 += *W1*fftOut[kz][1];
+						W++; W1++;
+					}
+				}
+			}
+			qHat_linear[ki][0] = scale3*tmp01;														// scale3 is the same for every term, so it is applied once to the linear sums
+			qHat_linear[ki][1] = scale3*tmp11;
+			qHat[ki][0] = tmp0 + qHat_linear[ki][0];												// the full part of Q also includes the linear part
+			qHat[ki][1] = tmp1 + qHat_linear[ki][1];
+		}
+	}
+}
+
+void ComputeQLinear_PackedWeights(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat)		// Function to calculate the Fourier transform of Q(f,M), as in ComputeQLinear, with the packed weights
+{
+	fft3D(f, fftOut);																				// perform the FFT of f and store the result in fftOut
+
+	PackedConvolution(Maxwell_fftOut, fftOut, qHat);
+}
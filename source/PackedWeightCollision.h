@@ -0,0 +1,36 @@
+/* This is the header file associated to PackedWeightCollision.cpp in which the prototypes for the
+ * functions contained in that file are declared.  Any other header files which must be linked to
+ * for the functions here are also included.
+ *
+ */
+
+//************************//
+//     INCLUDE GUARDS     //
+//************************//
+
+#ifndef PACKEDWEIGHTCOLLISION_H_
+#define PACKEDWEIGHTCOLLISION_H_
+
+//************************//
+//        INCLUDES        //
+//************************//
+
+#include "LP_ompi.h"																				// allows the libraries included, macros defined and external variables declared in LP_ompi.h to be used in the PackedWeightCollision functions
+#include "collisionRoutines_1.h"																	// allows fft3D to be used in the PackedWeightCollision functions
+#include "WeightStore.h"																			// allows the WEIGHTS_ kernel variants to be used
+#include "WeightTables.h"																			// allows GetPackedWeightTable to be used
+#include "CollisionWorkspace.h"																		// allows CurrentCollisionWorkspace to be used
+
+//************************//
+//   FUNCTION PROTOTYPES  //
+//************************//
+
+void InitPackedWeights(int gamma);
+
+void ComputeQ_PackedWeights(double *f, fftw_complex *qHat);
+
+void ComputeQ_FandL_PackedWeights(double *f, fftw_complex *qHat, fftw_complex *qHat_linear);
+
+void ComputeQLinear_PackedWeights(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat);
+
+#endif /* PACKEDWEIGHTCOLLISION_H_ */
@@ -0,0 +1,246 @@
+/* This is the source file which contains the two-dimensional grid of MPI processes used by the
+ * collision step.
+ *
+ * In the space inhomogeneous problem the space-steps are given out to the processes in whole chunks
+ * of chunk_Nx, so with more processes than Nx the extra ones would have nothing to do.  Instead, the
+ * processes are arranged in a Cartesian grid of (nprocs_mpi/nprocs_modes) x nprocs_modes: the
+ * space-steps are shared out along the first axis, and the nprocs_modes processes along the second
+ * axis (those in comm_modes) all hold the same space-steps.  Each of them computes its share of the
+ * modes of every quadrature sum (see ModeSchedule.cpp, which gathers qHat over comm_modes), and
+ * projects & updates only its chunk_kt velocity cells in the last step of RK4.  GatherProjectedCells
+ * then collects the cells of the whole chunk of space-steps on the first process of comm_modes,
+ * which sends them on to the processes holding them in U (see below).
+ *
+ * By default nprocs_modes is 1 unless there are more processes than Nx, in which case it is the
+ * smallest factor of nprocs_mpi which leaves no more than Nx processes along the first axis.  It
+ * may also be set with ModeProcesses.  In the space homogeneous problem every process holds the same
+ * f, so the grid is 1 x nprocs_mpi.
+ *
+ * U only holds the chunksize_dg cells of each process, in the order used by RK3 (see advection_1.cpp),
+ * and these do not line up with the space-steps of the grid.  So before the collision step
+ * FetchCollisionCells copies the cells of the space-steps of each process (all of the cells in the space
+ * homogeneous problem) from the processes which hold them into U_coll, and afterwards
+ * ScatterCollisionStep sends the coefficients updated in dU back to the processes which hold those
+ * cells in U, each with a single MPI_Alltoallv.  The five coefficients (0,2,3,4,5) of each cell of dU
+ * are received with a datatype which places them straight into the six coefficients of the cell in U.
+ * The coefficient 1 of every cell is not changed by the collision step.
+ *
+ * Functions included: InitProcessGrid, FreeProcessGrid, GatherProjectedCells, CollisionCells, UpdatedCells,
+ * SharedCells, InitCellExchange, FetchCollisionCells, ScatterCollisionStep
+ *
+ */
+
+#include "ProcessGrid.h"																			// ProcessGrid.h is where the prototypes for the functions contained in this file are declared
+
+static MPI_Comm comm_grid = MPI_COMM_NULL;															// declare comm_grid (the Cartesian communicator of all of the processes)
+static MPI_Datatype cells_send = MPI_DATATYPE_NULL, cells_recv = MPI_DATATYPE_NULL;					// declare cells_send & cells_recv (the velocity cells of dU updated by one process of comm_modes, in each space-step of the chunk, and the same resized so that the cells of consecutive processes follow each other)
+static MPI_Datatype cell_coeffs = MPI_DATATYPE_NULL;												// declare cell_coeffs (the coefficients 0, 2, 3, 4 & 5 of one cell of U, which the five values of the cell in dU are written to)
+static int *fetch_send_counts = NULL, *fetch_send_displs = NULL;									// declare pointers to fetch_send_counts & fetch_send_displs (the number of coefficients of U sent to each process by FetchCollisionCells & the index of the first)
+static int *fetch_recv_counts = NULL, *fetch_recv_displs = NULL;									// declare pointers to fetch_recv_counts & fetch_recv_displs (the number of coefficients of U_coll received from each process by FetchCollisionCells & the index of the first)
+static int *scatter_send_counts = NULL, *scatter_send_displs = NULL;								// declare pointers to scatter_send_counts & scatter_send_displs (the number of values of dU sent to each process by ScatterCollisionStep & the index of the first)
+static int *scatter_recv_counts = NULL, *scatter_recv_displs = NULL;								// declare pointers to scatter_recv_counts & scatter_recv_displs (the number of cells of U received from each process by ScatterCollisionStep & the first of them)
+
+void InitProcessGrid()																				// Function to arrange the processes in the grid of space-steps x modes and set nprocs_modes, grid_rank_x, grid_rank_modes, chunk_kt & comm_modes
+{
+	int dims[2], periods[2] = {0, 0}, coords[2], keep[2] = {0, 1};
+	int d;
+
+	if(Homogeneous)
+	{
+		nprocs_modes = nprocs_mpi;																	// every process holds the same f
+	}
+	else if(mode_processes > 0)
+	{
+		if(nprocs_mpi % mode_processes != 0)
+		{
+			if(myrank_mpi==0)
+			{
+				printf("Program cannot run... ModeProcesses = %d must be a factor of the number of processes (%d).\n", mode_processes, nprocs_mpi);
+			}
+			MPI_Finalize();
+			exit(1);
+		}
+		nprocs_modes = mode_processes;
+	}
+	else
+	{
+		d = 1;
+		while(nprocs_mpi/d > Nx || nprocs_mpi % d != 0)												// find the smallest factor of nprocs_mpi which leaves at most Nx processes along the space-steps
+		{
+			d++;
+		}
+		nprocs_modes = d;
+	}
+
+	if(nprocs_modes > 1 && ConcurrentCells && ! Homogeneous)
+	{
+		if(myrank_mpi==0)
+		{
+			printf("The modes of each space-step are shared between %d processes, so ConcurrentCells is switched off.\n\n", nprocs_modes);
+		}
+		ConcurrentCells = false;
+	}
+
+	dims[0] = nprocs_mpi/nprocs_modes;
+	dims[1] = nprocs_modes;
+	MPI_Cart_create(MPI_COMM_WORLD, 2, dims, periods, 0, &comm_grid);								// the ranks are not reordered, so process (x,m) has the rank x*nprocs_modes + m in MPI_COMM_WORLD
+	MPI_Cart_coords(comm_grid, myrank_mpi, 2, coords);
+	grid_rank_x = coords[0];
+	grid_rank_modes = coords[1];
+	MPI_Cart_sub(comm_grid, keep, &comm_modes);													// the processes which hold the same space-steps
+
+	chunk_kt = size_v/nprocs_modes;																	// size_v is a multiple of nprocs_mpi, so this is an integer
+
+	if(myrank_mpi==0 && nprocs_modes > 1 && ! Homogeneous)
+	{
+		printf("Process grid: %d x %d (the space-steps are shared out along the first axis & the modes of each space-step along the second).\n\n", dims[0], dims[1]);
+	}
+}
+
+void FreeProcessGrid()																				// Function to free the communicators & datatypes of the grid of processes
+{
+	if(cells_send != MPI_DATATYPE_NULL)
+	{
+		MPI_Type_free(&cells_send); MPI_Type_free(&cells_recv);
+	}
+	if(cell_coeffs != MPI_DATATYPE_NULL)
+	{
+		MPI_Type_free(&cell_coeffs);
+		free(fetch_send_counts); free(fetch_send_displs); free(fetch_recv_counts); free(fetch_recv_displs);
+		free(scatter_send_counts); free(scatter_send_displs); free(scatter_recv_counts); free(scatter_recv_displs);
+	}
+	MPI_Comm_free(&comm_modes);
+	MPI_Comm_free(&comm_grid);
+}
+
+void GatherProjectedCells(double *dU)																// Function to collect the velocity cells of dU updated by each process of comm_modes on its first process, for every space-step of the chunk (nothing is done unless the modes are shared between the processes of the space inhomogeneous problem)
+{
+	if(Homogeneous || nprocs_modes == 1)
+	{
+		return;
+	}
+	if(cells_send == MPI_DATATYPE_NULL)
+	{
+		MPI_Type_vector(chunk_Nx, 5*chunk_kt, 5*size_v, MPI_DOUBLE, &cells_send);					// the 5*chunk_kt values of the cells of this process in each of the chunk_Nx space-steps of dU
+		MPI_Type_create_resized(cells_send, 0, 5*chunk_kt*sizeof(double), &cells_recv);				// the cells of process m start 5*chunk_kt*m doubles into dU
+		MPI_Type_commit(&cells_send); MPI_Type_commit(&cells_recv);
+	}
+	if(grid_rank_modes == 0)
+	{
+		MPI_Gather(MPI_IN_PLACE, 1, cells_send, dU, 1, cells_recv, 0, comm_modes);
+	}
+	else
+	{
+		MPI_Gather(dU + 5*chunk_kt*grid_rank_modes, 1, cells_send, NULL, 1, cells_recv, 0, comm_modes);
+	}
+}
+
+static void CollisionCells(int r, int *first, int *count)										// Function to find the first & the number of the cells whose coefficients the process r needs in the collision step (those of its space-steps, or all of them in the space homogeneous problem)
+{
+	int steps;
+
+	if(Homogeneous)
+	{
+		*first = 0;
+		*count = size_v;
+		return;
+	}
+	*first = chunk_Nx*(r/nprocs_modes);																// process r is at (r/nprocs_modes, r%nprocs_modes) in the grid
+	steps = Nx - *first;
+	if(steps > chunk_Nx)
+	{
+		steps = chunk_Nx;
+	}
+	if(steps < 0)
+	{
+		steps = 0;
+	}
+	*first *= size_v;
+	*count = steps*size_v;
+}
+
+static void UpdatedCells(int r, int *first, int *count)											// Function to find the first & the number of the cells whose coefficients the process r holds in dU at the end of the collision step
+{
+	if(Homogeneous)
+	{
+		*first = chunk_kt*(r%nprocs_modes);															// process r updates the chunk_kt cells of its place r%nprocs_modes along the modes (see RK4_Homo)
+		*count = chunk_kt;
+		return;
+	}
+	CollisionCells(r, first, count);
+	if(r%nprocs_modes != 0)																			// only the first process of comm_modes holds all of the cells of its space-steps (see GatherProjectedCells)
+	{
+		*count = 0;
+	}
+}
+
+static int SharedCells(int first_a, int count_a, int first_b, int count_b, int *first)			// Function to return the number of cells in both of the ranges first_a,...,first_a+count_a-1 & first_b,...,first_b+count_b-1, and set first to the first of them
+{
+	int start = (first_a > first_b) ? first_a : first_b;
+	int end = (first_a + count_a < first_b + count_b) ? first_a + count_a : first_b + count_b;
+
+	*first = start;
+	return (end > start) ? end - start : 0;
+}
+
+static void InitCellExchange()																		// Function to work out what FetchCollisionCells & ScatterCollisionStep send to & receive from each process, and set up the datatype cell_coeffs
+{
+	int r, n, start, first, count, coll_first, coll_count, upd_first, upd_count, blocks[2] = {1, 4}, offsets[2] = {0, 2};
+	int dg_first = chunksize_dg*myrank_mpi;														// the first cell held by this process in U
+	MPI_Datatype coeffs;
+
+	MPI_Type_indexed(2, blocks, offsets, MPI_DOUBLE, &coeffs);										// U[6*k], U[6*k+2], ..., U[6*k+5] take dU[5*k], dU[5*k+1], ..., dU[5*k+4]
+	MPI_Type_create_resized(coeffs, 0, 6*sizeof(double), &cell_coeffs);								// so that the coefficients of consecutive cells follow each other
+	MPI_Type_commit(&cell_coeffs);
+	MPI_Type_free(&coeffs);
+
+	fetch_send_counts = (int *)malloc(nprocs_mpi*sizeof(int)); fetch_send_displs = (int *)malloc(nprocs_mpi*sizeof(int));
+	fetch_recv_counts = (int *)malloc(nprocs_mpi*sizeof(int)); fetch_recv_displs = (int *)malloc(nprocs_mpi*sizeof(int));
+	scatter_send_counts = (int *)malloc(nprocs_mpi*sizeof(int)); scatter_send_displs = (int *)malloc(nprocs_mpi*sizeof(int));
+	scatter_recv_counts = (int *)malloc(nprocs_mpi*sizeof(int)); scatter_recv_displs = (int *)malloc(nprocs_mpi*sizeof(int));
+
+	CollisionCells(myrank_mpi, &coll_first, &coll_count);
+	UpdatedCells(myrank_mpi, &upd_first, &upd_count);
+	for(r=0;r<nprocs_mpi;r++)
+	{
+		CollisionCells(r, &first, &count);
+		n = SharedCells(dg_first, chunksize_dg, first, count, &start);								// the cells of this process which r needs
+		fetch_send_counts[r] = 6*n;
+		fetch_send_displs[r] = (n > 0) ? 6*(start - dg_first) : 0;
+
+		n = SharedCells(chunksize_dg*r, chunksize_dg, coll_first, coll_count, &start);				// the cells of r which this process needs
+		fetch_recv_counts[r] = 6*n;
+		fetch_recv_displs[r] = (n > 0) ? 6*(start - coll_first) : 0;
+
+		n = SharedCells(upd_first, upd_count, chunksize_dg*r, chunksize_dg, &start);				// the cells updated by this process which r holds
+		scatter_send_counts[r] = 5*n;
+		scatter_send_displs[r] = (n > 0) ? 5*(start - upd_first) : 0;
+
+		UpdatedCells(r, &first, &count);
+		n = SharedCells(first, count, dg_first, chunksize_dg, &start);								// the cells updated by r which this process holds
+		scatter_recv_counts[r] = n;
+		scatter_recv_displs[r] = (n > 0) ? start - dg_first : 0;
+	}
+}
+
+void FetchCollisionCells(double *U, double *U_coll)												// Function to copy the cells which this process needs in the collision step (see CollisionCells) from the processes which hold them in U into U_coll, with one MPI_Alltoallv
+{
+	if(cell_coeffs == MPI_DATATYPE_NULL)
+	{
+		InitCellExchange();
+	}
+
+	MPI_Alltoallv(U, fetch_send_counts, fetch_send_displs, MPI_DOUBLE,
+			U_coll, fetch_recv_counts, fetch_recv_displs, MPI_DOUBLE, MPI_COMM_WORLD);
+}
+
+void ScatterCollisionStep(double *dU, double *U)													// Function to copy the DG coefficients updated in the collision step by every process from its dU into U on the processes which hold those cells, with one MPI_Alltoallv
+{
+	if(cell_coeffs == MPI_DATATYPE_NULL)
+	{
+		InitCellExchange();
+	}
+
+	MPI_Alltoallv(dU, scatter_send_counts, scatter_send_displs, MPI_DOUBLE,
+			U, scatter_recv_counts, scatter_recv_displs, cell_coeffs, MPI_COMM_WORLD);
+}
@@ -0,0 +1,34 @@
+/* This is the header file associated to ProcessGrid.cpp in which the prototypes for the
+ * functions contained in that file are declared.  Any other header files which must be linked to
+ * for the functions here are also included.
+ *
+ */
+
+//************************//
+//     INCLUDE GUARDS     //
+//************************//
+
+#ifndef PROCESSGRID_H_
+#define PROCESSGRID_H_
+
+//************************//
+//        INCLUDES        //
+//************************//
+
+#include "LP_ompi.h"																				// allows the libraries included, macros defined and external variables declared in LP_ompi.h to be used in the ProcessGrid functions
+
+//************************//
+//   FUNCTION PROTOTYPES  //
+//************************//
+
+void InitProcessGrid();
+
+void FreeProcessGrid();
+
+void GatherProjectedCells(double *dU);
+
+void FetchCollisionCells(double *U, double *U_coll);
+
+void ScatterCollisionStep(double *dU, double *U);
+
+#endif /* PROCESSGRID_H_ */
@@ -0,0 +1,274 @@
+/* This is the source file which contains the vectorised quadrature sums used by the Direct collision
+ * engine when DirectKernel is not Scalar.  They compute the same sums as ComputeQ_Direct &
+ * ComputeQLinear_Direct, reading the weights from the same tables in conv_weights.
+ *
+ * Before each sum the two spectra in the convolution are copied into split-complex streams (separate
+ * arrays of real & imaginary parts).  The quadrature weights wtN and h_eta^3 are folded into the
+ * stream of values at w, and the spectrum at ki - w is stored in reverse order, so that for a fixed
+ * ki, w_1 & w_2 the weights, both streams and the innermost index n are all read forwards with unit
+ * stride.  The innermost loop is then either a portable loop over the streams (Split) or is written
+ * with AVX2 (4 doubles per register, with FMA) or AVX-512 (8 doubles per register, with a masked
+ * tail) intrinsics.  The AVX kernels are only used if the processor supports them.
+ *
+ * Functions included: DirectKernelName, DirectKernelSupported, InitSIMDCollision, FreeSIMDCollision,
+ * ComputeQ_DirectSIMD, ComputeQLinear_DirectSIMD
+ *
+ */
+
+#include "SIMDCollision.h"																			// SIMDCollision.h is where the prototypes for the functions contained in this file are declared
+
+#if SIMD_X86
+#include <immintrin.h>																				// allows the AVX2 & AVX-512 intrinsics to be used
+#endif
+
+typedef void (*SplitKernel)(const double *W, int ki, double *sum);									// a kernel returns the real & imaginary parts of the quadrature sum for qHat(ki) in sum, given the row W of the weights for ki
+
+static double *a_re, *a_im;																			// declare pointers to a_re & a_im (the real & imaginary parts of h_eta^3 wtN[l]wtN[m]wtN[n] times the spectrum at w = eta(l,m,n))
+static double *b_re, *b_im;																			// declare pointers to b_re & b_im (the real & imaginary parts of the spectrum at ki - w, stored in reverse order)
+
+static const char *kernel_names[] = {"Scalar", "Split", "AVX2", "AVX512", "Auto"};					// the names of the KERNEL_ macros, as used for DirectKernel in the input file
+
+const char *DirectKernelName(int kernel)															// Function to return the name of the given kernel
+{
+	return kernel_names[kernel];
+}
+
+bool DirectKernelSupported(int kernel)																// Function to check if the given kernel can be run on this processor
+{
+	if(kernel == KERNEL_SCALAR || kernel == KERNEL_SPLIT)
+	{
+		return true;
+	}
+#if SIMD_X86
+	__builtin_cpu_init();
+	if(kernel == KERNEL_AVX2)
+	{
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+	}
+	if(kernel == KERNEL_AVX512)
+	{
+		return __builtin_cpu_supports("avx512f");
+	}
+#endif
+	return false;
+}
+
+void InitSIMDCollision()																			// Function to choose the kernel used for DirectKernel = Auto (or in place of an unsupported kernel) and allocate the split-complex streams
+{
+	int requested = direct_kernel;
+
+	if(direct_kernel == KERNEL_AUTO || ! DirectKernelSupported(direct_kernel))
+	{
+		if(DirectKernelSupported(KERNEL_AVX512)) direct_kernel = KERNEL_AVX512;
+		else if(DirectKernelSupported(KERNEL_AVX2)) direct_kernel = KERNEL_AVX2;
+		else direct_kernel = KERNEL_SPLIT;
+
+		if(requested != KERNEL_AUTO && myrank_mpi==0)
+		{
+			printf("The %s kernel is not supported on this processor, so the %s kernel is used instead.\n",
+					DirectKernelName(requested), DirectKernelName(direct_kernel));
+		}
+	}
+
+	a_re = (double *)fftw_malloc(size_ft*sizeof(double));											// allocate enough space at each of the pointers a_re, a_im, b_re & b_im for size_ft many double numbers
+	a_im = (double *)fftw_malloc(size_ft*sizeof(double));
+	b_re = (double *)fftw_malloc(size_ft*sizeof(double));
+	b_im = (double *)fftw_malloc(size_ft*sizeof(double));
+
+	if(myrank_mpi==0)
+	{
+		printf("Direct collision engine: using the %s kernel for the quadrature sums.\n", DirectKernelName(direct_kernel));
+	}
+}
+
+void FreeSIMDCollision()																			// Function to delete the split-complex streams
+{
+	fftw_free(a_re); fftw_free(a_im); fftw_free(b_re); fftw_free(b_im);
+}
+
+static inline int ReversedRow(int i, int j, int k, int l, int m)									// Function to return the position in the reversed streams of the spectrum at ki - eta(l,m,n), less n
+{
+	int x = i + N/2 - l;																			// eta[x] = ki[i] - eta[l]
+	int y = j + N/2 - m;
+	return (N/2 - 1 - k) + N*((N-1-y) + N*(N-1-x));													// size_ft-1-(z + N*(y + N*x)) with z = k + N/2 - n
+}
+
+static void PrepareStreams(fftw_complex *aHat, fftw_complex *bHat)									// Function to fill the split-complex streams from the spectra at w (aHat) & ki - w (bHat)
+{
+	int kw, l, m, n;
+	double wt, prefactor = h_eta*h_eta*h_eta;
+
+	#pragma omp parallel for private(kw,l,m,n,wt)
+	for(kw=0;kw<size_ft;kw++)
+	{
+		n = kw % N; m = (kw/N) % N; l = kw/(N*N);
+		wt = prefactor*wtN[l]*wtN[m]*wtN[n];
+		a_re[kw] = wt*aHat[kw][0];
+		a_im[kw] = wt*aHat[kw][1];
+		b_re[size_ft-1-kw] = bHat[kw][0];
+		b_im[size_ft-1-kw] = bHat[kw][1];
+	}
+}
+
+static void SplitSum(const double *W, int ki, double *sum)											// Function to compute the quadrature sum for qHat(ki) with a portable loop over the split-complex streams
+{
+	int i = ki/(N*N), j = (ki/N)%N, k = ki%N;
+	int l, m, n, kw, kb, len;
+	int start_i, start_j, start_k, end_i, end_j, end_k;
+	double re, im, s0 = 0., s1 = 0.;
+
+	ConvolutionWindow(i, &start_i, &end_i);
+	ConvolutionWindow(j, &start_j, &end_j);
+	ConvolutionWindow(k, &start_k, &end_k);
+	len = end_k - start_k;
+
+	for(l=start_i;l<end_i;l++)
+	{
+		for(m=start_j;m<end_j;m++)
+		{
+			kw = start_k + N*(m + N*l);
+			kb = start_k + ReversedRow(i, j, k, l, m);
+			#pragma omp simd reduction(+:s0,s1) private(re,im)
+			for(n=0;n<len;n++)
+			{
+				re = a_re[kw+n]*b_re[kb+n] - a_im[kw+n]*b_im[kb+n];
+				im = a_re[kw+n]*b_im[kb+n] + a_im[kw+n]*b_re[kb+n];
+				s0 += W[kw+n]*re;
+				s1 += W[kw+n]*im;
+			}
+		}
+	}
+	sum[0] = s0;
+	sum[1] = s1;
+}
+
+#if SIMD_X86
+__attribute__((target("avx2,fma")))
+static void SplitSumAVX2(const double *W, int ki, double *sum)										// Function to compute the quadrature sum for qHat(ki) with AVX2 & FMA, four values of n at a time
+{
+	int i = ki/(N*N), j = (ki/N)%N, k = ki%N;
+	int l, m, n, kw, kb, len;
+	int start_i, start_j, start_k, end_i, end_j, end_k;
+	double re, im, s0 = 0., s1 = 0.;
+	__m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+	__m256d w, ar, ai, br, bi, vre, vim;
+	__m128d h0, h1;
+
+	ConvolutionWindow(i, &start_i, &end_i);
+	ConvolutionWindow(j, &start_j, &end_j);
+	ConvolutionWindow(k, &start_k, &end_k);
+	len = end_k - start_k;
+
+	for(l=start_i;l<end_i;l++)
+	{
+		for(m=start_j;m<end_j;m++)
+		{
+			kw = start_k + N*(m + N*l);
+			kb = start_k + ReversedRow(i, j, k, l, m);
+			for(n=0;n+4<=len;n+=4)
+			{
+				w = _mm256_loadu_pd(&W[kw+n]);
+				ar = _mm256_loadu_pd(&a_re[kw+n]); ai = _mm256_loadu_pd(&a_im[kw+n]);
+				br = _mm256_loadu_pd(&b_re[kb+n]); bi = _mm256_loadu_pd(&b_im[kb+n]);
+				vre = _mm256_fmsub_pd(ar, br, _mm256_mul_pd(ai, bi));
+				vim = _mm256_fmadd_pd(ar, bi, _mm256_mul_pd(ai, br));
+				acc0 = _mm256_fmadd_pd(w, vre, acc0);
+				acc1 = _mm256_fmadd_pd(w, vim, acc1);
+			}
+			for(;n<len;n++)																			// the last len % 4 values of n
+			{
+				re = a_re[kw+n]*b_re[kb+n] - a_im[kw+n]*b_im[kb+n];
+				im = a_re[kw+n]*b_im[kb+n] + a_im[kw+n]*b_re[kb+n];
+				s0 += W[kw+n]*re;
+				s1 += W[kw+n]*im;
+			}
+		}
+	}
+	h0 = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));					// add up the four lanes of each accumulator
+	h1 = _mm_add_pd(_mm256_castpd256_pd128(acc1), _mm256_extractf128_pd(acc1, 1));
+	sum[0] = s0 + _mm_cvtsd_f64(_mm_add_sd(h0, _mm_unpackhi_pd(h0, h0)));
+	sum[1] = s1 + _mm_cvtsd_f64(_mm_add_sd(h1, _mm_unpackhi_pd(h1, h1)));
+}
+
+__attribute__((target("avx512f")))
+static void SplitSumAVX512(const double *W, int ki, double *sum)									// Function to compute the quadrature sum for qHat(ki) with AVX-512, eight values of n at a time
+{
+	int i = ki/(N*N), j = (ki/N)%N, k = ki%N;
+	int l, m, n, kw, kb, len;
+	int start_i, start_j, start_k, end_i, end_j, end_k;
+	__m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+	__m512d w, ar, ai, br, bi, vre, vim;
+	__m256d q0, q1;
+	__m128d h0, h1;
+	__mmask8 mask;
+
+	ConvolutionWindow(i, &start_i, &end_i);
+	ConvolutionWindow(j, &start_j, &end_j);
+	ConvolutionWindow(k, &start_k, &end_k);
+	len = end_k - start_k;
+
+	for(l=start_i;l<end_i;l++)
+	{
+		for(m=start_j;m<end_j;m++)
+		{
+			kw = start_k + N*(m + N*l);
+			kb = start_k + ReversedRow(i, j, k, l, m);
+			for(n=0;n<len;n+=8)
+			{
+				mask = (len-n >= 8) ? (__mmask8)0xFF : (__mmask8)((1 << (len-n)) - 1);				// the last len % 8 values of n are loaded with a mask (masked out lanes are zero)
+				w = _mm512_maskz_loadu_pd(mask, &W[kw+n]);
+				ar = _mm512_maskz_loadu_pd(mask, &a_re[kw+n]); ai = _mm512_maskz_loadu_pd(mask, &a_im[kw+n]);
+				br = _mm512_maskz_loadu_pd(mask, &b_re[kb+n]); bi = _mm512_maskz_loadu_pd(mask, &b_im[kb+n]);
+				vre = _mm512_fmsub_pd(ar, br, _mm512_mul_pd(ai, bi));
+				vim = _mm512_fmadd_pd(ar, bi, _mm512_mul_pd(ai, br));
+				acc0 = _mm512_fmadd_pd(w, vre, acc0);
+				acc1 = _mm512_fmadd_pd(w, vim, acc1);
+			}
+		}
+	}
+	q0 = _mm512_mask_extractf64x4_pd(_mm256_setzero_pd(), 0xFF, acc0, 0);							// add up the eight lanes of each accumulator, first into four (the masked extracts, with every lane selected, avoid the uninitialised _mm256_undefined_pd of the unmasked ones)
+	q0 = _mm256_add_pd(q0, _mm512_mask_extractf64x4_pd(_mm256_setzero_pd(), 0xFF, acc0, 1));
+	q1 = _mm512_mask_extractf64x4_pd(_mm256_setzero_pd(), 0xFF, acc1, 0);
+	q1 = _mm256_add_pd(q1, _mm512_mask_extractf64x4_pd(_mm256_setzero_pd(), 0xFF, acc1, 1));
+	h0 = _mm_add_pd(_mm256_castpd256_pd128(q0), _mm256_extractf128_pd(q0, 1));						// then as in SplitSumAVX2
+	h1 = _mm_add_pd(_mm256_castpd256_pd128(q1), _mm256_extractf128_pd(q1, 1));
+	sum[0] = _mm_cvtsd_f64(_mm_add_sd(h0, _mm_unpackhi_pd(h0, h0)));
+	sum[1] = _mm_cvtsd_f64(_mm_add_sd(h1, _mm_unpackhi_pd(h1, h1)));
+}
+#endif
+
+static void SplitQuadrature(double **conv_weights, fftw_complex *qHat)								// Function to calculate qHat(ki) for every ki from the streams, with the kernel chosen by direct_kernel
+{
+	int ki, ki_start = ModeStart(0, 1), ki_end = ModeStart(1, 1);									// the modes of this process (all of them unless the modes are shared between the processes)
+	double sum[2];
+	SplitKernel kernel = SplitSum;
+
+#if SIMD_X86
+	if(direct_kernel == KERNEL_AVX2) kernel = SplitSumAVX2;
+	else if(direct_kernel == KERNEL_AVX512) kernel = SplitSumAVX512;
+#endif
+
+	#pragma omp parallel for schedule(dynamic) private(ki,sum) shared(qHat, conv_weights)
+	for(ki=ki_start;ki<ki_end;ki++)
+	{
+		kernel(conv_weights[ki], ki, sum);
+		qHat[ki][0] = sum[0];
+		qHat[ki][1] = sum[1];
+	}
+}
+
+void ComputeQ_DirectSIMD(double *f, fftw_complex *qHat, double **conv_weights)						// Function to calculate the same qHat as ComputeQ_Direct with the kernel chosen by DirectKernel
+{
+	fft3D(f, fftOut);
+
+	PrepareStreams(fftOut, fftOut);
+	SplitQuadrature(conv_weights, qHat);
+}
+
+void ComputeQLinear_DirectSIMD(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat, double **conv_weights)	// Function to calculate the same qHat as ComputeQLinear_Direct with the kernel chosen by DirectKernel
+{
+	fft3D(f, fftOut);
+
+	PrepareStreams(Maxwell_fftOut, fftOut);
+	SplitQuadrature(conv_weights, qHat);
+}
@@ -0,0 +1,47 @@
+/* This is the header file associated to SIMDCollision.cpp in which the prototypes for the
+ * functions contained in that file are declared.  Any other header files which must be linked to
+ * for the functions here are also included.
+ *
+ */
+
+//************************//
+//     INCLUDE GUARDS     //
+//************************//
+
+#ifndef SIMDCOLLISION_H_
+#define SIMDCOLLISION_H_
+
+//************************//
+//        INCLUDES        //
+//************************//
+
+#include "LP_ompi.h"																				// allows the libraries included, macros defined and external variables declared in LP_ompi.h to be used in the SIMDCollision functions
+#include "collisionRoutines_1.h"																	// allows fft3D to be used in the SIMDCollision functions
+
+//************************//
+//         MACROS         //
+//************************//
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86 1																					// the AVX2 & AVX-512 kernels can be compiled (they are only used if the processor supports them)
+#else
+#define SIMD_X86 0
+#endif
+
+//************************//
+//   FUNCTION PROTOTYPES  //
+//************************//
+
+const char *DirectKernelName(int kernel);
+
+bool DirectKernelSupported(int kernel);
+
+void InitSIMDCollision();
+
+void FreeSIMDCollision();
+
+void ComputeQ_DirectSIMD(double *f, fftw_complex *qHat, double **conv_weights);
+
+void ComputeQLinear_DirectSIMD(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat, double **conv_weights);
+
+#endif /* SIMDCOLLISION_H_ */
@@ -107,15 +107,19 @@ void SetInit_LD(double *U)																						// function to calculate the DG
     			for(i=0;i<Nx;i++)																																	// loop through the space cells
     			{
     				k=i*size_v + (j1*Nv*Nv + j2*Nv + j3);																											// calculate the index of cell (i,j1,j2,j3) in U
+    				if(! HoldsCell(k))																																// U only holds the cells of this process
+    				{
+    					continue;
+    				}
     				tp0 = (dx + (sin(c*Gridx(i+0.5)) - sin(c*Gridx(i-0.5)))*a/c)*tmp0/dx;																			// calculate b_6k = (int_Ii (1 + Acos(kx)) dx)*(int_Kj Mw(v)*phi_6k(v) dv) (NOTE: int_(Omega_i) (1 + a*cos(c*x)) dx = dx + (sin(c*x_(i+0.5)) - sin(c*x_(i+0.5)))*(a/c))
     				tp5 = (dx + (sin(c*Gridx(i+0.5)) - sin(c*Gridx(i-0.5)))*a/c)*tmp4/dx;																			// calculate b_(6k+5) = (int_Ii (1 + Acos(kx)) dx)*(int_Kj Mw(v)*phi_(6k+5)(v) dv) (NOTE: int_(Omega_i) (1 + a*cos(c*x)) dx = dx + (sin(c*x_(i+0.5)) - sin(c*x_(i+0.5)))*(a/c))
-    				U[k*6+0] = 19*tp0/4. - 15*tp5;																													// calculate the coefficient U[6k]
-    				U[k*6+5] = 60*tp5 - 15*tp0;																														// calculate the coefficient U[6k+5]
+    				U[SlabIndex(k, 0)] = 19*tp0/4. - 15*tp5;																										// calculate the coefficient U[6k]
+    				U[SlabIndex(k, 5)] = 60*tp5 - 15*tp0;																											// calculate the coefficient U[6k+5]
 
-    				U[k*6+1] = (0.5*(sin(c*Gridx(i+0.5)) + sin(c*Gridx(i-0.5))) + (cos(c*Gridx(i+0.5)) - cos(c*Gridx(i-0.5)))/(c*dx))*(a/c)*tmp0*12./dx; 			// calculate the coefficient U[6k+1] = 12*b_(6k+1) = 12*(int_Ii (1 + Acos(kx))*phi_(6k+1)(x) dx)*(int_Kj Mw(v) dv) (NOTE: int_(Omega_i) (1 + a*cos(c*x))*phi_(6k+1)(x) dx = (0.5*(sin(c*x_(i+0.5)) + sin(c*x_(i+0.5))) + (cos(c*x_(i+0.5)) - cos(c*x_(i+0.5)))/(c*dx))*(a/c))
-    				U[k*6+2] = (dx + (sin(c*Gridx(i+0.5)) - sin(c*Gridx(i-0.5)))*a/c)*tmp1*12/dx;																	// calculate the coefficient U[6k+2] = 12*b_(6k+2) = 12*(int_Ii (1 + Acos(kx)) dx)*(int_Kj Mw(v)*phi_(6k+2)(v) dv) (NOTE: int_(Omega_i) (1 + a*cos(c*x)) dx = dx + (sin(c*x_(i+0.5)) - sin(c*x_(i+0.5)))*(a/c))
-    				U[k*6+3] = (dx + (sin(c*Gridx(i+0.5)) - sin(c*Gridx(i-0.5)))*a/c)*tmp2*12/dx;																	// calculate the coefficient U[6k+3] = 12*b_(6k+3) = 12*(int_Ii (1 + Acos(kx)) dx)*(int_Kj Mw(v)*phi_(6k+3)(v) dv) (NOTE: int_(Omega_i) (1 + a*cos(c*x)) dx = dx + (sin(c*x_(i+0.5)) - sin(c*x_(i+0.5)))*(a/c))
-    				U[k*6+4] = (dx + (sin(c*Gridx(i+0.5)) - sin(c*Gridx(i-0.5)))*a/c)*tmp3*12/dx;																	// calculate the coefficient U[6k+4] = 12*b_(6k+4) = 12*(int_Ii (1 + Acos(kx)) dx)*(int_Kj Mw(v)*phi_(6k+4)(v) dv) (NOTE: int_(Omega_i) (1 + a*cos(c*x)) dx = dx + (sin(c*x_(i+0.5)) - sin(c*x_(i+0.5)))*(a/c))
+    				U[SlabIndex(k, 1)] = (0.5*(sin(c*Gridx(i+0.5)) + sin(c*Gridx(i-0.5))) + (cos(c*Gridx(i+0.5)) - cos(c*Gridx(i-0.5)))/(c*dx))*(a/c)*tmp0*12./dx;	// calculate the coefficient U[6k+1] = 12*b_(6k+1) = 12*(int_Ii (1 + Acos(kx))*phi_(6k+1)(x) dx)*(int_Kj Mw(v) dv) (NOTE: int_(Omega_i) (1 + a*cos(c*x))*phi_(6k+1)(x) dx = (0.5*(sin(c*x_(i+0.5)) + sin(c*x_(i+0.5))) + (cos(c*x_(i+0.5)) - cos(c*x_(i+0.5)))/(c*dx))*(a/c))
+    				U[SlabIndex(k, 2)] = (dx + (sin(c*Gridx(i+0.5)) - sin(c*Gridx(i-0.5)))*a/c)*tmp1*12/dx;															// calculate the coefficient U[6k+2] = 12*b_(6k+2) = 12*(int_Ii (1 + Acos(kx)) dx)*(int_Kj Mw(v)*phi_(6k+2)(v) dv) (NOTE: int_(Omega_i) (1 + a*cos(c*x)) dx = dx + (sin(c*x_(i+0.5)) - sin(c*x_(i+0.5)))*(a/c))
+    				U[SlabIndex(k, 3)] = (dx + (sin(c*Gridx(i+0.5)) - sin(c*Gridx(i-0.5)))*a/c)*tmp2*12/dx;															// calculate the coefficient U[6k+3] = 12*b_(6k+3) = 12*(int_Ii (1 + Acos(kx)) dx)*(int_Kj Mw(v)*phi_(6k+3)(v) dv) (NOTE: int_(Omega_i) (1 + a*cos(c*x)) dx = dx + (sin(c*x_(i+0.5)) - sin(c*x_(i+0.5)))*(a/c))
+    				U[SlabIndex(k, 4)] = (dx + (sin(c*Gridx(i+0.5)) - sin(c*Gridx(i-0.5)))*a/c)*tmp3*12/dx;															// calculate the coefficient U[6k+4] = 12*b_(6k+4) = 12*(int_Ii (1 + Acos(kx)) dx)*(int_Kj Mw(v)*phi_(6k+4)(v) dv) (NOTE: int_(Omega_i) (1 + a*cos(c*x)) dx = dx + (sin(c*x_(i+0.5)) - sin(c*x_(i+0.5)))*(a/c))
     			}
     		}
     	}
@@ -160,15 +164,19 @@ void SetInit_ND(double *U)																						// function to calculate the DG
     				ND = DopingProfile(i);																															// set ND to the value of the doping profile at ix
 //    				if(myrank_mpi == 0){printf("i = %d: ND = %g \n", i, ND);}
     				k=i*size_v + (j1*Nv*Nv + j2*Nv + j3);																											// calculate the index of cell (i,j1,j2,j3) in U
+    				if(! HoldsCell(k))																																// U only holds the cells of this process
+    				{
+    					continue;
+    				}
     				tp0 = ND*tmp0;																																	// calculate b_6k = (int_Ii ND(x) dx)*(int_Kj Mw(v)*phi_6k(v) dv) (NOTE: int_(Omega_i) ND(x) dx = ND(x_i)*dx (as ND is assumed constant on each cell) and then need to divide by dx for calculating the coefficient, so dx is ommited)
     				tp5 = ND*tmp4;																																	// calculate b_(6k+5) = (int_Ii ND(x) dx)*(int_Kj Mw(v)*phi_(6k+5)(v) dv) (NOTE: int_(Omega_i) ND(x) dx = ND(x_i)*dx (as ND is assumed constant on each cell) and then need to divide by dx for calculating the coefficient, so dx is ommited)
-    				U[k*6+0] = 19*tp0/4. - 15*tp5;																													// calculate the coefficient U[6k]
-    				U[k*6+5] = 60*tp5 - 15*tp0;																														// calculate the coefficient U[6k+5]
+    				U[SlabIndex(k, 0)] = 19*tp0/4. - 15*tp5;																										// calculate the coefficient U[6k]
+    				U[SlabIndex(k, 5)] = 60*tp5 - 15*tp0;																											// calculate the coefficient U[6k+5]
 
-    				U[k*6+1] = 0; 																																	// calculate the coefficient U[6k+1] = 12*b_(6k+1) = 12*(int_Ii ND(x)*phi_(6k+1)(x) dx)*(int_Kj Mw(v) dv) (NOTE: int_(Omega_i) ND(x)*phi_(6k+1)(x) dx = 0 (as ND is assumed constant on each cell))
-    				U[k*6+2] = ND*tmp1*12;																															// calculate the coefficient U[6k+2] = 12*b_(6k+2) = 12*(int_Ii ND(x) dx)*(int_Kj Mw(v)*phi_(6k+2)(v) dv) (NOTE: int_(Omega_i) ND(x) dx = ND(x_i)*dx (as ND is assumed constant on each cell) and then need to divide by dx for calculating the coefficient, so dx is ommited)
-    				U[k*6+3] = ND*tmp2*12;																															// calculate the coefficient U[6k+3] = 12*b_(6k+3) = 12*(int_Ii ND(x) dx)*(int_Kj Mw(v)*phi_(6k+3)(v) dv) (NOTE: int_(Omega_i) ND(x) dx = ND(x_i)*dx (as ND is assumed constant on each cell) and then need to divide by dx for calculating the coefficient, so dx is ommited)
-    				U[k*6+4] = ND*tmp3*12;																															// calculate the coefficient U[6k+4] = 12*b_(6k+4) = 12*(int_Ii ND(x) dx)*(int_Kj Mw(v)*phi_(6k+4)(v) dv) (NOTE: int_(Omega_i) ND(x) dx = ND(x_i)*dx (as ND is assumed constant on each cell) and then need to divide by dx for calculating the coefficient, so dx is ommited)
+    				U[SlabIndex(k, 1)] = 0;																															// calculate the coefficient U[6k+1] = 12*b_(6k+1) = 12*(int_Ii ND(x)*phi_(6k+1)(x) dx)*(int_Kj Mw(v) dv) (NOTE: int_(Omega_i) ND(x)*phi_(6k+1)(x) dx = 0 (as ND is assumed constant on each cell))
+    				U[SlabIndex(k, 2)] = ND*tmp1*12;																												// calculate the coefficient U[6k+2] = 12*b_(6k+2) = 12*(int_Ii ND(x) dx)*(int_Kj Mw(v)*phi_(6k+2)(v) dv) (NOTE: int_(Omega_i) ND(x) dx = ND(x_i)*dx (as ND is assumed constant on each cell) and then need to divide by dx for calculating the coefficient, so dx is ommited)
+    				U[SlabIndex(k, 3)] = ND*tmp2*12;																												// calculate the coefficient U[6k+3] = 12*b_(6k+3) = 12*(int_Ii ND(x) dx)*(int_Kj Mw(v)*phi_(6k+3)(v) dv) (NOTE: int_(Omega_i) ND(x) dx = ND(x_i)*dx (as ND is assumed constant on each cell) and then need to divide by dx for calculating the coefficient, so dx is ommited)
+    				U[SlabIndex(k, 4)] = ND*tmp3*12;																												// calculate the coefficient U[6k+4] = 12*b_(6k+4) = 12*(int_Ii ND(x) dx)*(int_Kj Mw(v)*phi_(6k+4)(v) dv) (NOTE: int_(Omega_i) ND(x) dx = ND(x_i)*dx (as ND is assumed constant on each cell) and then need to divide by dx for calculating the coefficient, so dx is ommited)
     			}
     		}
     	}
@@ -223,36 +231,40 @@ void SetInit_4H(double *U)																							// function to calculate the DG
     					}
     					tmpx0 = tmpx0*0.5; tmpx1 = tmpx1*0.5;														// multiply tmpx0 & tmpx1 by 1/2 to represent the fact that quadrature isn't done over [-1, 1] (should also multiply by dx but this cancels with 1/dx later)
     					k=i*size_v + (j1*Nv*Nv + j2*Nv + j3);														// calculate the index of cell (i,j1,j2,j3) in U
+    					if(! HoldsCell(k))																			// U only holds the cells of this process
+    					{
+    						continue;
+    					}
 
     					tp0 = tmpx0*tmp0;																			// calculate b_6k = (int_Ii f_DH(x) dx)*(int_Kj Mw(v) dv)
     					tp5 = tmpx0*tmp4;																			// calculate b_(6k+5) = (int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+5)(v) dv)
 
     					if(p==0)
     					{
-    						U[k*6+0] = 19*tp0/4. - 15*tp5;															// calculate the coefficient U[6k]
-    						U[k*6+5] = 60*tp5 - 15*tp0;																// calculate the coefficient U[6k+5]
+    						U[SlabIndex(k, 0)] = 19*tp0/4. - 15*tp5;												// calculate the coefficient U[6k]
+    						U[SlabIndex(k, 5)] = 60*tp5 - 15*tp0;													// calculate the coefficient U[6k+5]
 
-    						U[k*6+1] = tmpx1*tmp0*12; 																// calculate the coefficient U[6k+1] = 12*b_(6k+1) = 12*(int_Ii f_DH(x)*phi_(6k+1)(x) dx)*(int_Kj Mw(v) dv)
-    						U[k*6+2] = tmpx0*tmp1*12;																// calculate the coefficient U[6k+2] = 12*b_(6k+2) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+2)(v) dv)
-    						U[k*6+3] = tmpx0*tmp2*12;																// calculate the coefficient U[6k+3] = 12*b_(6k+3) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+3)(v) dv)
-    						U[k*6+4] = tmpx0*tmp3*12;																// calculate the coefficient U[6k+4] = 12*b_(6k+4) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+4)(v) dv)
+    						U[SlabIndex(k, 1)] = tmpx1*tmp0*12;														// calculate the coefficient U[6k+1] = 12*b_(6k+1) = 12*(int_Ii f_DH(x)*phi_(6k+1)(x) dx)*(int_Kj Mw(v) dv)
+    						U[SlabIndex(k, 2)] = tmpx0*tmp1*12;														// calculate the coefficient U[6k+2] = 12*b_(6k+2) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+2)(v) dv)
+    						U[SlabIndex(k, 3)] = tmpx0*tmp2*12;														// calculate the coefficient U[6k+3] = 12*b_(6k+3) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+3)(v) dv)
+    						U[SlabIndex(k, 4)] = tmpx0*tmp3*12;														// calculate the coefficient U[6k+4] = 12*b_(6k+4) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+4)(v) dv)
     					}
     					else
     					{
-    						U[k*6+0] += 19*tp0/4. - 15*tp5;															// calculate the coefficient U[6k]
-    						U[k*6+5] += 60*tp5 - 15*tp0;															// calculate the coefficient U[6k+5]
+    						U[SlabIndex(k, 0)] += 19*tp0/4. - 15*tp5;												// calculate the coefficient U[6k]
+    						U[SlabIndex(k, 5)] += 60*tp5 - 15*tp0;													// calculate the coefficient U[6k+5]
 
-    						U[k*6+1] += tmpx1*tmp0*12; 																// calculate the coefficient U[6k+1] = 12*b_(6k+1) = 12*(int_Ii f_DH(x)*phi_(6k+1)(x) dx)*(int_Kj Mw(v) dv)
-    						U[k*6+2] += tmpx0*tmp1*12;																// calculate the coefficient U[6k+2] = 12*b_(6k+2) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+2)(v) dv)
-    						U[k*6+3] += tmpx0*tmp2*12;																// calculate the coefficient U[6k+3] = 12*b_(6k+3) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+3)(v) dv)
-    						U[k*6+4] += tmpx0*tmp3*12;																// calculate the coefficient U[6k+4] = 12*b_(6k+4) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+4)(v) dv)
+    						U[SlabIndex(k, 1)] += tmpx1*tmp0*12;													// calculate the coefficient U[6k+1] = 12*b_(6k+1) = 12*(int_Ii f_DH(x)*phi_(6k+1)(x) dx)*(int_Kj Mw(v) dv)
+    						U[SlabIndex(k, 2)] += tmpx0*tmp1*12;													// calculate the coefficient U[6k+2] = 12*b_(6k+2) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+2)(v) dv)
+    						U[SlabIndex(k, 3)] += tmpx0*tmp2*12;													// calculate the coefficient U[6k+3] = 12*b_(6k+3) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+3)(v) dv)
+    						U[SlabIndex(k, 4)] += tmpx0*tmp3*12;													// calculate the coefficient U[6k+4] = 12*b_(6k+4) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+4)(v) dv)
     					}
     				}
     			}
     		}
     	}
     }
-    for(k=0;k<6*size;k++)																							// loop through all entries of U
+    for(k=0;k<6*chunksize_dg;k++)																							// loop through all entries of U
     {
     	U[k] = U[k]/4;																								// divide the kth entry of U by 4 since 4 Maxwellians were added together
     }
@@ -296,29 +308,33 @@ void SetInit_4H_Homo(double *U)																				// function to calculate the
     				}
     				tmp0 = tmp0*0.5*0.5*0.5; tmp1 = tmp1*0.5*0.5*0.5; tmp2 = tmp2*0.5*0.5*0.5; tmp3 = tmp3*0.5*0.5*0.5; tmp4 = tmp4*0.5*0.5*0.5;						// multiply tmp0, tmp1, tmp2, tmp3 & tmp4 by (1/2)^3 to represent the fact that quadrature isn't done over [-1, 1] (should also multiply by dv^3 but this cancels with 1/dv^3 later)
 					k= j1*Nv*Nv + j2*Nv + j3;											// calculate the index of cell (i,j1,j2,j3) in U
+					if(! HoldsCell(k))													// U only holds the cells of this process
+					{
+						continue;
+					}
 					if(p==0)
     				{
-    					U[k*6+0] = 19*tmp0/4. - 15*tmp4;													// calculate the coefficient U[6k]
-    					U[k*6+5] = 60*tmp4 - 15*tmp0;														// calculate the coefficient U[6k+5]
+    					U[SlabIndex(k, 0)] = 19*tmp0/4. - 15*tmp4;											// calculate the coefficient U[6k]
+    					U[SlabIndex(k, 5)] = 60*tmp4 - 15*tmp0;												// calculate the coefficient U[6k+5]
 
-   						U[k*6+2] = tmp1*12;																// calculate the coefficient U[6k+2] = 12*b_(6k+2) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+2)(v) dv)
-   						U[k*6+3] = tmp2*12;																// calculate the coefficient U[6k+3] = 12*b_(6k+3) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+3)(v) dv)
-   						U[k*6+4] = tmp3*12;																// calculate the coefficient U[6k+4] = 12*b_(6k+4) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+4)(v) dv)
+   						U[SlabIndex(k, 2)] = tmp1*12;													// calculate the coefficient U[6k+2] = 12*b_(6k+2) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+2)(v) dv)
+   						U[SlabIndex(k, 3)] = tmp2*12;													// calculate the coefficient U[6k+3] = 12*b_(6k+3) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+3)(v) dv)
+   						U[SlabIndex(k, 4)] = tmp3*12;													// calculate the coefficient U[6k+4] = 12*b_(6k+4) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+4)(v) dv)
    					}
    					else
    					{
-   						U[k*6+0] += 19*tmp0/4. - 15*tmp4;													// calculate the coefficient U[6k]
-   						U[k*6+5] += 60*tmp4 - 15*tmp0;														// calculate the coefficient U[6k+5]
+   						U[SlabIndex(k, 0)] += 19*tmp0/4. - 15*tmp4;											// calculate the coefficient U[6k]
+   						U[SlabIndex(k, 5)] += 60*tmp4 - 15*tmp0;											// calculate the coefficient U[6k+5]
 
-   						U[k*6+2] += tmp1*12;															// calculate the coefficient U[6k+2] = 12*b_(6k+2) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+2)(v) dv)
-   						U[k*6+3] += tmp2*12;															// calculate the coefficient U[6k+3] = 12*b_(6k+3) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+3)(v) dv)
-   						U[k*6+4] += tmp3*12;															// calculate the coefficient U[6k+4] = 12*b_(6k+4) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+4)(v) dv)
+   						U[SlabIndex(k, 2)] += tmp1*12;													// calculate the coefficient U[6k+2] = 12*b_(6k+2) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+2)(v) dv)
+   						U[SlabIndex(k, 3)] += tmp2*12;													// calculate the coefficient U[6k+3] = 12*b_(6k+3) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+3)(v) dv)
+   						U[SlabIndex(k, 4)] += tmp3*12;													// calculate the coefficient U[6k+4] = 12*b_(6k+4) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+4)(v) dv)
    					}
    				}
    			}
    		}
    }
-   for(k=0;k<6*size_v;k++)																					// loop through all entries of U
+   for(k=0;k<6*chunksize_dg;k++)																					// loop through all entries of U
    {
 	   U[k] = U[k]/4;																						// divide the kth entry of U by 4 since 4 Maxwellians were added together
    }
@@ -365,16 +381,20 @@ void SetInit_2H(double *U)																							// function to calculate the DG
     				}
     				tmpx0 = tmpx0*0.5; tmpx1 = tmpx1*0.5;															// multiply tmpx0 & tmpx1 by 1/2 to represent the fact that quadrature isn't done over [-1, 1] (should also multiply by dx but this cancels with 1/dx later)
     				k=i*size_v + (j1*Nv*Nv + j2*Nv + j3);															// calculate the index of cell (i,j1,j2,j3) in U
+    				if(! HoldsCell(k))																				// U only holds the cells of this process
+    				{
+    					continue;
+    				}
 
     				tp0 = tmpx0*tmp0;																				// calculate b_6k = (int_Ii f_DH(x) dx)*(int_Kj Mw(v) dv)
     				tp5 = tmpx0*tmp4;																				// calculate b_(6k+5) = (int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+5)(v) dv)
-    				U[k*6+0] = 19*tp0/4. - 15*tp5;																	// calculate the coefficient U[6k]
-    				U[k*6+5] = 60*tp5 - 15*tp0;																		// calculate the coefficient U[6k+5]
+    				U[SlabIndex(k, 0)] = 19*tp0/4. - 15*tp5;														// calculate the coefficient U[6k]
+    				U[SlabIndex(k, 5)] = 60*tp5 - 15*tp0;															// calculate the coefficient U[6k+5]
 
-    				U[k*6+1] = tmpx1*tmp0*12; 																		// calculate the coefficient U[6k+1] = 12*b_(6k+1) = 12*(int_Ii f_DH(x)*phi_(6k+1)(x) dx)*(int_Kj Mw(v) dv)
-    				U[k*6+2] = tmpx0*tmp1*12;																		// calculate the coefficient U[6k+2] = 12*b_(6k+2) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+2)(v) dv)
-    				U[k*6+3] = tmpx0*tmp2*12;																		// calculate the coefficient U[6k+3] = 12*b_(6k+3) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+3)(v) dv)
-    				U[k*6+4] = tmpx0*tmp3*12;																		// calculate the coefficient U[6k+4] = 12*b_(6k+4) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+4)(v) dv)
+    				U[SlabIndex(k, 1)] = tmpx1*tmp0*12;																// calculate the coefficient U[6k+1] = 12*b_(6k+1) = 12*(int_Ii f_DH(x)*phi_(6k+1)(x) dx)*(int_Kj Mw(v) dv)
+    				U[SlabIndex(k, 2)] = tmpx0*tmp1*12;																// calculate the coefficient U[6k+2] = 12*b_(6k+2) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+2)(v) dv)
+    				U[SlabIndex(k, 3)] = tmpx0*tmp2*12;																// calculate the coefficient U[6k+3] = 12*b_(6k+3) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+3)(v) dv)
+    				U[SlabIndex(k, 4)] = tmpx0*tmp3*12;																// calculate the coefficient U[6k+4] = 12*b_(6k+4) = 12*(int_Ii f_DH(x) dx)*(int_Kj Mw(v)*phi_(6k+4)(v) dv)
     			}
     		}
     	}
@@ -396,7 +416,7 @@ void setInit_spectral(double *U, double **f)
 void setInit_spectral_Inhomo(double *U, double **f)
 {
   int i, j1, j2, j3, k, l, m ,n;
-  for(i=chunk_Nx*myrank_mpi;i<chunk_Nx*(myrank_mpi+1) && i<Nx;i++){  
+  for(i=chunk_Nx*grid_rank_x;i<chunk_Nx*(grid_rank_x+1) && i<Nx;i++){  
     for(l=0;l<N;l++){
       j1 = (l*h_v)/dv; // integer part = floor() for non-negative integers.
       if(j1==Nv)j1=Nv-1; // let the right end point lie in the last element
@@ -406,7 +426,7 @@ void setInit_spectral_Inhomo(double *U, double **f)
 		for(n=0;n<N;n++){
 			j3 = (n*h_v)/dv;
 			if(j3==Nv)j3=Nv-1;
-			k=i*size_v + (j1*Nv*Nv + j2*Nv + j3); // determine in which element the Fourier nodes lie	  
+			k=(i%chunk_Nx)*size_v + (j1*Nv*Nv + j2*Nv + j3); // determine in which element the Fourier nodes lie (U holds the cells of the space steps of this process)	  
 			f[i%chunk_Nx][l*N*N+m*N+n] = U[k*6+0] + U[k*6+2]*(v[l]-Gridv((double)j1))/dv + U[k*6+3]*(v[m]-Gridv((double)j2))/dv + U[k*6+4]*(v[n]-Gridv((double)j3))/dv + U[k*6+5]*( ((v[l]-Gridv((double)j1))/dv)*((v[l]-Gridv((double)j1))/dv) + ((v[m]-Gridv((double)j2))/dv)*((v[m]-Gridv((double)j2))/dv) + ((v[n]-Gridv((double)j3))/dv)*((v[n]-Gridv((double)j3))/dv) ); 
 		  //BUG: index was "l*N*N+m*N+n*N" !!!!!!
 		}
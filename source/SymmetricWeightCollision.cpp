@@ -0,0 +1,169 @@
+/* This is the source file which contains the quadrature sums used by the Direct collision engine
+ * when SymmetricWeights = True.  They compute the same sums as ComputeQ_Direct, ComputeQ_FandL_Direct &
+ * ComputeQLinear_Direct, but read the convolution weights from the tables built by
+ * GetSymmetricWeightTable, which only hold one weight for each orbit of the octahedral symmetry of
+ * the kernel.  The weight of the pairs (i,l), (j,m) & (k,n) of indices of ki & eta is found from
+ * their orbits c1, c2 & c3 (looked up in pair_class): sorted into lo <= mid <= hi, it is at
+ * tet[hi] + tri[mid] + lo.  The orbits of (i,l) & (j,m) are sorted once for each (l,m), so only c3
+ * is placed among them in the innermost loop.  The table is small enough to stay in the cache for
+ * N = 8 & 16, at the cost of this gather in place of a contiguous stream of weights.
+ *
+ * Functions included: InitSymmetricWeights, SymmetricIndex,
+ * SymmetricConvolution, ComputeQ_SymmetricWeights, ComputeQ_FandL_SymmetricWeights,
+ * ComputeQLinear_SymmetricWeights
+ *
+ */
+
+#include "SymmetricWeightCollision.h"																// SymmetricWeightCollision.h is where the prototypes for the functions contained in this file are declared
+
+static double *conv_weights_symmetric, *conv_weights_linear_symmetric;								// declare pointers to the tables of gHat3 & gHat3_linear weights with one weight per orbit
+static const WeightOrbits *orbits;																	// declare a pointer to orbits (the orbits of the pairs of indices in one direction)
+
+void InitSymmetricWeights(int gamma)																// Function to build the tables of weights with one weight per orbit (they are deleted by FreeWeightTables)
+{
+	orbits = GetWeightOrbits();
+	conv_weights_symmetric = GetSymmetricWeightTable(WEIGHTS_LANDAU, gamma);
+	if(FullandLinear)
+	{
+		conv_weights_linear_symmetric = GetSymmetricWeightTable(WEIGHTS_LINEAR, gamma);
+	}
+}
+
+static inline long SymmetricIndex(int lo, int hi, int c)											// Function to find the index in a symmetric table of the weight of the orbits lo <= hi & c (in any order)
+{
+	if(c >= hi)
+	{
+		return orbits->tet[c] + orbits->tri[hi] + lo;
+	}
+	if(c >= lo)
+	{
+		return orbits->tet[hi] + orbits->tri[c] + lo;
+	}
+	return orbits->tet[hi] + orbits->tri[lo] + c;
+}
+
+static void SymmetricConvolution(fftw_complex *gHat, fftw_complex *fHat, fftw_complex *qHat)		// Function to calculate qHat(ki) = sum over w of gHat3(ki,w)*gHat(w)*fHat(ki-w) (with the same quadrature as ComputeQ), reading the symmetric weights
+{
+	int ki, i, j, k, l, m, n, x, y, z, kw, kz, c1, c2, lo, hi;
+	int t, ki_end, threads = ModeThreads();
+	int start_i, start_j, start_k, end_i, end_j, end_k;
+	double prefactor = h_eta*h_eta*h_eta;
+	double tmp0, tmp1, wt, tempD;
+	const int *pair_class = orbits->pair_class;
+
+	#pragma omp parallel for schedule(static,1) num_threads(threads) private(t,ki_end,ki,i,j,k,l,m,n,x,y,z,kw,kz,c1,c2,lo,hi,start_i,start_j,start_k,end_i,end_j,end_k,tmp0,tmp1,wt,tempD) shared(qHat, gHat, fHat)
+	for(t=0;t<threads;t++)																			// give each thread one range of modes of about the same cost (see ModeSchedule.cpp)
+	{
+		for(ki=ModeStart(t, threads), ki_end=ModeStart(t+1, threads);ki<ki_end;ki++)
+		{
+			i = ki/(N*N); j = (ki/N)%N; k = ki%N;
+
+			ConvolutionWindow(i, &start_i, &end_i);
+			ConvolutionWindow(j, &start_j, &end_j);
+			ConvolutionWindow(k, &start_k, &end_k);
+
+			tmp0=0.; tmp1=0.;
+			for(l=start_i;l<end_i;l++)
+			{
+				x = i + N/2 - l;																	// eta[x] = ki[i] - eta[l]
+				c1 = pair_class[l + N*i];
+				for(m=start_j;m<end_j;m++)
+				{
+					y = j + N/2 - m;
+					c2 = pair_class[m + N*j];
+					lo = c1 < c2 ? c1 : c2;															// sort the orbits of the first two directions once for every n
+					hi = c1 < c2 ? c2 : c1;
+					for(n=start_k;n<end_k;n++)
+					{
+						z = k + N/2 - n;
+						kw = n + N*(m + N*l);
+						kz = z + N*(y + N*x);
+
+						tempD = conv_weights_symmetric[SymmetricIndex(lo, hi, pair_class[n + N*k])];
+						wt = prefactor*wtN[l]*wtN[m]*wtN[n]*tempD;
+						tmp0 += wt*(gHat[kw][0]*fHat[kz][0] - gHat[kw][1]*fHat[kz][1]);
+						tmp1 += wt*(gHat[kw][0]*fHat[kz][1] + gHat[kw][1]*fHat[kz][0]);
+					}
+				}
+			}
+			qHat[ki][0] = tmp0;
+			qHat[ki][1] = tmp1;
+		}
+	}
+}
+
+void ComputeQ_SymmetricWeights(double *f, fftw_complex *qHat)										// Function to calculate the Fourier transform of Q(f,f), as in ComputeQ, with the symmetric weights
+{
+	fftw_complex *fftOut = CurrentCollisionWorkspace()->fftOut;										// the spectrum of f is stored in this thread's workspace (the global fftOut unless the space-steps are run concurrently)
+
+	fft3D(f, fftOut);																				// perform the FFT of f and store the result in fftOut
+
+	SymmetricConvolution(fftOut, fftOut, qHat);
+}
+
+void ComputeQ_FandL_SymmetricWeights(double *f, fftw_complex *qHat, fftw_complex *qHat_linear)		// Function to calculate the Fourier transforms of the full & linear parts of Q, as in ComputeQ_FandL, with the symmetric weights
+{
+	int ki, i, j, k, l, m, n, x, y, z, kw, kz, c1, c2, lo, hi;
+	int t, ki_end, threads = ModeThreads();
+	int start_i, start_j, start_k, end_i, end_j, end_k;
+	long idx;
+	double prefactor = h_eta*h_eta*h_eta;
+	double tmp0, tmp1, tmp01, tmp11, wt, tempD, tempD1;
+	const int *pair_class = orbits->pair_class;
+
+	fft3D(f, fftOut);																				// perform the FFT of f and store the result in fftOut
+
+	#pragma omp parallel for schedule(static,1) num_threads(threads) private(t,ki_end,ki,i,j,k,l,m,n,x,y,z,kw,kz,c1,c2,lo,hi,idx,start_i,start_j,start_k,end_i,end_j,end_k,tmp0,tmp1,tmp01,tmp11,wt,tempD,tempD1) shared(qHat, qHat_linear, fftOut)
+	for(t=0;t<threads;t++)																			// give each thread one range of modes of about the same cost (see ModeSchedule.cpp)
+	{
+		for(ki=ModeStart(t, threads), ki_end=ModeStart(t+1, threads);ki<ki_end;ki++)
+		{
+			i = ki/(N*N); j = (ki/N)%N; k = ki%N;
+
+			ConvolutionWindow(i, &start_i, &end_i);
+			ConvolutionWindow(j, &start_j, &end_j);
+			ConvolutionWindow(k, &start_k, &end_k);
+
+			tmp0=0.; tmp1=0.; tmp01=0.; tmp11=0.;
+			for(l=start_i;l<end_i;l++)
+			{
+				x = i + N/2 - l;
+				c1 = pair_class[l + N*i];
+				for(m=start_j;m<end_j;m++)
+				{
+					y = j + N/2 - m;
+					c2 = pair_class[m + N*j];
+					lo = c1 < c2 ? c1 : c2;
+					hi = c1 < c2 ? c2 : c1;
+					for(n=start_k;n<end_k;n++)
+					{
+						z = k + N/2 - n;
+						kw = n + N*(m + N*l);
+						kz = z + N*(y + N*x);
+
+						idx = SymmetricIndex(lo, hi, pair_class[n + N*k]);							// both tables have the same orbits, so the index is found once
+						tempD = conv_weights_symmetric[idx];
+						tempD1 = conv_weights_linear_symmetric[idx];
+						wt = prefactor*wtN[l]*wtN[m]*wtN[n];
+						tmp0 += wt*tempD*(fftOut[kw][0]*fftOut[kz][0] - fftOut[kw][1]*fftOut[kz][1]);
+						tmp1 += wt*tempD*(fftOut[kw][0]*fftOut[kz][1] + fftOut[kw][1]*fftOut[kz][0]);
+
+						tmp01 += wt*tempD1*fftOut[kz][0];
+						tmp11 += wt*tempD1*fftOut[kz][1];
+					}
+				}
+			}
+			qHat_linear[ki][0] = scale3*tmp01;														// scale3 is the same for every term, so it is applied once to the linear sums
+			qHat_linear[ki][1] = scale3*tmp11;
+			qHat[ki][0] = tmp0 + qHat_linear[ki][0];												// the full part of Q also includes the linear part
+			qHat[ki][1] = tmp1 + qHat_linear[ki][1];
+		}
+	}
+}
+
+void ComputeQLinear_SymmetricWeights(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat)	// Function to calculate the Fourier transform of Q(f,M), as in ComputeQLinear, with the symmetric weights
+{
+	fft3D(f, fftOut);																				// perform the FFT of f and store the result in fftOut
+
+	SymmetricConvolution(Maxwell_fftOut, fftOut, qHat);
+}
@@ -0,0 +1,36 @@
+/* This is the header file associated to SymmetricWeightCollision.cpp in which the prototypes for the
+ * functions contained in that file are declared.  Any other header files which must be linked to
+ * for the functions here are also included.
+ *
+ */
+
+//************************//
+//     INCLUDE GUARDS     //
+//************************//
+
+#ifndef SYMMETRICWEIGHTCOLLISION_H_
+#define SYMMETRICWEIGHTCOLLISION_H_
+
+//************************//
+//        INCLUDES        //
+//************************//
+
+#include "LP_ompi.h"																				// allows the libraries included, macros defined and external variables declared in LP_ompi.h to be used in the SymmetricWeightCollision functions
+#include "collisionRoutines_1.h"																	// allows fft3D to be used in the SymmetricWeightCollision functions
+#include "WeightStore.h"																			// allows the WEIGHTS_ kernel variants to be used
+#include "WeightTables.h"																			// allows GetWeightOrbits & GetSymmetricWeightTable to be used
+#include "CollisionWorkspace.h"																		// allows CurrentCollisionWorkspace to be used
+
+//************************//
+//   FUNCTION PROTOTYPES  //
+//************************//
+
+void InitSymmetricWeights(int gamma);
+
+void ComputeQ_SymmetricWeights(double *f, fftw_complex *qHat);
+
+void ComputeQ_FandL_SymmetricWeights(double *f, fftw_complex *qHat, fftw_complex *qHat_linear);
+
+void ComputeQLinear_SymmetricWeights(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat);
+
+#endif /* SYMMETRICWEIGHTCOLLISION_H_ */
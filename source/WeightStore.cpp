@@ -0,0 +1,292 @@
+/* This is the source file which contains the subroutines necessary for storing the convolution
+ * weights of the collision operator in a versioned binary file (a weight store), which can be
+ * mapped into memory read-only at the start of a run instead of recomputing the weights each time.
+ *
+ * A weight store consists of a WeightStoreHeader (recording N, L_v, gamma, the kernel variant and
+ * a checksum) followed by the size_ft x size_ft weights, stored row by row in the same order as
+ * conv_weights[k + N*(j + N*i)][n + N*(m + N*l)].
+ *
+ * Functions included: WeightStoreFilename, FillWeightStoreHeader, WeightRowChecksum,
+ * GenerateWeightRows, LoadWeightStore, GenerateWeightStore, AttachWeightStore,
+ * DetachWeightStore
+ *
+ */
+
+#include "WeightStore.h"																			// WeightStore.h is where the prototypes for the functions contained in this file are declared
+
+#include <sys/mman.h>																				// allows mmap & munmap to be used
+#include <sys/stat.h>																				// allows fstat to be used
+#include <fcntl.h>																					// allows open to be used
+#include <unistd.h>																					// allows close to be used
+
+void WeightStoreFilename(char *filename, int gamma, int variant)									// Function to set filename to the name of the weight store for the current N, L_v, gamma & kernel variant
+{
+	if(variant == WEIGHTS_LINEAR)
+	{
+		snprintf(filename, WEIGHTSTORE_NAME_LENGTH, "%s/N%d_L%g_Landau_linear.wts",
+					weight_store_dir.c_str(), N, L_v);												// the linear weights do not depend on gamma, so it is left out of the name
+	}
+	else
+	{
+		snprintf(filename, WEIGHTSTORE_NAME_LENGTH, "%s/N%d_L%g_gamma%d_Landau.wts",
+					weight_store_dir.c_str(), N, L_v, gamma);
+	}
+}
+
+void FillWeightStoreHeader(WeightStoreHeader *header, int gamma, int variant, uint64_t checksum)	// Function to fill the header of a weight store for the current N & L_v
+{
+	memset(header, 0, sizeof(WeightStoreHeader));													// zero the header first so that the unused bytes of magic & reserved are always the same
+	strcpy(header->magic, "LPWTS");
+	header->version = WEIGHTSTORE_VERSION;
+	header->N = N;
+	header->L_v = L_v;
+	header->gamma = (variant == WEIGHTS_LINEAR) ? 0 : gamma;
+	header->variant = variant;
+	header->size_ft = size_ft;
+	header->checksum = checksum;
+}
+
+uint64_t WeightRowChecksum(const double *row, int ki)												// Function to calculate the checksum of the row ki of a weight table (the sum of these over all rows is stored in the header)
+{
+	const unsigned char *bytes = (const unsigned char *)row;										// view the row as raw bytes so that the checksum picks up any change in the bits of the weights
+	uint64_t hash = 14695981039346656037ULL;														// start a 64-bit FNV-1a hash of the row
+	long b;
+
+	for(b=0;b<(long)size_ft*(long)sizeof(double);b++)
+	{
+		hash ^= bytes[b];
+		hash *= 1099511628211ULL;
+	}
+
+	return (2*(uint64_t)ki + 1)*hash;																// multiply by an odd factor depending on ki so that swapping two rows changes the sum (which can be added up in any order across threads & MPI processes)
+}
+
+void GenerateWeightRows(double *rows, int ki_start, int ki_end, int gamma, int variant)				// Function to calculate the rows ki_start <= ki < ki_end of the weight table for the given kernel variant and store them one after the other in rows
+{
+	int ki;
+	bool linear = (variant == WEIGHTS_LINEAR);
+	double **row_ptrs = (double **)malloc((ki_end-ki_start)*sizeof(double *));
+	double *Shat_w = (double *)malloc(9*size_ft*sizeof(double));
+	double *Aiso_w = (double *)malloc(size_ft*sizeof(double));
+
+	for(ki=ki_start;ki<ki_end;ki++)
+	{
+		row_ptrs[ki-ki_start] = rows + (long)(ki-ki_start)*size_ft;
+	}
+
+	TabulateShat(linear ? -3 : gamma, Shat_w, Aiso_w);												// S-hat(w) is tabulated once for the block, so each weight is only a quadratic form in xi (gHat3_linear always uses the gamma = -3 tensor)
+	WeightRowsFromShat(row_ptrs, ki_start, ki_end, Shat_w, Aiso_w, gamma, linear);
+
+	free(row_ptrs); free(Shat_w); free(Aiso_w);
+}
+
+bool LoadWeightStore(const char *filename, int gamma, int variant, double **conv_weights)			// Function to map the weight store in filename read-only and point the rows of conv_weights into it (returns false, leaving conv_weights untouched, if the file is missing or does not match this run)
+{
+	int fid, ki;
+	struct stat file_info;
+	WeightStoreHeader expected;
+	const WeightStoreHeader *header;
+	void *mapping;
+	double *weights;
+	long file_bytes;
+	uint64_t checksum = 0;
+
+	fid = open(filename, O_RDONLY);
+	if(fid < 0)
+	{
+		return false;																				// the weight store has not been generated yet
+	}
+
+	file_bytes = WEIGHTSTORE_HEADER_BYTES + (long)size_ft*(long)size_ft*(long)sizeof(double);		// the size a weight store for this N must have
+	if(fstat(fid, &file_info) != 0 || (long)file_info.st_size != file_bytes)
+	{
+		if(myrank_mpi==0)
+		{
+			printf("Weight store %s has the wrong size for N = %d and will be regenerated.\n", filename, N);
+		}
+		close(fid);
+		return false;
+	}
+
+	mapping = mmap(NULL, file_bytes, PROT_READ, MAP_SHARED, fid, 0);								// map the file read-only (processes on the same node then share the same pages)
+	close(fid);																						// the mapping remains valid after the file is closed
+	if(mapping == MAP_FAILED)
+	{
+		if(myrank_mpi==0)
+		{
+			printf("Weight store %s could not be mapped into memory.\n", filename);
+		}
+		return false;
+	}
+
+	header = (const WeightStoreHeader *)mapping;
+	FillWeightStoreHeader(&expected, gamma, variant, header->checksum);								// the header this run expects (the checksum is checked separately)
+	if(memcmp(header, &expected, sizeof(WeightStoreHeader)) != 0)
+	{
+		if(myrank_mpi==0)
+		{
+			printf("Weight store %s was written for different parameters (or by a different version) and will be regenerated.\n", filename);
+		}
+		munmap(mapping, file_bytes);
+		return false;
+	}
+
+	weights = (double *)((char *)mapping + WEIGHTSTORE_HEADER_BYTES);
+
+	if(VerifyWeightStore)																			// only do this if the checksum was asked for, since it reads the whole file
+	{
+		#pragma omp parallel for private(ki) reduction(+:checksum)
+		for(ki=0;ki<size_ft;ki++)
+		{
+			checksum += WeightRowChecksum(weights + (long)ki*size_ft, ki);
+		}
+		if(checksum != header->checksum)
+		{
+			if(myrank_mpi==0)
+			{
+				printf("Weight store %s failed its checksum and will be regenerated.\n", filename);
+			}
+			munmap(mapping, file_bytes);
+			return false;
+		}
+	}
+
+	for(ki=0;ki<size_ft;ki++)
+	{
+		conv_weights[ki] = weights + (long)ki*size_ft;												// point the row ki of conv_weights at the corresponding row of the mapping
+	}
+
+	return true;
+}
+
+bool GenerateWeightStore(const char *filename, int gamma, int variant)								// Function to fill the weight store in filename in parallel, with each MPI process calculating and writing its own share of the rows
+{
+	char tmp_filename[WEIGHTSTORE_NAME_LENGTH + 8];
+	int ki_start, ki_end, chunk_rows, block_rows, n_blocks, b, rows_b, start_b, ki, err;
+	bool renamed = false;
+	double *rows;
+	uint64_t checksum_local = 0, checksum;
+	WeightStoreHeader header;
+	MPI_File fh;
+	MPI_Offset offset;
+	double t1, t2;
+
+	t1 = MPI_Wtime();
+
+	chunk_rows = (size_ft + nprocs_mpi - 1)/nprocs_mpi;												// the number of rows calculated by each process (the last process may have fewer)
+	ki_start = myrank_mpi*chunk_rows;
+	ki_end = ki_start + chunk_rows;
+	if(ki_start > size_ft) ki_start = size_ft;
+	if(ki_end > size_ft) ki_end = size_ft;
+
+	block_rows = WEIGHTSTORE_BLOCK_BYTES/((long)size_ft*sizeof(double));							// the number of rows held in memory at a time
+	if(block_rows < 1) block_rows = 1;
+	n_blocks = (chunk_rows + block_rows - 1)/block_rows;											// every process makes the same number of collective writes, even if it has no rows left
+	rows = (double *)malloc((long)block_rows*size_ft*sizeof(double));
+
+	snprintf(tmp_filename, sizeof(tmp_filename), "%s.tmp", filename);								// write to a temporary file first so that a partially written store is never picked up
+	err = MPI_File_open(MPI_COMM_WORLD, tmp_filename, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh);
+	if(err != MPI_SUCCESS)
+	{
+		if(myrank_mpi==0)
+		{
+			printf("Weight store %s could not be created (check that the directory %s exists).\n", tmp_filename, weight_store_dir.c_str());
+		}
+		free(rows);
+		return false;
+	}
+	MPI_File_set_size(fh, WEIGHTSTORE_HEADER_BYTES + (MPI_Offset)size_ft*size_ft*sizeof(double));	// discard anything left over from an earlier attempt which was interrupted
+
+	for(b=0;b<n_blocks;b++)
+	{
+		start_b = ki_start + b*block_rows;
+		rows_b = ki_end - start_b;
+		if(rows_b > block_rows) rows_b = block_rows;
+		if(rows_b < 0) rows_b = 0;
+
+		GenerateWeightRows(rows, start_b, start_b + rows_b, gamma, variant);
+		for(ki=0;ki<rows_b;ki++)
+		{
+			checksum_local += WeightRowChecksum(rows + (long)ki*size_ft, start_b + ki);
+		}
+
+		offset = WEIGHTSTORE_HEADER_BYTES + (MPI_Offset)start_b*size_ft*sizeof(double);
+		MPI_File_write_at_all(fh, offset, rows, rows_b*size_ft, MPI_DOUBLE, MPI_STATUS_IGNORE);
+	}
+
+	MPI_Allreduce(&checksum_local, &checksum, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);			// the checksum of the whole table is the sum of those of each row
+	if(myrank_mpi==0)
+	{
+		FillWeightStoreHeader(&header, gamma, variant, checksum);
+		MPI_File_write_at(fh, 0, &header, sizeof(WeightStoreHeader), MPI_BYTE, MPI_STATUS_IGNORE);
+	}
+	MPI_File_close(&fh);
+	free(rows);
+
+	if(myrank_mpi==0)
+	{
+		renamed = (rename(tmp_filename, filename) == 0);											// only now make the finished store visible under its proper name
+		if(! renamed)
+		{
+			printf("Weight store %s could not be renamed to %s.\n", tmp_filename, filename);
+		}
+	}
+	MPI_Bcast(&renamed, 1, MPI_CXX_BOOL, 0, MPI_COMM_WORLD);										// also makes sure no process tries to load the store before it has been renamed
+	if(! renamed)
+	{
+		return false;
+	}
+
+	t2 = MPI_Wtime();
+	if(myrank_mpi==0)
+	{
+		printf("Generated weight store %s in %g seconds.\n", filename, t2-t1);
+	}
+
+	return true;
+}
+
+bool AttachWeightStore(double **conv_weights, int gamma, int variant)								// Function to point the rows of conv_weights at the weight store for this run, generating the store first if it does not exist (returns false if this was not possible, in which case the weights must be computed in memory)
+{
+	char filename[WEIGHTSTORE_NAME_LENGTH];
+	bool loaded, loaded_here;
+
+	WeightStoreFilename(filename, gamma, variant);
+
+	loaded_here = LoadWeightStore(filename, gamma, variant, conv_weights);
+	MPI_Allreduce(&loaded_here, &loaded, 1, MPI_CXX_BOOL, MPI_LAND, MPI_COMM_WORLD);				// regenerate the store if any process could not load it
+	if(! loaded)
+	{
+		if(loaded_here)
+		{
+			DetachWeightStore(conv_weights);														// this process did map the old store, so unmap it before it is replaced
+		}
+		if(myrank_mpi==0)
+		{
+			printf("Weight store %s not found. Generating it with %d processes... \n", filename, nprocs_mpi);
+		}
+		if(! GenerateWeightStore(filename, gamma, variant))
+		{
+			return false;
+		}
+		loaded_here = LoadWeightStore(filename, gamma, variant, conv_weights);
+		MPI_Allreduce(&loaded_here, &loaded, 1, MPI_CXX_BOOL, MPI_LAND, MPI_COMM_WORLD);
+		if(! loaded && loaded_here)
+		{
+			DetachWeightStore(conv_weights);														// the weights will be computed in memory instead, so do not keep this mapping either
+		}
+	}
+	else if(myrank_mpi==0)
+	{
+		printf("Stored weights found in %s. \n", filename);
+	}
+
+	return loaded;
+}
+
+void DetachWeightStore(double **conv_weights)														// Function to unmap the weight store which the rows of conv_weights were pointed at by LoadWeightStore
+{
+	long file_bytes = WEIGHTSTORE_HEADER_BYTES + (long)size_ft*(long)size_ft*(long)sizeof(double);
+
+	munmap((char *)conv_weights[0] - WEIGHTSTORE_HEADER_BYTES, file_bytes);							// the first row starts straight after the header, at the start of the mapping
+}
@@ -0,0 +1,71 @@
+/* This is the header file associated to WeightStore.cpp in which the prototypes for the
+ * functions contained in that file are declared.  Any other header files which must be linked to
+ * for the functions here are also included.
+ *
+ */
+
+//************************//
+//     INCLUDE GUARDS     //
+//************************//
+
+#ifndef WEIGHTSTORE_H_
+#define WEIGHTSTORE_H_
+
+//************************//
+//        INCLUDES        //
+//************************//
+
+#include "LP_ompi.h"																				// allows the libraries included, macros defined and external variables declared in LP_ompi.h to be used in the WeightStore functions
+#include "collisionRoutines_1.h"																	// allows TabulateShat & WeightRowsFromShat to be used when filling the rows of a weight store
+#include <stdint.h>																					// allows the fixed width integer types used in the header of a weight store to be used
+
+//************************//
+//         MACROS         //
+//************************//
+
+#define WEIGHTSTORE_VERSION 1																		// version of the layout of a .wts file (increase this whenever the header or the ordering of the weights changes)
+#define WEIGHTSTORE_HEADER_BYTES 64																	// size of the header at the start of a .wts file (the weights start at this offset, so they stay aligned when the file is mapped)
+#define WEIGHTSTORE_NAME_LENGTH 256																	// maximum length of the name of a .wts file
+#define WEIGHTSTORE_BLOCK_BYTES (64L*1024L*1024L)													// size of the blocks of rows which are generated and written at a time by GenerateWeightStore
+
+#define WEIGHTS_LANDAU 0																			// kernel variant stored in the weight store: gHat3 with the chosen gamma (as used by ComputeQ, RK4 & ComputeQLinear)
+#define WEIGHTS_LINEAR 1																			// kernel variant stored in the weight store: gHat3_linear (as used by the linear part of ComputeQ_FandL)
+
+//************************//
+//  STRUCTURE DEFINITION  //
+//************************//
+
+struct WeightStoreHeader																			// the header found at the start of every .wts file
+{
+	char magic[8];																					// the characters "LPWTS" followed by zeros
+	int32_t version;																				// the value of WEIGHTSTORE_VERSION when the file was written
+	int32_t N;																						// the number of Fourier modes in each direction
+	double L_v;																						// the value of L_v (for -L_v < v < L_v in the collision problem)
+	int32_t gamma;																					// the value of gamma in the collision kernel (0 for WEIGHTS_LINEAR, which does not depend on it)
+	int32_t variant;																				// the kernel used to fill the file (WEIGHTS_LANDAU or WEIGHTS_LINEAR)
+	int64_t size_ft;																				// the number of rows (and of entries in each row), N^3
+	uint64_t checksum;																				// the sum of WeightRowChecksum over all rows
+	char reserved[WEIGHTSTORE_HEADER_BYTES - 48];													// padding up to WEIGHTSTORE_HEADER_BYTES (set to zero)
+};
+
+//************************//
+//   FUNCTION PROTOTYPES  //
+//************************//
+
+void WeightStoreFilename(char *filename, int gamma, int variant);
+
+void FillWeightStoreHeader(WeightStoreHeader *header, int gamma, int variant, uint64_t checksum);
+
+uint64_t WeightRowChecksum(const double *row, int ki);
+
+void GenerateWeightRows(double *rows, int ki_start, int ki_end, int gamma, int variant);
+
+bool LoadWeightStore(const char *filename, int gamma, int variant, double **conv_weights);
+
+bool GenerateWeightStore(const char *filename, int gamma, int variant);
+
+bool AttachWeightStore(double **conv_weights, int gamma, int variant);
+
+void DetachWeightStore(double **conv_weights);
+
+#endif /* WEIGHTSTORE_H_ */
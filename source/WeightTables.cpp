@@ -0,0 +1,533 @@
+/* This is the source file which contains the registry of the tables of convolution weights used by
+ * the Direct collision engine.
+ *
+ * Each operator path only reads some of the tables: ComputeQ, RK4, ComputeQLinear & RK4Linear use
+ * the gHat3 weights for the chosen gamma (WEIGHTS_LANDAU), while ComputeQ_FandL & the FandL
+ * versions of RK4 also use the gHat3_linear weights (WEIGHTS_LINEAR).  A table is only allocated
+ * and filled (or mapped from its weight store) the first time it is asked for, and the number of
+ * bytes and seconds spent on it are reported when it is built.
+ *
+ * With FloatWeights = True each table is instead held as 32-bit floats (built by GetFloatWeightTable,
+ * a block of rows at a time, so that the double table never has to be held in memory), which
+ * halves both its memory and the number of bytes streamed by the quadrature sums.
+ *
+ * With PackedWeights = True each table is instead held packed (built by GetPackedWeightTable): only
+ * the entries of each row inside its convolution window are kept, in the order the quadrature sums
+ * read them, with the quadrature weights h_eta^3*wtN[l]*wtN[m]*wtN[n] already multiplied in.  The
+ * rows are stored one after another in a single aligned block (optionally on transparent huge
+ * pages), which holds about 42% of the entries of the full table for N = 8.
+ *
+ * With SymmetricWeights = True each table is instead held as one weight for each orbit of the
+ * octahedral symmetry of the kernel (built by GetSymmetricWeightTable).  S-hat(w) transforms as a
+ * tensor under the permutations & reflections of the axes, so gHat3(xi,w) & gHat3_linear(xi,w) are
+ * unchanged when the same one is applied to xi & w.  Since eta[N-i] = -eta[i] for i > 0 (but eta[0]
+ * has no mirror image), the direction a may only be reflected when neither index of the pair
+ * (i_a,l_a) is 0.  The pairs of each direction are sorted into P orbits (GetWeightOrbits), and a
+ * weight is set by the unordered triple of the orbits of its three pairs, so the table holds
+ * P(P+1)(P+2)/6 weights, 1/23 of the full table for N = 8, 1/40 for N = 32 & 1/48 as N grows.
+ *
+ * With SharedWeights = True the double tables computed in memory are held once per node instead of
+ * once per process: the block of each table is allocated by the first process of the node in an
+ * MPI-3 shared-memory window (FillSharedBlock), each process of the node computes an equal share of
+ * its rows straight into it, and then every process points its rows into the same block.
+ *
+ * Functions included: FillSharedBlock, GetWeightTable, GetFloatWeightTable,
+ * PackedRowLength, AllocPackedBlock, GetPackedWeightTable, GetWeightOrbits, GetSymmetricWeightTable,
+ * SetupOperatorWeights, FreeWeightTables
+ *
+ */
+
+#include "WeightTables.h"																			// WeightTables.h is where the prototypes for the functions contained in this file are declared
+
+#include <sys/mman.h>																				// allows madvise to be used
+
+struct WeightTable																					// an entry of the registry of weight tables
+{
+	const char *name;																				// the name used when reporting the table
+	double **rows;																					// the rows of the table (NULL until it is first asked for)
+	double *block;																					// the block of memory holding the rows when they were computed in memory (NULL when they are mapped from a weight store)
+	float **rows_float;																				// the rows of the table stored as floats (NULL until it is first asked for)
+	float *block_float;																				// the block of memory holding the rows stored as floats
+	double *packed;																					// the entries of the table inside the convolution windows, scaled by the quadrature weights (NULL until it is first asked for)
+	double *symmetric;																				// one weight for each orbit of the octahedral symmetry of the kernel (NULL until it is first asked for)
+	MPI_Win window;																					// the shared-memory window holding block when it is shared by the processes of each node (MPI_WIN_NULL otherwise)
+	long bytes;																						// the number of bytes taken up by the weights in the table
+	double seconds;																					// the time taken to compute or map the table
+};
+
+static WeightTable weight_tables[WEIGHT_TABLE_KINDS] = {
+	{"gHat3", NULL, NULL, NULL, NULL, NULL, NULL, MPI_WIN_NULL, 0, 0.},
+	{"gHat3_linear", NULL, NULL, NULL, NULL, NULL, NULL, MPI_WIN_NULL, 0, 0.}
+};																									// declare the registry, with one entry for each kernel variant (indexed by WEIGHTS_LANDAU & WEIGHTS_LINEAR)
+
+static WeightOrbits orbits = {0, NULL, NULL, NULL, NULL, NULL};										// declare orbits (the orbits of the pairs of indices in one direction, set up by the first call of GetWeightOrbits)
+static MPI_Comm node_comm = MPI_COMM_NULL;															// declare node_comm (the communicator of the processes on this node, set up by the first call of FillSharedBlock)
+static long *packed_row_start = NULL;																// declare a pointer to packed_row_start (the index in each packed table of the first entry of each row, with the total number of entries at the end; the windows only depend on ki, so this is shared by the packed tables)
+
+static void FillSharedBlock(WeightTable *table, int variant, int gamma)								// Function to allocate the block of a table once per node in a shared-memory window, with each process of the node computing an equal share of its rows
+{
+	int node_rank, node_size, ki_start, ki_end, disp_unit;
+	MPI_Aint size;
+	double *base;
+
+	if(node_comm == MPI_COMM_NULL)
+	{
+		MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);	// group the processes which can share memory (those on the same node)
+	}
+	MPI_Comm_rank(node_comm, &node_rank);
+	MPI_Comm_size(node_comm, &node_size);
+
+	// Only the first process of the node allocates the block, so that it is held once per node, and
+	// the others find its address in their own memory:
+	size = (node_rank == 0) ? table->bytes : 0;
+	MPI_Win_allocate_shared(size, sizeof(double), MPI_INFO_NULL, node_comm, &base, &table->window);
+	MPI_Win_shared_query(table->window, 0, &size, &disp_unit, &table->block);
+
+	// Compute the rows ki_start <= ki < ki_end of this process straight into the shared block, then
+	// wait for every process of the node to finish before any of them reads the table:
+	ki_start = (int)(((long)size_ft*node_rank)/node_size);
+	ki_end = (int)(((long)size_ft*(node_rank+1))/node_size);
+	MPI_Win_lock_all(MPI_MODE_NOCHECK, table->window);
+	if(ki_end > ki_start)
+	{
+		GenerateWeightRows(table->block + (long)ki_start*size_ft, ki_start, ki_end, gamma, variant);
+	}
+	MPI_Win_sync(table->window);																	// make the rows written by this process visible to the others on the node
+	MPI_Barrier(node_comm);
+	MPI_Win_sync(table->window);
+	MPI_Win_unlock_all(table->window);
+}
+
+double **GetWeightTable(int variant, int gamma)														// Function to return the table of convolution weights for the given kernel variant, building it the first time it is asked for
+{
+	WeightTable *table = &weight_tables[variant];
+	int i;
+	double t1, t2;
+
+	if(table->rows != NULL)
+	{
+		return table->rows;																			// the table has already been built
+	}
+
+	t1 = MPI_Wtime();
+	table->rows = (double **)malloc(size_ft*sizeof(double *));										// allocate enough space for size_ft many pointers to the rows of the table
+	table->bytes = (long)size_ft*(long)size_ft*(long)sizeof(double);
+
+	// Map the weights from the weight store if one is being used (it is generated in parallel
+	// the first time it is needed), otherwise directly compute them in memory:
+	if(! (UseWeightStore && AttachWeightStore(table->rows, gamma, variant)))
+	{
+		if(SharedWeights)
+		{
+			FillSharedBlock(table, variant, gamma);													// allocate the table once per node, splitting the rows to compute between its processes
+			for(i=0;i<size_ft;i++)
+			{
+				table->rows[i] = table->block + (long)i*size_ft;
+			}
+		}
+		else
+		{
+			table->block = (double *)malloc(table->bytes);											// allocate the whole table at once, so that its rows are contiguous
+			for(i=0;i<size_ft;i++)
+			{
+				table->rows[i] = table->block + (long)i*size_ft;
+			}
+			if(variant == WEIGHTS_LINEAR)
+			{
+				generate_conv_weights_linear(table->rows);											// calculate the values of the convolution weights for the linear case
+			}
+			else
+			{
+				generate_conv_weights(table->rows, gamma);											// calculate the values of the convolution weights for the chosen gamma
+			}
+		}
+	}
+	t2 = MPI_Wtime();
+	table->seconds = t2 - t1;
+
+	if(myrank_mpi==0)
+	{
+		printf("Weight table %s: %g MB %s in %g seconds.\n", table->name, table->bytes/1.e6,
+				(table->block == NULL) ? "mapped from its weight store" :
+				(table->window != MPI_WIN_NULL) ? "computed once per node" : "computed", table->seconds);
+	}
+
+	return table->rows;
+}
+
+float **GetFloatWeightTable(int variant, int gamma)													// Function to return the table of convolution weights for the given kernel variant stored as floats, building it the first time it is asked for
+{
+	WeightTable *table = &weight_tables[variant];
+	double **rows, *buffer;
+	long bytes = (long)size_ft*(long)size_ft*(long)sizeof(float);
+	int ki, ki_start, ki_end, kw;
+	bool mapped = false;
+	double t1, t2;
+
+	if(table->rows_float != NULL)
+	{
+		return table->rows_float;																	// the table has already been built
+	}
+
+	t1 = MPI_Wtime();
+	table->rows_float = (float **)malloc(size_ft*sizeof(float *));									// allocate enough space for size_ft many pointers to the rows of the table
+	table->block_float = (float *)malloc(bytes);													// allocate the whole table at once, so that its rows are contiguous
+	for(ki=0;ki<size_ft;ki++)
+	{
+		table->rows_float[ki] = table->block_float + (long)ki*size_ft;
+	}
+
+	// Round the weights from the double table if it has been built, or from the weight store if one
+	// is being used, otherwise compute them N*N rows at a time and round each block:
+	rows = table->rows;
+	if(rows == NULL && UseWeightStore)
+	{
+		rows = (double **)malloc(size_ft*sizeof(double *));
+		mapped = AttachWeightStore(rows, gamma, variant);
+		if(! mapped)
+		{
+			free(rows);
+			rows = NULL;
+		}
+	}
+	if(rows != NULL)
+	{
+		#pragma omp parallel for private(ki,kw)
+		for(ki=0;ki<size_ft;ki++)
+		{
+			for(kw=0;kw<size_ft;kw++)
+			{
+				table->rows_float[ki][kw] = (float)rows[ki][kw];
+			}
+		}
+		if(mapped)
+		{
+			DetachWeightStore(rows);
+			free(rows);
+		}
+	}
+	else
+	{
+		buffer = (double *)malloc((long)N*N*size_ft*sizeof(double));								// space for the double values of N*N rows
+		for(ki_start=0;ki_start<size_ft;ki_start+=N*N)
+		{
+			ki_end = ki_start + N*N;
+			GenerateWeightRows(buffer, ki_start, ki_end, gamma, variant);
+			#pragma omp parallel for private(kw)
+			for(kw=0;kw<(ki_end-ki_start)*size_ft;kw++)
+			{
+				table->block_float[(long)ki_start*size_ft + kw] = (float)buffer[kw];
+			}
+		}
+		free(buffer);
+	}
+	t2 = MPI_Wtime();
+
+	if(myrank_mpi==0)
+	{
+		printf("Weight table %s (float): %g MB rounded from %s in %g seconds.\n", table->name, bytes/1.e6,
+				(table->rows != NULL) ? "the double table" : (mapped ? "its weight store" : "the computed weights"), t2 - t1);
+	}
+
+	return table->rows_float;
+}
+
+static long PackedRowLength(int ki)																	// Function to find the number of entries of the row ki inside its convolution window
+{
+	int i = ki/(N*N), j = (ki/N)%N, k = ki%N;
+	int start_i, start_j, start_k, end_i, end_j, end_k;
+
+	ConvolutionWindow(i, &start_i, &end_i);
+	ConvolutionWindow(j, &start_j, &end_j);
+	ConvolutionWindow(k, &start_k, &end_k);
+
+	return (long)(end_i - start_i)*(end_j - start_j)*(end_k - start_k);
+}
+
+static double *AllocPackedBlock(long bytes)															// Function to allocate one aligned block of bytes for a packed table, on transparent huge pages if PackedHugePages is true
+{
+	void *block = NULL;
+	size_t align = PACKED_WEIGHT_ALIGN;
+
+#ifdef MADV_HUGEPAGE
+	if(PackedHugePages)
+	{
+		align = HUGE_PAGE_BYTES;
+		bytes = (bytes + HUGE_PAGE_BYTES - 1)/HUGE_PAGE_BYTES*HUGE_PAGE_BYTES;						// a whole number of huge pages, so that madvise covers all of the block
+	}
+#endif
+	if(posix_memalign(&block, align, bytes) != 0)
+	{
+		printf("Program cannot run... %g MB could not be allocated for a packed table of weights on process %d.\n", bytes/1.e6, myrank_mpi);
+		exit(1);
+	}
+#ifdef MADV_HUGEPAGE
+	if(PackedHugePages)
+	{
+		madvise(block, bytes, MADV_HUGEPAGE);														// only a hint: the kernel may still use normal pages
+	}
+#endif
+
+	return (double *)block;
+}
+
+double *GetPackedWeightTable(int variant, int gamma, const long **row_start)						// Function to return the packed table of convolution weights for the given kernel variant (with the index of the first entry of each row in row_start), building it the first time it is asked for
+{
+	WeightTable *table = &weight_tables[variant];
+	double **rows, *buffer, prefactor = h_eta*h_eta*h_eta;
+	long total;
+	int ki, ki_start, ki_end, l, m, n, start_i, start_j, start_k, end_i, end_j, end_k;
+	double *row, *out;
+	bool mapped = false;
+	double t1, t2;
+
+	if(packed_row_start == NULL)
+	{
+		packed_row_start = (long *)malloc((size_ft + 1)*sizeof(long));
+		packed_row_start[0] = 0;
+		for(ki=0;ki<size_ft;ki++)
+		{
+			packed_row_start[ki+1] = packed_row_start[ki] + PackedRowLength(ki);
+		}
+	}
+	*row_start = packed_row_start;
+
+	if(table->packed != NULL)
+	{
+		return table->packed;																		// the table has already been built
+	}
+
+	t1 = MPI_Wtime();
+	total = packed_row_start[size_ft];
+	table->packed = AllocPackedBlock(total*(long)sizeof(double));
+
+	// Pack the weights from the double table if it has been built, or from the weight store if one
+	// is being used, otherwise compute them N*N rows at a time and pack each block:
+	rows = table->rows;
+	if(rows == NULL && UseWeightStore)
+	{
+		rows = (double **)malloc(size_ft*sizeof(double *));
+		mapped = AttachWeightStore(rows, gamma, variant);
+		if(! mapped)
+		{
+			free(rows);
+			rows = NULL;
+		}
+	}
+	buffer = NULL;
+	if(rows == NULL)
+	{
+		buffer = (double *)malloc((long)N*N*size_ft*sizeof(double));								// space for the double values of N*N rows
+	}
+	for(ki_start=0;ki_start<size_ft;ki_start+=N*N)
+	{
+		ki_end = ki_start + N*N;
+		if(buffer != NULL)
+		{
+			GenerateWeightRows(buffer, ki_start, ki_end, gamma, variant);
+		}
+		#pragma omp parallel for private(ki,l,m,n,start_i,start_j,start_k,end_i,end_j,end_k,row,out)
+		for(ki=ki_start;ki<ki_end;ki++)																// each thread writes its own rows first, so that they are placed in memory near it
+		{
+			row = (buffer != NULL) ? buffer + (long)(ki - ki_start)*size_ft : rows[ki];
+			out = table->packed + packed_row_start[ki];
+			ConvolutionWindow(ki/(N*N), &start_i, &end_i);
+			ConvolutionWindow((ki/N)%N, &start_j, &end_j);
+			ConvolutionWindow(ki%N, &start_k, &end_k);
+			for(l=start_i;l<end_i;l++)
+			{
+				for(m=start_j;m<end_j;m++)
+				{
+					for(n=start_k;n<end_k;n++)
+					{
+						*out++ = prefactor*wtN[l]*wtN[m]*wtN[n]*row[n + N*(m + N*l)];
+					}
+				}
+			}
+		}
+	}
+	if(buffer != NULL)
+	{
+		free(buffer);
+	}
+	if(mapped)
+	{
+		DetachWeightStore(rows);
+		free(rows);
+	}
+	t2 = MPI_Wtime();
+
+	if(myrank_mpi==0)
+	{
+		printf("Weight table %s (packed): %g MB (%.1f%% of the full table) packed from %s in %g seconds.\n", table->name,
+				total*sizeof(double)/1.e6, 100.*total/((double)size_ft*size_ft),
+				(table->rows != NULL) ? "the double table" : (mapped ? "its weight store" : "the computed weights"), t2 - t1);
+	}
+
+	return table->packed;
+}
+
+const WeightOrbits *GetWeightOrbits()																// Function to return the orbits of the pairs (i,l) of indices in one direction, sorting the pairs into them the first time it is called
+{
+	int i, l, c, mirror;
+
+	if(orbits.pair_class != NULL)
+	{
+		return &orbits;
+	}
+
+	orbits.pair_class = (int *)malloc(N*N*sizeof(int));
+	orbits.rep_i = (int *)malloc(N*N*sizeof(int));
+	orbits.rep_l = (int *)malloc(N*N*sizeof(int));
+	c = 0;
+	for(i=0;i<N;i++)
+	{
+		for(l=0;l<N;l++)
+		{
+			mirror = (N-l) + N*(N-i);																// the index of the reflection (N-i,N-l) of the pair, which is only in the grid if i & l are both non-zero
+			if(i > 0 && l > 0 && mirror < l + N*i)
+			{
+				orbits.pair_class[l + N*i] = orbits.pair_class[mirror];								// the reflection was found first, so the pair joins its orbit
+			}
+			else
+			{
+				orbits.pair_class[l + N*i] = c;
+				orbits.rep_i[c] = i;
+				orbits.rep_l[c] = l;
+				c++;
+			}
+		}
+	}
+	orbits.classes = c;
+
+	orbits.tet = (long *)malloc((c+1)*sizeof(long));
+	orbits.tri = (long *)malloc((c+1)*sizeof(long));
+	for(i=0;i<=c;i++)
+	{
+		orbits.tet[i] = (long)i*(i+1)*(i+2)/6;
+		orbits.tri[i] = (long)i*(i+1)/2;
+	}
+
+	return &orbits;
+}
+
+double *GetSymmetricWeightTable(int variant, int gamma)												// Function to return the table with one weight for each orbit of the octahedral symmetry of the kernel for the given variant, building it the first time it is asked for
+{
+	WeightTable *table = &weight_tables[variant];
+	const WeightOrbits *O = GetWeightOrbits();
+	long total, base;
+	int c1, c2, c3, P = O->classes;
+	double t1, t2;
+
+	if(table->symmetric != NULL)
+	{
+		return table->symmetric;																	// the table has already been built
+	}
+
+	t1 = MPI_Wtime();
+	total = O->tet[P];
+	table->symmetric = (double *)malloc(total*sizeof(double));
+
+	// Evaluate the kernel at the representative pairs of each triple of orbits c1 <= c2 <= c3 (one
+	// in each direction), which is 1/P(P+1)(P+2)/6 of the work of computing the full table:
+	#pragma omp parallel for schedule(dynamic) private(c1,c2,c3,base)
+	for(c3=P-1;c3>=0;c3--)																			// the largest orbits have the most triples, so they are handed out first
+	{
+		for(c2=0;c2<=c3;c2++)
+		{
+			base = O->tet[c3] + O->tri[c2];
+			for(c1=0;c1<=c2;c1++)
+			{
+				if(variant == WEIGHTS_LINEAR)
+				{
+					table->symmetric[base + c1] = gHat3_linear(eta[O->rep_i[c1]], eta[O->rep_i[c2]], eta[O->rep_i[c3]],
+																eta[O->rep_l[c1]], eta[O->rep_l[c2]], eta[O->rep_l[c3]]);
+				}
+				else
+				{
+					table->symmetric[base + c1] = gHat3(eta[O->rep_i[c1]], eta[O->rep_i[c2]], eta[O->rep_i[c3]],
+														eta[O->rep_l[c1]], eta[O->rep_l[c2]], eta[O->rep_l[c3]], gamma);
+				}
+			}
+		}
+	}
+	t2 = MPI_Wtime();
+
+	if(myrank_mpi==0)
+	{
+		printf("Weight table %s (symmetric): %g MB (1/%.1f of the full table, %d orbits of index pairs) computed in %g seconds.\n",
+				table->name, total*sizeof(double)/1.e6, (double)size_ft*size_ft/total, P, t2 - t1);
+	}
+
+	return table->symmetric;
+}
+
+void SetupOperatorWeights(int gamma, double ***conv_weights, double ***conv_weights_linear)			// Function to build only the tables of weights used by the collision operator chosen for this run and point conv_weights & conv_weights_linear at them
+{
+	if((FloatWeights && ! CompareFloatWeights) || PackedWeights || SymmetricWeights)
+	{
+		return;																						// the quadrature sums only read the tables stored as floats (built by InitFloatWeights), packed (built by InitPackedWeights) or by orbit (built by InitSymmetricWeights)
+	}
+	*conv_weights = GetWeightTable(WEIGHTS_LANDAU, gamma);											// every operator path uses the gHat3 weights for the chosen gamma
+	if(FullandLinear)																				// only ComputeQ_FandL (and the FandL versions of RK4) use the linear weights
+	{
+		*conv_weights_linear = GetWeightTable(WEIGHTS_LINEAR, gamma);
+	}
+}
+
+void FreeWeightTables()																				// Function to delete (or unmap) all of the tables of weights that were built
+{
+	int variant;
+	WeightTable *table;
+
+	for(variant=0;variant<WEIGHT_TABLE_KINDS;variant++)
+	{
+		table = &weight_tables[variant];
+		if(table->rows_float != NULL)
+		{
+			free(table->block_float); free(table->rows_float);
+			table->rows_float = NULL;
+			table->block_float = NULL;
+		}
+		if(table->packed != NULL)
+		{
+			free(table->packed);
+			table->packed = NULL;
+		}
+		if(table->symmetric != NULL)
+		{
+			free(table->symmetric);
+			table->symmetric = NULL;
+		}
+		if(table->rows == NULL)
+		{
+			continue;
+		}
+		if(table->window != MPI_WIN_NULL)
+		{
+			MPI_Win_free(&table->window);															// release the block shared by the processes of the node
+		}
+		else if(table->block != NULL)
+		{
+			free(table->block);
+		}
+		else
+		{
+			DetachWeightStore(table->rows);															// release the mapping of the weight store
+		}
+		free(table->rows);
+		table->rows = NULL;
+		table->block = NULL;
+	}
+	free(packed_row_start);
+	packed_row_start = NULL;
+	if(orbits.pair_class != NULL)
+	{
+		free(orbits.pair_class); free(orbits.rep_i); free(orbits.rep_l); free(orbits.tet); free(orbits.tri);
+		orbits.pair_class = NULL;
+	}
+	if(node_comm != MPI_COMM_NULL)
+	{
+		MPI_Comm_free(&node_comm);
+	}
+}
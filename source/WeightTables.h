@@ -0,0 +1,60 @@
+/* This is the header file associated to WeightTables.cpp in which the prototypes for the
+ * functions contained in that file are declared.  Any other header files which must be linked to
+ * for the functions here are also included.
+ *
+ */
+
+//************************//
+//     INCLUDE GUARDS     //
+//************************//
+
+#ifndef WEIGHTTABLES_H_
+#define WEIGHTTABLES_H_
+
+//************************//
+//        INCLUDES        //
+//************************//
+
+#include "LP_ompi.h"																				// allows the libraries included, macros defined and external variables declared in LP_ompi.h to be used in the WeightTables functions
+#include "WeightStore.h"																			// allows the WEIGHTS_ kernel variants, AttachWeightStore & DetachWeightStore to be used
+#include "collisionRoutines_1.h"																	// allows generate_conv_weights & generate_conv_weights_linear to be used
+
+//************************//
+//         MACROS         //
+//************************//
+
+#define WEIGHT_TABLE_KINDS 2																		// number of kernel variants the registry can hold (WEIGHTS_LANDAU & WEIGHTS_LINEAR)
+#define PACKED_WEIGHT_ALIGN 64																		// alignment (in bytes) of the block holding a packed table, so that each stream starts on a cache line
+#define HUGE_PAGE_BYTES (2L*1024*1024)																// size of a transparent huge page, to which the block is aligned if PackedHugePages is true
+
+//************************//
+//  STRUCTURE DEFINITION  //
+//************************//
+
+struct WeightOrbits																					// the orbits of the pairs (i,l) of indices of xi & w in one direction, from which the orbit of a weight under the octahedral symmetry of the kernel is found
+{
+	int classes;																					// the number of orbits of the pairs, P (a pair (i,l) with i & l both non-zero shares its orbit with its reflection (N-i,N-l))
+	int *pair_class;																				// the orbit of each pair (i,l), at pair_class[l + N*i]
+	int *rep_i, *rep_l;																				// the pair (rep_i[c],rep_l[c]) chosen to represent each orbit c
+	long *tet, *tri;																				// tet[c] = c(c+1)(c+2)/6 & tri[c] = c(c+1)/2, so that the weight of the orbits c1 <= c2 <= c3 is at tet[c3] + tri[c2] + c1
+};
+
+//************************//
+//   FUNCTION PROTOTYPES  //
+//************************//
+
+double **GetWeightTable(int variant, int gamma);
+
+float **GetFloatWeightTable(int variant, int gamma);
+
+double *GetPackedWeightTable(int variant, int gamma, const long **row_start);
+
+const WeightOrbits *GetWeightOrbits();
+
+double *GetSymmetricWeightTable(int variant, int gamma);
+
+void SetupOperatorWeights(int gamma, double ***conv_weights, double ***conv_weights_linear);
+
+void FreeWeightTables();
+
+#endif /* WEIGHTTABLES_H_ */
@@ -3,7 +3,15 @@
  * moments or entropy, etc.
  *
  * Functions included: Gridv, Gridx, rho_x, rho, computePhi_x_0, computePhi, PrintPhiVals, computeC_rho, Int_Int_rho
- * Int_Int_rho1st, Int_E, Int_E1st, Int_E2nd, Int_fE, I1, I2, I3, I5, computeH, RK3
+ * Int_Int_rho1st, Int_E, Int_E1st, Int_E2nd, Int_fE, I1, I2, I3, I5, computeH, FillSlab, ExchangeGhostCells, RK3
+ *
+ * RK3 only keeps the cells of this process in each stage, with the size_v cells on either side of them as
+ * ghost cells, so I3_Normal reads the periodic images of the cells at the ends of the domain from there.
+ * This slab starts at the cell k0-size_v, so I1, I2, I3 & I5 find the coefficients of the cell k through
+ * SlabIndex, which subtracts slab_first.  U itself only holds the chunksize_dg cells of this process (so
+ * slab_first is k0 outside of RK3), which the last stage of RK3 updates in place.  The collision step
+ * fetches the cells of its space-steps from the processes which hold them (see ProcessGrid.cpp), and the
+ * moments & the output add up or collect the contributions of every process when they need them.
  *
  */
 
@@ -11,6 +19,7 @@
 
 double wt[5]={0.5688888888888889, 0.4786286704993665, 0.4786286704993665,0.2369268850561891, 0.2369268850561891};				// weights for Gaussian quadrature
 double vt[5]={0., -0.5384693101056831,0.5384693101056831,-0.9061798459386640,0.9061798459386640};								// node values for Gaussian quadrature over the interval [-1,1]
+int slab_first = 0;																						// the global index of the first cell held in the arrays read through SlabIndex (the first cell of this process in U, set by LP_ompi, or of the slab of RK3 while it works on it)
 
 double Gridv(double m){ //v in [-Lv,Lv]
 	return (-Lv+(m+0.5)*dv);
@@ -79,7 +88,7 @@ double I1(double *U, int k, int l) // Calculate the first inegtral in H_(i,j), n
   j1 = (j_mod-j3-j2*Nv)/(Nv*Nv);
   i = (k-j_mod)/size_v;
 
-  if(l==1) result = dv*dv*dv*( Gridv((double)j1)*U[k*6+0] + dv*U[k*6+2]/12. + U[k*6+5]*Gridv((double)j1)/4.);
+  if(l==1) result = dv*dv*dv*( Gridv((double)j1)*U[SlabIndex(k, 0)] + dv*U[SlabIndex(k, 2)]/12. + U[SlabIndex(k, 5)]*Gridv((double)j1)/4.);
   else result=0.;
   
   return result;
@@ -96,7 +105,7 @@ double I2(double *U, int k, int l) // Calculate the fourth integral in H_(i,j),
   i = (k-j)/size_v;
 
   if(l==2) result = Int_fE(U,i,j)/dv;
-  else if(l==5) result = U[k*6+2]*dv*dv*intE[i]/6.; 
+  else if(l==5) result = U[SlabIndex(k, 2)]*dv*dv*intE[i]/6.; 
   else result = 0.;
   
   return result;
@@ -235,12 +244,12 @@ double I3_Doping(double *U, int k, int l) 																	// Calculate the diff
 		{
 			for(int p = 0; p < 6; p++)
 			{
-				Ur[p] = U[6*kkr + p];
+				Ur[p] = U[SlabIndex(kkr, p)];
 			}
 		}
 		for(int p = 0; p < 6; p++)																			// as information is coming from the right here, the coefficients in Ul will always come from the current approximate solution U
 		{
-			Ul[p] = U[6*kkl + p];
+			Ul[p] = U[SlabIndex(kkl, p)];
 		}
 
 		ur = -Ur[1]; 																						// set ur to the negative of the coefficient of the basis function with shape l which is non-zero in the cell with global index kkr (which corresponds to the evaluation of gh^+ at the right boundary and -ve since v_1 < 0 in here)
@@ -259,12 +268,12 @@ double I3_Doping(double *U, int k, int l) 																	// Calculate the diff
 		{
 			for(int p = 0; p < 6; p++)
 			{
-				Ul[p] = U[6*kkl + p];
+				Ul[p] = U[SlabIndex(kkl, p)];
 			}
 		}
 		for(int p = 0; p < 6; p++)																			// as information is coming from the right here, the coefficients in Ul will always come from the current approximate solution U
 		{
-			Ur[p] = U[6*kkr + p];
+			Ur[p] = U[SlabIndex(kkr, p)];
 		}
 
 		ur = Ur[1]; 																						// set ur to the negative of the coefficient of the basis function with shape l which is non-zero in the cell with global index kkr (which corresponds to the evaluation of gh^+ at the right boundary and -ve since v_1 < 0 in here)
@@ -294,28 +303,26 @@ double I3_Normal(double *U, int k, int l) 																	// Calculate the diff
 	if(j1<Nv/2)																								// do this if j1 < Nv/2 (so that the velocity in the v1 direction is negative)
 	{
 		iir=i+1; iil=i; 																					// set iir to the value of i+1 and iil to the value of i (as here the flow of information is from right to left so that gh^+ must be used at the cell edges)
-		if(iir==Nx)iir=0; //periodic bc																		// if iir = Nx (the maximum value that can be obtained, since i = 0,1,...,Nx-1) and so this cell is at the right boundary, requiring information from the non-existent cell with space index Nx, since there are periodic boundary conditions, set iir = 0 and use the cell with space index 0 (i.e. the cell at the left boundary)
 		kkr=iir*size_v + j_mod; 																			// calculate the value of kkr for this value of iir
 		kkl=k;																								// set kkl to k (since iil = i)
-		ur = -U[kkr*6+1]; 																					// set ur to the negative of the coefficient of the basis function with shape l which is non-zero in the cell with global index kkr (which corresponds to the evaluation of gh^+ at the right boundary and -ve since v_1 < 0 in here)
-		ul = -U[kkl*6+1];																					// set ul to the negative of the coefficient of the basis function with shape l which is non-zero in the cell with global index kkl	(which corresponds to the evaluation of gh^+ at the left boundary and -ve since phi < 0 here)
+		ur = -U[SlabIndex(kkr, 1)]; 																			// set ur to the negative of the coefficient of the basis function with shape l which is non-zero in the cell with global index kkr (which corresponds to the evaluation of gh^+ at the right boundary and -ve since v_1 < 0 in here), which is a ghost cell of RK3 when i = Nx-1
+		ul = -U[SlabIndex(kkl, 1)];																			// set ul to the negative of the coefficient of the basis function with shape l which is non-zero in the cell with global index kkl	(which corresponds to the evaluation of gh^+ at the left boundary and -ve since phi < 0 here)
 	}
 	else																									// do this if j1 >= Nv/2 (so that the velocity in the v1 direction is non-negative)
 	{
 		iir=i; iil=i-1;																						// set iir to the value of i and iil to the value of i-1 (as here the flow of information is from left to right so that gh^- must be used at the cell edges)
-		if(iil==-1)iil=Nx-1; // periodic bc																	// if iil = -1 (the minimum value that can be obtained, since i = 0,1,...,Nx-1) and so this cell is at the left boundary, requiring information from the non-existent cell with space index -1, since there are periodic boundary conditions, set iil = Nx-1 and use the cell with space index Nx-1 (i.e. the cell at the right boundary)
 		kkr=k; 																								// set kkr to k (since iir = i)
-		kkl=iil*size_v + j_mod; 																			// calculate the value of kkl for this value of iil
-		ur = U[kkr*6+1];																					// set ur to the value of the coefficient of the basis function with shape l which is non-zero in the cell with global index kkr (which corresponds to the evaluation of gh^- at the right boundary and +ve since v_1 >= 0 in here)
-		ul = U[kkl*6+1];																					// set ul to the value of the coefficient of the basis function with shape l which is non-zero in the cell with global index kkl (which corresponds to the evalutaion of gh^- at the left boundary and +ve since v_r >= 0 in here)
+		kkl=iil*size_v + j_mod; 																	// calculate the value of kkl for this value of iil (a ghost cell of RK3 when i = 0)
+		ur = U[SlabIndex(kkr, 1)];																			// set ur to the value of the coefficient of the basis function with shape l which is non-zero in the cell with global index kkr (which corresponds to the evaluation of gh^- at the right boundary and +ve since v_1 >= 0 in here)
+		ul = U[SlabIndex(kkl, 1)];																			// set ul to the value of the coefficient of the basis function with shape l which is non-zero in the cell with global index kkl (which corresponds to the evalutaion of gh^- at the left boundary and +ve since v_r >= 0 in here)
 	}
   
-	if(l==0)result = dv*dv*dv*( (U[kkr*6+0]+0.5*ur - U[kkl*6+0]-0.5*ul)*Gridv((double)j1) + (U[kkr*6+2]-U[kkl*6+2])*dv/12. + (U[kkr*6+5]-U[kkl*6+5])*Gridv((double)j1)/4.);					// calculate \int_j v1*gh*phi dv at interface x=x_i+1/2 - \int_j v1*gh*phi dv at interface x=x_i-1/2 for the basis function with shape 0 (i.e. constant) which is non-zero in the cell with global index k
-	if(l==1)result = 0.5*dv*dv*dv*( (U[kkr*6+0]+0.5*ur + U[kkl*6+0]+0.5*ul)*Gridv((double)j1) + (U[kkr*6+2]+U[kkl*6+2])*dv/12. + (U[kkr*6+5]+U[kkl*6+5])*Gridv((double)j1)/4.);				// calculate \int_j v1*gh*phi dv at interface x=x_i+1/2 - \int_j v1*gh*phi dv at interface x=x_i-1/2 for the basis function with shape 1 (i.e. linear in x) which is non-zero in the cell with global index k
-	if(l==2)result = dv*dv*(( (U[kkr*6+0]-U[kkl*6+0])*dv*dv + (ur-ul)*0.5*dv*dv + (U[kkr*6+2]-U[kkl*6+2])*dv*Gridv((double)j1))/12. + (U[kkr*6+5]-U[kkl*6+5])*dv*dv*19./720.);				// calculate \int_j v1*gh*phi dv at interface x=x_i+1/2 - \int_j v1*gh*phi dv at interface x=x_i-1/2 for the basis function with shape 2 (i.e. linear in v_1) which is non-zero in the cell with global index k
-	if(l==3)result = (U[kkr*6+3]-U[kkl*6+3])*Gridv((double)j1)*dv*dv*dv/12.;																												// calculate \int_j v1*gh*phi dv at interface x=x_i+1/2 - \int_j v1*gh*phi dv at interface x=x_i-1/2 for the basis function with shape 3 (i.e. linear in v_2) which is non-zero in the cell with global index k
-	if(l==4)result = (U[kkr*6+4]-U[kkl*6+4])*Gridv((double)j1)*dv*dv*dv/12.;																												// calculate \int_j v1*gh*phi dv at interface x=x_i+1/2 - \int_j v1*gh*phi dv at interface x=x_i-1/2 for the basis function with shape 4 (i.e. linear in v_3) which is non-zero in the cell with global index k
-	if(l==5)result = dv*dv*dv*((U[kkr*6+0] + 0.5*ur - U[kkl*6+0]-0.5*ul)*Gridv((double)j1)/4. + (U[kkr*6+2]-U[kkl*6+2])*dv*19./720. + (U[kkr*6+5]-U[kkl*6+5])*Gridv((double)j1)*19./240.);	// calculate \int_j v1*gh*phi dv at interface x=x_i+1/2 - \int_j v1*gh*phi dv at interface x=x_i-1/2 for the basis function with shape 5 (i.e. modulus of v) which is non-zero in the cell with global index k
+	if(l==0)result = dv*dv*dv*( (U[SlabIndex(kkr, 0)]+0.5*ur - U[SlabIndex(kkl, 0)]-0.5*ul)*Gridv((double)j1) + (U[SlabIndex(kkr, 2)]-U[SlabIndex(kkl, 2)])*dv/12. + (U[SlabIndex(kkr, 5)]-U[SlabIndex(kkl, 5)])*Gridv((double)j1)/4.);	// calculate \int_j v1*gh*phi dv at interface x=x_i+1/2 - \int_j v1*gh*phi dv at interface x=x_i-1/2 for the basis function with shape 0 (i.e. constant) which is non-zero in the cell with global index k
+	if(l==1)result = 0.5*dv*dv*dv*( (U[SlabIndex(kkr, 0)]+0.5*ur + U[SlabIndex(kkl, 0)]+0.5*ul)*Gridv((double)j1) + (U[SlabIndex(kkr, 2)]+U[SlabIndex(kkl, 2)])*dv/12. + (U[SlabIndex(kkr, 5)]+U[SlabIndex(kkl, 5)])*Gridv((double)j1)/4.);	// calculate \int_j v1*gh*phi dv at interface x=x_i+1/2 - \int_j v1*gh*phi dv at interface x=x_i-1/2 for the basis function with shape 1 (i.e. linear in x) which is non-zero in the cell with global index k
+	if(l==2)result = dv*dv*(( (U[SlabIndex(kkr, 0)]-U[SlabIndex(kkl, 0)])*dv*dv + (ur-ul)*0.5*dv*dv + (U[SlabIndex(kkr, 2)]-U[SlabIndex(kkl, 2)])*dv*Gridv((double)j1))/12. + (U[SlabIndex(kkr, 5)]-U[SlabIndex(kkl, 5)])*dv*dv*19./720.);	// calculate \int_j v1*gh*phi dv at interface x=x_i+1/2 - \int_j v1*gh*phi dv at interface x=x_i-1/2 for the basis function with shape 2 (i.e. linear in v_1) which is non-zero in the cell with global index k
+	if(l==3)result = (U[SlabIndex(kkr, 3)]-U[SlabIndex(kkl, 3)])*Gridv((double)j1)*dv*dv*dv/12.;																							// calculate \int_j v1*gh*phi dv at interface x=x_i+1/2 - \int_j v1*gh*phi dv at interface x=x_i-1/2 for the basis function with shape 3 (i.e. linear in v_2) which is non-zero in the cell with global index k
+	if(l==4)result = (U[SlabIndex(kkr, 4)]-U[SlabIndex(kkl, 4)])*Gridv((double)j1)*dv*dv*dv/12.;																							// calculate \int_j v1*gh*phi dv at interface x=x_i+1/2 - \int_j v1*gh*phi dv at interface x=x_i-1/2 for the basis function with shape 4 (i.e. linear in v_3) which is non-zero in the cell with global index k
+	if(l==5)result = dv*dv*dv*((U[SlabIndex(kkr, 0)] + 0.5*ur - U[SlabIndex(kkl, 0)]-0.5*ul)*Gridv((double)j1)/4. + (U[SlabIndex(kkr, 2)]-U[SlabIndex(kkl, 2)])*dv*19./720. + (U[SlabIndex(kkr, 5)]-U[SlabIndex(kkl, 5)])*Gridv((double)j1)*19./240.);	// calculate \int_j v1*gh*phi dv at interface x=x_i+1/2 - \int_j v1*gh*phi dv at interface x=x_i-1/2 for the basis function with shape 5 (i.e. modulus of v) which is non-zero in the cell with global index k
 
 	return result;
 }
@@ -337,53 +344,53 @@ double I5(double *U, int k, int l) 	// Calculate the difference of the fifth and
 		j1r=j1+1;  j1l=j1;																			// set j1r to the value of j1+1 and j1l to the value of j1 (as here the the average flow of the field is from left to right so that gh^- must be used at the cell edges, as information flows against the field)
 		kkr=i*size_v + (j1r*Nv*Nv + j2*Nv + j3);													// calculate the value of kkr for this value of j1r
 		kkl=k; 																						// set kkl to k (since j1l = j1)
-		if(j1r<Nv)ur = -U[kkr*6+2];																	// if j1r is not Nv (so that this cell is not receiving information from the right boundary), set ur to the negative of the coefficient of the basis function with shape 2 which is non-zero in the cell with global index kkr (which corresponds to the evaluation of gh^- at the right boundary and -ve since the field is negative here?) - note that if the cell was receiving information from the right boundary then gh^- = 0 here so ur is not needed
-		ul = -U[kkl*6+2];																			// set ul to the negative of the coefficient of the basis function with shape 2 which is non-zero in the cell with global index kkl (which corresponds to the evaluation of gh^- at the right boundary and -ve since phi < 0 here)
+		if(j1r<Nv)ur = -U[SlabIndex(kkr, 2)];														// if j1r is not Nv (so that this cell is not receiving information from the right boundary), set ur to the negative of the coefficient of the basis function with shape 2 which is non-zero in the cell with global index kkr (which corresponds to the evaluation of gh^- at the right boundary and -ve since the field is negative here?) - note that if the cell was receiving information from the right boundary then gh^- = 0 here so ur is not needed
+		ul = -U[SlabIndex(kkl, 2)];																	// set ul to the negative of the coefficient of the basis function with shape 2 which is non-zero in the cell with global index kkl (which corresponds to the evaluation of gh^- at the right boundary and -ve since phi < 0 here)
 	}
 	else																							// do this if the average direction of the field E over the space cell i is non-positive
 	{
 		j1r=j1; j1l=j1-1;																			// set j1r to the value of j1 and j1l to the value of j1-1 (as here the the average flow of the field is from right to left so that gh^+ must be used at the cell edges, as information flows against the field)
 		kkr=k;																						// set kkr to k (since j1r = j1)
 		kkl=i*size_v + (j1l*Nv*Nv + j2*Nv + j3);													// calculate the value of kkl for this value of j1l
-		ur = U[kkr*6+2];																			// set ur to the the coefficient of the basis function with shape 2 which is non-zero in the cell with global index kkr (which corresponds to the evaluation of gh^+ at the left boundary and +ve since phi > 0 here)
-		if(j1l>-1)ul = U[kkl*6+2];																	// if j1l is not -1 (so that this cell is not receiving information from the left boundary), set ul to the coefficient of the basis function with shape 2 which is non-zero in the cell with global index kkl (which corresponds to the evaluation of gh^+ at the left boundary and +ve since phi < 0 here and being subtracted?) - note that if the cell was receiving information from the left boundary then gh^+ = 0 here so ul is not needed
+		ur = U[SlabIndex(kkr, 2)];																	// set ur to the the coefficient of the basis function with shape 2 which is non-zero in the cell with global index kkr (which corresponds to the evaluation of gh^+ at the left boundary and +ve since phi > 0 here)
+		if(j1l>-1)ul = U[SlabIndex(kkl, 2)];														// if j1l is not -1 (so that this cell is not receiving information from the left boundary), set ul to the coefficient of the basis function with shape 2 which is non-zero in the cell with global index kkl (which corresponds to the evaluation of gh^+ at the left boundary and +ve since phi < 0 here and being subtracted?) - note that if the cell was receiving information from the left boundary then gh^+ = 0 here so ul is not needed
 	}
 
 	if(l==0)																						// calculate \int_i E*f*phi dx at interface v1==v_j+1/2 - \int_i E*f*phi dx at interface v1==v_j-1/2 for the basis function with shape 0 (i.e. constant) which is non-zero in the cell with global index k
 	{
-		if(j1r<Nv && j1l>-1) result = dv*dv*(U[kkr*6+0] + 0.5*ur + U[kkr*6+5]*5./12.- U[kkl*6+0] - 0.5*ul - U[kkl*6+5]*5./12.)*intE[i] + dv*dv*(U[kkr*6+1]-U[kkl*6+1])*intE1[i];		// this is the value at an interior cell
-		else if(j1r<Nv)result =   dv*dv*(U[kkr*6+0] + 0.5*ur + U[kkr*6+5]*5./12.)*intE[i] + dv*dv*U[kkr*6+1]*intE1[i];																	// this is the value at the cell at the left boundary in v1 (so that the integral over the left edge is zero)
-		else if(j1l>-1)result = dv*dv*(- U[kkl*6+0] - 0.5*ul - U[kkl*6+5]*5./12.)*intE[i] - dv*dv*U[kkl*6+1]*intE1[i];																	// this is the value at the cell at the right boundary in v1 (so that the integral over the right edge is zero)
+		if(j1r<Nv && j1l>-1) result = dv*dv*(U[SlabIndex(kkr, 0)] + 0.5*ur + U[SlabIndex(kkr, 5)]*5./12.- U[SlabIndex(kkl, 0)] - 0.5*ul - U[SlabIndex(kkl, 5)]*5./12.)*intE[i] + dv*dv*(U[SlabIndex(kkr, 1)]-U[SlabIndex(kkl, 1)])*intE1[i];	// this is the value at an interior cell
+		else if(j1r<Nv)result =   dv*dv*(U[SlabIndex(kkr, 0)] + 0.5*ur + U[SlabIndex(kkr, 5)]*5./12.)*intE[i] + dv*dv*U[SlabIndex(kkr, 1)]*intE1[i];									// this is the value at the cell at the left boundary in v1 (so that the integral over the left edge is zero)
+		else if(j1l>-1)result = dv*dv*(- U[SlabIndex(kkl, 0)] - 0.5*ul - U[SlabIndex(kkl, 5)]*5./12.)*intE[i] - dv*dv*U[SlabIndex(kkl, 1)]*intE1[i];									// this is the value at the cell at the right boundary in v1 (so that the integral over the right edge is zero)
 	}
 	if(l==1)																						// calculate \int_i E*f*phi dx at interface v1==v_j+1/2 - \int_i E*f*phi dx at interface v1==v_j-1/2 for the basis function with shape 1 (i.e. linear in x) which is non-zero in the cell with global index k
 	{
-		if(j1r<Nv && j1l>-1) result = dv*dv*( (U[kkr*6+0] + 0.5*ur + U[kkr*6+5]*5./12. - U[kkl*6+0] - 0.5*ul - U[kkl*6+5]*5./12.)*intE1[i] + (U[kkr*6+1] - U[kkl*6+1])*intE2[i] );		// this is the value at an interior cell
-		else if(j1r<Nv)result=dv*dv*( (U[kkr*6+0] + 0.5*ur + U[kkr*6+5]*5./12.)*intE1[i] + U[kkr*6+1]*intE2[i] );																		// this is the value at the cell at the left boundary in v1 (so that the integral over the left edge is zero)
-		else if(j1l>-1)result=dv*dv*( (- U[kkl*6+0] - 0.5*ul - U[kkl*6+5]*5./12.)*intE1[i] - U[kkl*6+1]*intE2[i] );																		// this is the value at the cell at the right boundary in v1 (so that the integral over the right edge is zero)
+		if(j1r<Nv && j1l>-1) result = dv*dv*( (U[SlabIndex(kkr, 0)] + 0.5*ur + U[SlabIndex(kkr, 5)]*5./12. - U[SlabIndex(kkl, 0)] - 0.5*ul - U[SlabIndex(kkl, 5)]*5./12.)*intE1[i] + (U[SlabIndex(kkr, 1)] - U[SlabIndex(kkl, 1)])*intE2[i] );	// this is the value at an interior cell
+		else if(j1r<Nv)result=dv*dv*( (U[SlabIndex(kkr, 0)] + 0.5*ur + U[SlabIndex(kkr, 5)]*5./12.)*intE1[i] + U[SlabIndex(kkr, 1)]*intE2[i] );											// this is the value at the cell at the left boundary in v1 (so that the integral over the left edge is zero)
+		else if(j1l>-1)result=dv*dv*( (- U[SlabIndex(kkl, 0)] - 0.5*ul - U[SlabIndex(kkl, 5)]*5./12.)*intE1[i] - U[SlabIndex(kkl, 1)]*intE2[i] );										// this is the value at the cell at the right boundary in v1 (so that the integral over the right edge is zero)
 	}
 	if(l==2)																						// calculate \int_i E*f*phi dx at interface v1==v_j+1/2 - \int_i E*f*phi dx at interface v1==v_j-1/2 for the basis function with shape 2 (i.e. linear in v1) which is non-zero in the cell with global index k
 	{
-		if(j1r<Nv && j1l>-1)result = 0.5*(dv*dv*(U[kkr*6+0] + 0.5*ur + U[kkr*6+5]*5./12.+ U[kkl*6+0] + 0.5*ul + U[kkl*6+5]*5./12.)*intE[i] + dv*dv*(U[kkr*6+1]+U[kkl*6+1])*intE1[i]);	// this is the value at an interior cell
-		else if(j1r<Nv)result = 0.5*(dv*dv*(U[kkr*6+0] + 0.5*ur + U[kkr*6+5]*5./12.)*intE[i] + dv*dv*U[kkr*6+1]*intE1[i]);																// this is the value at the cell at the left boundary in v1 (so that the integral over the left edge is zero)
-		else if(j1l>-1)result = 0.5*(dv*dv*(U[kkl*6+0] + 0.5*ul + U[kkl*6+5]*5./12.)*intE[i] + dv*dv*U[kkl*6+1]*intE1[i]);    															// this is the value at the cell at the right boundary in v1 (so that the integral over the right edge is zero)
+		if(j1r<Nv && j1l>-1)result = 0.5*(dv*dv*(U[SlabIndex(kkr, 0)] + 0.5*ur + U[SlabIndex(kkr, 5)]*5./12.+ U[SlabIndex(kkl, 0)] + 0.5*ul + U[SlabIndex(kkl, 5)]*5./12.)*intE[i] + dv*dv*(U[SlabIndex(kkr, 1)]+U[SlabIndex(kkl, 1)])*intE1[i]);	// this is the value at an interior cell
+		else if(j1r<Nv)result = 0.5*(dv*dv*(U[SlabIndex(kkr, 0)] + 0.5*ur + U[SlabIndex(kkr, 5)]*5./12.)*intE[i] + dv*dv*U[SlabIndex(kkr, 1)]*intE1[i]);								// this is the value at the cell at the left boundary in v1 (so that the integral over the left edge is zero)
+		else if(j1l>-1)result = 0.5*(dv*dv*(U[SlabIndex(kkl, 0)] + 0.5*ul + U[SlabIndex(kkl, 5)]*5./12.)*intE[i] + dv*dv*U[SlabIndex(kkl, 1)]*intE1[i]);    															// this is the value at the cell at the right boundary in v1 (so that the integral over the right edge is zero)
 	}
 	if(l==3)																						// calculate \int_i E*f*phi dx at interface v1==v_j+1/2 - \int_i E*f*phi dx at interface v1==v_j-1/2 for the basis function with shape 3 (i.e. linear in v2) which is non-zero in the cell with global index k
 	{
-		if(j1r<Nv && j1l>-1)result = (U[kkr*6+3]-U[kkl*6+3])*intE[i]*dv*dv/12.;						// this is the value at an interior cell
-		else if(j1r<Nv)result = U[kkr*6+3]*intE[i]*dv*dv/12.;										// this is the value at the cell at the left boundary in v1 (so that the integral over the left edge is zero)
-		else if(j1l>-1)result = -U[kkl*6+3]*intE[i]*dv*dv/12.;										// this is the value at the cell at the right boundary in v1 (so that the integral over the right edge is zero)
+		if(j1r<Nv && j1l>-1)result = (U[SlabIndex(kkr, 3)]-U[SlabIndex(kkl, 3)])*intE[i]*dv*dv/12.;	// this is the value at an interior cell
+		else if(j1r<Nv)result = U[SlabIndex(kkr, 3)]*intE[i]*dv*dv/12.;								// this is the value at the cell at the left boundary in v1 (so that the integral over the left edge is zero)
+		else if(j1l>-1)result = -U[SlabIndex(kkl, 3)]*intE[i]*dv*dv/12.;							// this is the value at the cell at the right boundary in v1 (so that the integral over the right edge is zero)
 	}
 	if(l==4)																						// calculate \int_i E*f*phi dx at interface v1==v_j+1/2 - \int_i E*f*phi dx at interface v1==v_j-1/2 for the basis function with shape 4 (i.e. linear in v3) which is non-zero in the cell with global index k
 	{
-		if(j1r<Nv && j1l>-1)result = (U[kkr*6+4]-U[kkl*6+4])*intE[i]*dv*dv/12.;						// this is the value at an interior cell
-		else if(j1r<Nv)result=U[kkr*6+4]*intE[i]*dv*dv/12.;											// this is the value at the cell at the left boundary in v1 (so that the integral over the left edge is zero)
-		else if(j1l>-1)result=-U[kkl*6+4]*intE[i]*dv*dv/12.;										// this is the value at the cell at the right boundary in v1 (so that the integral over the right edge is zero)
+		if(j1r<Nv && j1l>-1)result = (U[SlabIndex(kkr, 4)]-U[SlabIndex(kkl, 4)])*intE[i]*dv*dv/12.;	// this is the value at an interior cell
+		else if(j1r<Nv)result=U[SlabIndex(kkr, 4)]*intE[i]*dv*dv/12.;								// this is the value at the cell at the left boundary in v1 (so that the integral over the left edge is zero)
+		else if(j1l>-1)result=-U[SlabIndex(kkl, 4)]*intE[i]*dv*dv/12.;								// this is the value at the cell at the right boundary in v1 (so that the integral over the right edge is zero)
 	}
 	if(l==5)																						// calculate \int_i E*f*phi dx at interface v1==v_j+1/2 - \int_i E*f*phi dx at interface v1==v_j-1/2 for the basis function with shape 5 (i.e. the modulus of v) which is non-zero in the cell with global index k
 	{
-		if(j1r<Nv && j1l>-1)result = dv*dv*( ((U[kkr*6+0] + 0.5*ur - U[kkl*6+0] - 0.5*ul)*5./12. + (U[kkr*6+5]- U[kkl*6+5])*133./720.)*intE[i] + (U[kkr*6+1] - U[kkl*6+1])*intE1[i]*5./12. ); //BUG: coefficient of U[k][5] was 11/48 insteadof 133/720		// this is the value at an interior cell
-		else if(j1r<Nv)result= dv*dv*( ((U[kkr*6+0] + 0.5*ur)*5./12. + U[kkr*6+5]*133./720.)*intE[i] + U[kkr*6+1]*intE1[i]*5./12. );													// this is the value at the cell at the left boundary in v1 (so that the integral over the left edge is zero)
-		else if(j1l>-1)result=-dv*dv*( ((U[kkl*6+0] + 0.5*ul)*5./12. + U[kkl*6+5]*133./720.)*intE[i] + U[kkl*6+1]*intE1[i]*5./12. );													// this is the value at the cell at the right boundary in v1 (so that the integral over the right edge is zero)
+		if(j1r<Nv && j1l>-1)result = dv*dv*( ((U[SlabIndex(kkr, 0)] + 0.5*ur - U[SlabIndex(kkl, 0)] - 0.5*ul)*5./12. + (U[SlabIndex(kkr, 5)]- U[SlabIndex(kkl, 5)])*133./720.)*intE[i] + (U[SlabIndex(kkr, 1)] - U[SlabIndex(kkl, 1)])*intE1[i]*5./12. ); //BUG: coefficient of U[k][5] was 11/48 insteadof 133/720	// this is the value at an interior cell
+		else if(j1r<Nv)result= dv*dv*( ((U[SlabIndex(kkr, 0)] + 0.5*ur)*5./12. + U[SlabIndex(kkr, 5)]*133./720.)*intE[i] + U[SlabIndex(kkr, 1)]*intE1[i]*5./12. );						// this is the value at the cell at the left boundary in v1 (so that the integral over the left edge is zero)
+		else if(j1l>-1)result=-dv*dv*( ((U[SlabIndex(kkl, 0)] + 0.5*ul)*5./12. + U[SlabIndex(kkl, 5)]*133./720.)*intE[i] + U[SlabIndex(kkl, 1)]*intE1[i]*5./12. );						// this is the value at the cell at the right boundary in v1 (so that the integral over the right edge is zero)
 	}
 
   	return result;
@@ -409,84 +416,83 @@ void computeH(double *H, double *U)// H_k(i,j)(f, E, phi_l)
 }
 */
 
-void RK3(double *U) // RK3 for f_t = H(f)
+void FillSlab(double *U_slab, double *U) // Copy the cells of this process from U into the slab U_slab, which holds the cells from slab_first onwards, and fill the size_v cells on either side of them (wrapping around periodically) from the processes which hold them
 {
-  int i, k, l, k_local;
-  double tp0, tp1, tp2, tp3, tp4, tp5, H[6];//, tp0, tp5, tmp1, tmp2, tmp3, tmp5;
- 
-  MPI_Status status;
-  
-  ce = computePhi_x_0(U); 
+  memcpy(&U_slab[SlabIndex(chunksize_dg*myrank_mpi, 0)], U, chunksize_dg*6*sizeof(double));
+  ExchangeGhostCells(U_slab);
+}
 
-  #pragma omp parallel for private(i) shared(U,cp, intE, intE1)
-  for(i=0;i<Nx;i++){
-    cp[i] = computeC_rho(U,i); intE[i] = Int_E(U,i); intE1[i] = Int_E1st(U,i); 
+void ExchangeGhostCells(double *U_slab) // Fill the ghost cells of the slab U_slab (the size_v cells on either side of the cells of this process, which I3 & I5 read) from the processes which hold them, the ends of the domain being periodic images of each other
+{
+  int r, side, v, v_end, g, owner, run;
+  vector<MPI_Request> requests;
+  MPI_Request request;
+
+  for(r=0;r<nprocs_mpi;r++){ // every process goes through the ghost cells of every process in the same order, so the messages between each pair of processes are matched up in order
+    for(side=0;side<2;side++){
+      v = (side == 0) ? chunksize_dg*r - size_v : chunksize_dg*(r+1);
+      v_end = v + size_v;
+      for(;v<v_end;v+=run){
+        g = (v + size)%size; // the cell of the domain that the ghost cell v is an image of
+        owner = g/chunksize_dg;
+        run = chunksize_dg*(owner+1) - g; // the ghost cells from v onwards which are held by the same process
+        if(run > v_end - v) run = v_end - v;
+        if(r == myrank_mpi && owner == myrank_mpi) memcpy(&U_slab[SlabIndex(v, 0)], &U_slab[SlabIndex(g, 0)], run*6*sizeof(double));
+        else if(r == myrank_mpi){
+          MPI_Irecv(&U_slab[SlabIndex(v, 0)], run*6, MPI_DOUBLE, owner, 0, MPI_COMM_WORLD, &request);
+          requests.push_back(request);
+        }
+        else if(owner == myrank_mpi){
+          MPI_Isend(&U_slab[SlabIndex(g, 0)], run*6, MPI_DOUBLE, r, 0, MPI_COMM_WORLD, &request);
+          requests.push_back(request);
+        }
+      }
+    }
   }
+  if(!requests.empty()) MPI_Waitall(requests.size(), &requests[0], MPI_STATUSES_IGNORE);
+}
+
+void RK3(double *U) // RK3 for f_t = H(f)
+{
+  int k, k_local, l;
+  int k0 = chunksize_dg*myrank_mpi, k1 = chunksize_dg*(myrank_mpi+1);
+  double tp0, tp1, tp2, tp3, tp4, tp5, H[6];
+  double *charge = (double*)malloc(2*Nx*sizeof(double));
   
-  #pragma omp parallel for private(i) shared(intE2)
-  for(i=0;i<Nx;i++){
-    intE2[i] = Int_E2nd(U,i); // BUG: Int_E2nd() require knowldege of cp 
-  }
-  /*
-  for(i=0;i<Nx;i++)
-  {
-	  printf("intE[%d] = %g, intE1[%d] = %g, intE2[%d] = %g. \n", i, intE[i], i, intE1[i], i, intE2[i]);
-  }
-   */
-  #pragma omp parallel for schedule(dynamic)  private(H,k, k_local, l, tp0, tp1, tp2, tp3, tp4, tp5) shared(U, Utmp)
-  for(k=chunksize_dg*myrank_mpi;k<chunksize_dg*(myrank_mpi+1);k++){ 
+  slab_first = k0 - size_v; // U1 only holds the cells k0-size_v,...,k1+size_v-1 of each stage, so I1, I2, I3, I5 & ChargeSums read it through SlabIndex
+  FillSlab(U1, U);
+
+  ChargeSums(U1, k0, k1, charge); // the field only depends on two sums of U in each space cell, so these are added up over all of the processes
+  MPI_Allreduce(MPI_IN_PLACE, charge, 2*Nx, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+  FieldIntegralsFromCharge(charge);
+
+  #pragma omp parallel for schedule(dynamic)  private(H,k, k_local, l, tp0, tp1, tp2, tp3, tp4, tp5) shared(U, U1, Utmp)
+  for(k=k0;k<k1;k++){ 
     k_local = k%chunksize_dg;
     
-    tp0=I1(U,k,0)-I2(U,k,0)-I3(U,k,0)+I5(U,k,0);
-    tp1=I1(U,k,1)-I2(U,k,1)-I3(U,k,1)+I5(U,k,1);
-    tp2=I1(U,k,2)-I2(U,k,2)-I3(U,k,2)+I5(U,k,2);
-    tp3=I1(U,k,3)-I2(U,k,3)-I3(U,k,3)+I5(U,k,3);
-    tp4=I1(U,k,4)-I2(U,k,4)-I3(U,k,4)+I5(U,k,4);
-    tp5=I1(U,k,5)-I2(U,k,5)-I3(U,k,5)+I5(U,k,5);
-
-    //H[k_local][0] = (19*tp[0]/4. - 15*tp[5])/dx/scalev;
-    //H[k_local][5] = (60*tp[5] - 15*tp[0])/dx/scalev;	
+    tp0=I1(U1,k,0)-I2(U1,k,0)-I3(U1,k,0)+I5(U1,k,0);
+    tp1=I1(U1,k,1)-I2(U1,k,1)-I3(U1,k,1)+I5(U1,k,1);
+    tp2=I1(U1,k,2)-I2(U1,k,2)-I3(U1,k,2)+I5(U1,k,2);
+    tp3=I1(U1,k,3)-I2(U1,k,3)-I3(U1,k,3)+I5(U1,k,3);
+    tp4=I1(U1,k,4)-I2(U1,k,4)-I3(U1,k,4)+I5(U1,k,4);
+    tp5=I1(U1,k,5)-I2(U1,k,5)-I3(U1,k,5)+I5(U1,k,5);
+
     H[0] = (19*tp0/4. - 15*tp5)/dx/scalev;
     H[5] = (60*tp5 - 15*tp0)/dx/scalev;	
-    //for(l=1;l<5;l++)H[l] = tp[l]*12./dx/scalev;;//H[k_local][l] = tp[l]*12./dx/scalev;
     H[1] = tp1*12./dx/scalev; H[2] = tp2*12./dx/scalev; H[3] = tp3*12./dx/scalev; H[4] = tp4*12./dx/scalev;
     
-    for(l=0;l<6;l++) Utmp[k_local*6+l] = U[k*6+l] + dt*H[l];	
+    for(l=0;l<6;l++) Utmp[k_local*6+l] = U[k_local*6+l] + dt*H[l];	
   }    
-  if(myrank_mpi == 0) {
-    //dump the weights we've computed into U1
-    for(k=0;k<chunksize_dg;k++) {
-	for(l=0;l<6;l++) U1[k*6+l] = Utmp[k*6+l];	
-    } 
-    //receive from all other processes
-    for(i=1;i<nprocs_mpi;i++) {
-	    MPI_Recv(output_buffer_vp, chunksize_dg*6, MPI_DOUBLE, i, i, MPI_COMM_WORLD, &status); // receive weight from other processes consecutively, rank i=1..numNodes-1, ensuring the weights are stored in the file consecutively !
-	    for(k=0;k<chunksize_dg;k++) {
-			for(l=0;l<6;l++)U1[(k + i*chunksize_dg)*6+l] = output_buffer_vp[k*6+l];
-		}			
-    }
-  }
-  else  MPI_Send(Utmp, chunksize_dg*6, MPI_DOUBLE, 0, myrank_mpi, MPI_COMM_WORLD);
-  
-  
-  MPI_Bcast(U1, size*6, MPI_DOUBLE, 0, MPI_COMM_WORLD);    
-  MPI_Barrier(MPI_COMM_WORLD);
+  memcpy(&U1[SlabIndex(k0, 0)], Utmp, chunksize_dg*6*sizeof(double));
+  ExchangeGhostCells(U1);
   /////////////////// 1st step of RK3 done//////////////////////////////////////////////////////// 
     
-  ce = computePhi_x_0(U1); 
-
-  #pragma omp parallel for private(i) shared(U1,cp, intE, intE1)
-  for(i=0;i<Nx;i++){
-    cp[i] = computeC_rho(U1,i); intE[i] = Int_E(U1,i); intE1[i] = Int_E1st(U1,i); 
-  }
+  ChargeSums(U1, k0, k1, charge);
+  MPI_Allreduce(MPI_IN_PLACE, charge, 2*Nx, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+  FieldIntegralsFromCharge(charge);
   
-  #pragma omp parallel for private(i) shared(U1,intE2)
-  for(i=0;i<Nx;i++){
-    intE2[i] = Int_E2nd(U1,i); // BUG: Int_E2nd() require knowldege of cp 
-  }
-  
-  #pragma omp parallel for schedule(dynamic) private(H, k, k_local, l, tp0, tp1, tp2, tp3, tp4, tp5)  shared(U,Utmp)
-  for(k=chunksize_dg*myrank_mpi;k<chunksize_dg*(myrank_mpi+1);k++){      
+  #pragma omp parallel for schedule(dynamic) private(H, k, k_local, l, tp0, tp1, tp2, tp3, tp4, tp5)  shared(U, U1, Utmp)
+  for(k=k0;k<k1;k++){      
     k_local = k%chunksize_dg;
     
     tp0=I1(U1,k,0)-I2(U1,k,0)-I3(U1,k,0)+I5(U1,k,0);
@@ -496,49 +502,22 @@ void RK3(double *U) // RK3 for f_t = H(f)
     tp4=I1(U1,k,4)-I2(U1,k,4)-I3(U1,k,4)+I5(U1,k,4);
     tp5=I1(U1,k,5)-I2(U1,k,5)-I3(U1,k,5)+I5(U1,k,5);
 
-    //H[k_local][0] = (19*tp[0]/4. - 15*tp[5])/dx/scalev;
-    //H[k_local][5] = (60*tp[5] - 15*tp[0])/dx/scalev;	
     H[0] = (19*tp0/4. - 15*tp5)/dx/scalev;
     H[5] = (60*tp5 - 15*tp0)/dx/scalev;	
-    //for(l=1;l<5;l++)H[l] = tp[l]*12./dx/scalev;;//H[k_local][l] = tp[l]*12./dx/scalev;
     H[1] = tp1*12./dx/scalev; H[2] = tp2*12./dx/scalev; H[3] = tp3*12./dx/scalev; H[4] = tp4*12./dx/scalev;
     
-    for(l=0;l<6;l++) Utmp[k_local*6+l] = 0.75*U[k*6+l] + 0.25*U1[k*6+l] + 0.25*dt*H[l];
+    for(l=0;l<6;l++) Utmp[k_local*6+l] = 0.75*U[k_local*6+l] + 0.25*U1[SlabIndex(k, l)] + 0.25*dt*H[l];
   }    
-  if(myrank_mpi == 0) {
-    //dump the weights we've computed into U1
-    for(k=0;k<chunksize_dg;k++) {
-	      for(l=0;l<6;l++) U1[k*6+l] = Utmp[k*6+l];	
-    } 
-    //receive from all other processes
-    for(i=1;i<nprocs_mpi;i++) {      
-		MPI_Recv(output_buffer_vp, chunksize_dg*6, MPI_DOUBLE, i, i, MPI_COMM_WORLD, &status); // receive weight from other processes consecutively, rank i=1..numNodes-1, ensuring the weights are stored in the file consecutively !
-		for(k=0;k<chunksize_dg;k++) {
-			for(l=0;l<6;l++)U1[(k + i*chunksize_dg)*6+l] = output_buffer_vp[k*6+l];
-        }
-    }
-  }
-  else MPI_Send(Utmp, chunksize_dg*6, MPI_DOUBLE, 0, myrank_mpi, MPI_COMM_WORLD);
-  
-  
-  MPI_Bcast(U1, size*+6, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-  MPI_Barrier(MPI_COMM_WORLD);
+  memcpy(&U1[SlabIndex(k0, 0)], Utmp, chunksize_dg*6*sizeof(double));
+  ExchangeGhostCells(U1);
   /////////////////// 2nd step of RK3 done//////////////////////////////////////////////////////// 
    
-ce = computePhi_x_0(U1); 
-
-  #pragma omp parallel for private(i) shared(U1,cp, intE, intE1)
-  for(i=0;i<Nx;i++){
-    cp[i] = computeC_rho(U1,i); intE[i] = Int_E(U1,i); intE1[i] = Int_E1st(U1,i); 
-  }
-  
-  #pragma omp parallel for private(i) shared(U1,intE2)
-  for(i=0;i<Nx;i++){
-    intE2[i] = Int_E2nd(U1,i); // BUG: Int_E2nd() require knowldege of cp 
-  }
+  ChargeSums(U1, k0, k1, charge);
+  MPI_Allreduce(MPI_IN_PLACE, charge, 2*Nx, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+  FieldIntegralsFromCharge(charge);
   
-  #pragma omp parallel for schedule(dynamic) private(H, k, k_local, l, tp0, tp1, tp2, tp3, tp4, tp5)  shared(U,Utmp)
-  for(k=chunksize_dg*myrank_mpi;k<chunksize_dg*(myrank_mpi+1);k++){      
+  #pragma omp parallel for schedule(dynamic) private(H, k, k_local, l, tp0, tp1, tp2, tp3, tp4, tp5)  shared(U, U1)
+  for(k=k0;k<k1;k++){      
     k_local = k%chunksize_dg;
   
     tp0=I1(U1,k,0)-I2(U1,k,0)-I3(U1,k,0)+I5(U1,k,0);
@@ -550,27 +529,12 @@ ce = computePhi_x_0(U1);
 
     H[0] = (19*tp0/4. - 15*tp5)/dx/scalev;
     H[5] = (60*tp5 - 15*tp0)/dx/scalev;	
-    //for(l=1;l<5;l++)H[l] = tp[l]*12./dx/scalev;;//H[k_local][l] = tp[l]*12./dx/scalev;
     H[1] = tp1*12./dx/scalev; H[2] = tp2*12./dx/scalev; H[3] = tp3*12./dx/scalev; H[4] = tp4*12./dx/scalev;	
 
-    for(l=0;l<6;l++) Utmp[k_local*6+l] = U[k*6+l]/3. + U1[k*6+l]*2./3. + dt*H[l]*2./3.;
+    for(l=0;l<6;l++) U[k_local*6+l] = U[k_local*6+l]/3. + U1[SlabIndex(k, l)]*2./3. + dt*H[l]*2./3.; // each cell only reads its own coefficients of U, so the last stage is written straight into U
   }    
-  if(myrank_mpi == 0) {
-    //dump the weights we've computed into U1
-    for(k=0;k<chunksize_dg;k++) {
-	      for(l=0;l<6;l++) U[k*6+l] = Utmp[k*6+l];	
-    } 
-    //receive from all other processes
-    for(i=1;i<nprocs_mpi;i++) {      
-	    MPI_Recv(output_buffer_vp, chunksize_dg*6, MPI_DOUBLE, i, i, MPI_COMM_WORLD, &status); // receive weight from other processes consecutively, rank i=1..numNodes-1, ensuring the weights are stored in the file consecutively !
-	    for(k=0;k<chunksize_dg;k++) {
-		  for(l=0;l<6;l++)U[(k + i*chunksize_dg)*6+l] = output_buffer_vp[k*6+l];
-        } 
-    }
-  }
-  else MPI_Send(Utmp, chunksize_dg*6, MPI_DOUBLE, 0, myrank_mpi, MPI_COMM_WORLD);
-  
-  MPI_Bcast(U, size*6, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-  MPI_Barrier(MPI_COMM_WORLD); 
+  slab_first = k0;
   /////////////////// 3rd step of RK3 done//////////////////////////////////////////////////////// 
+
+  free(charge);
 }
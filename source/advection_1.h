@@ -26,6 +26,7 @@
 
 extern double wt[5];																					// weights for Gaussian quadrature
 extern double vt[5];																					// node values for Gaussian quadrature over the interval [-1,1]
+extern int slab_first;																					// the global index of the first cell held in the arrays read through SlabIndex (k0-size_v in the slab of RK3, k0 = chunksize_dg*myrank_mpi in U)
 
 //************************//
 //   FUNCTION PROTOTYPES  //
@@ -37,6 +38,16 @@ double Gridx(double m);
 
 void DirichletBC(vector<double>& Ub_vals, int i, int j1, int j2, int j3);
 
+static inline long SlabIndex(int k, int l)															// Function to find the index of the coefficient l of the cell with global index k in an array which holds the cells from slab_first onwards
+{
+	return (long)(k - slab_first)*6 + l;
+}
+
+static inline bool HoldsCell(int k)																	// Function to check if the cell with global index k is one of the chunksize_dg cells of this process held in U
+{
+	return k >= chunksize_dg*myrank_mpi && k < chunksize_dg*(myrank_mpi+1);
+}
+
 double I1(double *U, int k, int l);
 
 double I2(double *U, int k, int l);
@@ -53,6 +64,10 @@ double I5(double *U, int k, int l);
 
 void computeH(double *U);
 
+void FillSlab(double *U_slab, double *U);
+
+void ExchangeGhostCells(double *U_slab);
+
 void RK3(double *U);
 
 #endif /* ADVECTION_1_H_ */
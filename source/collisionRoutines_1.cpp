@@ -1,8 +1,9 @@
 /* This is the source file which contains the subroutines necessary for solving the space homogeneous,
  * collision problem resulting from time-splitting, including FFT routines.
  *
- * Functions included: S1hat, S233hat, S213hat, gHat3, gHat3_linear, generate_conv_weights,
- * generate_conv_weights_linear, fft3D, ifft3D, FS, ComputeQ, IntModes, ProjectedNodeValue, RK4
+ * Functions included: S1hat, S233hat, S213hat, ShatTensor, gHat3, gHat3_linear, TabulateShat,
+ * WeightRowsFromShat, generate_conv_weights, generate_conv_weights_linear, InitFFTShifts, FreeFFTShifts, FFTThreads, PlanFFTs, fft3D, ifft3D, FS, ComputeQ,
+ * PlanBatchedFFTs, FreeBatchedFFTs, fft3D_Batched, FS_Batched, IntModes, ProjectedNodeValue, RK4, RK4_Inhomo_Update, RK4_Inhomo_Apply
  *
  */
 
@@ -12,6 +13,13 @@ extern fftw_plan p_forward;
 extern fftw_plan p_backward; 
 extern fftw_complex *temp;
 
+static double *fft_pre, *ifft_post;																	// declare pointers to the real 1-D factors which shift the 'v' terms of the FFTs in fft3D, ifft3D & FS to our v domain (tabulated by InitFFTShifts)
+static fftw_complex *fft_post, *ifft_pre, *FS_pre;													// declare pointers to the complex 1-D factors which shift the 'eta' terms of the FFTs in fft3D, ifft3D & FS to our eta domain (tabulated by InitFFTShifts)
+static fftw_complex *temp_cells;																		// declare a pointer to temp_cells (the grids of the space-steps of a batch, each laid out as in temp, for the batched FFTs)
+static fftw_plan p_forward_cells, p_backward_cells;												// declare the fftw plans of the batched r2c & c2r FFTs (set by PlanBatchedFFTs)
+static int cells_threads = 1;																		// declare cells_threads (the number of threads used for the batched FFTs & the shifts around them, set by PlanBatchedFFTs)
+static int cells_planned = 0;																		// declare cells_planned (the number of space-steps the batched FFTs are planned for, set by PlanBatchedFFTs)
+
 double IntM[10];																					// declare an array IntM to hold 10 double variables
 #pragma omp threadprivate(IntM)																		// start the OpenMP parallel construct to start the threads which will run in parallel, passing IntM to each thread as private variables which will have their contents deleted when the threads finish (doesn't seem to be doing anything since no {} afterwards???)
 
@@ -95,14 +103,8 @@ double S213hat_hardspheres(double ki1, double ki2, double ki3)
 	else return sqrt(2./PI)*ki1*ki3*((Rr*Rr*(24. - Rr*Rr) - 48.)*cos_Rr + (7.*Rr*Rr - 48.)*Rr*sin_Rr + 48.)/(pow(r,8.));
 }
 
-double gHat3(double eta1, double eta2, double eta3, double ki1, double ki2, double ki3, int gamma)
+void ShatTensor(double ki1, double ki2, double ki3, int gamma, double Shat[3][3])
 {
-	double result = 0.;
-	double ki[3]={ki1,ki2,ki3}, zeta[3]={eta1,eta2,eta3}; // ki=w, zeta=xi in the notes
-	double Shat[3][3];
-	double r=sqrt(ki1*ki1+ki2*ki2+ki3*ki3);
-	int i,j;
-	
 	if(gamma==-3)
 	{
 		Shat[0][0]=S1hat(ki1,ki2,ki3)-S233hat(ki2,ki3,ki1);
@@ -133,6 +135,17 @@ double gHat3(double eta1, double eta2, double eta3, double ki1, double ki2, doub
 		Shat[1][2]=-S213hat_hardspheres(ki2,ki1,ki3);
 		Shat[1][0]=Shat[0][1]; Shat[2][0]=Shat[0][2]; Shat[2][1]=Shat[1][2];
 	}
+}
+
+double gHat3(double eta1, double eta2, double eta3, double ki1, double ki2, double ki3, int gamma)
+{
+	double result = 0.;
+	double ki[3]={ki1,ki2,ki3}, zeta[3]={eta1,eta2,eta3};											// ki=w, zeta=xi in the notes
+	double Shat[3][3];
+	double r=sqrt(ki1*ki1+ki2*ki2+ki3*ki3);
+	int i,j;
+	
+	ShatTensor(ki1, ki2, ki3, gamma, Shat);
 
 	if(gamma==-3)
 	{
@@ -160,52 +173,16 @@ double gHat3(double eta1, double eta2, double eta3, double ki1, double ki2, doub
 	return result;
 }
 
-double gHat3_2( double eta1, double eta2, double eta3, double ki1, double ki2, double ki3, int id)
-{
-	double result1 = 0., result2=0.;
-	double ki[3]={ki1,ki2,ki3}, zeta[3]={eta1,eta2,eta3};// corresponding to the notes, ki=w, eta=xi
-	double Shat[3][3];
-	double r=sqrt(ki1*ki1+ki2*ki2+ki3*ki3);
-	double eta_ki=ki1*eta1+ki2*eta2+ki3*eta3;
-	int i,j;
-
-	Shat[0][0]=S1hat(ki1,ki2,ki3)-S233hat(ki2,ki3,ki1);
-	Shat[1][1]=S1hat(ki1,ki2,ki3)-S233hat(ki1,ki3,ki2);
-	Shat[2][2]=S1hat(ki1,ki2,ki3)-S233hat(ki1,ki2,ki3);
-	Shat[0][1]=-S213hat(ki1,ki3,ki2);
-	Shat[0][2]=-S213hat(ki1,ki2,ki3);
-	Shat[1][2]=-S213hat(ki2,ki1,ki3);
-	Shat[1][0]=Shat[0][1]; Shat[2][0]=Shat[0][2]; Shat[2][1]=Shat[1][2];
-
-	for(i=0;i<3;i++){
-	  for(j=0;j<3;j++){
-	    result2 += Shat[i][j]*zeta[j]*zeta[i];
-	  }
-	}
-	if(r==0.)result1 = 0.;
-	else result1 = sqrt(8./PI)*eta_ki*(R_v*r-sin(R_v*r))/(R_v*r*r*r);
-
-	if(id==0) return result1;
-	else return -result2;
-
-}
-
 double gHat3_linear(double eta1, double eta2, double eta3, double ki1, double ki2, double ki3 ) 
 {
 	double result = 0.;
-	double ki[3]={ki1,ki2,ki3}, zeta[3]={eta1,eta2,eta3}; // ki=w, zeta=xi in the notes
+	double ki[3]={ki1,ki2,ki3}, zeta[3]={eta1,eta2,eta3};											// ki=w, zeta=xi in the notes
 	double Shat[3][3];
 	double r=sqrt(ki1*ki1+ki2*ki2+ki3*ki3);
 	//double darg[3][2];
 	int i,j;
 
-	Shat[0][0]=S1hat(ki1,ki2,ki3)-S233hat(ki2,ki3,ki1);
-	Shat[1][1]=S1hat(ki1,ki2,ki3)-S233hat(ki1,ki3,ki2);
-	Shat[2][2]=S1hat(ki1,ki2,ki3)-S233hat(ki1,ki2,ki3);
-	Shat[0][1]=-S213hat(ki1,ki3,ki2);
-	Shat[0][2]=-S213hat(ki1,ki2,ki3);
-	Shat[1][2]=-S213hat(ki2,ki1,ki3);
-	Shat[1][0]=Shat[0][1]; Shat[2][0]=Shat[0][2]; Shat[2][1]=Shat[1][2];
+	ShatTensor(ki1, ki2, ki3, -3, Shat);															// the linear kernel always uses the Coulomb (gamma = -3) tensor
 
 	for(i=0;i<3;i++){
 	  for(j=0;j<3;j++){
@@ -217,184 +194,417 @@ double gHat3_linear(double eta1, double eta2, double eta3, double ki1, double ki
   	return result;	
 }
 
-void generate_conv_weights(double **conv_weights, int gamma)
+/*
+function TabulateShat
+---------------------
+Tabulates the 3x3 tensor S-hat(w) (row by row, at Shat_w[9*kw]) for each of the size_ft nodes w, and
+if Aiso_w is not NULL the isotropic term sqrt(8/pi)(R_v|w| - sin(R_v|w|))/(R_v|w|) of gHat3 for
+gamma = -3 (0 at w = 0).  S-hat only depends on w, so tabulating it once takes the trig & pow out of
+the N^6 evaluations of the weights, which only need a quadratic form in xi for each w.
+*/
+void TabulateShat(int gamma, double *Shat_w, double *Aiso_w)
 {
-  int i, j, k, l, m, n;
-   #pragma omp parallel for private(i,j,k,l,m,n) shared(conv_weights)
-  for(i=0;i<N;i++){
-    for(j=0;j<N;j++){
-      for(k=0;k<N;k++){ 
-	for(l=0;l<N;l++){
-	  for(m=0;m<N;m++){
-	    for(n=0;n<N;n++) {
-	     conv_weights[k + N*(j + N*i)][n + N*(m + N*l)] = gHat3(eta[i], eta[j], eta[k], eta[l], eta[m], eta[n], gamma); // in the notes, correspondingly, (i,j,k)-kxi, (l,m,n)-w
-	    }
-	  }
-	}
-      }
+  int kw, l, m, n;
+  double r, Shat[3][3];
+
+  #pragma omp parallel for private(kw,l,m,n,r,Shat) shared(Shat_w, Aiso_w)
+  for(kw=0;kw<size_ft;kw++)
+  {
+    l = kw/(N*N); m = (kw/N)%N; n = kw%N;															// (l,m,n) are the indices of w, with kw = n + N*(m + N*l)
+    ShatTensor(eta[l], eta[m], eta[n], gamma, Shat);
+    memcpy(&Shat_w[9*kw], Shat, 9*sizeof(double));
+    if(Aiso_w != NULL)
+    {
+      r = sqrt(eta[l]*eta[l] + eta[m]*eta[m] + eta[n]*eta[n]);
+      if(r==0.) Aiso_w[kw] = 0.;
+      else Aiso_w[kw] = (sqrt(8./PI))*(R_v*r-sin(R_v*r))/(R_v*r);
     }
   }
 }
 
-void generate_conv_weights2(double **conv_weights, int id)
+/*
+function WeightRowsFromShat
+---------------------------
+Fills rows[ki - ki_start][kw] with gHat3(xi, w) (or gHat3_linear(xi, w) if linear is true) for
+ki_start <= ki < ki_end and every w, from the tables built by TabulateShat.  Each weight is rebuilt by
+TabulatedWeight, as in the matrix-free engine, so the weights are the same to the last bit.
+*/
+void WeightRowsFromShat(double **rows, int ki_start, int ki_end, const double *Shat_w, const double *Aiso_w, int gamma, bool linear)
 {
-  int i, j, k, l, m, n;
-
-   #pragma omp parallel for  private(i,j,k,l,m,n) shared(conv_weights)
-  for(i=0;i<N;i++){
-    for(j=0;j<N;j++){
-      for(k=0;k<N;k++){
-	for(l=0;l<N;l++){
-	  for(m=0;m<N;m++){
-	    for(n=0;n<N;n++) {
-	      conv_weights[k + N*(j + N*i)][n + N*(m + N*l)] =gHat3_2(eta[i], eta[j], eta[k], eta[l], eta[m], eta[n], id);
-	    }
-	  }
-	}
-      }
+  int ki, kw;
+  double zeta[3], w[3];
+
+  #pragma omp parallel for private(ki,kw,zeta,w) shared(rows)
+  for(ki=ki_start;ki<ki_end;ki++)
+  {
+    zeta[0] = eta[ki/(N*N)]; zeta[1] = eta[(ki/N)%N]; zeta[2] = eta[ki%N];							// in the notes, correspondingly, (i,j,k)-kxi, (l,m,n)-w
+    for(kw=0;kw<size_ft;kw++)
+    {
+      w[0] = eta[kw/(N*N)]; w[1] = eta[(kw/N)%N]; w[2] = eta[kw%N];
+      rows[ki-ki_start][kw] = TabulatedWeight(zeta, w, &Shat_w[9*kw], (Aiso_w != NULL) ? Aiso_w[kw] : 0., gamma, linear);	// Aiso_w is only read for gamma = -3 (it is NULL for the linear kernel)
     }
   }
 }
 
+void generate_conv_weights(double **conv_weights, int gamma)
+{
+  double *Shat_w = (double *)malloc(9*size_ft*sizeof(double));										// S-hat(w) & the isotropic term of gHat3 are tabulated once for each w
+  double *Aiso_w = (double *)malloc(size_ft*sizeof(double));
+
+  TabulateShat(gamma, Shat_w, Aiso_w);
+  WeightRowsFromShat(conv_weights, 0, size_ft, Shat_w, Aiso_w, gamma, false);
+
+  free(Shat_w); free(Aiso_w);
+}
+
 void generate_conv_weights_linear(double **conv_weights_linear)
 {
-  int i, j, k, l, m, n;
-   #pragma omp parallel for private(i,j,k,l,m,n) shared(conv_weights_linear)
-  for(i=0;i<N;i++){
-    for(j=0;j<N;j++){
-      for(k=0;k<N;k++){ 
-	for(l=0;l<N;l++){
-	  for(m=0;m<N;m++){
-	    for(n=0;n<N;n++) {
-	     conv_weights_linear[k + N*(j + N*i)][n + N*(m + N*l)] = gHat3_linear(eta[i], eta[j], eta[k], eta[l], eta[m], eta[n]); // in the notes, correspondingly, (i,j,k)-kxi, (l,m,n)-w	      	      
-	    }
-	  }
-	}
+  double *Shat_w = (double *)malloc(9*size_ft*sizeof(double));										// the linear kernel always uses the Coulomb (gamma = -3) tensor, tabulated once for each w
+
+  TabulateShat(-3, Shat_w, NULL);
+  WeightRowsFromShat(conv_weights_linear, 0, size_ft, Shat_w, NULL, -3, true);
+
+  free(Shat_w);
+}
+//#endif
+/*$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$*/
+
+/*
+function InitFFTShifts
+----------------------
+Tabulates the factors which shift the FFTs to our v & eta domains.  Each factor is a product of one
+1-D factor per direction (e.g. exp(i(i+j+k)L_eta h_v) wtN[i]wtN[j]wtN[k] is the product of
+wtN[i]exp(i i L_eta h_v) and the same for j & k), so only N values are stored for each.
+
+Since L_eta*h_v = pi, the shift of the 'v' terms is exp(i i pi) = (-1)^i before the FFT, and
+exp(-i L_eta v[i]) = exp(i L_eta L_v)(-1)^i after the inverse FFT.  Both are real up to the constant
+phase exp(i L_eta L_v), which is moved into the shift of the 'eta' terms before the inverse FFT.  The
+input of fft3D and the output of FS are real, so their FFTs are done as r2c & c2r transforms.
+*/
+void InitFFTShifts()
+{
+  int i;
+  double phase = L_eta*L_v;
+
+  fft_pre = (double *)malloc(N*sizeof(double));
+  fft_post = (fftw_complex *)fftw_malloc(N*sizeof(fftw_complex));
+  ifft_pre = (fftw_complex *)fftw_malloc(N*sizeof(fftw_complex));
+  FS_pre = (fftw_complex *)fftw_malloc(N*sizeof(fftw_complex));
+  ifft_post = (double *)malloc(N*sizeof(double));
+
+  for(i=0;i<N;i++)
+  {
+    fft_pre[i] = wtN[i]*cos((double)i*L_eta*h_v);																// shifts the 'v' terms before the FFT (sin(i L_eta h_v) = sin(i pi) = 0)
+    fft_post[i][0] = cos(L_v*eta[i]);                              fft_post[i][1] = sin(L_v*eta[i]);		// shifts the 'eta' terms after the FFT
+    ifft_pre[i][0] = wtN[i]*cos(phase - (double)i*L_v*h_eta);      ifft_pre[i][1] = wtN[i]*sin(phase - (double)i*L_v*h_eta);	// shifts the 'eta' terms before the inverse FFT, with the phase of the 'v' terms
+    FS_pre[i][0] = cos(phase - (double)i*L_v*h_eta);               FS_pre[i][1] = sin(phase - (double)i*L_v*h_eta);			// shifts the 'eta' terms before the Fourier series (no quadrature weights)
+    ifft_post[i] = cos((double)i*L_eta*h_v);																		// shifts the 'v' terms after the inverse FFT, (-1)^i
+  }
+}
+
+void FreeFFTShifts()
+{
+  free(fft_pre); fftw_free(fft_post); fftw_free(ifft_pre); fftw_free(FS_pre); free(ifft_post);
+}
+
+/*
+function FFTThreads
+-------------------
+The number of threads worth using for an FFT (or a pass over the points of one) on an n^3 grid:
+one for every FFT_POINTS_PER_THREAD points, up to the number of OpenMP threads, so that small grids
+(e.g. 8^3 or 16^3) are not split between threads which would mostly wait on each other.
+*/
+int FFTThreads(int n)
+{
+  int threads = n*n*n/FFT_POINTS_PER_THREAD;
+  if(threads > omp_get_max_threads()) threads = omp_get_max_threads();
+  if(threads < 1) threads = 1;
+  return threads;
+}
+
+/*
+function PlanFFTs
+-----------------
+Plans p_forward (r2c) & p_backward (c2r) in place on temp, which holds the N x N x (N/2+1) modes
+of the half spectrum, or the N x N x 2(N/2+1) values of the real array (the last 2(N/2+1) - N
+of each row are padding)
+*/
+void PlanFFTs(unsigned flags)
+{
+  p_forward = fftw_plan_dft_r2c_3d(N, N, N, (double *)temp, temp, flags);
+  p_backward = fftw_plan_dft_c2r_3d(N, N, N, temp, (double *)temp, flags);
+}
+
+/*
+function RealShiftPass
+----------------------
+Sets the real array of each of the cells grids in buf to c*s[i]*s[j]*s[k]*in[cell][index] for every
+point (i,j,k) of the grid (before an r2c transform), with real factors s.  The grids are stored one
+after another, so their rows of 2(N/2+1) values are taken in one loop.
+*/
+static void RealShiftPass(const double *s, double c, double **in, int cells, fftw_complex *buf, int threads)
+{
+  int row, ij, k, N_r = 2*(N/2+1);
+  double sij, *buf_r = (double *)buf;
+  const double *in_row;
+
+  #pragma omp parallel for num_threads(threads) if(threads > 1) private(ij,k,sij,in_row) shared(s,c,in,buf_r,N_r)
+  for(row=0;row<cells*N*N;row++)
+  {
+    ij = row%(N*N);
+    sij = c*s[ij/N]*s[ij%N];
+    in_row = in[row/(N*N)] + N*ij;
+    for(k=0;k<N;k++)
+    {
+      buf_r[k + N_r*row] = sij*s[k]*in_row[k];
+    }
+  }
+}
+
+/*
+function ExpandShiftPass
+------------------------
+Sets out[cell][index] = s[i]*s[j]*s[k]*G(i,j,k) for every point (i,j,k) of the grid (after an r2c
+transform), where G is the half spectrum of that cell in buf for k <= N/2 and the complex conjugate
+of its mirror image G(-i,-j,-k) otherwise
+*/
+static void ExpandShiftPass(const fftw_complex *s, fftw_complex **out, int cells, const fftw_complex *buf, int threads)
+{
+  int row, ij, i, j, k, N_h = N/2+1, index_h;
+  double sij_re, sij_im, s_re, s_im, G_re, G_im;
+  const fftw_complex *G;
+  fftw_complex *out_row;
+
+  #pragma omp parallel for num_threads(threads) if(threads > 1) private(ij,i,j,k,index_h,sij_re,sij_im,s_re,s_im,G_re,G_im,G,out_row) shared(s,out,buf,N_h)
+  for(row=0;row<cells*N*N;row++)
+  {
+    ij = row%(N*N);
+    i = ij/N; j = ij%N;
+    G = buf + N*N*N_h*(row/(N*N));																// the half spectrum of this cell
+    out_row = out[row/(N*N)] + N*ij;
+    sij_re = s[i][0]*s[j][0] - s[i][1]*s[j][1];
+    sij_im = s[i][0]*s[j][1] + s[i][1]*s[j][0];
+    for(k=0;k<N;k++)
+    {
+      if(k < N_h)
+      {
+        index_h = k + N_h*ij;
+        G_re = G[index_h][0]; G_im = G[index_h][1];
       }
+      else
+      {
+        index_h = (N-k) + N_h*((N-j)%N + N*((N-i)%N));
+        G_re = G[index_h][0]; G_im = -G[index_h][1];
+      }
+      s_re = sij_re*s[k][0] - sij_im*s[k][1];
+      s_im = sij_re*s[k][1] + sij_im*s[k][0];
+      out_row[k][0] = s_re*G_re - s_im*G_im;
+      out_row[k][1] = s_re*G_im + s_im*G_re;
     }
   }
 }
-//#endif
+
+/*
+function HalfShiftPass
+----------------------
+Sets the half spectrum of each of the cells grids in buf to (Y(i,j,k) + conj(Y(-i,-j,-k)))/2 for
+k <= N/2 (before a c2r transform), where Y(i,j,k) = c*s[i]*s[j]*s[k]*in[cell][index].  This is the
+Hermitian part of Y, so the c2r transform gives exactly the real part of the complex transform of Y.
+*/
+static void HalfShiftPass(const fftw_complex *s, double c, fftw_complex **in, int cells, fftw_complex *buf, int threads)
+{
+  int row, ij, i, j, k, N_h = N/2+1, mi, mj, mk;
+  double s_re, s_im, m_re, m_im, t_re, t_im;
+  const fftw_complex *Y;
+
+  #pragma omp parallel for num_threads(threads) if(threads > 1) private(ij,i,j,k,mi,mj,mk,s_re,s_im,m_re,m_im,t_re,t_im,Y) shared(s,c,in,buf,N_h)
+  for(row=0;row<cells*N*N;row++)
+  {
+    ij = row%(N*N);
+    i = ij/N; j = ij%N;
+    mi = (N-i)%N; mj = (N-j)%N;
+    Y = in[row/(N*N)];
+    for(k=0;k<N_h;k++)
+    {
+      mk = (N-k)%N;
+      t_re = s[i][0]*s[j][0] - s[i][1]*s[j][1];												// the factor at (i,j,k)
+      t_im = s[i][0]*s[j][1] + s[i][1]*s[j][0];
+      s_re = c*(t_re*s[k][0] - t_im*s[k][1]);
+      s_im = c*(t_re*s[k][1] + t_im*s[k][0]);
+      t_re = s[mi][0]*s[mj][0] - s[mi][1]*s[mj][1];											// the factor at (-i,-j,-k)
+      t_im = s[mi][0]*s[mj][1] + s[mi][1]*s[mj][0];
+      m_re = c*(t_re*s[mk][0] - t_im*s[mk][1]);
+      m_im = c*(t_re*s[mk][1] + t_im*s[mk][0]);
+
+      t_re = s_re*Y[k + N*ij][0] - s_im*Y[k + N*ij][1];										// Y(i,j,k)
+      t_im = s_re*Y[k + N*ij][1] + s_im*Y[k + N*ij][0];
+      buf[k + N_h*row][0] = 0.5*(t_re + m_re*Y[mk + N*(mj + N*mi)][0] - m_im*Y[mk + N*(mj + N*mi)][1]);
+      buf[k + N_h*row][1] = 0.5*(t_im - m_re*Y[mk + N*(mj + N*mi)][1] - m_im*Y[mk + N*(mj + N*mi)][0]);
+    }
+  }
+}
+
+/*
+function RealOutPass
+--------------------
+Sets out[cell][index] = c*s[i]*s[j]*s[k]*(the real array of that cell in buf) for every point (i,j,k)
+of the grid (after a c2r transform), with real factors s
+*/
+static void RealOutPass(const double *s, double c, double **out, int cells, const fftw_complex *buf, int threads)
+{
+  int row, ij, k, N_r = 2*(N/2+1);
+  double sij, *out_row;
+  const double *buf_r = (const double *)buf;
+
+  #pragma omp parallel for num_threads(threads) if(threads > 1) private(ij,k,sij,out_row) shared(s,c,out,buf_r,N_r)
+  for(row=0;row<cells*N*N;row++)
+  {
+    ij = row%(N*N);
+    sij = c*s[ij/N]*s[ij%N];
+    out_row = out[row/(N*N)] + N*ij;
+    for(k=0;k<N;k++)
+    {
+      out_row[k] = sij*s[k]*buf_r[k + N_r*row];
+    }
+  }
+}
+
 /*$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$*/
 
 /*
 function fft3D
 --------------
-Computes the fourier transform of in, and adjusts the coefficients based on our v, eta
+Computes the fourier transform of the real function in, and adjusts the coefficients based on our v, eta
 */
-void fft3D(fftw_complex *in, fftw_complex *out)
+void fft3D(double *in, fftw_complex *out)
 {
-  int i, j, k, index;
-  double sum;
-  
-  //shift the 'v' terms in the exponential to reflect our velocity domain
-  for(i=0;i<N;i++)
-    for(j=0;j<N;j++)
-      for(k=0;k<N;k++)
-	{
+  CollisionWorkspace *ws = CurrentCollisionWorkspace();		// the FFT is taken in the temp of this thread's workspace (the global temp unless the space-steps are run concurrently)
 
-	  index = k + N*(j + N*i);
-	  sum = ((double)i + (double)j + (double)k)*L_eta*h_v;
+  //shift the 'v' terms in the exponential to reflect our velocity domain
+  //h_v correspond to the velocity space scaling - ensures that the FFT is properly scaled since fftw does no scaling at all
+  RealShiftPass(fft_pre, scale3*h_v*h_v*h_v, &in, 1, ws->temp, ws->fft_threads);
 
-	  //h_v correspond to the velocity space scaling - ensures that the FFT is properly scaled since fftw does no scaling at all
-	  temp[index][0] = scale3*h_v*h_v*h_v*wtN[i]*wtN[j]*wtN[k]*(cos(sum)*in[index][0] - sin(sum)*in[index][1]);
-	  temp[index][1] = scale3*h_v*h_v*h_v*wtN[i]*wtN[j]*wtN[k]*(cos(sum)*in[index][1] + sin(sum)*in[index][0]);
-	}
-  //computes fft
-  fftw_execute(p_forward);
+  //computes the half spectrum of the real input
+  fftw_execute_dft_r2c(p_forward, (double *)ws->temp, ws->temp);
   //fftwnd_threads_one(nThreads, p_forward, temp, NULL); /*FFTW Library*/
 
-  //shifts the 'eta' terms to reflect our fourier domain
-  for(i=0;i<N;i++)
-    for(j=0;j<N;j++)
-      for(k=0;k<N;k++)
-	{
-	  index = k + N*(j + N*i);
-	  sum = L_v*(eta[i] + eta[j] + eta[k]);
-	  
-	  out[index][0] = ( cos(sum)*temp[index][0] - sin(sum)*temp[index][1]);
-	  out[index][1] = ( cos(sum)*temp[index][1] + sin(sum)*temp[index][0]);
-	}
-  
+  //fills in the other half & shifts the 'eta' terms to reflect our fourier domain
+  ExpandShiftPass(fft_post, &out, 1, ws->temp, ws->fft_threads);
 }
 
 /*$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$*/
 /*
 function fft3D
 --------------
-Computes the inverse fourier transform of in, and adjusts the coefficients based on our v, eta
+Computes the real part of the inverse fourier transform of in, and adjusts the coefficients based on our v, eta
 */
 
-void ifft3D(fftw_complex *in, fftw_complex *out)
+void ifft3D(fftw_complex *in, double *out)
 {
-  int i, j, k, index;
-  double sum, numScale = scale3;//= pow((double)N, -3.0);
+  double numScale = scale3;//= pow((double)N, -3.0);
+  CollisionWorkspace *ws = CurrentCollisionWorkspace();
+
+  //shifts the 'eta' terms to reflect our fourier domain & keeps the Hermitian part
+  //h_eta ensures FFT is scaled correctly, since fftw does no scaling at all
+  HalfShiftPass(ifft_pre, h_eta*h_eta*h_eta, &in, 1, ws->temp, ws->fft_threads);
 
-  //shifts the 'eta' terms to reflect our fourier domain
-  for(i=0;i<N;i++)
-    for(j=0;j<N;j++)
-      for(k=0;k<N;k++)
-	{
-	  index = k + N*(j + N*i);
-	  sum = -( ( (double)i + (double)j + (double)k )*L_v*h_eta );
-	  
-	  //h_eta ensures FFT is scaled correctly, since fftw does no scaling at all
-	  temp[index][0] = h_eta*h_eta*h_eta*wtN[i]*wtN[j]*wtN[k]*(cos(sum)*in[index][0] - sin(sum)*in[index][1]);
-	  temp[index][1] = h_eta*h_eta*h_eta*wtN[i]*wtN[j]*wtN[k]*(cos(sum)*in[index][1] + sin(sum)*in[index][0]);
-	}
   //compute IFFT
-  fftw_execute(p_backward);
+  fftw_execute_dft_c2r(p_backward, ws->temp, (double *)ws->temp);
   //fftwnd_threads_one(nThreads, p_backward, temp, NULL); /*FFTW Library*/
 
   //shifts the 'v' terms to reflect our velocity domain
-  for(i=0;i<N;i++)
-    for(j=0;j<N;j++)
-      for(k=0;k<N;k++)
-	{
-	  index = k + N*(j + N*i);
-	  sum = -( L_eta*(v[i] + v[j] + v[k])  );
-	  
-	  out[index][0] = (cos(sum)*temp[index][0] - sin(sum)*temp[index][1])*numScale;
-	  out[index][1] = (cos(sum)*temp[index][1] + sin(sum)*temp[index][0])*numScale;
-	}
-  
+  RealOutPass(ifft_post, numScale, &out, 1, ws->temp, ws->fft_threads);
 }
 
-void FS(fftw_complex *in, fftw_complex *out) // compute the Fourier series approximation of f (out), through fhat (in)
+void FS(fftw_complex *in, double *out) // compute the (real part of the) Fourier series approximation of f (out), through fhat (in)
 {
-  int i, j, k, index;
-  double sum;//= pow((double)N, -3.0);
-
-  //shifts the 'eta' terms to reflect our fourier domain
-  for(i=0;i<N;i++){
-    for(j=0;j<N;j++){
-      for(k=0;k<N;k++){
-	  index = k + N*(j + N*i);
-	  sum = -( ( (double)i + (double)j + (double)k )*L_v*h_eta );
-	  
-	  //h_eta ensures FFT is scaled correctly, since fftw does no scaling at all
-	  temp[index][0] = (cos(sum)*in[index][0] - sin(sum)*in[index][1]);
-	  temp[index][1] = (cos(sum)*in[index][1] + sin(sum)*in[index][0]);
-      }
-    }
-  }
+  CollisionWorkspace *ws = CurrentCollisionWorkspace();
+
+  //shifts the 'eta' terms to reflect our fourier domain & keeps the Hermitian part
+  HalfShiftPass(FS_pre, 1., &in, 1, ws->temp, ws->fft_threads);
+
   //compute IFFT
-  fftw_execute(p_backward);
+  fftw_execute_dft_c2r(p_backward, ws->temp, (double *)ws->temp);
   //fftwnd_threads_one(nThreads, p_backward, temp, NULL); /*FFTW Library*/
 
   //shifts the 'v' terms to reflect our velocity domain
-  for(i=0;i<N;i++){
-    for(j=0;j<N;j++){
-      for(k=0;k<N;k++){
-	  index = k + N*(j + N*i);
-	  sum = -( L_eta*(v[i] + v[j] + v[k])  );
-	  
-	  out[index][0] = (cos(sum)*temp[index][0] - sin(sum)*temp[index][1])/scaleL/scale3;
-	  out[index][1] = (cos(sum)*temp[index][1] + sin(sum)*temp[index][0])/scaleL/scale3;
-      }
-    }
+  RealOutPass(ifft_post, 1./scaleL/scale3, &out, 1, ws->temp, ws->fft_threads);
+}
+
+/*
+function PlanBatchedFFTs
+------------------------
+Allocates temp_cells, which holds the grids of up to cells space-steps one after another (each laid
+out as in temp), and plans p_forward_cells (r2c) & p_backward_cells (c2r) in place on it with
+fftw_plan_many_dft, so that the FFTs of all of the space-steps of a batch are taken in one call.  The
+threads are chosen for the points of the whole batch, so a batch of small grids is split between
+threads even though each of its grids is not.  The plans always transform all cells grids, so the
+slots not used by a shorter batch (as on the last process along x) are kept at zero.
+*/
+void PlanBatchedFFTs(int cells, unsigned flags)
+{
+  int n[3] = {N, N, N};
+  int n_real[3] = {N, N, 2*(N/2+1)};															// the real arrays are padded as in temp
+  int n_half[3] = {N, N, N/2+1};
+  int dist_real = N*N*2*(N/2+1), dist_half = N*N*(N/2+1);
+
+  cells_threads = cells*N*N*N/FFT_POINTS_PER_THREAD;
+  if(cells_threads > omp_get_max_threads()) cells_threads = omp_get_max_threads();
+  if(cells_threads < 1) cells_threads = 1;
+
+  temp_cells = (fftw_complex *)fftw_malloc(cells*dist_half*sizeof(fftw_complex));
+
+  fftw_plan_with_nthreads(cells_threads);
+  p_forward_cells = fftw_plan_many_dft_r2c(3, n, cells, (double *)temp_cells, n_real, 1, dist_real, temp_cells, n_half, 1, dist_half, flags);
+  p_backward_cells = fftw_plan_many_dft_c2r(3, n, cells, temp_cells, n_half, 1, dist_half, (double *)temp_cells, n_real, 1, dist_real, flags);
+  fftw_plan_with_nthreads(FFTThreads(N));														// go back to the number of threads for a single NxNxN grid for any later plans
+
+  cells_planned = cells;
+  memset(temp_cells, 0, cells*dist_half*sizeof(fftw_complex));									// the planner may have overwritten temp_cells
+}
+
+static void ClearUnusedCells(int cells)																// Function to zero the grids of temp_cells after the first cells, which the batched plans transform but no space-step fills
+{
+  int dist_half = N*N*(N/2+1);
+
+  if(cells < cells_planned)
+  {
+    memset(temp_cells + (size_t)cells*dist_half, 0, (size_t)(cells_planned - cells)*dist_half*sizeof(fftw_complex));
   }
-  
+}
+
+void FreeBatchedFFTs()
+{
+  fftw_destroy_plan(p_forward_cells); fftw_destroy_plan(p_backward_cells);
+  fftw_free(temp_cells);
+}
+
+/*
+function fft3D_Batched
+----------------------
+Computes out[c] = fft3D(in[c]) for c = 0,...,cells-1 (with cells at most the number given to
+PlanBatchedFFTs), with the FFTs of all of them taken by one call of fftw_execute
+*/
+void fft3D_Batched(double **in, fftw_complex **out, int cells)
+{
+  RealShiftPass(fft_pre, scale3*h_v*h_v*h_v, in, cells, temp_cells, cells_threads);
+  ClearUnusedCells(cells);
+  fftw_execute(p_forward_cells);
+  ExpandShiftPass(fft_post, out, cells, temp_cells, cells_threads);
+}
+
+/*
+function FS_Batched
+-------------------
+Computes out[c] = FS(in[c]) for c = 0,...,cells-1 (with cells at most the number given to
+PlanBatchedFFTs), with the inverse FFTs of all of them taken by one call of fftw_execute
+*/
+void FS_Batched(fftw_complex **in, double **out, int cells)
+{
+  HalfShiftPass(FS_pre, 1., in, cells, temp_cells, cells_threads);
+  ClearUnusedCells(cells);
+  fftw_execute(p_backward_cells);
+  RealOutPass(ifft_post, 1./scaleL/scale3, out, cells, temp_cells, cells_threads);
 }
 
 /*$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$*/
@@ -563,9 +773,11 @@ void IntModes(int k1, int k2,  int k3, int j1, int j2, int j3, double *result) /
 
 void ProjectedNodeValue(fftw_complex *qHat, double *Q_incremental) // incremental of node values, projected from qHat to DG mesh
 {
-    int m1,m2,m3,i,j,k,j1,j2,j3, kk,k_v,k_ft, k_eta;
-    double tp0, tp2, tp3, tp4, tp5, Q_re, Q_im, u0, u2, u3, u4, u5;
-    #pragma omp parallel for private(k_eta, k_ft, k_v, kk, j1,j2,j3,i,j,k,m1,m2,m3,tp0, tp2, tp3, tp4, tp5, Q_re, Q_im, u2, u3, u4, u5) shared(qHat,Q_incremental)
+    int m1,m2,m3,j1,j2,j3,k_v,k_ft;
+    double tp0, tp2, tp3, tp4, tp5, u0, u2, u3, u4, u5, *proj;
+
+    proj = ProjectModes(qHat, nu); // project nu*qHat onto the DG basis in every velocity cell
+    #pragma omp parallel for private(k_ft, k_v, j1,j2,j3,m1,m2,m3,tp0, tp2, tp3, tp4, tp5, u0, u2, u3, u4, u5) shared(proj,Q_incremental)
     for(k_ft=0;k_ft<size_ft;k_ft++){
 	m3 = k_ft % N; m2 = ((k_ft-m3)/N) % N; m1 = (k_ft - m3 - N*m2)/(N*N);
 	j1 = m1*h_v/dv; if(j1==Nv)j1=Nv-1;
@@ -573,26 +785,7 @@ void ProjectedNodeValue(fftw_complex *qHat, double *Q_incremental) // incrementa
 	j3 = m3*h_v/dv; if(j3==Nv)j3=Nv-1; // determine in which element (j1,j2,j3) should this Fourier node (i,j,k) falls
 	
 	k_v = j1*Nv*Nv + j2*Nv + j3;
-	tp0=0.; tp2=0.; tp3=0.; tp4=0.; tp5=0.;
-	for(i=0;i<N;i++){
-	  for(j=0;j<N;j++){
-	    for(k=0;k<N;k++){
-	      k_eta = k + N*(j + N*i);
-		  //kk = k_v*size_ft+k_eta;
-		  IntModes(i,j,k,j1,j2,j3,IntM); //the global IntM must be declared as threadprivate
-		  
-		  Q_re = nu*qHat[k_eta][0];
-	      Q_im = nu*qHat[k_eta][1];
-		  //tem = scale3*wtN[i]*wtN[j]*wtN[k]*h_eta*h_eta*h_eta;
-		 tp0 += IntM[0]*Q_re - IntM[1]*Q_im;
-		  tp2 += IntM[1*2]*Q_re - IntM[1*2+1]*Q_im;
-		  tp3 += IntM[2*2]*Q_re - IntM[2*2+1]*Q_im;
-		  tp4 += IntM[3*2]*Q_re - IntM[3*2+1]*Q_im;
-		  tp5 += IntM[4*2]*Q_re - IntM[4*2+1]*Q_im;
-		  
-	    }
-	  }
-	}	      
+	tp0 = proj[5*k_v]; tp2 = proj[5*k_v+1]; tp3 = proj[5*k_v+2]; tp4 = proj[5*k_v+3]; tp5 = proj[5*k_v+4];
 
 	u0 = (19*tp0/4. - 15*tp5)/scalev/scaleL/scale3;
 	u5 = (60*tp5 - 15*tp0)/scalev/scaleL/scale3;
@@ -603,8 +796,44 @@ void ProjectedNodeValue(fftw_complex *qHat, double *Q_incremental) // incrementa
 }	
 
 void ComputeQ_FandL(double *f, fftw_complex *qHat, double **conv_weights, fftw_complex *qHat_linear, double **conv_weights_linear)
+{
+	if(collision_engine == ENGINE_MATRIXFREE)
+	{
+		ComputeQ_FandL_MatrixFree(f, qHat, qHat_linear);
+	}
+	else if(collision_engine == ENGINE_FFT)
+	{
+		ComputeQ_FandL_FFT(f, qHat, qHat_linear);
+	}
+	else if(collision_engine == ENGINE_LOWRANK)
+	{
+		ComputeQ_FandL_LowRank(f, qHat, qHat_linear);
+	}
+	else if(FloatWeights)
+	{
+		ComputeQ_FandL_FloatWeights(f, qHat, qHat_linear);
+	}
+	else if(PackedWeights)
+	{
+		ComputeQ_FandL_PackedWeights(f, qHat, qHat_linear);
+	}
+	else if(SymmetricWeights)
+	{
+		ComputeQ_FandL_SymmetricWeights(f, qHat, qHat_linear);
+	}
+	else
+	{
+		ComputeQ_FandL_Direct(f, qHat, conv_weights, qHat_linear, conv_weights_linear);
+	}
+	GatherModes(qHat);																			// collect the modes computed by the other processes (only in Homogeneous runs with more than one process)
+	GatherModes(qHat_linear);
+	CheckComputeQ_FandL(f, qHat, qHat_linear);													// the first time through, compare with ComputeQ_FandL_Direct (if CheckEngine is true)
+}
+
+void ComputeQ_FandL_Direct(double *f, fftw_complex *qHat, double **conv_weights, fftw_complex *qHat_linear, double **conv_weights_linear)
 {
   int i, j, k, l, m, n, x, y, z;
+  int ki, ki_end, t, threads = ModeThreads();
   int start_i, start_j, start_k, end_i, end_j, end_k;
   //fftw_complex *fftIn, *fftOut;
   double tempD, tempD1, tmp0, tmp1, tmp01, tmp11;
@@ -613,19 +842,14 @@ void ComputeQ_FandL(double *f, fftw_complex *qHat, double **conv_weights, fftw_c
   //fftIn = (fftw_complex *)fftw_malloc(N*N*N*sizeof(fftw_complex));
   //fftOut = (fftw_complex *)fftw_malloc(N*N*N*sizeof(fftw_complex));
   
-  for(i=0;i<size_ft;i++){
-    fftIn[i][0] = f[i];
-    fftIn[i][1] = 0.;
-  }
-
-  fft3D(fftIn, fftOut);
+  fft3D(f, fftOut);
   
   //printf("fft done\n");
-  #pragma omp parallel for private(j,k,l,m,n,x,y,z,start_i,start_j,start_k,end_i,end_j,end_k,tempD, tempD1,tmp0, tmp1) shared(qHat, qHat_linear, fftOut, conv_weights, conv_weights_linear)
-  for(i=0;i<N;i++) {
-    for(j=0;j<N;j++){
-      for(k=0;k<N;k++)
+  #pragma omp parallel for schedule(static,1) num_threads(threads) private(t,ki,ki_end,i,j,k,l,m,n,x,y,z,start_i,start_j,start_k,end_i,end_j,end_k,tempD,tempD1,tmp0,tmp1,tmp01,tmp11) shared(qHat, qHat_linear, fftOut, conv_weights, conv_weights_linear)
+  for(t=0;t<threads;t++) {	// give each thread one range of modes of about the same cost (see ModeSchedule.cpp)
+      for(ki=ModeStart(t, threads), ki_end=ModeStart(t+1, threads);ki<ki_end;ki++)
 	{
+	  i = ki/(N*N); j = (ki/N)%N; k = ki%N;
 	  //figure out the windows for the convolutions (i.e. where xi(l) and eta(i)-xi(l) are in the domain)
 	  if( i < N/2 ) {
 	    start_i = 0;
@@ -683,92 +907,122 @@ void ComputeQ_FandL(double *f, fftw_complex *qHat, double **conv_weights, fftw_c
 	 qHat_linear[k + N*(j + N*i)][0] = tmp01;  
 	 qHat_linear[k + N*(j + N*i)][1] = tmp11;
 	}
-    }
   }
-
 }
 
 void ComputeQ(double *f, fftw_complex *qHat, double **conv_weights)
+{
+	if(collision_engine == ENGINE_MATRIXFREE)
+	{
+		ComputeQ_MatrixFree(f, qHat);
+	}
+	else if(collision_engine == ENGINE_FFT)
+	{
+		ComputeQ_FFT(f, qHat);
+	}
+	else if(collision_engine == ENGINE_LOWRANK)
+	{
+		ComputeQ_LowRank(f, qHat);
+	}
+	else if(FloatWeights)
+	{
+		ComputeQ_FloatWeights(f, qHat);
+	}
+	else if(PackedWeights)
+	{
+		ComputeQ_PackedWeights(f, qHat);
+	}
+	else if(SymmetricWeights)
+	{
+		ComputeQ_SymmetricWeights(f, qHat);
+	}
+	else if(direct_kernel != KERNEL_SCALAR)
+	{
+		ComputeQ_DirectSIMD(f, qHat, conv_weights);
+	}
+	else
+	{
+		ComputeQ_Direct(f, qHat, conv_weights);
+	}
+	GatherModes(qHat);																			// collect the modes computed by the other processes (only in Homogeneous runs with more than one process)
+	CheckComputeQ(f, qHat);																		// the first time through, compare with ComputeQ_Direct (if CheckEngine is true)
+}
+
+void ComputeQ_Direct(double *f, fftw_complex *qHat, double **conv_weights)
 {
 	int i, j, k, l, m, n, x, y, z;												// declare (i,j,k) (the indices for a given value of given ki = ki_(i,j,k)), (l,m,n) (counters for the quadrature to calculate the integral w.r.t. eta in the evaluation of qHat and so also represent the indices of a given eta = eta_(l,m,n)) & (x,y,z) (the indices for the value of a subtraction in the calculation, namely eta_(x,y,z) = ki_(i,j,k) - eta_(l,m,n))
+	int ki, ki_end, t, threads = ModeThreads();									// declare ki (the index of ki_(i,j,k), k + N*(j + N*i)), ki_end & t (the end of the range of modes of thread t) & threads (the number of ranges the modes are shared out between)
 	int start_i, start_j, start_k, end_i, end_j, end_k;							// declare start_i, start_j & start_k (the indices for the values of the lower bounds of integration in computation of the convolution, corresponding to the lowest point where both functions are non-zero, in each velocity direction) and end_i, end_j & end_k (the indices for the values of the upper bounds of integration in computation of the convolution, corresponding to the highest point where both functions are non-zero, in each velocity direction)
 	double tempD, tmp0, tmp1;													// declare tempD (the value of the convolution weight at a given ki & eta), tmp0 (which will become the real part of qHat) & tmp1 (which will become the imaginary part of qHat)
 	double prefactor = h_eta*h_eta*h_eta; 										// declare prefactor (the value of h_eta^3, as no scale3 in Fourier space) and set its value
+	fftw_complex *fftOut = CurrentCollisionWorkspace()->fftOut;					// the spectrum of f is stored in this thread's workspace (the global fftOut unless the space-steps are run concurrently)
 
-	for(i=0;i<size_ft;i++)														// initialise the input of the FFT
-	{
-		fftIn[i][0] = f[i];														// set the real part to the sampling of the solution stored in f
-		fftIn[i][1] = 0.;														// set the imaginary part to zero
-	}
-
-	fft3D(fftIn, fftOut);														// perform the FFT of fftIn and store the result in fftOut
+	fft3D(f, fftOut);														// perform the FFT of f and store the result in fftOut
 
-	#pragma omp parallel for schedule(dynamic) private(i,j,k,l,m,n,x,y,z,start_i,start_j,start_k,end_i,end_j,end_k,tempD) shared(qHat, fftOut, conv_weights) reduction(+:tmp0, tmp1)
-	for(i=0;i<N;i++) 															// loop through all points in the ki_1
+	#pragma omp parallel for schedule(static,1) num_threads(threads) private(t,ki,ki_end,i,j,k,l,m,n,x,y,z,start_i,start_j,start_k,end_i,end_j,end_k,tempD,tmp0,tmp1) shared(qHat, fftOut, conv_weights)
+	for(t=0;t<threads;t++)														// give each thread one range of modes of about the same cost (see ModeSchedule.cpp)
 	{
-		for(j=0;j<N;j++)														// loop through all points in the ki_2
+		for(ki=ModeStart(t, threads), ki_end=ModeStart(t+1, threads);ki<ki_end;ki++)	// loop through all the modes ki(i,j,k) of this range
 		{
-			for(k=0;k<N;k++)													// loop through all points in the ki_3
+			i = ki/(N*N); j = (ki/N)%N; k = ki%N;								// find the indices (i,j,k) of ki_(i,j,k)
+			//figure out the windows for the convolutions (i.e. where eta(l,m,n) and ki(i,j,k)-eta(l,m,n) are in the domain)
+			if( i < N/2 ) 														// if ki_1(i) < 0 then the values of l for which f(ki_1(i)-eta_1(l))*f(eta_1(l)) give a non-zero product range need -Lv < eta_1 <= ki_1 + Lv/2, due to the support of f being -Lv to Lv
 			{
-				//figure out the windows for the convolutions (i.e. where eta(l,m,n) and ki(i,j,k)-eta(l,m,n) are in the domain)
-				if( i < N/2 ) 													// if ki_1(i) < 0 then the values of l for which f(ki_1(i)-eta_1(l))*f(eta_1(l)) give a non-zero product range need -Lv < eta_1 <= ki_1 + Lv/2, due to the support of f being -Lv to Lv
-				{
-					start_i = 0;												// set start_i to 0 to represent -Lv as the lower bound of integration
-					end_i = i + N/2 + 1;										// set end_i to i + N/2 + 1 to represent eta_1(i+N/2+1/2) as the upper bound of integration (with +1 there so that all cells less than index end_i are integrated over)
-				}
-				else 															// if ki_1(i) >= 0 then the values of l for which f(ki_1(i)-eta_1(l))*f(eta_1(l)) give a non-zero product range need ki_1 - Lv/2 < eta_1 <= Lv, due to the support of f being -Lv to Lv
-				{
-					start_i = i - N/2 + 1;										// set start_i to i - N/2 + 1 to represent eta_1(i) - Lv as the lower bound of integration (with +1 since ki_1[i-N/2] - eta_1[i] actually overlaps with eta_1[-1/2] = -Lv, where f(-Lv)=0, so start at the next index)
-					end_i = N;													// set end_i to N to represent Lv as the upper bound of integration (i.e. integrate over all cells with index less than N)
-				}
+				start_i = 0;													// set start_i to 0 to represent -Lv as the lower bound of integration
+				end_i = i + N/2 + 1;											// set end_i to i + N/2 + 1 to represent eta_1(i+N/2+1/2) as the upper bound of integration (with +1 there so that all cells less than index end_i are integrated over)
+			}
+			else 																// if ki_1(i) >= 0 then the values of l for which f(ki_1(i)-eta_1(l))*f(eta_1(l)) give a non-zero product range need ki_1 - Lv/2 < eta_1 <= Lv, due to the support of f being -Lv to Lv
+			{
+				start_i = i - N/2 + 1;											// set start_i to i - N/2 + 1 to represent eta_1(i) - Lv as the lower bound of integration (with +1 since ki_1[i-N/2] - eta_1[i] actually overlaps with eta_1[-1/2] = -Lv, where f(-Lv)=0, so start at the next index)
+				end_i = N;														// set end_i to N to represent Lv as the upper bound of integration (i.e. integrate over all cells with index less than N)
+			}
 
-				if( j < N/2 )													// if ki_2(j) < 0 then the values of m for which f(ki_2(j)-eta_2(m))*f(eta_2(m)) give a non-zero product range need -Lv < eta_2 <= ki_2 + Lv/2, due to the support of f being -Lv to Lv
-				{
-					start_j = 0;												// set start_j to 0 to represent -Lv as the lower bound of integration
-					end_j = j + N/2 + 1;										// set end_j to j + N/2 + 1 to represent eta_2(j+N/2+1/2) as the upper bound of integration (with +1 there so that all cells less than index end_i are integrated over)
-				}
-				else															// if ki_2(j) >= 0 then the values of m for which f(ki_2(j)-eta_2(m))*f(eta_2(m)) give a non-zero product range need ki_2 - Lv/2 < eta_2 <= Lv, due to the support of f being -Lv to Lv
-				{
-					start_j = j - N/2 + 1;										// set start_j to j - N/2 + 1 to represent eta_2(j) - Lv as the lower bound of integration (with +1 since ki_2[j-N/2] - eta_2[j] actually overlaps with eta_2[-1/2] = -Lv, where f(-Lv)=0, so start at the next index)
-					end_j = N;													// set end_j to N to represent Lv as the upper bound of integration (i.e. integrate over all cells with index less than N)
-				}
+			if( j < N/2 )														// if ki_2(j) < 0 then the values of m for which f(ki_2(j)-eta_2(m))*f(eta_2(m)) give a non-zero product range need -Lv < eta_2 <= ki_2 + Lv/2, due to the support of f being -Lv to Lv
+			{
+				start_j = 0;													// set start_j to 0 to represent -Lv as the lower bound of integration
+				end_j = j + N/2 + 1;											// set end_j to j + N/2 + 1 to represent eta_2(j+N/2+1/2) as the upper bound of integration (with +1 there so that all cells less than index end_i are integrated over)
+			}
+			else																// if ki_2(j) >= 0 then the values of m for which f(ki_2(j)-eta_2(m))*f(eta_2(m)) give a non-zero product range need ki_2 - Lv/2 < eta_2 <= Lv, due to the support of f being -Lv to Lv
+			{
+				start_j = j - N/2 + 1;											// set start_j to j - N/2 + 1 to represent eta_2(j) - Lv as the lower bound of integration (with +1 since ki_2[j-N/2] - eta_2[j] actually overlaps with eta_2[-1/2] = -Lv, where f(-Lv)=0, so start at the next index)
+				end_j = N;														// set end_j to N to represent Lv as the upper bound of integration (i.e. integrate over all cells with index less than N)
+			}
 
-				if( k < N/2 )													// if ki_3(k) < 0 then the values of n for which f(ki_3(k)-eta_3(n))*f(eta_3(n)) give a non-zero product range need -Lv < eta_3 <= ki_3 + Lv/2, due to the support of f being -Lv to Lv
-				{
-					start_k = 0;												// set start_k to 0 to represent -Lv as the lower bound of integration
-					end_k = k + N/2 + 1;										// set end_k to k + N/2 + 1 to represent eta_3(k+N/2+1/2) as the upper bound of integration (with +1 there so that all cells less than index end_i are integrated over)
-				}
-				else															// if ki_3(k) >= 0 then the values of n for which f(ki_3(k)-eta_3(n))*f(eta_3(n)) give a non-zero product range need ki_3 - Lv/2 < eta_3 <= Lv, due to the support of f being -Lv to Lv
-				{
-					start_k = k - N/2 + 1;										// set start_k to k - N/2 + 1 to represent eta_3(k) - Lv as the lower bound of integration (with +1 since ki_3[k-N/2] - eta_3[k] actually overlaps with eta_3[-1/2] = -Lv, where f(-Lv)=0, so start at the next index)
-					end_k = N;													// set end_k to N to represent Lv as the upper bound of integration (i.e. integrate over all cells with index less than N)
-				}
-				tmp0=0.; tmp1=0.;												// initialise tmp0 & tmp1 at zero to begin the quadrature
-				for(l=start_i;l<end_i;l++)										// loop through all the quadrature indices in the eta_1 direction that give non-zero contribution
+			if( k < N/2 )														// if ki_3(k) < 0 then the values of n for which f(ki_3(k)-eta_3(n))*f(eta_3(n)) give a non-zero product range need -Lv < eta_3 <= ki_3 + Lv/2, due to the support of f being -Lv to Lv
+			{
+				start_k = 0;													// set start_k to 0 to represent -Lv as the lower bound of integration
+				end_k = k + N/2 + 1;											// set end_k to k + N/2 + 1 to represent eta_3(k+N/2+1/2) as the upper bound of integration (with +1 there so that all cells less than index end_i are integrated over)
+			}
+			else																// if ki_3(k) >= 0 then the values of n for which f(ki_3(k)-eta_3(n))*f(eta_3(n)) give a non-zero product range need ki_3 - Lv/2 < eta_3 <= Lv, due to the support of f being -Lv to Lv
+			{
+				start_k = k - N/2 + 1;											// set start_k to k - N/2 + 1 to represent eta_3(k) - Lv as the lower bound of integration (with +1 since ki_3[k-N/2] - eta_3[k] actually overlaps with eta_3[-1/2] = -Lv, where f(-Lv)=0, so start at the next index)
+				end_k = N;														// set end_k to N to represent Lv as the upper bound of integration (i.e. integrate over all cells with index less than N)
+			}
+			tmp0=0.; tmp1=0.;													// initialise tmp0 & tmp1 at zero to begin the quadrature
+			for(l=start_i;l<end_i;l++)											// loop through all the quadrature indices in the eta_1 direction that give non-zero contribution
+			{
+				for(m=start_j;m<end_j;m++)										// loop through all the quadrature indices in the eta_2 direction that give non-zero contribution
 				{
-					for(m=start_j;m<end_j;m++)									// loop through all the quadrature indices in the eta_2 direction that give non-zero contribution
+					for(n=start_k;n<end_k;n++)									// loop through all the quadrature indices in the eta_3 direction that give non-zero contribution
 					{
-						for(n=start_k;n<end_k;n++)								// loop through all the quadrature indices in the eta_3 direction that give non-zero contribution
-						{
 
-							x = i + N/2 - l;									// set the index x to i + N/2 - l to represent the subtraction eta[x] = ki[i] - eta[l]
-							y = j + N/2 - m;									// set the index y to j + N/2 - m to represent the subtraction eta[y] = ki[j] - eta[m]
-							z = k + N/2 - n;									// set the index z to k + N/2 - n to represent the subtraction eta[z] = ki[k] - eta[n]
+						x = i + N/2 - l;										// set the index x to i + N/2 - l to represent the subtraction eta[x] = ki[i] - eta[l]
+						y = j + N/2 - m;										// set the index y to j + N/2 - m to represent the subtraction eta[y] = ki[j] - eta[m]
+						z = k + N/2 - n;										// set the index z to k + N/2 - n to represent the subtraction eta[z] = ki[k] - eta[n]
 
-							tempD = conv_weights[k + N*(j+ N*i)][n + N*(m + N*l)];		// set tempD to the value of the convolution weight corresponding to current value of ki(i,j,k) & eta(l,m,n)
-							tmp0 += prefactor*wtN[l]*wtN[m]*wtN[n]*tempD*(fftOut[n + N*(m + N*l)][0]*fftOut[z + N*(y + N*x)][0] - fftOut[n + N*(m + N*l)][1]*fftOut[z + N*(y + N*x)][1]);		// increment the value of the real part of qHat(ki(i,j,k)) by fHat(eta(l,m,n))*f(ki(i,j,k)-eta(l,m,n))*conv_weight(ki(i,j,k),eta(l,m,n)) for the current values of l, m & n in the quadrature sum
+						tempD = conv_weights[k + N*(j+ N*i)][n + N*(m + N*l)];			// set tempD to the value of the convolution weight corresponding to current value of ki(i,j,k) & eta(l,m,n)
+						tmp0 += prefactor*wtN[l]*wtN[m]*wtN[n]*tempD*(fftOut[n + N*(m + N*l)][0]*fftOut[z + N*(y + N*x)][0] - fftOut[n + N*(m + N*l)][1]*fftOut[z + N*(y + N*x)][1]);			// increment the value of the real part of qHat(ki(i,j,k)) by fHat(eta(l,m,n))*f(ki(i,j,k)-eta(l,m,n))*conv_weight(ki(i,j,k),eta(l,m,n)) for the current values of l, m & n in the quadrature sum
 
-							tmp1 += prefactor*wtN[l]*wtN[m]*wtN[n]*tempD*(fftOut[n + N*(m + N*l)][0]*fftOut[z + N*(y + N*x)][1] + fftOut[n + N*(m + N*l)][1]*fftOut[z + N*(y + N*x)][0]);		// increment the value of the imaginary part of qHat(ki(i,j,k)) by fHat(eta(l,m,n))*f(ki(i,j,k)-eta(l,m,n))*conv_weight(ki(i,j,k),eta(l,m,n)) for the current values of l, m & n in the quadrature sum
+						tmp1 += prefactor*wtN[l]*wtN[m]*wtN[n]*tempD*(fftOut[n + N*(m + N*l)][0]*fftOut[z + N*(y + N*x)][1] + fftOut[n + N*(m + N*l)][1]*fftOut[z + N*(y + N*x)][0]);			// increment the value of the imaginary part of qHat(ki(i,j,k)) by fHat(eta(l,m,n))*f(ki(i,j,k)-eta(l,m,n))*conv_weight(ki(i,j,k),eta(l,m,n)) for the current values of l, m & n in the quadrature sum
 
-							// printf(" tempD=%g, prefactor=%g, fftOut=[%g,%g] at %d, %d, %d; %d, %d, %d; %d, %d, %d\n",tempD, prefactor, fftOut[z + N*(y + N*x)][0], fftOut[z + N*(y + N*x)][1],i,j,k,l,m,n, x,y,z);
-						}
+						// printf(" tempD=%g, prefactor=%g, fftOut=[%g,%g] at %d, %d, %d; %d, %d, %d; %d, %d, %d\n",tempD, prefactor, fftOut[z + N*(y + N*x)][0], fftOut[z + N*(y + N*x)][1],i,j,k,l,m,n, x,y,z);
 					}
 				}
-				// printf("%d, %d, %d done\n", i,j,k);
-				qHat[k + N*(j + N*i)][0] = tmp0;								// set the real part of qHat(ki(i,j,k)) to the value tmp0 calculated in the quadrature
-				qHat[k + N*(j + N*i)][1] = tmp1;								// set the imaginary part of qHat(ki(i,j,k)) to the value tmp1 calculated in the quadrature
-				// printf("%d, %d, %d write-in done\n", i,j,k);
 			}
+			// printf("%d, %d, %d done\n", i,j,k);
+			qHat[k + N*(j + N*i)][0] = tmp0;									// set the real part of qHat(ki(i,j,k)) to the value tmp0 calculated in the quadrature
+			qHat[k + N*(j + N*i)][1] = tmp1;									// set the imaginary part of qHat(ki(i,j,k)) to the value tmp1 calculated in the quadrature
+			// printf("%d, %d, %d write-in done\n", i,j,k);
 		}
 	}
 }
@@ -799,8 +1053,8 @@ void RK4(double *f, int l, fftw_complex *qHat, double **conv_weights, double *U,
 
 void RK4_FandL_Inhomo(double *f, int l, fftw_complex *qHat, double **conv_weights, fftw_complex *qHat_linear, double **conv_weights_linear, double *U, double *dU) //4-th RK. yn=yn+(3*k1+k2+k3+k4)/6
 {
-int i,j,k, j1, j2, j3, k_v, k_eta, kk, l_local;  
-  double Q_re, Q_im, tp0, tp2, tp3,tp4,tp5, tmp0=0., tmp2=0., tmp3=0., tmp4=0.,tmp5=0., tem;
+int i, k_v, l_local;
+  double tp0, tp2, tp3,tp4,tp5, *proj;
 
   l_local = l%chunk_Nx;
   
@@ -809,11 +1063,10 @@ int i,j,k, j1, j2, j3, k_v, k_eta, kk, l_local;
     qHat[i][0] += qHat_linear[i][0];
 	qHat[i][1] += qHat_linear[i][1];
   }
-  FS(qHat, fftOut); 
+  FS(qHat, Q); 
 
   #pragma omp parallel for private(i) shared(Q,fftOut,f1,f)
   for(i=0;i<size_ft;i++){    
-    Q[i] = fftOut[i][0];
     f1[i] = f[i] + dt*Q[i]*nu; //BUG: this evolution (only on node values) is not consistent with our conservation routine, which preserves the exact moments of the {1,v,|v|^{2}} approximations
   }
 
@@ -826,11 +1079,10 @@ int i,j,k, j1, j2, j3, k_v, k_eta, kk, l_local;
 	Q1_fft[i][1] += Q1_fft_linear[i][1];
   }
   
-  FS(Q1_fft, fftOut);
+  FS(Q1_fft, Q1);
 
   #pragma omp parallel for private(i) shared(Q,Q1,fftOut,f1,f)
   for(i=0;i<size_ft;i++){ 	
-    Q1[i] = fftOut[i][0];	   
     f1[i] = f[i] +  0.5*dt*Q[i]*nu + 0.5*dt*Q1[i]*nu;
   }
  
@@ -842,11 +1094,10 @@ int i,j,k, j1, j2, j3, k_v, k_eta, kk, l_local;
     Q2_fft[i][0] += Q2_fft_linear[i][0];
 	Q2_fft[i][1] += Q2_fft_linear[i][1];
   }
-  FS(Q2_fft, fftOut);
+  FS(Q2_fft, Q1);
   //ifft3D(Q2_fft, fftOut);
   #pragma omp parallel for private(i) shared(Q,Q1,fftOut,f1,f)
   for(i=0;i<size_ft;i++){	
-    Q1[i] = fftOut[i][0];	 
     f1[i] = f[i] + 0.5*dt*Q[i]*nu + 0.5*dt*Q1[i]*nu;
   }
 
@@ -858,33 +1109,14 @@ int i,j,k, j1, j2, j3, k_v, k_eta, kk, l_local;
     Q3_fft[i][0] += Q3_fft_linear[i][0];
 	Q3_fft[i][1] += Q3_fft_linear[i][1];
   }
-  #pragma omp parallel for schedule(dynamic) private(j1,j2,j3,i,j,k,k_v,k_eta,Q_re, Q_im, tp0, tp2,tp3,tp4, tp5) shared(l,l_local,qHat,U, dU) //reduction(+: tmp0, tmp2, tmp3, tmp4, tmp5)
-  for(int kt=0;kt<size_v;kt++){
-    j3 = kt % Nv; j2 = ((kt-j3)/Nv) % Nv; j1 = (kt - j3 - Nv*j2)/(Nv*Nv);
-    tp0=0.; tp2=0.; tp3=0.; tp4=0.; tp5=0.;
-    for(i=0;i<N;i++){
-      for(j=0;j<N;j++){
-		for(k=0;k<N;k++){
-		  k_eta = k + N*(j + N*i);
-
-		  IntModes(i,j,k,j1,j2,j3,IntM); //the global IntM must be declared as threadprivate; BUG: forgot to uncomment this and thus IntM=0 !!
-		  
-		  Q_re = nu*(0.5*qHat[k_eta][0] + (Q1_fft[k_eta][0]+Q2_fft[k_eta][0]+Q3_fft[k_eta][0])/6.);
-		  Q_im = nu*(0.5*qHat[k_eta][1] + (Q1_fft[k_eta][1]+Q2_fft[k_eta][1]+Q3_fft[k_eta][1])/6.);
-		  
-		  //tem = scale3*wtN[i]*wtN[j]*wtN[k]*h_eta*h_eta*h_eta;
-		  tp0 += IntM[0]*Q_re - IntM[1]*Q_im;
-		  tp2 += IntM[1*2]*Q_re - IntM[1*2+1]*Q_im;
-		  tp3 += IntM[2*2]*Q_re - IntM[2*2+1]*Q_im;
-		  tp4 += IntM[3*2]*Q_re - IntM[3*2+1]*Q_im;
-		  tp5 += IntM[4*2]*Q_re - IntM[4*2+1]*Q_im;
-		}
-      }
-    }	     
+  proj = ProjectRK4Stages(qHat, Q1_fft, Q2_fft, Q3_fft, nu);							// project the combination of the four stages of RK4 onto the DG basis in every velocity cell
+  #pragma omp parallel for private(k_v,tp0,tp2,tp3,tp4,tp5) shared(l,l_local,proj,U,dU)   //reduction(+: tmp0, tmp2, tmp3, tmp4, tmp5)
+  for(int kt=chunk_kt*grid_rank_modes;kt<chunk_kt*(grid_rank_modes+1);kt++){						// only the velocity cells of this process (see RK4_Inhomo_Apply)
+    tp0 = proj[5*kt]; tp2 = proj[5*kt+1]; tp3 = proj[5*kt+2]; tp4 = proj[5*kt+3]; tp5 = proj[5*kt+4];
     //tmp0 += tp0; tmp2 += dv*tp2 + Gridv((double)j1)*tp0; tmp3 += dv*tp3 +Gridv((double)j2)*tp0 ;tmp4 += dv*tp4 + Gridv((double)j3)*tp0;  //tmp5 += (Gridv((double)j1)*Gridv((double)j1) + Gridv((double)j2)*Gridv((double)j2) + Gridv((double)j3)*Gridv((double)j3))*tp0 +dv*dv*tp5+2*dv*(Gridv((double)j1)*tp2 + Gridv((double)j2)*tp3 +Gridv((double)j3)*tp4);     
 	//tmp5 += dv*dv*tp5 -  (Gridv((double)j1)*Gridv((double)j1) + Gridv((double)j2)*Gridv((double)j2) + Gridv((double)j3)*Gridv((double)j3))*tp0 + 2*(Gridv((double)j1)*(dv*tp2 + Gridv((double)j1)*tp0) + Gridv((double)j2)*(dv*tp3 + Gridv((double)j2)*tp0) + Gridv((double)j3)*(dv*tp4 + Gridv((double)j3)*tp0));
 	  
-    k_v = l*size_v + kt;      
+    k_v = l_local*size_v + kt;																		// U holds the cells of the space-steps of this process (see FetchCollisionCells)
     tp0 = U[k_v*6+0] + U[k_v*6+5]/4. + dt*tp0/scalev/scaleL/scale3;
     tp2 = U[k_v*6+2] + dt*tp2*12./scalev/scaleL/scale3;
     tp3 = U[k_v*6+3] + dt*tp3*12./scalev/scaleL/scale3;
@@ -902,74 +1134,67 @@ int i,j,k, j1, j2, j3, k_v, k_eta, kk, l_local;
 
 void RK4_Inhomo(double *f, int l, fftw_complex *qHat, double **conv_weights, double *U, double *dU) //4-th RK. yn=yn+(3*k1+k2+k3+k4)/6
 {
-  int i,j,k, j1, j2, j3, k_v, k_eta, kk,l_local;
-  double Q_re, Q_im, tp0, tp2, tp3,tp4,tp5, tmp0=0., tmp2=0., tmp3=0., tmp4=0.,tmp5=0., tem;
+  int i;
 
-  l_local = l%chunk_Nx;
+  CollisionWorkspace *ws = CurrentCollisionWorkspace();								// the stages are stored in this thread's workspace (the global buffers unless the space-steps are run concurrently)
+  double *Q = ws->Q, *f1 = ws->f1, *Q1 = ws->Q1;
+  fftw_complex *Q1_fft = ws->Q1_fft, *Q2_fft = ws->Q2_fft, *Q3_fft = ws->Q3_fft;
 
-  FS(qHat, fftOut); 																	// set fftOut to the Fourier series representation of qHat (i.e. the IFFT of qHat)
+  FS(qHat, Q); 																		// set Q to the Fourier series representation of qHat (i.e. the IFFT of qHat)
   //ifft3D(qHat, fftOut);
   #pragma omp parallel for private(i) shared(Q,fftOut,f1,f)
   for(i=0;i<size_ft;i++)																// calculate the first step of RK4
   {
-    Q[i] = fftOut[i][0];																// this is Q(Fn, Fn) so that Kn^1 = dt*Q(Fn, Fn) = dt*Q[i]
     f1[i] = f[i] + dt*Q[i]*nu; 															// this is Fn + Kn^1(*nu...?) BUG: this evolution (only on node values) is not consistent with our conservation routine, which preserves the exact moments of the {1,v,|v|^{2}} approximations
   }
 
   ComputeQ(f1, Q1_fft, conv_weights);								// calculate the Fourier transform of Q(f1,M) using conv_weights1 & conv_weights2 for the weights in the convolution, then store the results of the Fourier transform in Q1_fft
   conserveMoments(Q1_fft);   														// perform the explicit conservation calculation on Kn2^ = Q^(f1,f1) = Q1_fft
 
-  FS(Q1_fft, fftOut);																	// set fftOut to the Fourier series representation of Q1_fft (i.e. the IFFT of Q1_fft, so that Kn^2 = fftOut = Q(Fn + dt*Kn^1, Fn + dt*Kn^1) )
+  FS(Q1_fft, Q1);																	// set Q1 to the Fourier series representation of Q1_fft (i.e. the IFFT of Q1_fft, so that Kn^2 = Q1 = Q(Fn + dt*Kn^1, Fn + dt*Kn^1) )
   //ifft3D(Q1_fft, fftOut);
   #pragma omp parallel for private(i) shared(Q,Q1,fftOut,f1,f)
   for(i=0;i<size_ft;i++)																// calculate the second step of RK4
   {
-    Q1[i] = fftOut[i][0];
     f1[i] = f[i] +  0.5*dt*Q[i]*nu + 0.5*dt*Q1[i]*nu;
   }
 
   ComputeQ(f1, Q2_fft, conv_weights);								// calculate the Fourier tranform of Q(f1,M) using conv_weights1 & conv_weights2 for the weights in the convolution, then store the results of the Fourier transform in Q2_fft
   conserveMoments(Q2_fft);   //conserves k3
 
-  FS(Q2_fft, fftOut);
+  FS(Q2_fft, Q1);
   //ifft3D(Q2_fft, fftOut);
   #pragma omp parallel for private(i) shared(Q,Q1,fftOut,f1,f)
   for(i=0;i<size_ft;i++)																// calculate the third step of RK4
   {
-    Q1[i] = fftOut[i][0];
     f1[i] = f[i] + 0.5*Q[i]*nu + 0.5*Q1[i]*nu;
   }
 
   ComputeQ(f1, Q3_fft, conv_weights);								// calculate the Fourier transform of Q(f1,M) using conv_weights1 & conv_weights2 for the weights in the convolution, then store the results of the Fourier transform in Q3_fft
   conserveMoments(Q3_fft);                //conserves k4
 
-  #pragma omp parallel for schedule(dynamic) private(j1,j2,j3,i,j,k,k_v,k_eta,kk,Q_re, Q_im) shared(l, l_local, qHat,U, dU) reduction(+:tp0, tp2,tp3,tp4, tp5)  // calculate the fourth step of RK4 (still in Fourier space though?!) - reduction(+: tmp0, tmp2, tmp3, tmp4, tmp5)
-  for(int kt=0;kt<size_v;kt++){
-    j3 = kt % Nv; j2 = ((kt-j3)/Nv) % Nv; j1 = (kt - j3 - Nv*j2)/(Nv*Nv);
-    tp0=0.; tp2=0.; tp3=0.; tp4=0.; tp5=0.;
-    for(i=0;i<N;i++){
-      for(j=0;j<N;j++){
-		for(k=0;k<N;k++){
-		  k_eta = k + N*(j + N*i);
-
-		  IntModes(i,j,k,j1,j2,j3,IntM); //the global IntM must be declared as threadprivate; BUG: forgot to uncomment this and thus IntM=0 !!
-
-		  Q_re = nu*(0.5*qHat[k_eta][0] + (Q1_fft[k_eta][0]+Q2_fft[k_eta][0]+Q3_fft[k_eta][0])/6.);
-		  Q_im = nu*(0.5*qHat[k_eta][1] + (Q1_fft[k_eta][1]+Q2_fft[k_eta][1]+Q3_fft[k_eta][1])/6.);
-
-		  //tem = scale3*wtN[i]*wtN[j]*wtN[k]*h_eta*h_eta*h_eta;
-		  tp0 += IntM[0]*Q_re - IntM[1]*Q_im;
-		  tp2 += IntM[1*2]*Q_re - IntM[1*2+1]*Q_im;
-		  tp3 += IntM[2*2]*Q_re - IntM[2*2+1]*Q_im;
-		  tp4 += IntM[3*2]*Q_re - IntM[3*2+1]*Q_im;
-		  tp5 += IntM[4*2]*Q_re - IntM[4*2+1]*Q_im;
-		}
-      }
-    }
+  RK4_Inhomo_Update(l, qHat, Q1_fft, Q2_fft, Q3_fft, U, dU);						// combine the four stages and project the increment onto the DG basis at the space-step l
+}
+
+void RK4_Inhomo_Update(int l, fftw_complex *qHat, fftw_complex *Q1_hat, fftw_complex *Q2_hat, fftw_complex *Q3_hat, double *U, double *dU)	// final step of RK4_Inhomo: combine the Fourier transforms of the four stages & project the result onto the DG basis
+{
+  RK4_Inhomo_Apply(l, ProjectRK4Stages(qHat, Q1_hat, Q2_hat, Q3_hat, nu), U, dU);		// project the combination of the four stages of RK4 onto the DG basis in every velocity cell & update the space-step l with it
+}
+
+void RK4_Inhomo_Apply(int l, double *proj, double *U, double *dU)					// update the DG coefficients at the space-step l with the projected increment proj (tp0, tp2, tp3, tp4 & tp5 of cell kt at 5*kt,...,5*kt+4)
+{
+  int k_v, l_local;
+  double tp0, tp2, tp3,tp4,tp5;
+
+  l_local = l%chunk_Nx;
+
+  #pragma omp parallel for private(k_v,tp0,tp2,tp3,tp4,tp5) shared(l,l_local,proj,U,dU)   // calculate the fourth step of RK4 (still in Fourier space though?!) - reduction(+: tmp0, tmp2, tmp3, tmp4, tmp5)
+  for(int kt=chunk_kt*grid_rank_modes;kt<chunk_kt*(grid_rank_modes+1);kt++){						// each process holding this space-step updates only its own velocity cells (all of them unless the modes are shared, see ProcessGrid.cpp)
+    tp0 = proj[5*kt]; tp2 = proj[5*kt+1]; tp3 = proj[5*kt+2]; tp4 = proj[5*kt+3]; tp5 = proj[5*kt+4];
     //tmp0 += tp0; tmp2 += dv*tp2 + Gridv((double)j1)*tp0; tmp3 += dv*tp3 +Gridv((double)j2)*tp0 ;tmp4 += dv*tp4 + Gridv((double)j3)*tp0;  //tmp5 += (Gridv((double)j1)*Gridv((double)j1) + Gridv((double)j2)*Gridv((double)j2) + Gridv((double)j3)*Gridv((double)j3))*tp0 +dv*dv*tp5+2*dv*(Gridv((double)j1)*tp2 + Gridv((double)j2)*tp3 +Gridv((double)j3)*tp4);
 	//tmp5 += dv*dv*tp5 -  (Gridv((double)j1)*Gridv((double)j1) + Gridv((double)j2)*Gridv((double)j2) + Gridv((double)j3)*Gridv((double)j3))*tp0 + 2*(Gridv((double)j1)*(dv*tp2 + Gridv((double)j1)*tp0) + Gridv((double)j2)*(dv*tp3 + Gridv((double)j2)*tp0) + Gridv((double)j3)*(dv*tp4 + Gridv((double)j3)*tp0));
 
-    k_v = l*size_v + kt;
+    k_v = l_local*size_v + kt;																		// U holds the cells of the space-steps of this process (see FetchCollisionCells)
     tp0 = U[k_v*6+0] + U[k_v*6+5]/4. + dt*tp0/scalev/scaleL/scale3;
     tp2 = U[k_v*6+2] + dt*tp2*12./scalev/scaleL/scale3;
     tp3 = U[k_v*6+3] + dt*tp3*12./scalev/scaleL/scale3;
@@ -986,19 +1211,18 @@ void RK4_Inhomo(double *f, int l, fftw_complex *qHat, double **conv_weights, dou
 
 void RK4_FandL_Homo(double *f, fftw_complex *qHat, double **conv_weights, fftw_complex *qHat_linear, double **conv_weights_linear, double *U, double *dU) //4-th RK. yn=yn+(3*k1+k2+k3+k4)/6
 {
-int i,j,k, j1, j2, j3, k_v, k_eta, kk, l_local, k_loc;
-  double Q_re, Q_im, tp0, tp2, tp3,tp4,tp5, tmp0=0., tmp2=0., tmp3=0., tmp4=0.,tmp5=0., tem;
+int i, k_v, k_loc;
+  double tp0, tp2, tp3,tp4,tp5, *proj;
 
   #pragma omp parallel for private(i) shared(qHat, qHat_linear)
   for(i=0;i<size_ft;i++){
     qHat[i][0] += qHat_linear[i][0];
 	qHat[i][1] += qHat_linear[i][1];
   }
-  FS(qHat, fftOut);
+  FS(qHat, Q);
 
   #pragma omp parallel for private(i) shared(Q,fftOut,f1,f)
   for(i=0;i<size_ft;i++){
-    Q[i] = fftOut[i][0];
     f1[i] = f[i] + dt*Q[i]*nu; //BUG: this evolution (only on node values) is not consistent with our conservation routine, which preserves the exact moments of the {1,v,|v|^{2}} approximations
   }
 
@@ -1011,11 +1235,10 @@ int i,j,k, j1, j2, j3, k_v, k_eta, kk, l_local, k_loc;
 	Q1_fft[i][1] += Q1_fft_linear[i][1];
   }
 
-  FS(Q1_fft, fftOut);
+  FS(Q1_fft, Q1);
 
   #pragma omp parallel for private(i) shared(Q,Q1,fftOut,f1,f)
   for(i=0;i<size_ft;i++){
-    Q1[i] = fftOut[i][0];
     f1[i] = f[i] +  0.5*dt*Q[i]*nu + 0.5*dt*Q1[i]*nu;
   }
 
@@ -1027,11 +1250,10 @@ int i,j,k, j1, j2, j3, k_v, k_eta, kk, l_local, k_loc;
     Q2_fft[i][0] += Q2_fft_linear[i][0];
 	Q2_fft[i][1] += Q2_fft_linear[i][1];
   }
-  FS(Q2_fft, fftOut);
+  FS(Q2_fft, Q1);
   //ifft3D(Q2_fft, fftOut);
   #pragma omp parallel for private(i) shared(Q,Q1,fftOut,f1,f)
   for(i=0;i<size_ft;i++){
-    Q1[i] = fftOut[i][0];
     f1[i] = f[i] + 0.5*dt*Q[i]*nu + 0.5*dt*Q1[i]*nu;
   }
 
@@ -1043,30 +1265,11 @@ int i,j,k, j1, j2, j3, k_v, k_eta, kk, l_local, k_loc;
     Q3_fft[i][0] += Q3_fft_linear[i][0];
 	Q3_fft[i][1] += Q3_fft_linear[i][1];
   }
-	#pragma omp parallel for schedule(dynamic) private(k_loc,j1,j2,j3,i,j,k,k_v,k_eta,kk,Q_re, Q_im, tp0, tp2,tp3,tp4, tp5) shared(qHat,U, dU)   // calculate the fourth step of RK4 (still in Fourier space though?!) - reduction(+: tmp0, tmp2, tmp3, tmp4, tmp5)
-	for(k_v = myrank_mpi*chunksize_dg; k_v < (myrank_mpi+1)*chunksize_dg; k_v++){
-	  j3 = k_v % Nv; j2 = ((k_v-j3)/Nv) % Nv; j1 = (k_v - j3 - Nv*j2)/(Nv*Nv);
-		k_loc = k_v%chunksize_dg;
-	  tp0=0.; tp2=0.; tp3=0.; tp4=0.; tp5=0.;
-	  for(i=0;i<N;i++){
-		for(j=0;j<N;j++){
-			for(k=0;k<N;k++){
-			  k_eta = k + N*(j + N*i);
-
-			  IntModes(i,j,k,j1,j2,j3,IntM); //the global IntM must be declared as threadprivate; BUG: forgot to uncomment this and thus IntM=0 !!
-
-			  Q_re = nu*(0.5*qHat[k_eta][0] + (Q1_fft[k_eta][0]+Q2_fft[k_eta][0]+Q3_fft[k_eta][0])/6.);
-			  Q_im = nu*(0.5*qHat[k_eta][1] + (Q1_fft[k_eta][1]+Q2_fft[k_eta][1]+Q3_fft[k_eta][1])/6.);
-
-			  //tem = scale3*wtN[i]*wtN[j]*wtN[k]*h_eta*h_eta*h_eta;
-			  tp0 += IntM[0]*Q_re - IntM[1]*Q_im;
-			  tp2 += IntM[1*2]*Q_re - IntM[1*2+1]*Q_im;
-			  tp3 += IntM[2*2]*Q_re - IntM[2*2+1]*Q_im;
-			  tp4 += IntM[3*2]*Q_re - IntM[3*2+1]*Q_im;
-			  tp5 += IntM[4*2]*Q_re - IntM[4*2+1]*Q_im;
-			}
-		}
-	  }
+	proj = ProjectRK4Stages(qHat, Q1_fft, Q2_fft, Q3_fft, nu);							// project the combination of the four stages of RK4 onto the DG basis in every velocity cell
+	#pragma omp parallel for private(k_loc,k_v,tp0,tp2,tp3,tp4,tp5) shared(proj,U,dU)   // calculate the fourth step of RK4 (still in Fourier space though?!) - reduction(+: tmp0, tmp2, tmp3, tmp4, tmp5)
+	for(k_v = chunk_kt*grid_rank_modes; k_v < chunk_kt*(grid_rank_modes+1); k_v++){					// only the velocity cells of this process (see RK4_Inhomo_Apply)
+		k_loc = k_v - chunk_kt*grid_rank_modes;
+	  tp0 = proj[5*k_v]; tp2 = proj[5*k_v+1]; tp3 = proj[5*k_v+2]; tp4 = proj[5*k_v+3]; tp5 = proj[5*k_v+4];
 	  //tmp0 += tp0; tmp2 += dv*tp2 + Gridv((double)j1)*tp0; tmp3 += dv*tp3 +Gridv((double)j2)*tp0 ;tmp4 += dv*tp4 + Gridv((double)j3)*tp0;  //tmp5 += (Gridv((double)j1)*Gridv((double)j1) + Gridv((double)j2)*Gridv((double)j2) + Gridv((double)j3)*Gridv((double)j3))*tp0 +dv*dv*tp5+2*dv*(Gridv((double)j1)*tp2 + Gridv((double)j2)*tp3 +Gridv((double)j3)*tp4);
 		//tmp5 += dv*dv*tp5 -  (Gridv((double)j1)*Gridv((double)j1) + Gridv((double)j2)*Gridv((double)j2) + Gridv((double)j3)*Gridv((double)j3))*tp0 + 2*(Gridv((double)j1)*(dv*tp2 + Gridv((double)j1)*tp0) + Gridv((double)j2)*(dv*tp3 + Gridv((double)j2)*tp0) + Gridv((double)j3)*(dv*tp4 + Gridv((double)j3)*tp0));
 
@@ -1086,69 +1289,47 @@ int i,j,k, j1, j2, j3, k_v, k_eta, kk, l_local, k_loc;
 
 void RK4_Homo(double *f, fftw_complex *qHat, double **conv_weights, double *U, double *dU) //4-th RK. yn=yn+(3*k1+k2+k3+k4)/6
 {
-  int i,j,k, j1, j2, j3, k_v, k_eta, kk, k_loc;
-  double Q_re, Q_im, tp0, tp2, tp3,tp4,tp5, tmp0=0., tmp2=0., tmp3=0., tmp4=0.,tmp5=0., tem;
+  int i, k_v, k_loc;
+  double tp0, tp2, tp3,tp4,tp5, *proj;
 
-  FS(qHat, fftOut); 																	// set fftOut to the Fourier series representation of qHat (i.e. the IFFT of qHat)
+  FS(qHat, Q); 																		// set Q to the Fourier series representation of qHat (i.e. the IFFT of qHat)
   //ifft3D(qHat, fftOut);
   #pragma omp parallel for private(i) shared(Q,fftOut,f1,f)
   for(i=0;i<size_ft;i++)																// calculate the first step of RK4
   {
-    Q[i] = fftOut[i][0];																// this is Q(Fn, Fn) so that Kn^1 = dt*Q(Fn, Fn) = dt*Q[i]
     f1[i] = f[i] + dt*Q[i]*nu; 															// this is Fn + Kn^1(*nu...?) BUG: this evolution (only on node values) is not consistent with our conservation routine, which preserves the exact moments of the {1,v,|v|^{2}} approximations
   }
 
   ComputeQ(f1, Q1_fft, conv_weights);													// calculate the Fourier tranform of Q(f1,f1) using conv_weights for the weights in the convolution, then store the results of the Fourier transform in Q1_fft
   conserveMoments(Q1_fft);   															// perform the explicit conservation calculation on Kn2^ = Q^(f1,f1) = Q1_fft
 
-  FS(Q1_fft, fftOut);																	// set fftOut to the Fourier series representation of Q1_fft (i.e. the IFFT of Q1_fft, so that Kn^2 = fftOut = Q(Fn + dt*Kn^1, Fn + dt*Kn^1) )
+  FS(Q1_fft, Q1);																	// set Q1 to the Fourier series representation of Q1_fft (i.e. the IFFT of Q1_fft, so that Kn^2 = Q1 = Q(Fn + dt*Kn^1, Fn + dt*Kn^1) )
   //ifft3D(Q1_fft, fftOut);
   #pragma omp parallel for private(i) shared(Q,Q1,fftOut,f1,f)
   for(i=0;i<size_ft;i++)																// calculate the second step of RK4
   {
-    Q1[i] = fftOut[i][0];
     f1[i] = f[i] +  0.5*dt*Q[i]*nu + 0.5*dt*Q1[i]*nu;
   }
 
   ComputeQ(f1, Q2_fft, conv_weights); //collides
   conserveMoments(Q2_fft);   //conserves k3
 
-  FS(Q2_fft, fftOut);
+  FS(Q2_fft, Q1);
   //ifft3D(Q2_fft, fftOut);
   #pragma omp parallel for private(i) shared(Q,Q1,fftOut,f1,f)
   for(i=0;i<size_ft;i++)																// calculate the third step of RK4
   {
-    Q1[i] = fftOut[i][0];
     f1[i] = f[i] + 0.5*Q[i]*nu + 0.5*Q1[i]*nu;
   }
 
   ComputeQ(f1, Q3_fft, conv_weights); //collides
   conserveMoments(Q3_fft);                //conserves k4
 
-  #pragma omp parallel for schedule(dynamic) private(k_loc,j1,j2,j3,i,j,k,k_v,k_eta,kk,Q_re, Q_im, tp0, tp2,tp3,tp4, tp5) shared(qHat,U, dU)   // calculate the fourth step of RK4 (still in Fourier space though?!) - reduction(+: tmp0, tmp2, tmp3, tmp4, tmp5)
-  for(k_v = myrank_mpi*chunksize_dg; k_v < (myrank_mpi+1)*chunksize_dg; k_v++){
-    j3 = k_v % Nv; j2 = ((k_v-j3)/Nv) % Nv; j1 = (k_v - j3 - Nv*j2)/(Nv*Nv);
-	k_loc = k_v%chunksize_dg;
-    tp0=0.; tp2=0.; tp3=0.; tp4=0.; tp5=0.;
-    for(i=0;i<N;i++){
-      for(j=0;j<N;j++){
-		for(k=0;k<N;k++){
-		  k_eta = k + N*(j + N*i);
-
-		  IntModes(i,j,k,j1,j2,j3,IntM); //the global IntM must be declared as threadprivate; BUG: forgot to uncomment this and thus IntM=0 !!
-
-		  Q_re = nu*(0.5*qHat[k_eta][0] + (Q1_fft[k_eta][0]+Q2_fft[k_eta][0]+Q3_fft[k_eta][0])/6.);
-		  Q_im = nu*(0.5*qHat[k_eta][1] + (Q1_fft[k_eta][1]+Q2_fft[k_eta][1]+Q3_fft[k_eta][1])/6.);
-
-		  //tem = scale3*wtN[i]*wtN[j]*wtN[k]*h_eta*h_eta*h_eta;
-		  tp0 += IntM[0]*Q_re - IntM[1]*Q_im;
-		  tp2 += IntM[1*2]*Q_re - IntM[1*2+1]*Q_im;
-		  tp3 += IntM[2*2]*Q_re - IntM[2*2+1]*Q_im;
-		  tp4 += IntM[3*2]*Q_re - IntM[3*2+1]*Q_im;
-		  tp5 += IntM[4*2]*Q_re - IntM[4*2+1]*Q_im;
-		}
-      }
-    }
+  proj = ProjectRK4Stages(qHat, Q1_fft, Q2_fft, Q3_fft, nu);							// project the combination of the four stages of RK4 onto the DG basis in every velocity cell
+  #pragma omp parallel for private(k_loc,k_v,tp0,tp2,tp3,tp4,tp5) shared(proj,U,dU)   // calculate the fourth step of RK4 (still in Fourier space though?!) - reduction(+: tmp0, tmp2, tmp3, tmp4, tmp5)
+  for(k_v = chunk_kt*grid_rank_modes; k_v < chunk_kt*(grid_rank_modes+1); k_v++){					// only the velocity cells of this process (see RK4_Inhomo_Apply)
+	k_loc = k_v - chunk_kt*grid_rank_modes;
+    tp0 = proj[5*k_v]; tp2 = proj[5*k_v+1]; tp3 = proj[5*k_v+2]; tp4 = proj[5*k_v+3]; tp5 = proj[5*k_v+4];
     //tmp0 += tp0; tmp2 += dv*tp2 + Gridv((double)j1)*tp0; tmp3 += dv*tp3 +Gridv((double)j2)*tp0 ;tmp4 += dv*tp4 + Gridv((double)j3)*tp0;  //tmp5 += (Gridv((double)j1)*Gridv((double)j1) + Gridv((double)j2)*Gridv((double)j2) + Gridv((double)j3)*Gridv((double)j3))*tp0 +dv*dv*tp5+2*dv*(Gridv((double)j1)*tp2 + Gridv((double)j2)*tp3 +Gridv((double)j3)*tp4);
 	//tmp5 += dv*dv*tp5 -  (Gridv((double)j1)*Gridv((double)j1) + Gridv((double)j2)*Gridv((double)j2) + Gridv((double)j3)*Gridv((double)j3))*tp0 + 2*(Gridv((double)j1)*(dv*tp2 + Gridv((double)j1)*tp0) + Gridv((double)j2)*(dv*tp3 + Gridv((double)j2)*tp0) + Gridv((double)j3)*(dv*tp4 + Gridv((double)j3)*tp0));
 
@@ -1170,100 +1351,126 @@ void ComputeDFTofMaxwellian(double *UMaxwell, double **fMaxwell, fftw_complex **
 {
 	setInit_spectral(UMaxwell, fMaxwell); 												// Take the coefficient of the DG solution from the advection step, and project them onto the grid used for the spectral method to perform the collision step
 
-	for(int l=chunk_Nx*myrank_mpi;l<chunk_Nx*(myrank_mpi+1) && l<Nx;l++)
+	for(int l=chunk_Nx*grid_rank_x;l<chunk_Nx*(grid_rank_x+1) && l<Nx;l++)
 	{
-		for(int i=0;i<size_ft;i++)														// initialise the input of the FFT
-		{
-			fftIn[i][0] = fMaxwell[l%chunk_Nx][i];												// set the real part to the sampling of the Maxwellian stored in fMaxwell
-			fftIn[i][1] = 0.;														// set the imaginary part to zero
-			fft3D(fftIn, DFTMax[l%chunk_Nx]);														// perform the FFT of fftIn and store the result in DFTMaxwell
-		}
+		fft3D(fMaxwell[l%chunk_Nx], DFTMax[l%chunk_Nx]);										// perform the FFT of the sampling of the Maxwellian stored in fMaxwell and store the result in DFTMaxwell
 	}
 
 }
 
-void ComputeQLinear(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat, double **conv_weights)		// function to calculate the discrete Fourier transform of the linear collision operator Q(f, M) at a given f(Hat)
+void ComputeQLinear(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat, double **conv_weights)		// function to calculate the discrete Fourier transform of the linear collision operator Q(f, M) at a given f(Hat), using the chosen collision engine
+{
+	if(collision_engine == ENGINE_MATRIXFREE)
+	{
+		ComputeQLinear_MatrixFree(f, Maxwell_fftOut, qHat);
+	}
+	else if(collision_engine == ENGINE_FFT)
+	{
+		ComputeQLinear_FFT(f, Maxwell_fftOut, qHat);
+	}
+	else if(collision_engine == ENGINE_LOWRANK)
+	{
+		ComputeQLinear_LowRank(f, Maxwell_fftOut, qHat);
+	}
+	else if(FloatWeights)
+	{
+		ComputeQLinear_FloatWeights(f, Maxwell_fftOut, qHat);
+	}
+	else if(PackedWeights)
+	{
+		ComputeQLinear_PackedWeights(f, Maxwell_fftOut, qHat);
+	}
+	else if(SymmetricWeights)
+	{
+		ComputeQLinear_SymmetricWeights(f, Maxwell_fftOut, qHat);
+	}
+	else if(direct_kernel != KERNEL_SCALAR)
+	{
+		ComputeQLinear_DirectSIMD(f, Maxwell_fftOut, qHat, conv_weights);
+	}
+	else
+	{
+		ComputeQLinear_Direct(f, Maxwell_fftOut, qHat, conv_weights);
+	}
+	GatherModes(qHat);																			// collect the modes computed by the other processes (only in Homogeneous runs with more than one process)
+	CheckComputeQLinear(f, Maxwell_fftOut, qHat);												// the first time through, compare with ComputeQLinear_Direct (if CheckEngine is true)
+}
+
+void ComputeQLinear_Direct(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat, double **conv_weights)	// function to calculate the discrete Fourier transform of the linear collision operator Q(f, M) at a given f(Hat), reading the weights from conv_weights
 {
 	int i, j, k, l, m, n, x, y, z;												// declare (i,j,k) (the indices for a given value of given ki = ki_(i,j,k)), (l,m,n) (counters for the quadrature to calculate the integral w.r.t. eta in the evaluation of qHat and so also represent the indices of a given eta = eta_(l,m,n)) & (x,y,z) (the indices for the value of a subtraction in the calculation, namely eta_(x,y,z) = ki_(i,j,k) - eta_(l,m,n))
+	int ki, ki_end, t, threads = ModeThreads();									// declare ki (the index of ki_(i,j,k), k + N*(j + N*i)), ki_end & t (the end of the range of modes of thread t) & threads (the number of ranges the modes are shared out between)
 	int start_i, start_j, start_k, end_i, end_j, end_k;							// declare start_i, start_j & start_k (the indices for the values of the lower bounds of integration in computation of the convolution, corresponding to the lowest point where both functions are non-zero, in each velocity direction) and end_i, end_j & end_k (the indices for the values of the upper bounds of integration in computation of the convolution, corresponding to the highest point where both functions are non-zero, in each velocity direction)
 	double tempD, tmp0, tmp1;													// declare tempD (the value of the convolution weight at a given ki & eta), tmp0 (which will become the real part of qHat) & tmp1 (which will become the imaginary part of qHat)
 //	double tempD1, tempD2;														// declare tempD1 & tempD2 (the values of the convolution weights at a given ki & eta, separated to allow for multispecies calculations with different masses)
 	double prefactor = h_eta*h_eta*h_eta; 										// declare prefactor (the value of h_eta^3, as no scale3 in Fourier space) and set its value
 
-	for(i=0;i<size_ft;i++)														// initialise the input of the FFT
-	{
-		fftIn[i][0] = f[i];														// set the real part to the sampling of the solution stored in f
-		fftIn[i][1] = 0.;														// set the imaginary part to zero
-	}
-
-	fft3D(fftIn, fftOut);														// perform the FFT of fftIn and store the result in fftOut
+	fft3D(f, fftOut);														// perform the FFT of f and store the result in fftOut
 
-	#pragma omp parallel for schedule(dynamic) private(i,j,k,l,m,n,x,y,z,start_i,start_j,start_k,end_i,end_j,end_k,tempD) shared(qHat, fftOut, conv_weights) reduction(+:tmp0, tmp1)
-	for(i=0;i<N;i++) 															// loop through all points in the ki_1
+	#pragma omp parallel for schedule(static,1) num_threads(threads) private(t,ki,ki_end,i,j,k,l,m,n,x,y,z,start_i,start_j,start_k,end_i,end_j,end_k,tempD,tmp0,tmp1) shared(qHat, fftOut, conv_weights)
+	for(t=0;t<threads;t++)														// give each thread one range of modes of about the same cost (see ModeSchedule.cpp)
 	{
-		for(j=0;j<N;j++)														// loop through all points in the ki_2
+		for(ki=ModeStart(t, threads), ki_end=ModeStart(t+1, threads);ki<ki_end;ki++)	// loop through all the modes ki(i,j,k) of this range
 		{
-			for(k=0;k<N;k++)													// loop through all points in the ki_3
+			i = ki/(N*N); j = (ki/N)%N; k = ki%N;								// find the indices (i,j,k) of ki_(i,j,k)
+			//figure out the windows for the convolutions (i.e. where eta(l,m,n) and ki(i,j,k)-eta(l,m,n) are in the domain)
+			if( i < N/2 ) 														// if ki_1(i) < 0 then the values of l for which f(ki_1(i)-eta_1(l))*f(eta_1(l)) give a non-zero product range need -Lv < eta_1 <= ki_1 + Lv/2, due to the support of f being -Lv to Lv
 			{
-				//figure out the windows for the convolutions (i.e. where eta(l,m,n) and ki(i,j,k)-eta(l,m,n) are in the domain)
-				if( i < N/2 ) 													// if ki_1(i) < 0 then the values of l for which f(ki_1(i)-eta_1(l))*f(eta_1(l)) give a non-zero product range need -Lv < eta_1 <= ki_1 + Lv/2, due to the support of f being -Lv to Lv
-				{
-					start_i = 0;												// set start_i to 0 to represent -Lv as the lower bound of integration
-					end_i = i + N/2 + 1;										// set end_i to i + N/2 + 1 to represent eta_1(i+N/2+1/2) as the upper bound of integration (with +1 there so that all cells less than index end_i are integrated over)
-				}
-				else 															// if ki_1(i) >= 0 then the values of l for which f(ki_1(i)-eta_1(l))*f(eta_1(l)) give a non-zero product range need ki_1 - Lv/2 < eta_1 <= Lv, due to the support of f being -Lv to Lv
-				{
-					start_i = i - N/2 + 1;										// set start_i to i - N/2 + 1 to represent eta_1(i) - Lv as the lower bound of integration (with +1 since ki_1[i-N/2] - eta_1[i] actually overlaps with eta_1[-1/2] = -Lv, where f(-Lv)=0, so start at the next index)
-					end_i = N;													// set end_i to N to represent Lv as the upper bound of integration (i.e. integrate over all cells with index less than N)
-				}
+				start_i = 0;													// set start_i to 0 to represent -Lv as the lower bound of integration
+				end_i = i + N/2 + 1;											// set end_i to i + N/2 + 1 to represent eta_1(i+N/2+1/2) as the upper bound of integration (with +1 there so that all cells less than index end_i are integrated over)
+			}
+			else 																// if ki_1(i) >= 0 then the values of l for which f(ki_1(i)-eta_1(l))*f(eta_1(l)) give a non-zero product range need ki_1 - Lv/2 < eta_1 <= Lv, due to the support of f being -Lv to Lv
+			{
+				start_i = i - N/2 + 1;											// set start_i to i - N/2 + 1 to represent eta_1(i) - Lv as the lower bound of integration (with +1 since ki_1[i-N/2] - eta_1[i] actually overlaps with eta_1[-1/2] = -Lv, where f(-Lv)=0, so start at the next index)
+				end_i = N;														// set end_i to N to represent Lv as the upper bound of integration (i.e. integrate over all cells with index less than N)
+			}
 
-				if( j < N/2 )													// if ki_2(j) < 0 then the values of m for which f(ki_2(j)-eta_2(m))*f(eta_2(m)) give a non-zero product range need -Lv < eta_2 <= ki_2 + Lv/2, due to the support of f being -Lv to Lv
-				{
-					start_j = 0;												// set start_j to 0 to represent -Lv as the lower bound of integration
-					end_j = j + N/2 + 1;										// set end_j to j + N/2 + 1 to represent eta_2(j+N/2+1/2) as the upper bound of integration (with +1 there so that all cells less than index end_i are integrated over)
-				}
-				else															// if ki_2(j) >= 0 then the values of m for which f(ki_2(j)-eta_2(m))*f(eta_2(m)) give a non-zero product range need ki_2 - Lv/2 < eta_2 <= Lv, due to the support of f being -Lv to Lv
-				{
-					start_j = j - N/2 + 1;										// set start_j to j - N/2 + 1 to represent eta_2(j) - Lv as the lower bound of integration (with +1 since ki_2[j-N/2] - eta_2[j] actually overlaps with eta_2[-1/2] = -Lv, where f(-Lv)=0, so start at the next index)
-					end_j = N;													// set end_j to N to represent Lv as the upper bound of integration (i.e. integrate over all cells with index less than N)
-				}
+			if( j < N/2 )														// if ki_2(j) < 0 then the values of m for which f(ki_2(j)-eta_2(m))*f(eta_2(m)) give a non-zero product range need -Lv < eta_2 <= ki_2 + Lv/2, due to the support of f being -Lv to Lv
+			{
+				start_j = 0;													// set start_j to 0 to represent -Lv as the lower bound of integration
+				end_j = j + N/2 + 1;											// set end_j to j + N/2 + 1 to represent eta_2(j+N/2+1/2) as the upper bound of integration (with +1 there so that all cells less than index end_i are integrated over)
+			}
+			else																// if ki_2(j) >= 0 then the values of m for which f(ki_2(j)-eta_2(m))*f(eta_2(m)) give a non-zero product range need ki_2 - Lv/2 < eta_2 <= Lv, due to the support of f being -Lv to Lv
+			{
+				start_j = j - N/2 + 1;											// set start_j to j - N/2 + 1 to represent eta_2(j) - Lv as the lower bound of integration (with +1 since ki_2[j-N/2] - eta_2[j] actually overlaps with eta_2[-1/2] = -Lv, where f(-Lv)=0, so start at the next index)
+				end_j = N;														// set end_j to N to represent Lv as the upper bound of integration (i.e. integrate over all cells with index less than N)
+			}
 
-				if( k < N/2 )													// if ki_3(k) < 0 then the values of n for which f(ki_3(k)-eta_3(n))*f(eta_3(n)) give a non-zero product range need -Lv < eta_3 <= ki_3 + Lv/2, due to the support of f being -Lv to Lv
-				{
-					start_k = 0;												// set start_k to 0 to represent -Lv as the lower bound of integration
-					end_k = k + N/2 + 1;										// set end_k to k + N/2 + 1 to represent eta_3(k+N/2+1/2) as the upper bound of integration (with +1 there so that all cells less than index end_i are integrated over)
-				}
-				else															// if ki_3(k) >= 0 then the values of n for which f(ki_3(k)-eta_3(n))*f(eta_3(n)) give a non-zero product range need ki_3 - Lv/2 < eta_3 <= Lv, due to the support of f being -Lv to Lv
-				{
-					start_k = k - N/2 + 1;										// set start_k to k - N/2 + 1 to represent eta_3(k) - Lv as the lower bound of integration (with +1 since ki_3[k-N/2] - eta_3[k] actually overlaps with eta_3[-1/2] = -Lv, where f(-Lv)=0, so start at the next index)
-					end_k = N;													// set end_k to N to represent Lv as the upper bound of integration (i.e. integrate over all cells with index less than N)
-				}
-				tmp0=0.; tmp1=0.;												// initialise tmp0 & tmp1 at zero to begin the quadrature
-				for(l=start_i;l<end_i;l++)										// loop through all the quadrature indices in the eta_1 direction that give non-zero contribution
+			if( k < N/2 )														// if ki_3(k) < 0 then the values of n for which f(ki_3(k)-eta_3(n))*f(eta_3(n)) give a non-zero product range need -Lv < eta_3 <= ki_3 + Lv/2, due to the support of f being -Lv to Lv
+			{
+				start_k = 0;													// set start_k to 0 to represent -Lv as the lower bound of integration
+				end_k = k + N/2 + 1;											// set end_k to k + N/2 + 1 to represent eta_3(k+N/2+1/2) as the upper bound of integration (with +1 there so that all cells less than index end_i are integrated over)
+			}
+			else																// if ki_3(k) >= 0 then the values of n for which f(ki_3(k)-eta_3(n))*f(eta_3(n)) give a non-zero product range need ki_3 - Lv/2 < eta_3 <= Lv, due to the support of f being -Lv to Lv
+			{
+				start_k = k - N/2 + 1;											// set start_k to k - N/2 + 1 to represent eta_3(k) - Lv as the lower bound of integration (with +1 since ki_3[k-N/2] - eta_3[k] actually overlaps with eta_3[-1/2] = -Lv, where f(-Lv)=0, so start at the next index)
+				end_k = N;														// set end_k to N to represent Lv as the upper bound of integration (i.e. integrate over all cells with index less than N)
+			}
+			tmp0=0.; tmp1=0.;													// initialise tmp0 & tmp1 at zero to begin the quadrature
+			for(l=start_i;l<end_i;l++)											// loop through all the quadrature indices in the eta_1 direction that give non-zero contribution
+			{
+				for(m=start_j;m<end_j;m++)										// loop through all the quadrature indices in the eta_2 direction that give non-zero contribution
 				{
-					for(m=start_j;m<end_j;m++)									// loop through all the quadrature indices in the eta_2 direction that give non-zero contribution
+					for(n=start_k;n<end_k;n++)									// loop through all the quadrature indices in the eta_3 direction that give non-zero contribution
 					{
-						for(n=start_k;n<end_k;n++)								// loop through all the quadrature indices in the eta_3 direction that give non-zero contribution
-						{
 
-							x = i + N/2 - l;									// set the index x to i + N/2 - l to represent the subtraction eta[x] = ki[i] - eta[l]
-							y = j + N/2 - m;									// set the index y to j + N/2 - m to represent the subtraction eta[y] = ki[j] - eta[m]
-							z = k + N/2 - n;									// set the index z to k + N/2 - n to represent the subtraction eta[z] = ki[k] - eta[n]
+						x = i + N/2 - l;										// set the index x to i + N/2 - l to represent the subtraction eta[x] = ki[i] - eta[l]
+						y = j + N/2 - m;										// set the index y to j + N/2 - m to represent the subtraction eta[y] = ki[j] - eta[m]
+						z = k + N/2 - n;										// set the index z to k + N/2 - n to represent the subtraction eta[z] = ki[k] - eta[n]
 
-							tempD = conv_weights[k + N*(j+ N*i)][n + N*(m + N*l)];
+						tempD = conv_weights[k + N*(j+ N*i)][n + N*(m + N*l)];
 //							tempD1 = conv_weightsA[k + N*(j+ N*i)][n + N*(m + N*l)];
 //							tempD2 = conv_weightsB[k + N*(j+ N*i)][n + N*(m + N*l)];
-							//multiply the weighted fourier coeff product
-							tmp0 += prefactor*wtN[l]*wtN[m]*wtN[n]*(tempD*(Maxwell_fftOut[n + N*(m + N*l)][0]*fftOut[z + N*(y + N*x)][0] - Maxwell_fftOut[n + N*(m + N*l)][1]*fftOut[z + N*(y + N*x)][1]));
-							tmp1 += prefactor*wtN[l]*wtN[m]*wtN[n]*(tempD*(Maxwell_fftOut[n + N*(m + N*l)][0]*fftOut[z + N*(y + N*x)][1] + Maxwell_fftOut[n + N*(m + N*l)][1]*fftOut[z + N*(y + N*x)][0]));
+						//multiply the weighted fourier coeff product
+						tmp0 += prefactor*wtN[l]*wtN[m]*wtN[n]*(tempD*(Maxwell_fftOut[n + N*(m + N*l)][0]*fftOut[z + N*(y + N*x)][0] - Maxwell_fftOut[n + N*(m + N*l)][1]*fftOut[z + N*(y + N*x)][1]));
+						tmp1 += prefactor*wtN[l]*wtN[m]*wtN[n]*(tempD*(Maxwell_fftOut[n + N*(m + N*l)][0]*fftOut[z + N*(y + N*x)][1] + Maxwell_fftOut[n + N*(m + N*l)][1]*fftOut[z + N*(y + N*x)][0]));
 //							tmp0 += prefactor*wtN[l]*wtN[m]*wtN[n]*((2*tempD1+tempD2)*(Maxwell_fftOut[n + N*(m + N*l)][0]*fftOut[z + N*(y + N*x)][0] - Maxwell_fftOut[n + N*(m + N*l)][1]*fftOut[z + N*(y + N*x)][1]));
 //							tmp1 += prefactor*wtN[l]*wtN[m]*wtN[n]*((2*tempD1+tempD2)*(Maxwell_fftOut[n + N*(m + N*l)][0]*fftOut[z + N*(y + N*x)][1] + Maxwell_fftOut[n + N*(m + N*l)][1]*fftOut[z + N*(y + N*x)][0]));
-						}
 					}
 				}
-				qHat[k + N*(j + N*i)][0] = tmp0;								// set the real part of qHat(ki(i,j,k)) to the value tmp0 calculated in the quadrature
-				qHat[k + N*(j + N*i)][1] = tmp1;								// set the imaginary part of qHat(ki(i,j,k)) to the value tmp1 calculated in the quadrature
 			}
+			qHat[k + N*(j + N*i)][0] = tmp0;									// set the real part of qHat(ki(i,j,k)) to the value tmp0 calculated in the quadrature
+			qHat[k + N*(j + N*i)][1] = tmp1;									// set the imaginary part of qHat(ki(i,j,k)) to the value tmp1 calculated in the quadrature
 		}
 	}
 }
@@ -1272,85 +1479,64 @@ void ComputeQLinear(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat,
 void RK4Linear(double *f, fftw_complex *MaxwellHat, int l, fftw_complex *qHat, double **conv_weights, double *U, double *dU)
 {
   double nu_val = nu;	// temp without nu vector
-  int i,j,k, j1, j2, j3, k_v, k_eta, kk,l_local;
-  double Q_re, Q_im, tp0, tp2, tp3,tp4,tp5, tmp0=0., tmp2=0., tmp3=0., tmp4=0.,tmp5=0., tem;
+  int i, k_v, l_local, k_loc;
+  double tp0, tp2, tp3,tp4,tp5, *proj;
 
   l_local = l%chunk_Nx;
 
-  FS(qHat, fftOut); 																	// set fftOut to the Fourier series representation of qHat (i.e. the IFFT of qHat)
+  FS(qHat, Q); 																		// set Q to the Fourier series representation of qHat (i.e. the IFFT of qHat)
   //ifft3D(qHat, fftOut);
   #pragma omp parallel for private(i) shared(Q,fftOut,f1,f)
   for(i=0;i<size_ft;i++)																// calculate the first step of RK4
   {
-    Q[i] = fftOut[i][0];																// this is Q(Fn, Fn) so that Kn^1 = dt*Q(Fn, Fn) = dt*Q[i]
     f1[i] = f[i] + dt*Q[i]*nu_val; 															// this is Fn + Kn^1(*nu...?) BUG: this evolution (only on node values) is not consistent with our conservation routine, which preserves the exact moments of the {1,v,|v|^{2}} approximations
   }
 
   ComputeQLinear(f1, MaxwellHat, Q1_fft, conv_weights);								// calculate the Fourier transform of Q(f1,M) using conv_weights1 & conv_weights2 for the weights in the convolution, then store the results of the Fourier transform in Q1_fft
   conserveMoments(Q1_fft);   														// perform the explicit conservation calculation on Kn2^ = Q^(f1,f1) = Q1_fft
 
-  FS(Q1_fft, fftOut);																	// set fftOut to the Fourier series representation of Q1_fft (i.e. the IFFT of Q1_fft, so that Kn^2 = fftOut = Q(Fn + dt*Kn^1, Fn + dt*Kn^1) )
+  FS(Q1_fft, Q1);																	// set Q1 to the Fourier series representation of Q1_fft (i.e. the IFFT of Q1_fft, so that Kn^2 = Q1 = Q(Fn + dt*Kn^1, Fn + dt*Kn^1) )
   //ifft3D(Q1_fft, fftOut);
   #pragma omp parallel for private(i) shared(Q,Q1,fftOut,f1,f)
   for(i=0;i<size_ft;i++)																// calculate the second step of RK4
   {
-    Q1[i] = fftOut[i][0];
     f1[i] = f[i] +  0.5*dt*Q[i]*nu_val + 0.5*dt*Q1[i]*nu_val;
   }
 
   ComputeQLinear(f1, MaxwellHat, Q2_fft, conv_weights);								// calculate the Fourier tranform of Q(f1,M) using conv_weights1 & conv_weights2 for the weights in the convolution, then store the results of the Fourier transform in Q2_fft
   conserveMoments(Q2_fft);   //conserves k3
 
-  FS(Q2_fft, fftOut);
+  FS(Q2_fft, Q1);
   //ifft3D(Q2_fft, fftOut);
   #pragma omp parallel for private(i) shared(Q,Q1,fftOut,f1,f)
   for(i=0;i<size_ft;i++)																// calculate the third step of RK4
   {
-    Q1[i] = fftOut[i][0];
     f1[i] = f[i] + 0.5*Q[i]*nu_val + 0.5*Q1[i]*nu_val;
   }
 
   ComputeQLinear(f1, MaxwellHat, Q3_fft, conv_weights);								// calculate the Fourier transform of Q(f1,M) using conv_weights1 & conv_weights2 for the weights in the convolution, then store the results of the Fourier transform in Q3_fft
   conserveMoments(Q3_fft);                //conserves k4
 
-  #pragma omp parallel for schedule(dynamic) private(j1,j2,j3,i,j,k,k_v,k_eta,kk,Q_re, Q_im) shared(l, l_local, qHat,U, dU) reduction(+:tp0, tp2,tp3,tp4, tp5)  // calculate the fourth step of RK4 (still in Fourier space though?!) - reduction(+: tmp0, tmp2, tmp3, tmp4, tmp5)
-  for(int kt=0;kt<size_v;kt++){
-    j3 = kt % Nv; j2 = ((kt-j3)/Nv) % Nv; j1 = (kt - j3 - Nv*j2)/(Nv*Nv);
-    tp0=0.; tp2=0.; tp3=0.; tp4=0.; tp5=0.;
-    for(i=0;i<N;i++){
-      for(j=0;j<N;j++){
-		for(k=0;k<N;k++){
-		  k_eta = k + N*(j + N*i);
-
-		  IntModes(i,j,k,j1,j2,j3,IntM); //the global IntM must be declared as threadprivate; BUG: forgot to uncomment this and thus IntM=0 !!
-
-		  Q_re = nu_val*(0.5*qHat[k_eta][0] + (Q1_fft[k_eta][0]+Q2_fft[k_eta][0]+Q3_fft[k_eta][0])/6.);
-		  Q_im = nu_val*(0.5*qHat[k_eta][1] + (Q1_fft[k_eta][1]+Q2_fft[k_eta][1]+Q3_fft[k_eta][1])/6.);
-
-		  //tem = scale3*wtN[i]*wtN[j]*wtN[k]*h_eta*h_eta*h_eta;
-		  tp0 += IntM[0]*Q_re - IntM[1]*Q_im;
-		  tp2 += IntM[1*2]*Q_re - IntM[1*2+1]*Q_im;
-		  tp3 += IntM[2*2]*Q_re - IntM[2*2+1]*Q_im;
-		  tp4 += IntM[3*2]*Q_re - IntM[3*2+1]*Q_im;
-		  tp5 += IntM[4*2]*Q_re - IntM[4*2+1]*Q_im;
-		}
-      }
-    }
+  proj = ProjectRK4Stages(qHat, Q1_fft, Q2_fft, Q3_fft, nu_val);						// project the combination of the four stages of RK4 onto the DG basis in every velocity cell
+  #pragma omp parallel for private(k_v,k_loc,tp0,tp2,tp3,tp4,tp5) shared(l,l_local,proj,U,dU)   // calculate the fourth step of RK4 (still in Fourier space though?!) - reduction(+: tmp0, tmp2, tmp3, tmp4, tmp5)
+  for(int kt=chunk_kt*grid_rank_modes;kt<chunk_kt*(grid_rank_modes+1);kt++){						// only the velocity cells of this process (see RK4_Inhomo_Apply)
+    tp0 = proj[5*kt]; tp2 = proj[5*kt+1]; tp3 = proj[5*kt+2]; tp4 = proj[5*kt+3]; tp5 = proj[5*kt+4];
     //tmp0 += tp0; tmp2 += dv*tp2 + Gridv((double)j1)*tp0; tmp3 += dv*tp3 +Gridv((double)j2)*tp0 ;tmp4 += dv*tp4 + Gridv((double)j3)*tp0;  //tmp5 += (Gridv((double)j1)*Gridv((double)j1) + Gridv((double)j2)*Gridv((double)j2) + Gridv((double)j3)*Gridv((double)j3))*tp0 +dv*dv*tp5+2*dv*(Gridv((double)j1)*tp2 + Gridv((double)j2)*tp3 +Gridv((double)j3)*tp4);
 	//tmp5 += dv*dv*tp5 -  (Gridv((double)j1)*Gridv((double)j1) + Gridv((double)j2)*Gridv((double)j2) + Gridv((double)j3)*Gridv((double)j3))*tp0 + 2*(Gridv((double)j1)*(dv*tp2 + Gridv((double)j1)*tp0) + Gridv((double)j2)*(dv*tp3 + Gridv((double)j2)*tp0) + Gridv((double)j3)*(dv*tp4 + Gridv((double)j3)*tp0));
 
-    k_v = l*size_v + kt;
+    k_v = l_local*size_v + kt;																		// U holds the cells of the space-steps of this process (see FetchCollisionCells)
     tp0 = U[k_v*6+0] + U[k_v*6+5]/4. + dt*tp0/scalev/scaleL/scale3;
     tp2 = U[k_v*6+2] + dt*tp2*12./scalev/scaleL/scale3;
     tp3 = U[k_v*6+3] + dt*tp3*12./scalev/scaleL/scale3;
     tp4 = U[k_v*6+4] + dt*tp4*12./scalev/scaleL/scale3;
     tp5 = U[k_v*6+0]/4. + U[k_v*6+5]*19./240. + dt*tp5/scalev/scaleL/scale3;
 
-    dU[(l_local*size_v + kt)*5] = 19*tp0/4. - 15*tp5;
-    dU[(l_local*size_v + kt)*5+4] = 60*tp5 - 15*tp0;
-    dU[(l_local*size_v + kt)*5+1] = tp2;
-    dU[(l_local*size_v + kt)*5+2] = tp3;
-    dU[(l_local*size_v + kt)*5+3] = tp4;
+    k_loc = Homogeneous ? kt - chunk_kt*grid_rank_modes : l_local*size_v + kt;						// in the space homogeneous problem dU only holds the chunksize_dg cells of this process (as in RK4_Homo)
+    dU[k_loc*5] = 19*tp0/4. - 15*tp5;
+    dU[k_loc*5+4] = 60*tp5 - 15*tp0;
+    dU[k_loc*5+1] = tp2;
+    dU[k_loc*5+2] = tp3;
+    dU[k_loc*5+3] = tp4;
   }
 }
 
@@ -19,6 +19,12 @@
 #include "advection_1.h"																				// allows the external variables and function prototypes declared in advection_1.h to be used in the collitionRoutines_1 functions
 #include "conservationRoutines.h"																		// allows the function prototypes declared in conservationRoutines.h to be used in the collisionRoutines_1 functions
 
+//************************//
+//         MACROS         //
+//************************//
+
+#define FFT_POINTS_PER_THREAD 4096																		// the number of points of an FFT grid per thread used for the FFT & the shifts around it (so an 8^3 or 16^3 grid uses one thread)
+
 //************************//
 //   FUNCTION PROTOTYPES  //
 //************************//
@@ -41,23 +47,82 @@ double S233hat_hardspheres(double ki1, double ki2, double ki3);
 
 double S213hat_hardspheres(double ki1, double ki2, double ki3);
 
+void ShatTensor(double ki1, double ki2, double ki3, int gamma, double Shat[3][3]);
+
 double gHat3(double eta1, double eta2, double eta3, double ki1, double ki2, double ki3, int gamma);
 
 double gHat3_linear(double eta1, double eta2, double eta3, double ki1, double ki2, double ki3 );
 
-double gHat3_2(double eta1, double eta2, double eta3, double ki1, double ki2, double ki3, int id);
+void TabulateShat(int gamma, double *Shat_w, double *Aiso_w);
+
+void WeightRowsFromShat(double **rows, int ki_start, int ki_end, const double *Shat_w, const double *Aiso_w, int gamma, bool linear);
+
+static inline double TabulatedWeight(const double *zeta, const double *w, const double *Shat, double Aiso, int gamma, bool linear)	// Function to rebuild gHat3(zeta, w) (or gHat3_linear(zeta, w) if linear is true) from the tensor Shat & isotropic term Aiso tabulated at w by TabulateShat (the same sums, in the same order, as gHat3 & gHat3_linear)
+{
+	double result = 0.;
+	int a, b;
+
+	if(linear)
+	{
+		for(a=0;a<3;a++)
+		{
+			for(b=0;b<3;b++)
+			{
+				result += Shat[3*a+b]*zeta[a]*(zeta[b]-w[b]);
+			}
+		}
+		result = -result;
+	}
+	else if(gamma==-3)
+	{
+		for(a=0;a<3;a++)
+		{
+			for(b=0;b<3;b++)
+			{
+				result += Shat[3*a+b]*(zeta[a]-w[a])*(zeta[b]-w[b]);
+			}
+		}
+		if(Aiso==0.) result = -result;																// this is the case w = 0
+		else result = Aiso - result;
+	}
+	else
+	{
+		for(a=0;a<3;a++)
+		{
+			for(b=0;b<3;b++)
+			{
+				result += Shat[3*a+b]*(2.*w[b]-zeta[b])*zeta[a];
+			}
+		}
+	}
+	return result;
+}
 
 void generate_conv_weights(double **conv_weights, int gamma);
 
 void generate_conv_weights_linear(double **conv_weights_linear);
 
-void generate_conv_weights2(double **conv_weights, int id);
+void InitFFTShifts();
+
+void FreeFFTShifts();
+
+int FFTThreads(int n);
+
+void PlanFFTs(unsigned flags);
+
+void fft3D(double *in, fftw_complex *out);
 
-void fft3D(fftw_complex *in, fftw_complex *out);
+void ifft3D(fftw_complex *in, double *out);
 
-void ifft3D(fftw_complex *in, fftw_complex *out);
+void FS(fftw_complex *in, double *out);
 
-void FS(fftw_complex *in, fftw_complex *out);
+void PlanBatchedFFTs(int cells, unsigned flags);
+
+void FreeBatchedFFTs();
+
+void fft3D_Batched(double **in, fftw_complex **out, int cells);
+
+void FS_Batched(fftw_complex **in, double **out, int cells);
 
 #ifdef MPI_parallelcollision
 void ComputeQ(double *f, fftw_complex *qHat, double **conv_weights);
@@ -69,8 +134,26 @@ void ProjectedNodeValue(fftw_complex *qHat, double *Q_incremental);
 
 void ComputeQ_FandL(double *f, fftw_complex *qHat, double **conv_weights, fftw_complex *qHat_linear, double **conv_weights_linear);
 
+void ComputeQ_FandL_Direct(double *f, fftw_complex *qHat, double **conv_weights, fftw_complex *qHat_linear, double **conv_weights_linear);
+
 void ComputeQ(double *f, fftw_complex *qHat, double **conv_weights);
 
+void ComputeQ_Direct(double *f, fftw_complex *qHat, double **conv_weights);
+
+static inline void ConvolutionWindow(int i, int *start, int *end)									// Function to find the range of indices l for which eta(l) & ki(i) - eta(l) are both in the domain (the same windows as in ComputeQ_Direct, for the engines which share them)
+{
+	if( i < N/2 )
+	{
+		*start = 0;
+		*end = i + N/2 + 1;
+	}
+	else
+	{
+		*start = i - N/2 + 1;
+		*end = N;
+	}
+}
+
 void RK4_FandL(double *f, int l, fftw_complex *qHat, double **conv_weights, fftw_complex *qHat_linear, double **conv_weights_linear, double *U, double *dU);
 
 void RK4(double *f, int l, fftw_complex *qHat, double **conv_weights, double *U, double *dU);
@@ -79,6 +162,10 @@ void RK4_FandL_Inhomo(double *f, int l, fftw_complex *qHat, double **conv_weight
 
 void RK4_Inhomo(double *f, int l, fftw_complex *qHat, double **conv_weights, double *U, double *dU);
 
+void RK4_Inhomo_Update(int l, fftw_complex *qHat, fftw_complex *Q1_hat, fftw_complex *Q2_hat, fftw_complex *Q3_hat, double *U, double *dU);
+
+void RK4_Inhomo_Apply(int l, double *proj, double *U, double *dU);
+
 void RK4_FandL_Homo(double *f, fftw_complex *qHat, double **conv_weights, fftw_complex *qHat_linear, double **conv_weights_linear, double *U, double *dU);
 
 void RK4_Homo(double *f, fftw_complex *qHat, double **conv_weights, double *U, double *dU);
@@ -97,6 +184,8 @@ void ComputeDFTofMaxwellian(double *UMaxwell, double **fMaxwell, fftw_complex **
 
 void ComputeQLinear(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat, double **conv_weights);
 
+void ComputeQLinear_Direct(double *f, fftw_complex *Maxwell_fftOut, fftw_complex *qHat, double **conv_weights);
+
 //void RK4Linear(double *f, fftw_complex *MaxwellHat, int l, double nu_val, fftw_complex *qHat, double **conv_weights, double *U, double *dU); // required for vector nu
 void RK4Linear(double *f, fftw_complex *MaxwellHat, int l, fftw_complex *qHat, double **conv_weights, double *U, double *dU);
 
@@ -130,6 +130,7 @@ void conserveAllMoments_FandL(fftw_complex *qHat, fftw_complex *qHat_linear) //
 
 void conserveAllMoments_Normal(fftw_complex *qHat) // Q^ -->Q--->conserve-->new Q^
 {
+	double lamb[5];												// the multipliers (a local array rather than the global lamb, so that the space-steps can be conserved by several threads at once)
 	double tmp0=0., tmp1=0., tmp2=0., tmp3=0., tmp4=0., tp0=0., tp1=0.;
 	int i,k_eta;	
 
@@ -297,6 +298,7 @@ void conserveMass_FandL(fftw_complex *qHat, fftw_complex *qHat_linear) // Q^ -->
 
 void conserveMass_Normal(fftw_complex *qHat) // Q^ -->Q--->conserve-->new Q^
 {
+	double lamb[5];												// the multipliers (a local array rather than the global lamb, so that the space-steps can be conserved by several threads at once)
 	double tmp0=0., tmp1=0., tmp2=0., tmp3=0., tmp4=0., tp0=0., tp1=0.;
 	int i,k_eta;
 